@@ -0,0 +1,182 @@
+//
+// Copyright (c) 2022-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR rhs
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR rhsWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR rhs DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/Container/IndexAllocator.h>
+#include <Urho3D/Core/WorkQueue.h>
+
+#include <EASTL/sort.h>
+
+#include <thread>
+
+TEST_CASE("ConcurrentIndexAllocator reuses released indices")
+{
+    ConcurrentIndexAllocator allocator;
+
+    ea::vector<unsigned> indices;
+    for (unsigned i = 0; i < 100; ++i)
+        indices.push_back(allocator.Allocate());
+    for (unsigned i = 0; i < 100; ++i)
+        REQUIRE(indices[i] == i + 1);
+    REQUIRE(allocator.GetNextFreeIndex() == 101);
+    REQUIRE(allocator.GetSize() == 100);
+
+    // Release all but the last index, they should be reused
+    for (unsigned i = 0; i < 99; ++i)
+        allocator.Release(indices[i]);
+    REQUIRE(allocator.GetSize() == 1);
+
+    ea::vector<unsigned> reusedIndices;
+    for (unsigned i = 0; i < 99; ++i)
+        reusedIndices.push_back(allocator.Allocate());
+    ea::sort(reusedIndices.begin(), reusedIndices.end());
+    for (unsigned i = 0; i < 99; ++i)
+        REQUIRE(reusedIndices[i] == i + 1);
+    REQUIRE(allocator.GetNextFreeIndex() == 101);
+    REQUIRE(allocator.GetSize() == 100);
+}
+
+TEST_CASE("ConcurrentIndexAllocator is shrunk to the last allocated index")
+{
+    ConcurrentIndexAllocator allocator;
+
+    ea::vector<unsigned> indices;
+    for (unsigned i = 0; i < 100; ++i)
+        indices.push_back(allocator.Allocate());
+
+    // Last index is released immediately
+    allocator.Release(indices[99]);
+    REQUIRE(allocator.GetNextFreeIndex() == 100);
+
+    // Index 99 becomes the last one and is released immediately too
+    for (unsigned i = 10; i < 99; ++i)
+        allocator.Release(indices[i]);
+    allocator.Release(indices[5]);
+    REQUIRE(allocator.GetNextFreeIndex() == 99);
+    REQUIRE(allocator.GetSize() == 9);
+
+    allocator.Shrink();
+    REQUIRE(allocator.GetNextFreeIndex() == 11);
+    REQUIRE(allocator.GetSize() == 9);
+
+    // Hole at index 6 is reused first
+    REQUIRE(allocator.Allocate() == 6);
+    REQUIRE(allocator.Allocate() == 11);
+
+    allocator.Clear();
+    REQUIRE(allocator.GetNextFreeIndex() == 1);
+    REQUIRE(allocator.Allocate() == 1);
+}
+
+TEST_CASE("ConcurrentIndexAllocator reuses indices cached by exited threads")
+{
+    ConcurrentIndexAllocator allocator;
+    const unsigned numIndices = ConcurrentIndexAllocator::CacheSize;
+    for (unsigned i = 0; i < numIndices * 2; ++i)
+        allocator.Allocate();
+
+    // Indices released by another thread end up in its cache
+    std::thread thread([&]
+    {
+        for (unsigned i = 1; i <= numIndices; ++i)
+            allocator.Release(i);
+    });
+    thread.join();
+
+    ea::vector<unsigned> reusedIndices;
+    for (unsigned i = 0; i < numIndices; ++i)
+        reusedIndices.push_back(allocator.Allocate());
+    ea::sort(reusedIndices.begin(), reusedIndices.end());
+
+    REQUIRE(reusedIndices.front() == 1);
+    REQUIRE(reusedIndices.back() == numIndices);
+    REQUIRE(allocator.GetNextFreeIndex() == numIndices * 2 + 1);
+}
+
+TEST_CASE("ConcurrentIndexAllocator returns unique indices from all threads")
+{
+    auto context = MakeShared<Context>();
+    auto workQueue = MakeShared<WorkQueue>(context);
+    workQueue->CreateThreads(3);
+
+    ConcurrentIndexAllocator allocator;
+    const unsigned numIndices = 4000;
+    ea::vector<unsigned> indices(numIndices);
+
+    for (unsigned iteration = 0; iteration < 20; ++iteration)
+    {
+        // Allocate in all threads
+        ForEachParallel(workQueue, 1, numIndices, [&](unsigned beginIndex, unsigned endIndex)
+        {
+            for (unsigned i = beginIndex; i < endIndex; ++i)
+                indices[i] = allocator.Allocate();
+        });
+
+        ea::vector<unsigned> sortedIndices = indices;
+        ea::sort(sortedIndices.begin(), sortedIndices.end());
+        REQUIRE(sortedIndices.front() != 0);
+        REQUIRE(ea::adjacent_find(sortedIndices.begin(), sortedIndices.end()) == sortedIndices.end());
+        REQUIRE(sortedIndices.back() < allocator.GetNextFreeIndex());
+        REQUIRE(allocator.GetSize() == numIndices);
+
+        // Release half of indices from other threads, interleaved with allocations and shrinks
+        ForEachParallel(workQueue, 1, numIndices / 2, [&](unsigned beginIndex, unsigned endIndex)
+        {
+            for (unsigned i = beginIndex; i < endIndex; ++i)
+            {
+                const unsigned j = numIndices - i - 1;
+                allocator.Release(indices[j]);
+                indices[j] = 0;
+
+                if (i % 2 == 0)
+                    indices[j] = allocator.Allocate();
+                if (i % 500 == 0)
+                    allocator.Shrink();
+            }
+        });
+
+        sortedIndices.clear();
+        for (unsigned index : indices)
+        {
+            if (index != 0)
+                sortedIndices.push_back(index);
+        }
+        ea::sort(sortedIndices.begin(), sortedIndices.end());
+        REQUIRE(ea::adjacent_find(sortedIndices.begin(), sortedIndices.end()) == sortedIndices.end());
+        REQUIRE(allocator.GetSize() == sortedIndices.size());
+
+        // Release everything
+        ForEachParallel(workQueue, 1, numIndices, [&](unsigned beginIndex, unsigned endIndex)
+        {
+            for (unsigned i = beginIndex; i < endIndex; ++i)
+            {
+                if (indices[i] != 0)
+                    allocator.Release(indices[i]);
+            }
+        });
+        REQUIRE(allocator.GetSize() == 0);
+
+        allocator.Shrink();
+        REQUIRE(allocator.GetNextFreeIndex() == 1);
+    }
+}
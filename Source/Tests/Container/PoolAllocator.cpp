@@ -0,0 +1,163 @@
+//
+// Copyright (c) 2022-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR rhs
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR rhsWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR rhs DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/Container/Allocator.h>
+#include <Urho3D/Container/PoolAllocator.h>
+#include <Urho3D/Container/ThreadSlot.h>
+#include <Urho3D/Core/WorkQueue.h>
+
+#include <EASTL/list.h>
+
+#include <thread>
+
+TEST_CASE("ConcurrentPool reuses freed nodes")
+{
+    ConcurrentPool pool(24, 4);
+    REQUIRE(pool.GetNodeSize() == 32);
+
+    ea::vector<void*> nodes;
+    for (unsigned i = 0; i < 10; ++i)
+    {
+        void* node = pool.Allocate();
+        REQUIRE(reinterpret_cast<uintptr_t>(node) % ConcurrentPool::NodeHeaderSize == 0);
+        nodes.push_back(node);
+    }
+
+    REQUIRE(pool.GetStats().numLiveNodes_ == 10);
+    REQUIRE(pool.GetStats().numPeakNodes_ == 10);
+    REQUIRE(pool.GetStats().numCapacityNodes_ == 12);
+
+    for (void* node : nodes)
+        pool.Free(node);
+    for (unsigned i = 0; i < 10; ++i)
+        nodes[i] = pool.Allocate();
+
+    REQUIRE(pool.GetStats().numLiveNodes_ == 10);
+    REQUIRE(pool.GetStats().numCapacityNodes_ == 12);
+
+    for (void* node : nodes)
+        pool.Free(node);
+    REQUIRE(pool.GetStats().numLiveNodes_ == 0);
+    REQUIRE(pool.GetStats().numPeakNodes_ == 10);
+}
+
+TEST_CASE("ConcurrentPool nodes are freed from other threads")
+{
+    auto context = MakeShared<Context>();
+    auto workQueue = MakeShared<WorkQueue>(context);
+    workQueue->CreateThreads(3);
+
+    ConcurrentPool pool(sizeof(unsigned));
+    const unsigned numNodes = 1000;
+    ea::vector<unsigned*> nodes(numNodes);
+    std::atomic<unsigned> numCorruptedNodes{};
+
+    for (unsigned iteration = 0; iteration < 10; ++iteration)
+    {
+        // Allocate in all threads
+        ForEachParallel(workQueue, 1, numNodes, [&](unsigned beginIndex, unsigned endIndex)
+        {
+            for (unsigned i = beginIndex; i < endIndex; ++i)
+            {
+                nodes[i] = static_cast<unsigned*>(pool.Allocate());
+                *nodes[i] = i;
+            }
+        });
+
+        // Free in reverse order so most nodes are returned to other threads
+        ForEachParallel(workQueue, 1, numNodes, [&](unsigned beginIndex, unsigned endIndex)
+        {
+            for (unsigned i = beginIndex; i < endIndex; ++i)
+            {
+                unsigned* node = nodes[numNodes - i - 1];
+                if (*node != numNodes - i - 1)
+                    numCorruptedNodes.fetch_add(1, std::memory_order_relaxed);
+                pool.Free(node);
+            }
+        });
+    }
+
+    const PoolAllocatorStats stats = pool.GetStats();
+    REQUIRE(numCorruptedNodes == 0);
+    REQUIRE(stats.numLiveNodes_ == 0);
+    REQUIRE(stats.numCapacityNodes_ <= numNodes * 4);
+}
+
+TEST_CASE("ConcurrentPool reuses nodes and thread slots of exited threads")
+{
+    const unsigned nodesPerBlock = 16;
+    ConcurrentPool pool(sizeof(unsigned), nodesPerBlock);
+
+    // Start more threads than there are thread caches, one at a time
+    const unsigned numThreads = ConcurrentPool::MaxThreadCaches * 2;
+    unsigned maxThreadSlot = 0;
+    for (unsigned i = 0; i < numThreads; ++i)
+    {
+        unsigned threadSlot = 0;
+        std::thread thread([&]
+        {
+            threadSlot = ThreadSlot::GetCurrent();
+
+            ea::vector<void*> nodes;
+            for (unsigned j = 0; j < nodesPerBlock; ++j)
+                nodes.push_back(pool.Allocate());
+            for (void* node : nodes)
+                pool.Free(node);
+        });
+        thread.join();
+        maxThreadSlot = ea::max(maxThreadSlot, threadSlot);
+    }
+
+    const PoolAllocatorStats stats = pool.GetStats();
+    REQUIRE(maxThreadSlot < ConcurrentPool::MaxThreadCaches);
+    REQUIRE(stats.numLiveNodes_ == 0);
+    REQUIRE(stats.numCapacityNodes_ == nodesPerBlock);
+}
+
+TEST_CASE("Allocator constructs and destroys objects")
+{
+    Allocator<ea::string> allocator(2);
+
+    ea::string* first = allocator.Reserve("First string that is long enough to be allocated on heap");
+    ea::string* second = allocator.Reserve();
+    REQUIRE(*first == "First string that is long enough to be allocated on heap");
+    REQUIRE(second->empty());
+    REQUIRE(allocator.GetStats().numLiveNodes_ == 2);
+
+    allocator.Free(first);
+    allocator.Free(second);
+    REQUIRE(allocator.GetStats().numLiveNodes_ == 0);
+}
+
+TEST_CASE("PoolEASTLAllocator is used by node-based containers")
+{
+    ea::list<unsigned, PoolEASTLAllocator> values;
+    for (unsigned i = 0; i < 100; ++i)
+        values.push_back(i);
+    REQUIRE(PoolAllocator::GetStats().numLiveNodes_ >= 100);
+
+    unsigned expectedValue = 0;
+    for (unsigned value : values)
+        REQUIRE(value == expectedValue++);
+}
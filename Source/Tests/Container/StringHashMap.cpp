@@ -0,0 +1,222 @@
+//
+// Copyright (c) 2022-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR rhs
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR rhsWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR rhs DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/Container/StringHashMap.h>
+#include <Urho3D/Math/RandomEngine.h>
+
+#include <EASTL/unordered_map.h>
+
+namespace
+{
+
+ea::vector<StringHash> GenerateKeys(unsigned count, unsigned seed)
+{
+    ea::vector<StringHash> keys;
+    for (unsigned i = 0; i < count; ++i)
+        keys.emplace_back(Format("Key_{}_{}", seed, i));
+    return keys;
+}
+
+template <class T, class U>
+void CompareMaps(const T& map, const U& referenceMap)
+{
+    REQUIRE(map.size() == referenceMap.size());
+
+    unsigned numIterated = 0;
+    for (const auto& [key, value] : map)
+    {
+        const auto iter = referenceMap.find(key);
+        REQUIRE(iter != referenceMap.end());
+        REQUIRE(iter->second == value);
+        ++numIterated;
+    }
+    REQUIRE(numIterated == referenceMap.size());
+
+    for (const auto& [key, value] : referenceMap)
+    {
+        const auto iter = map.find(key);
+        REQUIRE(iter != map.end());
+        REQUIRE(iter->second == value);
+    }
+}
+
+}
+
+TEST_CASE("StringHashMap behaves like unordered_map")
+{
+    StringHashMap<ea::string> map;
+    ea::unordered_map<StringHash, ea::string> referenceMap;
+
+    RandomEngine rng(0);
+    const ea::vector<StringHash> keys = GenerateKeys(2000, 0);
+    for (unsigned i = 0; i < 20000; ++i)
+    {
+        const StringHash key = keys[rng.GetUInt(0, keys.size())];
+        const unsigned operation = rng.GetUInt(0, 4);
+        if (operation == 0)
+        {
+            const ea::string value = Format("Value {}", i);
+            REQUIRE(map.emplace(key, value).second == referenceMap.emplace(key, value).second);
+        }
+        else if (operation == 1)
+        {
+            map[key] = Format("Assigned {}", i);
+            referenceMap[key] = Format("Assigned {}", i);
+        }
+        else if (operation == 2)
+        {
+            REQUIRE(map.erase(key) == referenceMap.erase(key));
+        }
+        else
+        {
+            REQUIRE(map.contains(key) == referenceMap.contains(key));
+        }
+    }
+
+    CompareMaps(map, referenceMap);
+
+    // Erase elements while iterating
+    for (auto iter = map.begin(); iter != map.end();)
+    {
+        if (iter->first.Value() % 2 == 0)
+        {
+            referenceMap.erase(iter->first);
+            iter = map.erase(iter);
+        }
+        else
+            ++iter;
+    }
+
+    CompareMaps(map, referenceMap);
+
+    const StringHashMap<ea::string> mapCopy = map;
+    CompareMaps(mapCopy, referenceMap);
+    REQUIRE(mapCopy == map);
+
+    const StringHashMap<ea::string> mapMoved = ea::move(map);
+    CompareMaps(mapMoved, referenceMap);
+    REQUIRE(map.empty());
+    REQUIRE(map.begin() == map.end());
+
+    map = mapMoved;
+    map.clear();
+    REQUIRE(map.empty());
+    REQUIRE(map.find(keys[0]) == map.end());
+}
+
+TEST_CASE("StringHashMap handles colliding ideal slots")
+{
+    // Keys with equal low bits of hash, so probe sequences overlap
+    StringHashMap<unsigned> map;
+    for (unsigned i = 0; i < 1000; ++i)
+        map.emplace(StringHash(i << 16), i);
+
+    REQUIRE(map.size() == 1000);
+    for (unsigned i = 0; i < 1000; ++i)
+        REQUIRE(map[StringHash(i << 16)] == i);
+
+    for (unsigned i = 0; i < 1000; i += 2)
+        REQUIRE(map.erase(StringHash(i << 16)) == 1);
+
+    REQUIRE(map.size() == 500);
+    for (unsigned i = 0; i < 1000; ++i)
+        REQUIRE(map.contains(StringHash(i << 16)) == (i % 2 == 1));
+}
+
+TEST_CASE("StringHashMap performance is compared to unordered_map", "[.][benchmark]")
+{
+    for (unsigned size : {8u, 64u, 1024u, 16384u})
+    {
+        const ea::vector<StringHash> keys = GenerateKeys(size, 1);
+
+        StringHashMap<unsigned> map;
+        ea::unordered_map<StringHash, unsigned> referenceMap;
+        for (unsigned i = 0; i < size; ++i)
+        {
+            map.emplace(keys[i], i);
+            referenceMap.emplace(keys[i], i);
+        }
+
+        const unsigned numLookups = 16384;
+        ea::vector<StringHash> lookupKeys;
+        for (unsigned i = 0; i < numLookups; ++i)
+            lookupKeys.push_back(i % 2 == 0 ? keys[(i * 7919) % size] : StringHash(i));
+
+        BENCHMARK(Format("Lookup x{} in StringHashMap of {}", numLookups, size).c_str())
+        {
+            unsigned sum = 0;
+            for (StringHash key : lookupKeys)
+            {
+                const auto iter = map.find(key);
+                if (iter != map.end())
+                    sum += iter->second;
+            }
+            return sum;
+        };
+
+        BENCHMARK(Format("Lookup x{} in unordered_map of {}", numLookups, size).c_str())
+        {
+            unsigned sum = 0;
+            for (StringHash key : lookupKeys)
+            {
+                const auto iter = referenceMap.find(key);
+                if (iter != referenceMap.end())
+                    sum += iter->second;
+            }
+            return sum;
+        };
+
+        BENCHMARK(Format("Insert {} to StringHashMap", size).c_str())
+        {
+            StringHashMap<unsigned> newMap;
+            for (unsigned i = 0; i < size; ++i)
+                newMap.emplace(keys[i], i);
+            return newMap.size();
+        };
+
+        BENCHMARK(Format("Insert {} to unordered_map", size).c_str())
+        {
+            ea::unordered_map<StringHash, unsigned> newMap;
+            for (unsigned i = 0; i < size; ++i)
+                newMap.emplace(keys[i], i);
+            return newMap.size();
+        };
+
+        BENCHMARK(Format("Iterate StringHashMap of {}", size).c_str())
+        {
+            unsigned sum = 0;
+            for (const auto& [key, value] : map)
+                sum += value;
+            return sum;
+        };
+
+        BENCHMARK(Format("Iterate unordered_map of {}", size).c_str())
+        {
+            unsigned sum = 0;
+            for (const auto& [key, value] : referenceMap)
+                sum += value;
+            return sum;
+        };
+    }
+}
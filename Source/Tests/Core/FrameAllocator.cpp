@@ -0,0 +1,152 @@
+//
+// Copyright (c) 2022-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR rhs
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR rhsWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR rhs DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/Core/CoreEvents.h>
+#include <Urho3D/Core/FrameAllocator.h>
+#include <Urho3D/Core/WorkQueue.h>
+
+#include <EASTL/numeric.h>
+
+namespace
+{
+
+/// Simulate frame with temporary containers.
+template <class Allocator>
+unsigned SimulateFrame(const Allocator& allocator, unsigned numContainers, unsigned numElements)
+{
+    unsigned checksum = 0;
+    for (unsigned i = 0; i < numContainers; ++i)
+    {
+        ea::vector<unsigned, Allocator> values(allocator);
+        for (unsigned j = 0; j < numElements + i % 32; ++j)
+            values.push_back(i + j);
+        checksum += values.back();
+    }
+    return checksum;
+}
+
+}
+
+TEST_CASE("LinearAllocator allocates aligned memory and reuses it after reset")
+{
+    LinearAllocator allocator(1024);
+
+    void* first = allocator.Allocate(10, 4);
+    void* second = allocator.Allocate(1, 64);
+    REQUIRE(reinterpret_cast<uintptr_t>(first) % 4 == 0);
+    REQUIRE(reinterpret_cast<uintptr_t>(second) % 64 == 0);
+    REQUIRE(allocator.GetStats().allocatedBytes_ == 11);
+    REQUIRE(allocator.GetStats().numBlockAllocations_ == 1);
+
+    // Overflow into new blocks
+    allocator.Allocate(2000);
+    allocator.Allocate(600);
+    REQUIRE(allocator.GetStats().numBlockAllocations_ == 3);
+    REQUIRE(allocator.GetStats().peakAllocatedBytes_ == 2611);
+
+    // Blocks are merged on reset
+    allocator.Reset();
+    REQUIRE(allocator.GetStats().allocatedBytes_ == 0);
+    REQUIRE(allocator.GetStats().peakAllocatedBytes_ == 2611);
+    REQUIRE(allocator.GetStats().numBlockAllocations_ == 4);
+
+    allocator.Allocate(10, 4);
+    allocator.Allocate(1, 64);
+    allocator.Allocate(2000);
+    allocator.Allocate(600);
+    REQUIRE(allocator.GetStats().numBlockAllocations_ == 4);
+}
+
+TEST_CASE("FrameAllocator is used from multiple threads")
+{
+    auto context = MakeShared<Context>();
+    auto workQueue = MakeShared<WorkQueue>(context);
+    workQueue->CreateThreads(3);
+
+    const unsigned size = 1000;
+    ea::vector<unsigned> checksums(size);
+    ForEachParallel(workQueue, 1, size, [&](unsigned beginIndex, unsigned endIndex)
+    {
+        for (unsigned i = beginIndex; i < endIndex; ++i)
+        {
+            FrameVector<unsigned> values(workQueue->GetFrameAllocator());
+            for (unsigned j = 0; j <= i; ++j)
+                values.push_back(j);
+            checksums[i] = ea::accumulate(values.begin(), values.end(), 0u);
+        }
+    });
+
+    for (unsigned i = 0; i < size; ++i)
+        REQUIRE(checksums[i] == i * (i + 1) / 2);
+
+    FrameMemory* frameMemory = workQueue->GetFrameMemory();
+    REQUIRE(frameMemory->GetStats().allocatedBytes_ != 0);
+    frameMemory->Reset();
+    REQUIRE(frameMemory->GetStats().allocatedBytes_ == 0);
+    REQUIRE(frameMemory->GetStats().peakAllocatedBytes_ != 0);
+}
+
+TEST_CASE("FrameAllocator memory is owned by WorkQueue")
+{
+    auto context = MakeShared<Context>();
+    auto firstQueue = MakeShared<WorkQueue>(context);
+    auto secondQueue = MakeShared<WorkQueue>(context);
+
+    {
+        FrameVector<unsigned> values(firstQueue->GetFrameAllocator());
+        values.resize(100);
+    }
+    REQUIRE(firstQueue->GetFrameMemory()->GetStats().allocatedBytes_ != 0);
+    REQUIRE(secondQueue->GetFrameMemory()->GetStats().allocatedBytes_ == 0);
+
+    // Default-constructed allocator uses the heap
+    {
+        FrameVector<unsigned> values;
+        values.resize(100);
+        REQUIRE(values.get_allocator().GetMemory() == nullptr);
+    }
+    REQUIRE(secondQueue->GetFrameMemory()->GetStats().allocatedBytes_ == 0);
+
+    firstQueue->SendEvent(E_ENDFRAME);
+    REQUIRE(firstQueue->GetFrameMemory()->GetStats().allocatedBytes_ == 0);
+}
+
+TEST_CASE("FrameAllocator benchmark", "[.][benchmark]")
+{
+    const unsigned numContainers = 2000;
+    const unsigned numElements = 100;
+    FrameMemory frameMemory;
+
+    BENCHMARK("Frame with heap allocations")
+    {
+        return SimulateFrame(EASTLAllocatorType(), numContainers, numElements);
+    };
+
+    BENCHMARK("Frame with frame allocator")
+    {
+        const unsigned checksum = SimulateFrame(FrameAllocator(&frameMemory), numContainers, numElements);
+        frameMemory.Reset();
+        return checksum;
+    };
+}
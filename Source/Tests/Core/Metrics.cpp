@@ -0,0 +1,166 @@
+//
+// Copyright (c) 2022-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR rhs
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR rhsWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR rhs DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/Core/Metrics.h>
+#include <Urho3D/Resource/JSONFile.h>
+
+#include <thread>
+
+TEST_CASE("Metrics are aggregated over threads")
+{
+    auto& registry = MetricsRegistry::Get();
+    const MetricId counterId = registry.RegisterMetric("Tests.Counter", MetricType::Counter);
+    const MetricId histogramId = registry.RegisterMetric("Tests.Histogram", MetricType::Histogram);
+    REQUIRE(registry.RegisterMetric("Tests.Counter", MetricType::Counter) == counterId);
+
+    const unsigned numThreads = 4;
+    const unsigned numSamplesPerThread = 1000;
+
+    ea::vector<std::thread> threads;
+    for (unsigned threadIndex = 0; threadIndex < numThreads; ++threadIndex)
+    {
+        threads.emplace_back([&]
+        {
+            for (unsigned i = 0; i < numSamplesPerThread; ++i)
+            {
+                registry.Record(counterId, 2);
+                registry.Record(histogramId, i);
+                URHO3D_METRIC_TIMER("Tests.Timer");
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+
+    const MetricsSnapshot snapshot = registry.TakeSnapshot();
+
+    const MetricSnapshot* counter = snapshot.FindMetric("Tests.Counter");
+    REQUIRE(counter);
+    CHECK(counter->type_ == MetricType::Counter);
+    CHECK(counter->count_ == numThreads * numSamplesPerThread);
+    CHECK(counter->sum_ == 2 * numThreads * numSamplesPerThread);
+    CHECK(counter->buckets_.empty());
+
+    const MetricSnapshot* histogram = snapshot.FindMetric("Tests.Histogram");
+    REQUIRE(histogram);
+    CHECK(histogram->count_ == numThreads * numSamplesPerThread);
+    CHECK(histogram->sum_ == numThreads * numSamplesPerThread * (numSamplesPerThread - 1) / 2);
+    CHECK(histogram->min_ == 0);
+    CHECK(histogram->max_ == numSamplesPerThread - 1);
+    CHECK(histogram->buckets_[0] == numThreads);
+    CHECK(histogram->buckets_[1] == numThreads);
+    CHECK(histogram->buckets_[2] == 2 * numThreads);
+    CHECK(histogram->GetPercentile(0.5f) == 511);
+    CHECK(histogram->GetPercentile(1.0f) == numSamplesPerThread - 1);
+
+    const MetricSnapshot* timer = snapshot.FindMetric("Tests.Timer");
+    REQUIRE(timer);
+    CHECK(timer->type_ == MetricType::Timer);
+    CHECK(timer->count_ == numThreads * numSamplesPerThread);
+}
+
+TEST_CASE("Metrics are not recorded when disabled")
+{
+    auto& registry = MetricsRegistry::Get();
+    const MetricId counterId = registry.RegisterMetric("Tests.DisabledCounter", MetricType::Counter);
+
+    registry.SetEnabled(false);
+    registry.Record(counterId, 1);
+    registry.SetEnabled(true);
+    registry.Record(counterId, 10);
+
+    const MetricsSnapshot snapshot = registry.TakeSnapshot();
+    const MetricSnapshot* counter = snapshot.FindMetric("Tests.DisabledCounter");
+    REQUIRE(counter);
+    CHECK(counter->count_ == 1);
+    CHECK(counter->sum_ == 10);
+}
+
+TEST_CASE("Metrics shards are reused by new threads")
+{
+    auto& registry = MetricsRegistry::Get();
+    const MetricId counterId = registry.RegisterMetric("Tests.ReusedCounter", MetricType::Counter);
+
+    const auto recordFromThread = [&] { std::thread([&] { registry.Record(counterId, 3); }).join(); };
+
+    recordFromThread();
+    const unsigned numShards = registry.GetNumShards();
+
+    const unsigned numThreads = 16;
+    for (unsigned i = 0; i < numThreads; ++i)
+        recordFromThread();
+    CHECK(registry.GetNumShards() == numShards);
+
+    // Samples of exited threads are kept
+    const MetricsSnapshot snapshot = registry.TakeSnapshot();
+    const MetricSnapshot* counter = snapshot.FindMetric("Tests.ReusedCounter");
+    REQUIRE(counter);
+    CHECK(counter->count_ == numThreads + 1);
+    CHECK(counter->sum_ == 3 * (numThreads + 1));
+    CHECK(counter->min_ == 3);
+    CHECK(counter->max_ == 3);
+}
+
+TEST_CASE("Metrics snapshot is serialized")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    URHO3D_METRIC_HISTOGRAM("Tests.SerializedHistogram", 100);
+
+    const MetricsSnapshot snapshot = MetricsRegistry::Get().TakeSnapshot();
+    auto file = MakeShared<JSONFile>(context);
+    REQUIRE(file->SaveObject("metrics", snapshot));
+
+    MetricsSnapshot loadedSnapshot;
+    REQUIRE(file->LoadObject("metrics", loadedSnapshot));
+    REQUIRE(loadedSnapshot.metrics_.size() == snapshot.metrics_.size());
+
+    const MetricSnapshot* histogram = loadedSnapshot.FindMetric("Tests.SerializedHistogram");
+    REQUIRE(histogram);
+    CHECK(histogram->type_ == MetricType::Histogram);
+    CHECK(histogram->count_ == 1);
+    CHECK(histogram->sum_ == 100);
+    CHECK(histogram->buckets_.size() == MetricSnapshot::NumBuckets);
+    CHECK(histogram->buckets_[7] == 1);
+}
+
+TEST_CASE("Metrics overhead is measured", "[.][benchmark]")
+{
+    unsigned value = 0;
+    BENCHMARK("Empty scope")
+    {
+        return ++value;
+    };
+
+    BENCHMARK("Scoped timer")
+    {
+        URHO3D_METRIC_TIMER("Tests.BenchmarkTimer");
+        return ++value;
+    };
+
+    BENCHMARK("Counter")
+    {
+        URHO3D_METRIC_COUNTER("Tests.BenchmarkCounter", 1);
+        return ++value;
+    };
+}
@@ -0,0 +1,101 @@
+//
+// Copyright (c) 2022-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR rhs
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR rhsWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR rhs DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/Core/RadixSort.h>
+#include <Urho3D/Core/WorkQueue.h>
+
+#include <EASTL/sort.h>
+
+namespace
+{
+
+struct SortedElement
+{
+    unsigned long long key_{};
+    unsigned index_{};
+};
+
+ea::vector<SortedElement> CreateElements(unsigned size, unsigned long long keyMask, unsigned seed)
+{
+    ea::vector<SortedElement> result(size);
+    unsigned long long state = seed * 6364136223846793005ull + 1442695040888963407ull;
+    for (unsigned i = 0; i < size; ++i)
+    {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        result[i].key_ = (state ^ (state >> 29)) & keyMask;
+        result[i].index_ = i;
+    }
+    return result;
+}
+
+bool IsSameOrder(const ea::vector<SortedElement>& lhs, const ea::vector<SortedElement>& rhs)
+{
+    const auto isSame = [](const SortedElement& lhs, const SortedElement& rhs)
+    { return lhs.key_ == rhs.key_ && lhs.index_ == rhs.index_; };
+    return lhs.size() == rhs.size() && ea::equal(lhs.begin(), lhs.end(), rhs.begin(), isSame);
+}
+
+}
+
+TEST_CASE("RadixSorter sorts elements in stable order")
+{
+    auto context = MakeShared<Context>();
+    auto workQueue = MakeShared<WorkQueue>(context);
+    workQueue->CreateThreads(3);
+
+    const unsigned size = GENERATE(0u, 1u, 17u, 64u, 65u, 1000u, 4095u, 4096u, 50000u);
+    const unsigned long long keyMask = GENERATE(0ull, 0xfull, 0xff00ff00ull, 0xffffffffffffffffull);
+
+    const auto getKey = [](const SortedElement& element) { return element.key_; };
+    const ea::vector<SortedElement> elements = CreateElements(size, keyMask, size);
+
+    ea::vector<SortedElement> expected = elements;
+    ea::stable_sort(expected.begin(), expected.end(),
+        [](const SortedElement& lhs, const SortedElement& rhs) { return lhs.key_ < rhs.key_; });
+
+    RadixSorter<SortedElement> sorter;
+
+    ea::vector<SortedElement> sortedInMainThread = elements;
+    sorter.Sort(nullptr, sortedInMainThread, getKey);
+    REQUIRE(IsSameOrder(sortedInMainThread, expected));
+
+    ea::vector<SortedElement> sortedInThreads = elements;
+    sorter.Sort(workQueue, sortedInThreads, getKey);
+    REQUIRE(IsSameOrder(sortedInThreads, expected));
+}
+
+TEST_CASE("RadixSorter sorts subrange of array")
+{
+    const auto getKey = [](const SortedElement& element) { return element.key_; };
+    ea::vector<SortedElement> elements = CreateElements(1000, 0xffffull, 1);
+    const ea::vector<SortedElement> original = elements;
+
+    RadixSorter<SortedElement> sorter;
+    sorter.Sort(nullptr, ea::span<SortedElement>(elements).subspan(100, 800), getKey);
+
+    REQUIRE(IsSameOrder({original.begin(), original.begin() + 100}, {elements.begin(), elements.begin() + 100}));
+    REQUIRE(IsSameOrder({original.begin() + 900, original.end()}, {elements.begin() + 900, elements.end()}));
+    REQUIRE(ea::is_sorted(elements.begin() + 100, elements.begin() + 900,
+        [](const SortedElement& lhs, const SortedElement& rhs) { return lhs.key_ < rhs.key_; }));
+}
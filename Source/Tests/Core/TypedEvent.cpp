@@ -0,0 +1,153 @@
+//
+// Copyright (c) 2022-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR rhs
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR rhsWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR rhs DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/Scene/LogicComponent.h>
+#include <Urho3D/Scene/Scene.h>
+#include <Urho3D/Scene/SceneEvents.h>
+
+namespace
+{
+
+class TestUpdateCounter : public LogicComponent
+{
+    URHO3D_OBJECT(TestUpdateCounter, LogicComponent);
+
+public:
+    using LogicComponent::LogicComponent;
+
+    void Update(float timeStep) override { timeStep_ += timeStep; ++numUpdates_; }
+    void PostUpdate(float timeStep) override { ++numPostUpdates_; }
+
+    float timeStep_{};
+    unsigned numUpdates_{};
+    unsigned numPostUpdates_{};
+};
+
+}
+
+TEST_CASE("Typed events are delivered to typed and VariantMap receivers")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto scene = MakeShared<Scene>(context);
+    auto receiver = MakeShared<Node>(context);
+
+    ea::vector<ea::string> calls;
+    scene->OnSceneUpdate.Subscribe(receiver.Get(), [&](const SceneUpdateEvent& event)
+    {
+        REQUIRE(event.scene_ == scene);
+        calls.push_back(Format("Typed {}", event.timeStep_));
+    });
+    receiver->SubscribeToEvent(scene, E_SCENEUPDATE, [&](StringHash, VariantMap& eventData)
+    {
+        REQUIRE(eventData[SceneUpdate::P_SCENE].GetPtr() == scene);
+        calls.push_back(Format("Specific {}", eventData[SceneUpdate::P_TIMESTEP].GetFloat()));
+    });
+
+    scene->OnSceneUpdate.Send({scene, 0.5f});
+    REQUIRE(calls == ea::vector<ea::string>{"Typed 0.5", "Specific 0.5"});
+
+    receiver->UnsubscribeFromAllEvents();
+    scene->OnSceneUpdate.Unsubscribe(receiver);
+    calls.clear();
+
+    scene->OnSceneUpdate.Send({scene, 0.5f});
+    REQUIRE(calls.empty());
+}
+
+TEST_CASE("Typed event receivers are added and removed during sending")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto scene = MakeShared<Scene>(context);
+    auto receiver1 = MakeShared<Node>(context);
+    auto receiver2 = MakeShared<Node>(context);
+    auto receiver3 = MakeShared<Node>(context);
+
+    ea::vector<unsigned> calls;
+    scene->OnSceneUpdate.Subscribe(receiver1.Get(), [&](const SceneUpdateEvent&)
+    {
+        calls.push_back(1);
+        scene->OnSceneUpdate.Unsubscribe(receiver2);
+        scene->OnSceneUpdate.Subscribe(receiver3.Get(), [&](const SceneUpdateEvent&) { calls.push_back(3); });
+    });
+    scene->OnSceneUpdate.Subscribe(receiver2.Get(), [&](const SceneUpdateEvent&) { calls.push_back(2); });
+
+    scene->OnSceneUpdate.Send({scene, 0.1f});
+    REQUIRE(calls == ea::vector<unsigned>{1});
+
+    scene->OnSceneUpdate.Unsubscribe(receiver1);
+    receiver3 = nullptr;
+    calls.clear();
+
+    scene->OnSceneUpdate.Send({scene, 0.1f});
+    REQUIRE(calls.empty());
+    REQUIRE(scene->OnSceneUpdate.GetNumSubscriptions() == 0);
+}
+
+TEST_CASE("LogicComponent is updated via typed scene events")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    if (!context->IsReflected<TestUpdateCounter>())
+        context->AddFactoryReflection<TestUpdateCounter>();
+
+    auto scene = MakeShared<Scene>(context);
+    SharedPtr<TestUpdateCounter> counter{scene->CreateChild("Node")->CreateComponent<TestUpdateCounter>()};
+
+    scene->Update(0.25f);
+    scene->Update(0.25f);
+    REQUIRE(counter->numUpdates_ == 2);
+    REQUIRE(counter->numPostUpdates_ == 2);
+    REQUIRE(counter->timeStep_ == 0.5f);
+
+    counter->SetEnabled(false);
+    scene->Update(0.25f);
+    REQUIRE(counter->numUpdates_ == 2);
+
+    counter->SetEnabled(true);
+    counter->Remove();
+    scene->Update(0.25f);
+    REQUIRE(counter->numUpdates_ == 2);
+    REQUIRE(counter->numPostUpdates_ == 2);
+}
+
+TEST_CASE("LogicComponent is updated before VariantMap scene update receivers")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    if (!context->IsReflected<TestUpdateCounter>())
+        context->AddFactoryReflection<TestUpdateCounter>();
+
+    auto scene = MakeShared<Scene>(context);
+    auto receiver = MakeShared<Node>(context);
+
+    // Subscribe to VariantMap event before the component is created
+    unsigned numUpdatesBeforeEvent = M_MAX_UNSIGNED;
+    TestUpdateCounter* counter{};
+    receiver->SubscribeToEvent(scene, E_SCENEUPDATE, [&](StringHash, VariantMap&)
+    {
+        numUpdatesBeforeEvent = counter->numUpdates_;
+    });
+    counter = scene->CreateChild("Node")->CreateComponent<TestUpdateCounter>();
+
+    scene->Update(0.25f);
+    REQUIRE(numUpdatesBeforeEvent == 1);
+}
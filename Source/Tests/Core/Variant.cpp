@@ -0,0 +1,174 @@
+//
+// Copyright (c) 2022-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR rhs
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR rhsWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR rhs DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/Core/Variant.h>
+#include <Urho3D/Scene/Node.h>
+
+namespace
+{
+
+struct LargeCustomValue
+{
+    ea::string name_;
+    Matrix4 matrix_;
+
+    bool operator==(const LargeCustomValue& rhs) const { return name_ == rhs.name_ && matrix_ == rhs.matrix_; }
+};
+
+class EventCounter : public Object
+{
+    URHO3D_OBJECT(EventCounter, Object);
+
+public:
+    explicit EventCounter(Context* context, StringHash eventType)
+        : Object(context)
+    {
+        SubscribeToEvent(eventType, [this](StringHash, VariantMap& eventData) { value_ += eventData["Value"].GetInt(); });
+    }
+
+    int value_{};
+};
+
+}
+
+TEST_CASE("Variant stores small matrices inline")
+{
+    const Matrix3x4 matrix{Vector3(1, 2, 3), Quaternion(30.0f, Vector3::UP), Vector3(1, 2, 1)};
+
+    Variant value = matrix;
+    REQUIRE(value.GetType() == VAR_MATRIX3X4);
+    REQUIRE(value.GetMatrix3x4() == matrix);
+    REQUIRE(static_cast<const void*>(&value.GetMatrix3x4()) >= static_cast<const void*>(&value));
+    REQUIRE(static_cast<const void*>(&value.GetMatrix3x4()) < static_cast<const void*>(&value + 1));
+
+    Variant copy = value;
+    REQUIRE(copy == value);
+
+    value = matrix.ToMatrix3();
+    REQUIRE(value.GetMatrix3() == matrix.ToMatrix3());
+}
+
+TEST_CASE("Variant is moved without copying the value")
+{
+    SECTION("String")
+    {
+        const ea::string longString = "This string is long enough to be allocated on the heap";
+        Variant source = longString;
+        const char* data = source.GetString().data();
+
+        Variant destination = ea::move(source);
+        REQUIRE(destination.GetString() == longString);
+        REQUIRE(destination.GetString().data() == data);
+    }
+
+    SECTION("VariantMap")
+    {
+        VariantMap map;
+        map["A"] = 1;
+        map["B"] = "Text";
+
+        Variant source = map;
+        const VariantMap* mapPtr = source.GetVariantMapPtr();
+
+        Variant destination;
+        destination = ea::move(source);
+        REQUIRE(source.IsEmpty());
+        REQUIRE(destination.GetVariantMapPtr() == mapPtr);
+        REQUIRE(*destination.GetVariantMapPtr() == map);
+    }
+
+    SECTION("Custom value")
+    {
+        const LargeCustomValue value{"Value", Matrix4::IDENTITY};
+        Variant source = MakeCustomValue(value);
+        const LargeCustomValue* valuePtr = source.GetCustomPtr<LargeCustomValue>();
+
+        Variant destination = ea::move(source);
+        REQUIRE(destination.GetCustomPtr<LargeCustomValue>() == valuePtr);
+        REQUIRE(destination.GetCustom<LargeCustomValue>() == value);
+    }
+
+    SECTION("Vector of variants")
+    {
+        VariantVector vector{Variant(1), Variant("Text"), Variant(Matrix3x4::IDENTITY)};
+        const Variant* data = vector.data();
+
+        Variant value = ea::move(vector);
+        REQUIRE(value.GetVariantVector().data() == data);
+        REQUIRE(value.GetVariantVector()[2].GetMatrix3x4() == Matrix3x4::IDENTITY);
+    }
+}
+
+TEST_CASE("Variant performance is measured", "[.][benchmark]")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    auto node = MakeShared<Node>(context);
+
+    BENCHMARK("Attribute get/set")
+    {
+        node->SetAttribute("Position", Vector3(1.0f, 2.0f, 3.0f));
+        node->SetAttribute("Rotation", Quaternion(30.0f, Vector3::UP));
+        node->SetAttribute("Name", "Node name that does not fit into small string");
+        return node->GetAttribute("Position").GetVector3().x_ + node->GetAttribute("Name").GetString().size();
+    };
+
+    ea::vector<StringHash> keys;
+    for (unsigned i = 0; i < 64; ++i)
+        keys.push_back(StringHash(i));
+
+    BENCHMARK("VariantMap insert/lookup")
+    {
+        VariantMap map;
+        for (unsigned i = 0; i < keys.size(); ++i)
+        {
+            if (i % 4 == 0)
+                map[keys[i]] = Matrix3x4::IDENTITY;
+            else if (i % 4 == 1)
+                map[keys[i]] = ea::string("Value that does not fit into small string");
+            else
+                map[keys[i]] = static_cast<int>(i);
+        }
+
+        int sum = 0;
+        for (StringHash key : keys)
+            sum += map[key].GetInt();
+        return sum;
+    };
+
+    const StringHash eventType("VariantBenchmarkEvent");
+    auto counter = MakeShared<EventCounter>(context, eventType);
+    BENCHMARK("Event send")
+    {
+        for (unsigned i = 0; i < 16; ++i)
+        {
+            VariantMap& eventData = counter->GetEventDataMap();
+            eventData["Value"] = 1;
+            eventData["Transform"] = Matrix3x4::IDENTITY;
+            eventData["Name"] = "Event name that does not fit into small string";
+            counter->SendEvent(eventType, eventData);
+        }
+        return counter->value_;
+    };
+}
@@ -0,0 +1,148 @@
+//
+// Copyright (c) 2022-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR rhs
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR rhsWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR rhs DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Core/WorkQueue.h>
+
+TEST_CASE("WorkQueue executes tasks after their dependencies")
+{
+    auto context = MakeShared<Context>();
+    auto workQueue = MakeShared<WorkQueue>(context);
+    workQueue->CreateThreads(3);
+
+    for (unsigned iteration = 0; iteration < 100; ++iteration)
+    {
+        std::atomic<unsigned> counter{};
+        std::atomic<bool> orderViolated{};
+
+        // Diamond: A -> (B, C) -> D
+        const auto taskA = workQueue->CreateTask([&](unsigned) { counter.fetch_add(1); });
+        const auto taskB = workQueue->CreateTask([&](unsigned)
+        {
+            if (!taskA->IsCompleted())
+                orderViolated = true;
+            counter.fetch_add(10);
+        });
+        const auto taskC = workQueue->CreateTask([&](unsigned)
+        {
+            if (!taskA->IsCompleted())
+                orderViolated = true;
+            counter.fetch_add(100);
+        });
+        const auto taskD = workQueue->CreateTask([&](unsigned)
+        {
+            if (!taskB->IsCompleted() || !taskC->IsCompleted())
+                orderViolated = true;
+            counter.fetch_add(1000);
+        });
+        workQueue->AddDependency(taskB, taskA);
+        workQueue->AddDependency(taskC, taskA);
+        workQueue->AddDependency(taskD, taskB);
+        workQueue->AddDependency(taskD, taskC);
+
+        // Submit in reverse order to make sure that dependencies are respected
+        workQueue->SubmitTask(taskD);
+        workQueue->SubmitTask(taskC);
+        workQueue->SubmitTask(taskB);
+        workQueue->SubmitTask(taskA);
+        workQueue->WaitForTask(taskD);
+
+        REQUIRE(counter == 1111);
+        REQUIRE_FALSE(orderViolated);
+        REQUIRE(workQueue->GetNumPendingTasks() == 0);
+    }
+}
+
+TEST_CASE("WorkQueue processes arrays in parallel")
+{
+    auto context = MakeShared<Context>();
+    auto workQueue = MakeShared<WorkQueue>(context);
+    workQueue->CreateThreads(3);
+
+    const unsigned size = 10000;
+    ea::vector<unsigned> values(size);
+
+    ForEachParallel(workQueue, 16, size, [&](unsigned beginIndex, unsigned endIndex)
+    {
+        for (unsigned i = beginIndex; i < endIndex; ++i)
+            values[i] += i;
+    });
+
+    const auto firstPass = ScheduleForEachParallel(workQueue, 16, size, [&](unsigned beginIndex, unsigned endIndex)
+    {
+        for (unsigned i = beginIndex; i < endIndex; ++i)
+            values[i] *= 2;
+    });
+    const auto secondPass = ScheduleForEachParallel(workQueue, 16, size, [&](unsigned beginIndex, unsigned endIndex)
+    {
+        for (unsigned i = beginIndex; i < endIndex; ++i)
+            values[i] += 1;
+    }, {&firstPass, 1});
+    workQueue->WaitForTask(secondPass);
+
+    for (unsigned i = 0; i < size; ++i)
+        REQUIRE(values[i] == i * 2 + 1);
+}
+
+TEST_CASE("WorkQueue completes legacy work items")
+{
+    auto context = MakeShared<Context>();
+    auto workQueue = MakeShared<WorkQueue>(context);
+    workQueue->CreateThreads(3);
+
+    std::atomic<unsigned> counter{};
+    for (unsigned i = 0; i < 100; ++i)
+    {
+        workQueue->AddWorkItem([&](unsigned) { counter.fetch_add(1); }, M_MAX_UNSIGNED);
+        workQueue->AddWorkItem([&](unsigned) { counter.fetch_add(1); }, 1);
+    }
+
+    workQueue->Complete(1);
+    REQUIRE(counter == 200);
+    REQUIRE(workQueue->IsCompleted(0));
+}
+
+TEST_CASE("WorkQueue wakes up idle worker threads")
+{
+    auto context = MakeShared<Context>();
+    auto workQueue = MakeShared<WorkQueue>(context);
+    workQueue->CreateThreads(3);
+
+    for (unsigned iteration = 0; iteration < 20; ++iteration)
+    {
+        // Let worker threads run out of work and go to sleep
+        Time::Sleep(1);
+
+        std::atomic<unsigned> executingThread{};
+        const auto task = workQueue->ScheduleTask([&](unsigned threadIndex) { executingThread = threadIndex; });
+
+        // Main thread doesn't help, so the task should be picked by a worker thread
+        Timer timer;
+        while (!task->IsCompleted() && timer.GetMSec(false) < 5000)
+            Time::Sleep(0);
+
+        REQUIRE(task->IsCompleted());
+        REQUIRE(executingThread != 0);
+    }
+}
@@ -0,0 +1,176 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../CommonUtils.h"
+#include "../ModelUtils.h"
+
+#include <Urho3D/Graphics/AnimatedModel.h>
+#include <Urho3D/Graphics/Animation.h>
+#include <Urho3D/Graphics/AnimationController.h>
+#include <Urho3D/Graphics/Octree.h>
+#include <Urho3D/IO/MemoryBuffer.h>
+#include <Urho3D/IO/VectorBuffer.h>
+#include <Urho3D/Resource/ResourceCache.h>
+#include <Urho3D/Scene/Scene.h>
+
+namespace
+{
+
+const float SampleRate = 30.0f;
+
+SharedPtr<Animation> CreateDenseAnimation(Context* context)
+{
+    auto animation = MakeShared<Animation>(context);
+    animation->SetLength(2.0f);
+
+    AnimationTrack* track = animation->CreateTrack("Bone");
+    track->channelMask_ = CHANNEL_POSITION | CHANNEL_ROTATION | CHANNEL_SCALE;
+
+    const unsigned numKeys = static_cast<unsigned>(animation->GetLength() * SampleRate) + 1;
+    for (unsigned i = 0; i < numKeys; ++i)
+    {
+        const float time = i / SampleRate;
+        const Vector3 position{time * 3.0f, 1.0f, -time};
+        const Quaternion rotation{45.0f, Vector3::UP};
+        const Vector3 scale = Vector3::ONE * (1.0f + 0.5f * Sin(time * 180.0f));
+        track->AddKeyFrame({time, position, rotation, scale});
+    }
+    return animation;
+}
+
+}
+
+TEST_CASE("Smallest three quaternion encoding is precise")
+{
+    const Quaternion rotations[] = {
+        Quaternion::IDENTITY,
+        Quaternion{-0.1f, 0.7f, -0.5f, 0.3f}.Normalized(),
+        Quaternion{0.0f, 0.0f, 0.0f, -1.0f},
+        Quaternion{30.0f, 60.0f, 120.0f},
+        Quaternion{179.0f, Vector3{1.0f, 2.0f, 3.0f}.Normalized()},
+    };
+
+    for (const Quaternion& rotation : rotations)
+    {
+        auto animation = MakeShared<Animation>(Tests::GetOrCreateContext(Tests::CreateCompleteContext));
+        AnimationTrack* track = animation->CreateTrack("Bone");
+        track->channelMask_ = CHANNEL_ROTATION;
+        track->AddKeyFrame({0.0f, Vector3::ZERO, rotation});
+        animation->Compress({});
+
+        const CompressedAnimationTrack* compressedTrack = animation->GetCompressedTrack("Bone");
+        REQUIRE(compressedTrack);
+
+        const Quaternion decoded = compressedTrack->rotation_.Decode(0);
+        const float sign = decoded.DotProduct(rotation) < 0.0f ? -1.0f : 1.0f;
+        CHECK((decoded * sign).Equals(rotation, 0.0001f));
+    }
+}
+
+TEST_CASE("Animation compression removes redundant keys within tolerance")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    const auto sourceAnimation = CreateDenseAnimation(context);
+    const AnimationTrack& sourceTrack = *sourceAnimation->GetTrack(ea::string{"Bone"});
+
+    AnimationCompressionSettings settings;
+    const auto animation = sourceAnimation->Clone();
+    animation->Compress(settings);
+
+    REQUIRE(animation->IsCompressed());
+    REQUIRE(animation->GetNumTracks() == 0);
+    REQUIRE(animation->GetNumCompressedTracks() == 1);
+
+    const CompressedAnimationTrack& track = *animation->GetCompressedTrack("Bone");
+
+    // Linear position needs only end points, constant rotation needs single key
+    CHECK(track.position_.times_.size() == 2);
+    CHECK(track.rotation_.times_.size() == 1);
+    CHECK(track.scale_.times_.size() > 2);
+    CHECK(track.scale_.times_.size() < sourceTrack.GetNumKeyFrames());
+
+    // Sample in between of source keys
+    const float quantizationError = 0.0001f;
+    unsigned frameIndex = 0;
+    for (float time = 0.0f; time <= sourceAnimation->GetLength(); time += 0.25f / SampleRate)
+    {
+        Transform expected;
+        sourceTrack.Sample(time, sourceAnimation->GetLength(), false, frameIndex, expected);
+
+        Transform actual;
+        track.Sample(time, animation->GetLength(), false, actual);
+
+        CHECK(actual.position_.Equals(expected.position_, settings.positionTolerance_ + quantizationError));
+        CHECK(actual.rotation_.Equals(expected.rotation_, settings.rotationTolerance_ + quantizationError));
+        CHECK(actual.scale_.Equals(expected.scale_, settings.scaleTolerance_ + quantizationError));
+    }
+
+    // Save and load compressed animation
+    VectorBuffer buffer;
+    REQUIRE(animation->Save(buffer));
+
+    auto loadedAnimation = MakeShared<Animation>(context);
+    MemoryBuffer source(buffer.GetBuffer());
+    REQUIRE(loadedAnimation->Load(source));
+
+    REQUIRE(loadedAnimation->GetNumCompressedTracks() == 1);
+    CHECK(*loadedAnimation->GetCompressedTrack("Bone") == track);
+}
+
+TEST_CASE("Compressed animation is applied to AnimatedModel")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    auto model = Tests::CreateSkinnedQuad_Model(context)->ExportModel();
+    auto animation = Tests::CreateLoopedTranslationAnimation(context,
+        "@Tests/AnimationCompression/TranslateX.ani", "Quad 2", {0.0f, 1.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, 2.0f);
+    auto compressedAnimation = animation->Clone("@Tests/AnimationCompression/TranslateX_Compressed.ani");
+    compressedAnimation->Compress({});
+
+    auto cache = context->GetSubsystem<ResourceCache>();
+    cache->AddManualResource(animation);
+    cache->AddManualResource(compressedAnimation);
+
+    auto scene = MakeShared<Scene>(context);
+    scene->CreateComponent<Octree>();
+
+    const auto createAnimatedNode = [&](Animation* playedAnimation)
+    {
+        Node* node = scene->CreateChild();
+        auto animatedModel = node->CreateComponent<AnimatedModel>();
+        animatedModel->SetModel(model);
+
+        auto controller = node->CreateComponent<AnimationController>();
+        controller->Play(playedAnimation->GetName(), 0, true);
+        return node->GetChild("Quad 2", true);
+    };
+
+    Node* sourceBone = createAnimatedNode(animation);
+    Node* compressedBone = createAnimatedNode(compressedAnimation);
+
+    for (int i = 0; i < 8; ++i)
+    {
+        Tests::RunFrame(context, 0.3f, 0.05f);
+        CHECK(compressedBone->GetPosition().Equals(sourceBone->GetPosition(), 0.001f));
+    }
+}
@@ -0,0 +1,133 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../CommonUtils.h"
+#include "../ModelUtils.h"
+
+#include <Urho3D/Graphics/Camera.h>
+#include <Urho3D/Graphics/Geometry.h>
+#include <Urho3D/Graphics/HierarchicalLodProxy.h>
+#include <Urho3D/Graphics/Model.h>
+#include <Urho3D/Graphics/Octree.h>
+#include <Urho3D/Graphics/StaticModel.h>
+#include <Urho3D/Scene/Scene.h>
+#include <Urho3D/Utility/HierarchicalLodGenerator.h>
+
+namespace
+{
+
+SharedPtr<Model> CreateQuadModel(Context* context)
+{
+    GeometryLODView lod;
+    lod.vertexFormat_ = Tests::GetVertexFormat();
+    Tests::AppendQuad(lod, Vector3::ZERO, Quaternion::IDENTITY, Vector2::ONE, Color::WHITE);
+
+    GeometryView geometry;
+    geometry.lods_.push_back(lod);
+
+    auto modelView = MakeShared<ModelView>(context);
+    modelView->SetGeometries({geometry});
+    return modelView->ExportModel();
+}
+
+StaticModel* CreateStaticModel(Scene* scene, Model* model, const Vector3& position)
+{
+    Node* node = scene->CreateChild();
+    node->SetPosition(position);
+    auto staticModel = node->CreateComponent<StaticModel>();
+    staticModel->SetModel(model);
+    return staticModel;
+}
+
+}
+
+TEST_CASE("Nearby static models are merged into hierarchical LOD proxy")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto scene = MakeShared<Scene>(context);
+    scene->CreateComponent<Octree>();
+    auto model = CreateQuadModel(context);
+
+    StaticModel* model1 = CreateStaticModel(scene, model, {1.0f, 0.0f, 1.0f});
+    StaticModel* model2 = CreateStaticModel(scene, model, {3.0f, 0.0f, 1.0f});
+    StaticModel* model3 = CreateStaticModel(scene, model, {100.0f, 0.0f, 100.0f});
+
+    HierarchicalLodParameters params;
+    params.clusterSize_ = 10.0f;
+    const auto proxyModels = GenerateHierarchicalLod(scene, params, "Proxy_");
+
+    // Single model is not merged
+    REQUIRE(proxyModels.size() == 1);
+    REQUIRE(proxyModels[0]->GetName() == "Proxy_0.mdl");
+    REQUIRE(proxyModels[0]->GetNumGeometries() == 1);
+    REQUIRE(proxyModels[0]->GetGeometry(0, 0)->GetIndexCount() == 12);
+    REQUIRE(proxyModels[0]->GetBoundingBox().Size().Equals(Vector3{3.0f, 1.0f, 0.0f}));
+
+    auto proxy = scene->GetComponent<HierarchicalLodProxy>(true);
+    REQUIRE(proxy);
+    REQUIRE(proxy->GetNode()->GetWorldPosition().Equals(Vector3{2.0f, 0.0f, 1.0f}));
+    REQUIRE(proxy->GetNumClusterNodes() == 2);
+    REQUIRE(proxy->GetLodProxy() == proxy);
+    REQUIRE(model1->GetLodProxy() == proxy);
+    REQUIRE(model2->GetLodProxy() == proxy);
+    REQUIRE(model3->GetLodProxy() == nullptr);
+
+    // Proxy is not merged again
+    REQUIRE(GenerateHierarchicalLod(scene, params, "Proxy_").empty());
+
+    proxy->Remove();
+    REQUIRE(model1->GetLodProxy() == nullptr);
+    REQUIRE(model2->GetLodProxy() == nullptr);
+}
+
+TEST_CASE("Hierarchical LOD proxy is used when cluster is small on the screen")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto scene = MakeShared<Scene>(context);
+    scene->CreateComponent<Octree>();
+    auto model = CreateQuadModel(context);
+
+    CreateStaticModel(scene, model, {0.0f, 0.0f, 0.0f});
+    CreateStaticModel(scene, model, {2.0f, 0.0f, 0.0f});
+
+    HierarchicalLodParameters params;
+    params.switchScreenSize_ = 0.1f;
+    GenerateHierarchicalLod(scene, params, "Proxy_");
+
+    auto proxy = scene->GetComponent<HierarchicalLodProxy>(true);
+    REQUIRE(proxy);
+    proxy->GetWorldBoundingBox();
+
+    Node* cameraNode = scene->CreateChild();
+    auto camera = cameraNode->CreateComponent<Camera>();
+    camera->SetFov(90.0f);
+
+    // Cluster is ~3.2 units wide, view height is twice the distance
+    cameraNode->SetPosition({1.0f, 0.0f, -10.0f});
+    REQUIRE_FALSE(proxy->IsProxyUsed(camera));
+
+    cameraNode->SetPosition({1.0f, 0.0f, -20.0f});
+    REQUIRE(proxy->IsProxyUsed(camera));
+
+    proxy->SetEnabled(false);
+    REQUIRE_FALSE(proxy->IsProxyUsed(camera));
+}
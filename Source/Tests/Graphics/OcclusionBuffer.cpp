@@ -0,0 +1,238 @@
+//
+// Copyright (c) 2022-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR rhs
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR rhsWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR rhs DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/Graphics/Camera.h>
+#include <Urho3D/Graphics/OcclusionBuffer.h>
+#include <Urho3D/Math/RandomEngine.h>
+#include <Urho3D/Scene/Node.h>
+
+namespace
+{
+
+/// Set of occluder meshes with transforms, submitted to occlusion buffer as is.
+struct OccluderSet
+{
+    ea::vector<Vector3> vertices_;
+    ea::vector<unsigned short> indices_;
+    ea::vector<Matrix3x4> transforms_;
+
+    void Draw(OcclusionBuffer* buffer) const
+    {
+        buffer->Clear();
+        for (const Matrix3x4& transform : transforms_)
+        {
+            buffer->AddTriangles(transform, vertices_.data(), sizeof(Vector3), indices_.data(), sizeof(unsigned short),
+                0, indices_.size());
+        }
+        buffer->DrawTriangles();
+        buffer->BuildDepthHierarchy();
+    }
+};
+
+/// Create boxes scattered in front of the camera.
+OccluderSet CreateOccluderSet(unsigned count, RandomEngine& re)
+{
+    OccluderSet result;
+    for (unsigned i = 0; i < 8; ++i)
+        result.vertices_.emplace_back(i & 1 ? 0.5f : -0.5f, i & 2 ? 0.5f : -0.5f, i & 4 ? 0.5f : -0.5f);
+
+    static const unsigned short faces[6][4] = {
+        {0, 2, 3, 1}, {4, 5, 7, 6}, {0, 1, 5, 4}, {2, 6, 7, 3}, {0, 4, 6, 2}, {1, 3, 7, 5}};
+    for (const auto& face : faces)
+        result.indices_.insert(result.indices_.end(), {face[0], face[1], face[2], face[0], face[2], face[3]});
+
+    for (unsigned i = 0; i < count; ++i)
+    {
+        const Vector3 position = re.GetVector3({-100.0f, -20.0f, 20.0f}, {100.0f, 20.0f, 200.0f});
+        const Quaternion rotation{re.GetFloat(0.0f, 360.0f), Vector3::UP};
+        const Vector3 scale = re.GetVector3(Vector3::ONE * 2.0f, Vector3::ONE * 20.0f);
+        result.transforms_.emplace_back(position, rotation, scale);
+    }
+    return result;
+}
+
+/// Create boxes to test for visibility.
+ea::vector<BoundingBox> CreateTestBoxes(unsigned count, RandomEngine& re)
+{
+    ea::vector<BoundingBox> result;
+    for (unsigned i = 0; i < count; ++i)
+    {
+        const Vector3 center = re.GetVector3({-150.0f, -30.0f, -10.0f}, {150.0f, 30.0f, 300.0f});
+        const Vector3 halfSize = re.GetVector3(Vector3::ONE * 0.5f, Vector3::ONE * 3.0f);
+        result.emplace_back(center - halfSize, center + halfSize);
+    }
+    return result;
+}
+
+SharedPtr<OcclusionBuffer> CreateOcclusionBuffer(Context* context, Camera* camera, bool threaded)
+{
+    auto buffer = MakeShared<OcclusionBuffer>(context);
+    buffer->SetSize(256, 128, threaded);
+    buffer->SetView(camera);
+    buffer->SetMaxTriangles(M_MAX_UNSIGNED);
+    buffer->SetCullMode(CULL_NONE);
+    return buffer;
+}
+
+}
+
+TEST_CASE("OcclusionBuffer rasterizes the same depth with and without threads")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    SharedPtr<WorkQueue> defaultWorkQueue{context->GetSubsystem<WorkQueue>()};
+    auto threadedWorkQueue = MakeShared<WorkQueue>(context);
+    threadedWorkQueue->CreateThreads(3);
+
+    auto node = MakeShared<Node>(context);
+    auto camera = node->CreateComponent<Camera>();
+    camera->SetFarClip(500.0f);
+
+    RandomEngine re(0);
+    const OccluderSet occluders = CreateOccluderSet(200, re);
+
+    auto buffer = CreateOcclusionBuffer(context, camera, false);
+    REQUIRE_FALSE(buffer->IsThreaded());
+    occluders.Draw(buffer);
+
+    context->RegisterSubsystem(threadedWorkQueue);
+    auto threadedBuffer = CreateOcclusionBuffer(context, camera, true);
+    REQUIRE(threadedBuffer->IsThreaded());
+    occluders.Draw(threadedBuffer);
+    context->RegisterSubsystem(defaultWorkQueue);
+
+    const int* depth = buffer->GetBuffer();
+    const int* threadedDepth = threadedBuffer->GetBuffer();
+    const unsigned numPixels = buffer->GetWidth() * buffer->GetHeight();
+    REQUIRE(ea::equal(depth, depth + numPixels, threadedDepth));
+    REQUIRE(buffer->GetNumTriangles() == threadedBuffer->GetNumTriangles());
+
+    // Some pixels are covered, some are not
+    const auto isCleared = [](int value) { return value == static_cast<int>(OCCLUSION_Z_SCALE); };
+    REQUIRE(ea::any_of(depth, depth + numPixels, isCleared));
+    REQUIRE_FALSE(ea::all_of(depth, depth + numPixels, isCleared));
+}
+
+TEST_CASE("OcclusionBuffer batched visibility test is consistent with per-box test")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto node = MakeShared<Node>(context);
+    auto camera = node->CreateComponent<Camera>();
+    camera->SetFarClip(500.0f);
+
+    RandomEngine re(0);
+    const OccluderSet occluders = CreateOccluderSet(200, re);
+    auto buffer = CreateOcclusionBuffer(context, camera, false);
+    occluders.Draw(buffer);
+
+    const ea::vector<BoundingBox> boxes = CreateTestBoxes(1001, re);
+    ea::vector<bool> batchResult(boxes.size());
+    buffer->IsVisible(boxes, batchResult);
+
+    unsigned numVisible = 0;
+    for (unsigned i = 0; i < boxes.size(); ++i)
+    {
+        const bool isVisible = buffer->IsVisible(boxes[i]);
+        REQUIRE(batchResult[i] == isVisible);
+        numVisible += isVisible;
+    }
+    REQUIRE(numVisible > 0);
+    REQUIRE(numVisible < boxes.size());
+}
+
+TEST_CASE("OcclusionBuffer hides boxes behind occluder")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto node = MakeShared<Node>(context);
+    auto camera = node->CreateComponent<Camera>();
+    camera->SetFarClip(500.0f);
+
+    OccluderSet wall;
+    wall.vertices_ = {{-1.0f, -1.0f, 0.0f}, {1.0f, -1.0f, 0.0f}, {1.0f, 1.0f, 0.0f}, {-1.0f, 1.0f, 0.0f}};
+    wall.indices_ = {0, 1, 2, 0, 2, 3};
+    wall.transforms_ = {Matrix3x4(Vector3(0.0f, 0.0f, 50.0f), Quaternion::IDENTITY, 50.0f)};
+
+    auto buffer = CreateOcclusionBuffer(context, camera, false);
+    wall.Draw(buffer);
+
+    const ea::vector<BoundingBox> boxes = {
+        BoundingBox(Vector3(-1.0f, -1.0f, 20.0f), Vector3(1.0f, 1.0f, 22.0f)),
+        BoundingBox(Vector3(-1.0f, -1.0f, 80.0f), Vector3(1.0f, 1.0f, 82.0f)),
+        BoundingBox(Vector3(-10.0f, -10.0f, 100.0f), Vector3(10.0f, 10.0f, 120.0f)),
+        BoundingBox(Vector3(-50.0f, -1.0f, 30.0f), Vector3(50.0f, 1.0f, 32.0f)),
+    };
+    ea::vector<bool> result(boxes.size());
+    buffer->IsVisible(boxes, result);
+
+    CHECK(result[0]);
+    CHECK_FALSE(result[1]);
+    CHECK_FALSE(result[2]);
+    CHECK(result[3]);
+}
+
+TEST_CASE("OcclusionBuffer performance is measured on generated occluder set", "[.][benchmark]")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    SharedPtr<WorkQueue> defaultWorkQueue{context->GetSubsystem<WorkQueue>()};
+    auto threadedWorkQueue = MakeShared<WorkQueue>(context);
+    threadedWorkQueue->CreateThreads(3);
+
+    auto node = MakeShared<Node>(context);
+    auto camera = node->CreateComponent<Camera>();
+    camera->SetFarClip(500.0f);
+
+    RandomEngine re(0);
+    const OccluderSet occluders = CreateOccluderSet(1000, re);
+    const ea::vector<BoundingBox> boxes = CreateTestBoxes(10000, re);
+    ea::vector<bool> result(boxes.size());
+
+    auto buffer = CreateOcclusionBuffer(context, camera, false);
+    BENCHMARK("Draw 12k occluder triangles")
+    {
+        occluders.Draw(buffer);
+        return buffer->GetNumTriangles();
+    };
+
+    context->RegisterSubsystem(threadedWorkQueue);
+    auto threadedBuffer = CreateOcclusionBuffer(context, camera, true);
+    BENCHMARK("Draw 12k occluder triangles in 4 threads")
+    {
+        occluders.Draw(threadedBuffer);
+        return threadedBuffer->GetNumTriangles();
+    };
+    context->RegisterSubsystem(defaultWorkQueue);
+
+    BENCHMARK("Test 10k boxes one by one")
+    {
+        for (unsigned i = 0; i < boxes.size(); ++i)
+            result[i] = buffer->IsVisible(boxes[i]);
+        return result.size();
+    };
+
+    BENCHMARK("Test 10k boxes in batch")
+    {
+        buffer->IsVisible(boxes, result);
+        return result.size();
+    };
+}
@@ -0,0 +1,494 @@
+//
+// Copyright (c) 2022-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR rhs
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR rhsWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR rhs DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/Core/Metrics.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/Graphics/Model.h>
+#include <Urho3D/Graphics/Octree.h>
+#include <Urho3D/Graphics/StaticModel.h>
+#include <Urho3D/Math/BoundingBoxArray.h>
+#include <Urho3D/Math/RandomEngine.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include <EASTL/sort.h>
+
+namespace
+{
+
+/// Frustum query that tests each drawable individually.
+class ReferenceFrustumOctreeQuery : public FrustumOctreeQuery
+{
+public:
+    using FrustumOctreeQuery::FrustumOctreeQuery;
+
+    const Frustum* GetCullingFrustum() const override { return nullptr; }
+};
+
+SharedPtr<Model> CreateUnitBoxModel(Context* context)
+{
+    auto model = MakeShared<Model>(context);
+    model->SetBoundingBox(BoundingBox(-0.5f, 0.5f));
+    return model;
+}
+
+void RandomizeTransform(Node* node, float sceneSize, RandomEngine& re)
+{
+    node->SetPosition(re.GetVector3(-Vector3::ONE * sceneSize, Vector3::ONE * sceneSize));
+    node->SetScale(re.GetFloat(0.5f, 5.0f));
+}
+
+ea::vector<Node*> CreateRandomDrawables(Scene* scene, Model* model, unsigned count, float sceneSize, RandomEngine& re)
+{
+    ea::vector<Node*> nodes;
+    for (unsigned i = 0; i < count; ++i)
+    {
+        Node* node = scene->CreateChild();
+        RandomizeTransform(node, sceneSize, re);
+        node->CreateComponent<StaticModel>()->SetModel(model);
+        nodes.push_back(node);
+    }
+    return nodes;
+}
+
+/// Drawable that queues several transforms for the same node during update.
+class TransformQueueingModel : public StaticModel
+{
+    URHO3D_OBJECT(TransformQueueingModel, StaticModel);
+
+public:
+    using StaticModel::StaticModel;
+
+    void Update(const FrameInfo& frame) override
+    {
+        Octree* octree = GetOctant()->GetOctree();
+        for (const Vector3& position : positions_)
+            octree->QueueNodeTransformUpdate(target_, Transform{position});
+    }
+
+    Node* target_{};
+    ea::vector<Vector3> positions_;
+};
+
+void UpdateOctree(Octree* octree)
+{
+    FrameInfo frameInfo;
+    octree->Update(frameInfo);
+}
+
+Frustum CreateTestFrustum(float farClip)
+{
+    Frustum frustum;
+    frustum.Define(60.0f, 1.5f, 1.0f, 0.1f, farClip, Matrix3x4(Vector3::ZERO, Quaternion(30.0f, Vector3::UP), Vector3::ONE));
+    return frustum;
+}
+
+template <class T>
+ea::vector<Drawable*> QueryDrawables(Octree* octree, const Frustum& frustum)
+{
+    ea::vector<Drawable*> result;
+    T query(result, frustum, DRAWABLE_GEOMETRY);
+    octree->GetDrawables(query);
+    ea::sort(result.begin(), result.end());
+    return result;
+}
+
+ea::vector<Drawable*> QuerySphereDrawables(Octree* octree, const Sphere& sphere)
+{
+    ea::vector<Drawable*> result;
+    SphereOctreeQuery query(result, sphere, DRAWABLE_GEOMETRY);
+    octree->GetDrawables(query);
+    ea::sort(result.begin(), result.end());
+    return result;
+}
+
+ea::vector<Drawable*> QueryRayDrawables(Octree* octree, const Ray& ray, float maxDistance)
+{
+    ea::vector<RayQueryResult> queryResult;
+    RayOctreeQuery query(queryResult, ray, RAY_AABB, maxDistance, DRAWABLE_GEOMETRY);
+    octree->Raycast(query);
+
+    ea::vector<Drawable*> result;
+    for (const RayQueryResult& item : queryResult)
+        result.push_back(item.drawable_);
+    ea::sort(result.begin(), result.end());
+    return result;
+}
+
+template <class T>
+ea::vector<Drawable*> QueryDrawablesBruteForce(Octree* octree, const T& isVisible)
+{
+    ea::vector<Drawable*> result;
+    for (Drawable* drawable : octree->GetAllDrawables())
+    {
+        if (isVisible(drawable->GetWorldBoundingBox()))
+            result.push_back(drawable);
+    }
+    ea::sort(result.begin(), result.end());
+    return result;
+}
+
+ea::vector<Drawable*> QueryDrawablesBruteForce(Octree* octree, const Frustum& frustum)
+{
+    return QueryDrawablesBruteForce(octree, [&](const BoundingBox& box) { return frustum.IsInsideFast(box) != OUTSIDE; });
+}
+
+}
+
+TEST_CASE("Octree frustum query with cached bounds is consistent with reference query")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto scene = MakeShared<Scene>(context);
+    auto octree = scene->GetOrCreateComponent<Octree>();
+    octree->SetSize(BoundingBox(-200.0f, 200.0f), 6);
+    auto model = CreateUnitBoxModel(context);
+
+    RandomEngine re(0);
+    ea::vector<Node*> nodes = CreateRandomDrawables(scene, model, 5000, 150.0f, re);
+    UpdateOctree(octree);
+
+    const Frustum frustum = CreateTestFrustum(120.0f);
+    const auto visibleDrawables = QueryDrawables<FrustumOctreeQuery>(octree, frustum);
+    REQUIRE(!visibleDrawables.empty());
+    REQUIRE(visibleDrawables.size() < nodes.size());
+    REQUIRE(visibleDrawables == QueryDrawables<ReferenceFrustumOctreeQuery>(octree, frustum));
+    REQUIRE(visibleDrawables == QueryDrawablesBruteForce(octree, frustum));
+
+    // Move some drawables without updating octree, cached bounds should not be used for them
+    for (unsigned i = 0; i < 1000; ++i)
+        RandomizeTransform(nodes[i * 5], 150.0f, re);
+    REQUIRE(QueryDrawables<FrustumOctreeQuery>(octree, frustum)
+        == QueryDrawables<ReferenceFrustumOctreeQuery>(octree, frustum));
+
+    UpdateOctree(octree);
+    REQUIRE(QueryDrawables<FrustumOctreeQuery>(octree, frustum) == QueryDrawablesBruteForce(octree, frustum));
+
+    // Remove some drawables
+    for (unsigned i = 0; i < 1000; ++i)
+        nodes[i * 5 + 1]->Remove();
+    REQUIRE(QueryDrawables<FrustumOctreeQuery>(octree, frustum) == QueryDrawablesBruteForce(octree, frustum));
+
+    // Resize octree, drawables are temporarily moved to root
+    octree->SetSize(BoundingBox(-300.0f, 300.0f), 7);
+    REQUIRE(QueryDrawables<FrustumOctreeQuery>(octree, frustum) == QueryDrawablesBruteForce(octree, frustum));
+    UpdateOctree(octree);
+    REQUIRE(QueryDrawables<FrustumOctreeQuery>(octree, frustum) == QueryDrawablesBruteForce(octree, frustum));
+}
+
+TEST_CASE("Octree queries are consistent for all spatial index types")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    const SpatialIndexType indexType = GENERATE(SpatialIndexType::Octree, SpatialIndexType::BVH);
+
+    auto scene = MakeShared<Scene>(context);
+    auto octree = scene->GetOrCreateComponent<Octree>();
+    octree->SetSize(BoundingBox(-200.0f, 200.0f), 6);
+    octree->SetSpatialIndexType(indexType);
+    auto model = CreateUnitBoxModel(context);
+
+    RandomEngine re(0);
+    ea::vector<Node*> nodes = CreateRandomDrawables(scene, model, 5000, 150.0f, re);
+    UpdateOctree(octree);
+
+    const Frustum frustum = CreateTestFrustum(120.0f);
+    const Sphere sphere{Vector3(20.0f, 0.0f, 10.0f), 60.0f};
+    const Ray ray{Vector3(-160.0f, -5.0f, -150.0f), Vector3(1.0f, 0.05f, 0.9f)};
+    const float rayLength = 400.0f;
+
+    const auto checkQueries = [&]()
+    {
+        const auto frustumDrawables = QueryDrawables<FrustumOctreeQuery>(octree, frustum);
+        REQUIRE(!frustumDrawables.empty());
+        REQUIRE(frustumDrawables == QueryDrawablesBruteForce(octree, frustum));
+
+        const auto sphereDrawables = QuerySphereDrawables(octree, sphere);
+        REQUIRE(!sphereDrawables.empty());
+        REQUIRE(sphereDrawables == QueryDrawablesBruteForce(octree,
+            [&](const BoundingBox& box) { return sphere.IsInsideFast(box) != OUTSIDE; }));
+
+        const auto rayDrawables = QueryRayDrawables(octree, ray, rayLength);
+        REQUIRE(!rayDrawables.empty());
+        REQUIRE(rayDrawables == QueryDrawablesBruteForce(octree,
+            [&](const BoundingBox& box) { return ray.HitDistance(box) < rayLength; }));
+    };
+
+    checkQueries();
+
+    // Move drawables by small and large distances
+    for (unsigned i = 0; i < 1000; ++i)
+    {
+        nodes[i * 5]->Translate(re.GetVector3(-Vector3::ONE, Vector3::ONE) * 0.2f);
+        RandomizeTransform(nodes[i * 5 + 1], 150.0f, re);
+    }
+    UpdateOctree(octree);
+    checkQueries();
+
+    // Remove some drawables
+    for (unsigned i = 0; i < 1000; ++i)
+        nodes[i * 5 + 2]->Remove();
+    checkQueries();
+
+    // Switch to another spatial index and back
+    octree->SetSpatialIndexType(indexType == SpatialIndexType::BVH ? SpatialIndexType::Octree : SpatialIndexType::BVH);
+    UpdateOctree(octree);
+    checkQueries();
+
+    octree->SetSpatialIndexType(indexType);
+    UpdateOctree(octree);
+    checkQueries();
+    REQUIRE(octree->GetAllDrawables().size() == 4000);
+}
+
+TEST_CASE("Octree reinsertion in worker threads is consistent with single-threaded reinsertion")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    SharedPtr<WorkQueue> defaultWorkQueue{context->GetSubsystem<WorkQueue>()};
+    auto threadedWorkQueue = MakeShared<WorkQueue>(context);
+    threadedWorkQueue->CreateThreads(3);
+
+    auto model = CreateUnitBoxModel(context);
+    auto scene = MakeShared<Scene>(context);
+    auto octree = scene->GetOrCreateComponent<Octree>();
+    octree->SetSize(BoundingBox(-200.0f, 200.0f), 6);
+    auto referenceScene = MakeShared<Scene>(context);
+    auto referenceOctree = referenceScene->GetOrCreateComponent<Octree>();
+    referenceOctree->SetSize(BoundingBox(-200.0f, 200.0f), 6);
+
+    RandomEngine re(0);
+    RandomEngine referenceRe(0);
+    ea::vector<Node*> nodes = CreateRandomDrawables(scene, model, 5000, 250.0f, re);
+    ea::vector<Node*> referenceNodes = CreateRandomDrawables(referenceScene, model, 5000, 250.0f, referenceRe);
+
+    auto& metrics = MetricsRegistry::Get();
+    const auto getMetricCount = [&](ea::string_view name)
+    {
+        const MetricsSnapshot snapshot = metrics.TakeSnapshot();
+        const MetricSnapshot* metric = snapshot.FindMetric(name);
+        return metric ? metric->count_ : 0;
+    };
+    const auto numReinsertTimers = getMetricCount("Octree::Reinsert");
+
+    const Frustum frustum = CreateTestFrustum(120.0f);
+    for (unsigned frame = 0; frame < 5; ++frame)
+    {
+        for (unsigned i = frame; i < nodes.size(); i += 3)
+        {
+            RandomizeTransform(nodes[i], 250.0f, re);
+            RandomizeTransform(referenceNodes[i], 250.0f, referenceRe);
+        }
+
+        context->RegisterSubsystem(threadedWorkQueue);
+        UpdateOctree(octree);
+        context->RegisterSubsystem(defaultWorkQueue);
+        UpdateOctree(referenceOctree);
+
+        for (unsigned i = 0; i < nodes.size(); ++i)
+        {
+            const Octant* octant = nodes[i]->GetComponent<StaticModel>()->GetOctant();
+            const Octant* referenceOctant = referenceNodes[i]->GetComponent<StaticModel>()->GetOctant();
+            REQUIRE(octant);
+            REQUIRE(referenceOctant);
+            REQUIRE(octant->GetLevel() == referenceOctant->GetLevel());
+            REQUIRE(octant->GetWorldBoundingBox() == referenceOctant->GetWorldBoundingBox());
+        }
+
+        REQUIRE(QueryDrawables<FrustumOctreeQuery>(octree, frustum) == QueryDrawablesBruteForce(octree, frustum));
+    }
+
+    if (metrics.IsEnabled())
+        REQUIRE(getMetricCount("Octree::Reinsert") == numReinsertTimers + 10);
+}
+
+TEST_CASE("Octree applies the last transform queued for the node")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    auto scene = MakeShared<Scene>(context);
+    auto octree = scene->GetOrCreateComponent<Octree>();
+    Node* target = scene->CreateChild("Target");
+    Node* child = target->CreateChild("Child");
+
+    ea::vector<SharedPtr<TransformQueueingModel>> models;
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        auto model = MakeShared<TransformQueueingModel>(context);
+        model->SetModel(CreateUnitBoxModel(context));
+        model->target_ = target;
+        for (unsigned j = 0; j <= i; ++j)
+            model->positions_.push_back(Vector3::ONE * static_cast<float>(j + 1));
+        scene->CreateChild()->AddComponent(model, 0, LOCAL);
+        models.push_back(model);
+    }
+
+    // Drawables may be updated in any order, but the node receives exactly one of the queued transforms
+    for (TransformQueueingModel* model : models)
+        model->MarkForUpdate();
+    UpdateOctree(octree);
+
+    const Vector3 position = target->GetPosition();
+    CHECK((position == Vector3::ONE || position == Vector3::ONE * 2.0f || position == Vector3::ONE * 3.0f));
+    CHECK(child->GetWorldPosition() == position);
+
+    // Single drawable, so the order of queued transforms is deterministic
+    models[0]->positions_ = {Vector3::ONE * 4.0f, Vector3::ONE * 5.0f};
+    models[0]->MarkForUpdate();
+    UpdateOctree(octree);
+
+    CHECK(target->GetPosition() == Vector3::ONE * 5.0f);
+    CHECK(child->GetWorldPosition() == Vector3::ONE * 5.0f);
+}
+
+TEST_CASE("Octree frustum query performance is compared to per-drawable tests", "[.][benchmark]")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    RandomEngine re(0);
+
+    {
+        // Kernel only
+        const unsigned numBoxes = 200 * 1000;
+        const Frustum frustum = CreateTestFrustum(500.0f);
+
+        BoundingBoxArray boxes;
+        ea::vector<BoundingBox> referenceBoxes;
+        for (unsigned i = 0; i < numBoxes; ++i)
+        {
+            const Vector3 center = re.GetVector3(-Vector3::ONE * 1000.0f, Vector3::ONE * 1000.0f);
+            const BoundingBox box{center - Vector3::ONE, center + Vector3::ONE};
+            referenceBoxes.push_back(box);
+            boxes.PushBack(box);
+        }
+        ea::vector<unsigned> visibleIndices(numBoxes);
+
+        BENCHMARK("Cull 200k boxes with Frustum::IsInsideFast")
+        {
+            unsigned numVisible = 0;
+            for (unsigned i = 0; i < numBoxes; ++i)
+            {
+                if (frustum.IsInsideFast(referenceBoxes[i]) != OUTSIDE)
+                    visibleIndices[numVisible++] = i;
+            }
+            return numVisible;
+        };
+
+        BENCHMARK("Cull 200k boxes with BoundingBoxArray::CullFrustum")
+        {
+            return boxes.CullFrustum(frustum, 0, numBoxes, visibleIndices.data());
+        };
+    }
+
+    {
+        // Whole octree query
+        auto scene = MakeShared<Scene>(context);
+        auto octree = scene->GetOrCreateComponent<Octree>();
+        octree->SetSize(BoundingBox(-1000.0f, 1000.0f), 8);
+        auto model = CreateUnitBoxModel(context);
+
+        CreateRandomDrawables(scene, model, 100 * 1000, 1000.0f, re);
+        UpdateOctree(octree);
+
+        const Frustum frustum = CreateTestFrustum(800.0f);
+        ea::vector<Drawable*> result;
+
+        BENCHMARK("Query 100k drawables with per-drawable tests")
+        {
+            ReferenceFrustumOctreeQuery query(result, frustum, DRAWABLE_GEOMETRY);
+            octree->GetDrawables(query);
+            return result.size();
+        };
+
+        BENCHMARK("Query 100k drawables with cached bounds")
+        {
+            FrustumOctreeQuery query(result, frustum, DRAWABLE_GEOMETRY);
+            octree->GetDrawables(query);
+            return result.size();
+        };
+    }
+}
+
+TEST_CASE("Spatial index performance is compared between Octree and BVH", "[.][benchmark]")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    for (const SpatialIndexType indexType : {SpatialIndexType::Octree, SpatialIndexType::BVH})
+    {
+        const ea::string name = indexType == SpatialIndexType::Octree ? "Octree" : "BVH";
+
+        auto scene = MakeShared<Scene>(context);
+        auto octree = scene->GetOrCreateComponent<Octree>();
+        octree->SetSize(BoundingBox(-1000.0f, 1000.0f), 8);
+        octree->SetSpatialIndexType(indexType);
+        auto model = CreateUnitBoxModel(context);
+
+        RandomEngine re(0);
+        ea::vector<Node*> nodes = CreateRandomDrawables(scene, model, 100 * 1000, 1000.0f, re);
+        UpdateOctree(octree);
+
+        const Frustum frustum = CreateTestFrustum(800.0f);
+        const Sphere sphere{Vector3::ZERO, 200.0f};
+        const Ray ray{Vector3(-1000.0f, 0.0f, -1000.0f), Vector3(1.0f, 0.0f, 1.0f)};
+        ea::vector<Drawable*> result;
+        ea::vector<RayQueryResult> rayResult;
+
+        BENCHMARK((name + ": Frustum query of 100k drawables").c_str())
+        {
+            FrustumOctreeQuery query(result, frustum, DRAWABLE_GEOMETRY);
+            octree->GetDrawables(query);
+            return result.size();
+        };
+
+        BENCHMARK((name + ": Sphere query of 100k drawables").c_str())
+        {
+            SphereOctreeQuery query(result, sphere, DRAWABLE_GEOMETRY);
+            octree->GetDrawables(query);
+            return result.size();
+        };
+
+        BENCHMARK((name + ": Raycast of 100k drawables").c_str())
+        {
+            RayOctreeQuery query(rayResult, ray, RAY_AABB, M_INFINITY, DRAWABLE_GEOMETRY);
+            octree->Raycast(query);
+            return rayResult.size();
+        };
+
+        // Move 10% of drawables every frame with constant velocity, like in scenes with many animated objects
+        ea::vector<Vector3> velocities;
+        for (unsigned i = 0; i < nodes.size(); i += 10)
+            velocities.push_back(re.GetDirectionVector3() * re.GetFloat(0.05f, 0.5f));
+
+        BENCHMARK((name + ": Update of 10k moving drawables").c_str())
+        {
+            for (unsigned i = 0; i < velocities.size(); ++i)
+                nodes[i * 10]->Translate(velocities[i]);
+            UpdateOctree(octree);
+            return octree->GetAllDrawables().size();
+        };
+
+        BENCHMARK((name + ": Update of 10k teleporting drawables").c_str())
+        {
+            for (unsigned i = 0; i < nodes.size(); i += 10)
+                nodes[i]->SetPosition(re.GetVector3(-Vector3::ONE * 1000.0f, Vector3::ONE * 1000.0f));
+            UpdateOctree(octree);
+            return octree->GetAllDrawables().size();
+        };
+    }
+}
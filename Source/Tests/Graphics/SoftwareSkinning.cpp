@@ -0,0 +1,264 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/Graphics/Model.h>
+#include <Urho3D/Graphics/ModelView.h>
+#include <Urho3D/Graphics/SoftwareModelAnimator.h>
+#include <Urho3D/Graphics/VertexBuffer.h>
+#include <Urho3D/Math/RandomEngine.h>
+
+#include <EASTL/sort.h>
+
+namespace
+{
+
+const unsigned NumTestBones = 16;
+
+/// Create model with random triangles skinned to random bones and one morph affecting every other vertex.
+SharedPtr<Model> CreateRandomSkinnedModel(Context* context, unsigned numVertices, RandomEngine& re)
+{
+    auto modelView = MakeShared<ModelView>(context);
+
+    ModelVertexFormat format;
+    format.position_ = TYPE_VECTOR3;
+    format.normal_ = TYPE_VECTOR3;
+    format.tangent_ = TYPE_VECTOR4;
+    format.blendIndices_ = TYPE_UBYTE4;
+    format.blendWeights_ = TYPE_VECTOR4;
+
+    auto& geometries = modelView->GetGeometries();
+    geometries.resize(1);
+    geometries[0].lods_.resize(1);
+    GeometryLODView& geometry = geometries[0].lods_[0];
+    geometry.vertexFormat_ = format;
+    geometry.primitiveType_ = TRIANGLE_LIST;
+
+    for (unsigned i = 0; i < numVertices; ++i)
+    {
+        ModelVertex vertex;
+        vertex.SetPosition(re.GetVector3(-Vector3::ONE, Vector3::ONE));
+        vertex.SetNormal(re.GetDirectionVector3());
+        vertex.tangent_ = Vector4(re.GetDirectionVector3(), 1.0f);
+
+        // Use distinct bones and weights so the most important bones are well-defined
+        const unsigned firstBone = re.GetUInt(NumTestBones);
+        const float weights[4] = {0.4f, 0.3f, 0.2f, 0.1f};
+        const unsigned shift = re.GetUInt(4);
+        float blendIndices[4];
+        float blendWeights[4];
+        for (unsigned j = 0; j < 4; ++j)
+        {
+            blendIndices[j] = static_cast<float>((firstBone + j * 3) % NumTestBones);
+            blendWeights[j] = weights[(j + shift) % 4];
+        }
+        vertex.blendIndices_ = Vector4(blendIndices);
+        vertex.blendWeights_ = Vector4(blendWeights);
+
+        geometry.vertices_.push_back(vertex);
+    }
+    for (unsigned i = 0; i < numVertices / 3 * 3; ++i)
+        geometry.indices_.push_back(i);
+
+    ModelVertexMorphVector& morph = geometry.morphs_[0];
+    for (unsigned i = 0; i < numVertices; i += 2)
+    {
+        ModelVertexMorph vertexMorph;
+        vertexMorph.index_ = i;
+        vertexMorph.positionDelta_ = re.GetVector3(-Vector3::ONE, Vector3::ONE);
+        vertexMorph.normalDelta_ = re.GetVector3(-Vector3::ONE, Vector3::ONE);
+        morph.push_back(vertexMorph);
+    }
+    modelView->SetMorphs({ModelMorphView{"Morph", 0.0f}});
+
+    auto& bones = modelView->GetBones();
+    bones.resize(NumTestBones);
+    for (unsigned i = 0; i < NumTestBones; ++i)
+    {
+        bones[i].name_ = Format("Bone {}", i);
+        bones[i].parentIndex_ = i == 0 ? M_MAX_UNSIGNED : 0;
+        bones[i].SetInitialTransform(Vector3::ZERO);
+        bones[i].RecalculateOffsetMatrix();
+    }
+
+    return modelView->ExportModel();
+}
+
+ea::vector<Matrix3x4> CreateRandomTransforms(RandomEngine& re)
+{
+    ea::vector<Matrix3x4> transforms;
+    for (unsigned i = 0; i < NumTestBones; ++i)
+    {
+        const Vector3 position = re.GetVector3(-Vector3::ONE * 10.0f, Vector3::ONE * 10.0f);
+        const Vector3 scale = re.GetVector3(Vector3::ONE * 0.5f, Vector3::ONE * 2.0f);
+        transforms.emplace_back(position, re.GetQuaternion(), scale);
+    }
+    return transforms;
+}
+
+/// Return blended skinning matrix for the vertex using given number of most important bones.
+Matrix3x4 GetReferenceSkinMatrix(const ModelVertex& vertex, ea::span<const Matrix3x4> transforms, unsigned numBones)
+{
+    ea::pair<float, unsigned> bones[4];
+    for (unsigned j = 0; j < 4; ++j)
+        bones[j] = {vertex.blendWeights_.Data()[j], static_cast<unsigned>(vertex.blendIndices_.Data()[j])};
+    ea::sort(ea::begin(bones), ea::end(bones), ea::greater<>{});
+
+    float totalWeight = 0.0f;
+    for (unsigned j = 0; j < numBones; ++j)
+        totalWeight += bones[j].first;
+
+    Matrix3x4 result = transforms[bones[0].second] * (bones[0].first / totalWeight);
+    for (unsigned j = 1; j < numBones; ++j)
+        result = result + transforms[bones[j].second] * (bones[j].first / totalWeight);
+    return result;
+}
+
+}
+
+TEST_CASE("Software skinning matches reference for any number of bones")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    RandomEngine re(0);
+    // Use enough vertices to process them in multiple tasks
+    const unsigned numVertices = SoftwareModelAnimator::VerticesPerTask * 2 + 3;
+    auto model = CreateRandomSkinnedModel(context, numVertices, re);
+    const ea::vector<Matrix3x4> transforms = CreateRandomTransforms(re);
+
+    auto modelView = MakeShared<ModelView>(context);
+    REQUIRE(modelView->ImportModel(model));
+    const ea::vector<ModelVertex>& vertices = modelView->GetGeometries()[0].lods_[0].vertices_;
+    REQUIRE(vertices.size() == numVertices);
+
+    for (unsigned numBones = 1; numBones <= SoftwareModelAnimator::MaxBones; ++numBones)
+    {
+        auto animator = MakeShared<SoftwareModelAnimator>(context);
+        animator->Initialize(model, true, numBones);
+        animator->ResetAnimation();
+        animator->ApplySkinning(transforms);
+
+        VertexBuffer* vertexBuffer = animator->GetVertexBuffers()[0];
+        REQUIRE(vertexBuffer);
+        REQUIRE(vertexBuffer->GetVertexSize() == 10 * sizeof(float));
+        const auto data = reinterpret_cast<const float*>(vertexBuffer->GetShadowData());
+
+        for (unsigned i = 0; i < numVertices; ++i)
+        {
+            const ModelVertex& vertex = vertices[i];
+            const Matrix3x4 matrix = GetReferenceSkinMatrix(vertex, transforms, numBones);
+            const Matrix3 rotation = matrix.ToMatrix3();
+
+            const float* animatedVertex = data + i * 10;
+            const Vector3 position{animatedVertex};
+            const Vector3 normal{animatedVertex + 3};
+            const Vector4 tangent{animatedVertex + 6};
+
+            REQUIRE(position.Equals(matrix * vertex.GetPosition(), M_LARGE_EPSILON));
+            REQUIRE(normal.Equals(rotation * static_cast<Vector3>(vertex.normal_), M_LARGE_EPSILON));
+            REQUIRE(tangent.Equals(Vector4(rotation * static_cast<Vector3>(vertex.tangent_), vertex.tangent_.w_), M_LARGE_EPSILON));
+        }
+    }
+}
+
+TEST_CASE("Software morphing is applied to morphed vertices only")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    RandomEngine re(0);
+    const unsigned numVertices = SoftwareModelAnimator::VerticesPerTask * 4 + 3;
+    auto model = CreateRandomSkinnedModel(context, numVertices, re);
+
+    auto modelView = MakeShared<ModelView>(context);
+    REQUIRE(modelView->ImportModel(model));
+    const GeometryLODView& geometry = modelView->GetGeometries()[0].lods_[0];
+    const ModelVertexMorphVector& morph = geometry.morphs_.at(0);
+
+    auto animator = MakeShared<SoftwareModelAnimator>(context);
+    animator->Initialize(model, false, SoftwareModelAnimator::MaxBones);
+
+    ea::vector<ModelMorph> morphs = model->GetMorphs();
+    REQUIRE(morphs.size() == 1);
+    morphs[0].weight_ = 0.5f;
+    animator->ResetAnimation();
+    animator->ApplyMorphs(morphs);
+
+    VertexBuffer* vertexBuffer = animator->GetVertexBuffers()[0];
+    REQUIRE(vertexBuffer);
+    const unsigned vertexSize = vertexBuffer->GetVertexSize() / sizeof(float);
+    const auto data = reinterpret_cast<const float*>(vertexBuffer->GetShadowData());
+
+    ea::vector<Vector3> expectedPositions;
+    ea::vector<Vector3> expectedNormals;
+    for (const ModelVertex& vertex : geometry.vertices_)
+    {
+        expectedPositions.push_back(vertex.GetPosition());
+        expectedNormals.push_back(static_cast<Vector3>(vertex.normal_));
+    }
+    for (const ModelVertexMorph& vertexMorph : morph)
+    {
+        expectedPositions[vertexMorph.index_] += vertexMorph.positionDelta_ * 0.5f;
+        expectedNormals[vertexMorph.index_] += vertexMorph.normalDelta_ * 0.5f;
+    }
+
+    const unsigned morphRangeStart = model->GetMorphRangeStart(0);
+    for (unsigned i = morphRangeStart; i < numVertices; ++i)
+    {
+        const float* morphedVertex = data + i * vertexSize;
+        REQUIRE(Vector3(morphedVertex).Equals(expectedPositions[i], M_LARGE_EPSILON));
+        REQUIRE(Vector3(morphedVertex + 3).Equals(expectedNormals[i], M_LARGE_EPSILON));
+    }
+}
+
+TEST_CASE("Software skinning throughput", "[.][benchmark]")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    RandomEngine re(0);
+    const unsigned numVertices = 100000;
+    auto model = CreateRandomSkinnedModel(context, numVertices, re);
+    const ea::vector<Matrix3x4> transforms = CreateRandomTransforms(re);
+
+    auto skinningAnimator = MakeShared<SoftwareModelAnimator>(context);
+    skinningAnimator->Initialize(model, true, SoftwareModelAnimator::MaxBones);
+
+    auto morphAnimator = MakeShared<SoftwareModelAnimator>(context);
+    morphAnimator->Initialize(model, false, SoftwareModelAnimator::MaxBones);
+    ea::vector<ModelMorph> morphs = model->GetMorphs();
+    morphs[0].weight_ = 0.5f;
+
+    BENCHMARK("Reset and skin 100k vertices with normals and tangents")
+    {
+        skinningAnimator->ResetAnimation();
+        skinningAnimator->ApplySkinning(transforms);
+        return skinningAnimator->GetVertexBuffers()[0]->GetShadowData()[0];
+    };
+
+    BENCHMARK("Reset and morph 50k of 100k vertices")
+    {
+        morphAnimator->ResetAnimation();
+        morphAnimator->ApplyMorphs(morphs);
+        return morphAnimator->GetVertexBuffers()[0]->GetShadowData()[0];
+    };
+}
@@ -0,0 +1,272 @@
+//
+// Copyright (c) 2022-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR rhs
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR rhsWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR rhs DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/Container/MPSCRingBuffer.h>
+#include <Urho3D/IO/IOEvents.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/Scene/Serializable.h>
+
+#include <thread>
+
+namespace
+{
+
+/// Write messages to the logger from several threads.
+void WriteFromThreads(const Logger& logger, unsigned numThreads, unsigned numMessagesPerThread)
+{
+    ea::vector<std::thread> threads;
+    for (unsigned threadIndex = 0; threadIndex < numThreads; ++threadIndex)
+    {
+        threads.emplace_back([&, threadIndex]
+        {
+            for (unsigned i = 0; i < numMessagesPerThread; ++i)
+            {
+                if (i % 2 == 0)
+                    logger.Info("Message {} from thread {}", i, threadIndex);
+                else
+                    logger.WriteDeferred(LOG_INFO, [=] { return Format("Message {} from thread {}", i, threadIndex); });
+            }
+        });
+    }
+
+    for (std::thread& thread : threads)
+        thread.join();
+}
+
+/// Restore log mode on scope exit, even if the test fails.
+class AsyncLogGuard
+{
+public:
+    explicit AsyncLogGuard(Log* log)
+        : log_(log)
+        , async_(log->IsAsync())
+        , queueCapacity_(log->GetAsyncQueueCapacity())
+        , overflowPolicy_(log->GetOverflowPolicy())
+        , sampleRate_(log->GetSampleRate())
+    {
+    }
+
+    ~AsyncLogGuard()
+    {
+        log_->SetAsync(false);
+        log_->PumpThreadMessages();
+        log_->SetAsyncQueueCapacity(queueCapacity_);
+        log_->SetOverflowPolicy(overflowPolicy_);
+        log_->SetSampleRate(sampleRate_);
+        log_->SetAsync(async_);
+    }
+
+private:
+    Log* log_{};
+    bool async_{};
+    unsigned queueCapacity_{};
+    LogOverflowPolicy overflowPolicy_{};
+    unsigned sampleRate_{};
+};
+
+}
+
+TEST_CASE("MPSCRingBuffer transfers elements from multiple producers")
+{
+    const unsigned numProducers = 4;
+    const unsigned numElementsPerProducer = 20000;
+
+    MPSCRingBuffer<unsigned> buffer(64);
+    REQUIRE(buffer.GetCapacity() == 64);
+
+    ea::vector<std::thread> producers;
+    for (unsigned producerIndex = 0; producerIndex < numProducers; ++producerIndex)
+    {
+        producers.emplace_back([&, producerIndex]
+        {
+            for (unsigned i = 0; i < numElementsPerProducer; ++i)
+            {
+                unsigned value = producerIndex * numElementsPerProducer + i;
+                while (!buffer.TryPush(ea::move(value)))
+                    std::this_thread::yield();
+            }
+        });
+    }
+
+    // Elements from each producer are received in order
+    ea::vector<unsigned> nextElement(numProducers);
+    unsigned numReceived = 0;
+    while (numReceived < numProducers * numElementsPerProducer)
+    {
+        unsigned value{};
+        if (!buffer.TryPop(value))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        const unsigned producerIndex = value / numElementsPerProducer;
+        REQUIRE(producerIndex < numProducers);
+        REQUIRE(value % numElementsPerProducer == nextElement[producerIndex]);
+        ++nextElement[producerIndex];
+        ++numReceived;
+    }
+
+    for (std::thread& producer : producers)
+        producer.join();
+
+    REQUIRE(buffer.IsEmpty());
+}
+
+TEST_CASE("MPSCRingBuffer rejects elements when full")
+{
+    MPSCRingBuffer<ea::string> buffer(3);
+    REQUIRE(buffer.GetCapacity() == 4);
+
+    for (unsigned i = 0; i < 4; ++i)
+        REQUIRE(buffer.TryPush(Format("Element {}", i)));
+
+    ea::string rejected = "Rejected";
+    REQUIRE_FALSE(buffer.TryPush(ea::move(rejected)));
+    REQUIRE(rejected == "Rejected");
+    REQUIRE(buffer.GetSize() == 4);
+
+    ea::string value;
+    REQUIRE(buffer.TryPop(value));
+    REQUIRE(value == "Element 0");
+    REQUIRE(buffer.TryPush("Element 4"));
+
+    for (unsigned i = 1; i <= 4; ++i)
+    {
+        REQUIRE(buffer.TryPop(value));
+        REQUIRE(value == Format("Element {}", i));
+    }
+    REQUIRE_FALSE(buffer.TryPop(value));
+}
+
+TEST_CASE("Asynchronous log delivers all messages with blocking policy")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto log = context->GetSubsystem<Log>();
+    const Logger logger = log->GetOrCreateLogger("AsyncBlock");
+
+    const unsigned numThreads = 4;
+    const unsigned numMessagesPerThread = 500;
+
+    // Collect messages in the handler and check them later, a failure inside the handler would break the log
+    ea::vector<unsigned> numMessages(numThreads);
+    unsigned numUnexpectedMessages = 0;
+    Serializable receiver(context);
+    receiver.SubscribeToEvent(E_LOGMESSAGE, [&](StringHash, VariantMap& eventData)
+    {
+        if (eventData[LogMessage::P_LOGGER].GetString() != "AsyncBlock")
+            return;
+
+        // Ignore service messages like skipped duplicates
+        const ea::string& message = eventData[LogMessage::P_MESSAGE].GetString();
+        if (!message.starts_with("Message "))
+            return;
+
+        const unsigned threadIndex = ToUInt(message.substr(message.find_last_of(' ') + 1));
+        if (threadIndex >= numThreads
+            || message != Format("Message {} from thread {}", numMessages[threadIndex], threadIndex))
+        {
+            ++numUnexpectedMessages;
+            return;
+        }
+        ++numMessages[threadIndex];
+    });
+
+    const AsyncLogGuard guard(log);
+    log->SetAsyncQueueCapacity(16);
+    log->SetOverflowPolicy(LogOverflowPolicy::Block);
+    log->SetAsync(true);
+    REQUIRE(log->IsAsync());
+
+    const unsigned long long numDropped = log->GetNumDroppedMessages();
+    WriteFromThreads(logger, numThreads, numMessagesPerThread);
+    log->Flush();
+    log->PumpThreadMessages();
+
+    REQUIRE(log->GetNumDroppedMessages() == numDropped);
+    REQUIRE(log->GetNumQueuedMessages() == 0);
+    REQUIRE(numUnexpectedMessages == 0);
+    for (unsigned threadIndex = 0; threadIndex < numThreads; ++threadIndex)
+        REQUIRE(numMessages[threadIndex] == numMessagesPerThread);
+
+    log->SetAsync(false);
+    REQUIRE_FALSE(log->IsAsync());
+}
+
+TEST_CASE("Asynchronous log counts dropped messages")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto log = context->GetSubsystem<Log>();
+    const Logger logger = log->GetOrCreateLogger("AsyncDrop");
+
+    const unsigned numThreads = 4;
+    const unsigned numMessagesPerThread = 2000;
+
+    const AsyncLogGuard guard(log);
+    for (LogOverflowPolicy policy : {LogOverflowPolicy::Drop, LogOverflowPolicy::Sample})
+    {
+        log->SetAsyncQueueCapacity(16);
+        log->SetOverflowPolicy(policy);
+        log->SetSampleRate(4);
+        log->SetAsync(true);
+
+        const unsigned long long numDropped = log->GetNumDroppedMessages();
+        const unsigned long long numProcessed = log->GetNumProcessedMessages();
+        WriteFromThreads(logger, numThreads, numMessagesPerThread);
+        log->Flush();
+
+        // Every message is either written or dropped
+        const unsigned long long numNewDropped = log->GetNumDroppedMessages() - numDropped;
+        const unsigned long long numNewProcessed = log->GetNumProcessedMessages() - numProcessed;
+        REQUIRE(numNewDropped + numNewProcessed == numThreads * numMessagesPerThread);
+
+        log->SetAsync(false);
+        log->PumpThreadMessages();
+    }
+}
+
+TEST_CASE("Logger stays valid after its Log is destroyed")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    auto log = MakeShared<Log>(context);
+    const Logger logger = log->GetOrCreateLogger("Orphan");
+
+    unsigned numMessages = 0;
+    Serializable receiver(context);
+    receiver.SubscribeToEvent(log, E_LOGMESSAGE, [&](StringHash, VariantMap& eventData)
+    {
+        if (eventData[LogMessage::P_LOGGER].GetString() == "Orphan")
+            ++numMessages;
+    });
+
+    logger.Info("Message before Log is destroyed");
+    log->PumpThreadMessages();
+    REQUIRE(numMessages == 1);
+
+    log = nullptr;
+    REQUIRE(logger.IsEnabled(LOG_INFO));
+    logger.Info("Message after Log is destroyed");
+    REQUIRE(numMessages == 1);
+}
@@ -0,0 +1,111 @@
+//
+// Copyright (c) 2022-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR rhs
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR rhsWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR rhs DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/Math/BoundingBoxArray.h>
+#include <Urho3D/Math/Frustum.h>
+#include <Urho3D/Math/RandomEngine.h>
+
+namespace
+{
+
+BoundingBox GetRandomBox(RandomEngine& re)
+{
+    const Vector3 center = re.GetVector3(-Vector3::ONE * 100.0f, Vector3::ONE * 100.0f);
+    const Vector3 halfSize = re.GetVector3(Vector3::ONE * 0.1f, Vector3::ONE * 10.0f);
+    return BoundingBox(center - halfSize, center + halfSize);
+}
+
+ea::vector<unsigned> CullFrustum(const BoundingBoxArray& boxes, const Frustum& frustum, unsigned beginIndex, unsigned endIndex)
+{
+    ea::vector<unsigned> result(endIndex - beginIndex);
+    result.resize(boxes.CullFrustum(frustum, beginIndex, endIndex, result.data()));
+    return result;
+}
+
+ea::vector<unsigned> CullFrustumReference(
+    const ea::vector<BoundingBox>& boxes, const Frustum& frustum, unsigned beginIndex, unsigned endIndex)
+{
+    ea::vector<unsigned> result;
+    for (unsigned i = beginIndex; i < endIndex; ++i)
+    {
+        if (frustum.IsInsideFast(boxes[i]) != OUTSIDE)
+            result.push_back(i);
+    }
+    return result;
+}
+
+}
+
+TEST_CASE("BoundingBoxArray frustum culling is consistent with Frustum")
+{
+    RandomEngine re(0);
+
+    Frustum frustum;
+    frustum.Define(60.0f, 1.5f, 1.0f, 0.1f, 80.0f, Matrix3x4(Vector3::ZERO, Quaternion(30.0f, Vector3::UP), Vector3::ONE));
+
+    BoundingBoxArray boxes;
+    ea::vector<BoundingBox> referenceBoxes;
+    for (unsigned i = 0; i < 1000; ++i)
+    {
+        referenceBoxes.push_back(GetRandomBox(re));
+        boxes.PushBack(referenceBoxes.back());
+    }
+    REQUIRE(boxes.Size() == 1000);
+
+    const auto visibleIndices = CullFrustum(boxes, frustum, 0, boxes.Size());
+    REQUIRE(!visibleIndices.empty());
+    REQUIRE(visibleIndices.size() < boxes.Size());
+    REQUIRE(visibleIndices == CullFrustumReference(referenceBoxes, frustum, 0, boxes.Size()));
+
+    // Unaligned ranges
+    REQUIRE(CullFrustum(boxes, frustum, 3, 17) == CullFrustumReference(referenceBoxes, frustum, 3, 17));
+    REQUIRE(CullFrustum(boxes, frustum, 998, 1000) == CullFrustumReference(referenceBoxes, frustum, 998, 1000));
+    REQUIRE(CullFrustum(boxes, frustum, 500, 500).empty());
+
+    // Modify and erase boxes
+    for (unsigned i = 0; i < 100; ++i)
+    {
+        const unsigned index = re.GetUInt(0, boxes.Size());
+        referenceBoxes[index] = GetRandomBox(re);
+        boxes.Set(index, referenceBoxes[index]);
+
+        const unsigned erasedIndex = re.GetUInt(0, boxes.Size());
+        referenceBoxes.erase_at(erasedIndex);
+        boxes.EraseAt(erasedIndex);
+    }
+    REQUIRE(boxes.Size() == 900);
+    REQUIRE(CullFrustum(boxes, frustum, 0, boxes.Size()) == CullFrustumReference(referenceBoxes, frustum, 0, boxes.Size()));
+
+    // Invalid boxes are never culled
+    for (unsigned i = 0; i < boxes.Size(); ++i)
+    {
+        REQUIRE(boxes.IsValid(i));
+        boxes.Invalidate(i);
+        REQUIRE(!boxes.IsValid(i));
+    }
+    REQUIRE(CullFrustum(boxes, frustum, 0, boxes.Size()).size() == boxes.Size());
+
+    boxes.Clear();
+    REQUIRE(boxes.Empty());
+}
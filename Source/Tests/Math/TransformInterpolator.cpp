@@ -0,0 +1,77 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/Math/RandomEngine.h>
+#include <Urho3D/Math/TransformInterpolator.h>
+
+namespace
+{
+
+Transform GetRandomTransform(RandomEngine& re)
+{
+    Transform transform;
+    transform.position_ = re.GetVector3(-Vector3::ONE * 10.0f, Vector3::ONE * 10.0f);
+    transform.rotation_ = re.GetQuaternion();
+    transform.scale_ = re.GetVector3(Vector3::ONE * 0.1f, Vector3::ONE * 2.0f);
+    return transform;
+}
+
+}
+
+TEST_CASE("TransformInterpolator is consistent with Lerp and Slerp")
+{
+    RandomEngine re(0);
+    const unsigned numPairs = 101;
+
+    ea::vector<Transform> from;
+    ea::vector<Transform> to;
+    ea::vector<Vector3> factors;
+    TransformInterpolator interpolator;
+    for (unsigned i = 0; i < numPairs; ++i)
+    {
+        from.push_back(GetRandomTransform(re));
+        // Test nearly equal rotations too
+        to.push_back(i % 10 == 0 ? from.back() : GetRandomTransform(re));
+        factors.push_back(i % 7 == 0 ? Vector3::ZERO : re.GetVector3(Vector3::ZERO, Vector3::ONE));
+        REQUIRE(interpolator.Add(from.back(), to.back(), factors.back()) == i);
+    }
+
+    interpolator.Evaluate();
+    REQUIRE(interpolator.Size() == numPairs);
+
+    for (unsigned i = 0; i < numPairs; ++i)
+    {
+        const Transform result = interpolator.GetResult(i);
+
+        // Linear interpolation is exact
+        CHECK(result.position_ == from[i].position_.Lerp(to[i].position_, factors[i].x_));
+        CHECK(result.scale_ == from[i].scale_.Lerp(to[i].scale_, factors[i].z_));
+        CHECK(result.rotation_.Equals(from[i].rotation_.Slerp(to[i].rotation_, factors[i].y_), 0.00001f));
+
+        // Zero factor returns source value as is
+        if (factors[i].y_ == 0.0f)
+            CHECK(result.rotation_ == from[i].rotation_);
+    }
+}
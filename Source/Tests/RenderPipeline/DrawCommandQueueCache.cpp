@@ -0,0 +1,174 @@
+//
+// Copyright (c) 2022-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR rhs
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR rhsWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR rhs DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/Graphics/Geometry.h>
+#include <Urho3D/Graphics/IndexBuffer.h>
+#include <Urho3D/Graphics/Material.h>
+#include <Urho3D/Graphics/Model.h>
+#include <Urho3D/Graphics/StaticModel.h>
+#include <Urho3D/Graphics/Texture2D.h>
+#include <Urho3D/Graphics/VertexBuffer.h>
+#include <Urho3D/RenderPipeline/DrawCommandQueueCache.h>
+#include <Urho3D/Scene/Scene.h>
+
+namespace
+{
+
+struct TestBatchSource
+{
+    SharedPtr<Scene> scene_;
+    SharedPtr<Node> node_;
+    SharedPtr<StaticModel> staticModel_;
+    SharedPtr<Geometry> geometry_;
+    SharedPtr<Material> material_;
+
+    PipelineBatch GetBatch() const
+    {
+        PipelineBatch batch{staticModel_, 0};
+        batch.material_ = material_;
+        return batch;
+    }
+};
+
+TestBatchSource CreateTestBatchSource(Context* context)
+{
+    TestBatchSource result;
+    result.scene_ = MakeShared<Scene>(context);
+    result.node_ = result.scene_->CreateChild();
+    result.staticModel_ = result.node_->CreateComponent<StaticModel>();
+
+    auto model = MakeShared<Model>(context);
+    auto vb = MakeShared<VertexBuffer>(context);
+    model->SetVertexBuffers({vb}, {}, {});
+    auto ib = MakeShared<IndexBuffer>(context);
+    ib->SetSize(6, false);
+    REQUIRE(model->SetIndexBuffers({ib}));
+
+    result.geometry_ = MakeShared<Geometry>(context);
+    REQUIRE(result.geometry_->SetVertexBuffer(0, vb));
+    result.geometry_->SetIndexBuffer(ib);
+    REQUIRE(result.geometry_->SetDrawRange(TRIANGLE_LIST, 0, 6));
+    model->SetNumGeometries(1);
+    REQUIRE(model->SetNumGeometryLodLevels(0, 1));
+    REQUIRE(model->SetGeometry(0, 0, result.geometry_));
+
+    result.staticModel_->SetModel(model);
+    result.material_ = MakeShared<Material>(context);
+    return result;
+}
+
+DrawCommandQueueKey CreateKey(const PipelineBatch& batch, BatchRenderFlags flags = BatchRenderFlag::None)
+{
+    PipelineBatchByState sortedBatch;
+    sortedBatch.pipelineBatch_ = &batch;
+
+    PipelineBatchGroup<PipelineBatchByState> batchGroup;
+    batchGroup.batches_ = {&sortedBatch, 1};
+    batchGroup.flags_ = flags;
+
+    DrawCommandQueueKey key;
+    key.Define(batchGroup, {}, 100.0f, nullptr);
+    return key;
+}
+
+}
+
+TEST_CASE("Draw command queue key is invalidated by drawable changes")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    const TestBatchSource source = CreateTestBatchSource(context);
+
+    const DrawCommandQueueKey key = CreateKey(source.GetBatch());
+    REQUIRE(key == CreateKey(source.GetBatch()));
+
+    source.node_->SetPosition({1.0f, 2.0f, 3.0f});
+    const DrawCommandQueueKey movedKey = CreateKey(source.GetBatch());
+    REQUIRE(key != movedKey);
+    REQUIRE(movedKey == CreateKey(source.GetBatch()));
+
+    REQUIRE(source.geometry_->SetDrawRange(TRIANGLE_LIST, 3, 3));
+    REQUIRE(movedKey != CreateKey(source.GetBatch()));
+}
+
+TEST_CASE("Draw command queue key is invalidated by material changes")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    const TestBatchSource source = CreateTestBatchSource(context);
+
+    const DrawCommandQueueKey key = CreateKey(source.GetBatch());
+
+    source.material_->SetShaderParameter("MatDiffColor", Color::RED);
+    const DrawCommandQueueKey parameterKey = CreateKey(source.GetBatch());
+    REQUIRE(key != parameterKey);
+    REQUIRE(parameterKey == CreateKey(source.GetBatch()));
+
+    source.material_->SetTexture(TU_DIFFUSE, MakeShared<Texture2D>(context));
+    REQUIRE(parameterKey != CreateKey(source.GetBatch()));
+}
+
+TEST_CASE("Only unlit static batch groups are cached")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    const TestBatchSource source = CreateTestBatchSource(context);
+
+    PipelineBatch batch = source.GetBatch();
+    PipelineBatchByState sortedBatch;
+    sortedBatch.pipelineBatch_ = &batch;
+
+    PipelineBatchGroup<PipelineBatchByState> batchGroup;
+    REQUIRE_FALSE(DrawCommandQueueKey::IsCacheable(batchGroup));
+
+    batchGroup.batches_ = {&sortedBatch, 1};
+    batchGroup.flags_ = BatchRenderFlag::EnableInstancingForStaticGeometry | BatchRenderFlag::DisableColorOutput;
+    REQUIRE(DrawCommandQueueKey::IsCacheable(batchGroup));
+
+    batchGroup.flags_ = BatchRenderFlag::EnablePixelLights;
+    REQUIRE_FALSE(DrawCommandQueueKey::IsCacheable(batchGroup));
+
+    batchGroup.flags_ = BatchRenderFlag::EnableAmbientLighting;
+    REQUIRE_FALSE(DrawCommandQueueKey::IsCacheable(batchGroup));
+
+    batchGroup.flags_ = BatchRenderFlag::None;
+    batch.geometryType_ = GEOM_SKINNED;
+    REQUIRE_FALSE(DrawCommandQueueKey::IsCacheable(batchGroup));
+}
+
+TEST_CASE("Draw command queue cache is disabled without constant buffers")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    const TestBatchSource source = CreateTestBatchSource(context);
+
+    const PipelineBatch batch = source.GetBatch();
+    PipelineBatchByState sortedBatch;
+    sortedBatch.pipelineBatch_ = &batch;
+
+    PipelineBatchGroup<PipelineBatchByState> batchGroup;
+    batchGroup.batches_ = {&sortedBatch, 1};
+
+    DrawCommandQueueCache cache(nullptr);
+    const auto [queue, isRecorded] = cache.GetQueue(&batchGroup, batchGroup, {}, 100.0f, nullptr);
+    REQUIRE(queue == nullptr);
+    REQUIRE_FALSE(isRecorded);
+    REQUIRE(cache.GetNumCacheableQueues() == 0);
+}
@@ -0,0 +1,105 @@
+//
+// Copyright (c) 2022-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR rhs
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR rhsWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR rhs DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/RenderPipeline/InstancingBuffer.h>
+
+namespace
+{
+
+SharedPtr<InstancingBuffer> CreateInstancingBuffer(Context* context, unsigned numTexCoords)
+{
+    InstancingBufferSettings settings;
+    settings.enableInstancing_ = true;
+    settings.firstInstancingTexCoord_ = 4;
+    settings.numInstancingTexCoords_ = numTexCoords;
+
+    auto instancingBuffer = MakeShared<InstancingBuffer>(context);
+    instancingBuffer->SetSettings(settings);
+    return instancingBuffer;
+}
+
+ea::vector<Matrix3x4> CreateTransforms(unsigned count)
+{
+    ea::vector<Matrix3x4> result(count);
+    for (unsigned i = 0; i < count; ++i)
+        result[i] = Matrix3x4{Vector3::ONE * static_cast<float>(i), Quaternion::IDENTITY, 1.0f};
+    return result;
+}
+
+}
+
+TEST_CASE("Instancing buffer allocates ranges of instances")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto instancingBuffer = CreateInstancingBuffer(context, 3);
+    REQUIRE(instancingBuffer->GetInstanceStride() == sizeof(Matrix3x4));
+
+    const auto transforms = CreateTransforms(300);
+
+    instancingBuffer->Begin();
+    const unsigned firstIndex = instancingBuffer->AddInstances(100);
+    const unsigned secondIndex = instancingBuffer->AddInstances(200);
+    REQUIRE(firstIndex == 0);
+    REQUIRE(secondIndex == 100);
+    REQUIRE(instancingBuffer->GetNextInstanceIndex() == 300);
+
+    // Fill ranges in reverse order, they should not overlap
+    memcpy(instancingBuffer->GetInstanceData(secondIndex), &transforms[100], 200 * sizeof(Matrix3x4));
+    memcpy(instancingBuffer->GetInstanceData(firstIndex), &transforms[0], 100 * sizeof(Matrix3x4));
+
+    const auto* data = reinterpret_cast<const Matrix3x4*>(instancingBuffer->GetInstanceData(0));
+    for (unsigned i = 0; i < transforms.size(); ++i)
+        REQUIRE(data[i].Equals(transforms[i]));
+
+    instancingBuffer->Begin();
+    REQUIRE(instancingBuffer->AddInstances(10) == 0);
+}
+
+TEST_CASE("Instancing buffer fill", "[.][benchmark]")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto instancingBuffer = CreateInstancingBuffer(context, 3);
+
+    static const unsigned numInstances = 100000;
+    const auto transforms = CreateTransforms(numInstances);
+
+    BENCHMARK("Add 100k instances one by one")
+    {
+        instancingBuffer->Begin();
+        for (unsigned i = 0; i < numInstances; ++i)
+        {
+            instancingBuffer->AddInstance();
+            instancingBuffer->SetElements(&transforms[i], 0, 3);
+        }
+        return instancingBuffer->GetNextInstanceIndex();
+    };
+
+    BENCHMARK("Add 100k instances at once")
+    {
+        instancingBuffer->Begin();
+        const unsigned startIndex = instancingBuffer->AddInstances(numInstances);
+        memcpy(instancingBuffer->GetInstanceData(startIndex), transforms.data(), numInstances * sizeof(Matrix3x4));
+        return instancingBuffer->GetNextInstanceIndex();
+    };
+}
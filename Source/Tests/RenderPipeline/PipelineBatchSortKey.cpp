@@ -0,0 +1,191 @@
+//
+// Copyright (c) 2022-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR rhs
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR rhsWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR rhs DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/Math/RandomEngine.h>
+#include <Urho3D/RenderPipeline/PipelineBatchSortKey.h>
+
+#include <EASTL/sort.h>
+
+namespace
+{
+
+/// Create sort keys with distribution similar to real scenes: few shaders, more materials and geometries.
+ea::vector<PipelineBatchByState> CreateBatchesByState(unsigned size, RandomEngine& re)
+{
+    using Key = PipelineBatchByState;
+
+    ea::vector<PipelineBatchByState> result(size);
+    for (PipelineBatchByState& batch : result)
+    {
+        batch.primaryKey_ |= 128ull << Key::RenderOrderOffset;
+        batch.primaryKey_ |= static_cast<unsigned long long>(re.GetUInt(0, 50)) << Key::ShaderProgramOffset;
+        batch.primaryKey_ |= static_cast<unsigned long long>(re.GetUInt(0, 100)) << Key::PipelineStateOffset;
+        batch.primaryKey_ |= static_cast<unsigned long long>(re.GetUInt(0, 500)) << Key::MaterialOffset;
+        batch.primaryKey_ |= static_cast<unsigned long long>(re.GetUInt(0, 10)) << Key::PixelLightOffset;
+        batch.secondaryKey_ |= static_cast<unsigned long long>(re.GetUInt(0, 1000)) << Key::GeometryOffset;
+    }
+    return result;
+}
+
+ea::vector<PipelineBatchBackToFront> CreateBatchesBackToFront(unsigned size, RandomEngine& re)
+{
+    ea::vector<PipelineBatchBackToFront> result(size);
+    for (PipelineBatchBackToFront& batch : result)
+    {
+        batch.renderOrder_ = re.GetBool(0.9f) ? 128 : re.GetUInt(0, 256);
+        batch.distance_ = re.GetFloat(-10.0f, 1000.0f);
+    }
+    return result;
+}
+
+/// Comparison of batches sorted back to front without packing into 64-bit key.
+bool CompareBackToFront(const PipelineBatchBackToFront& lhs, const PipelineBatchBackToFront& rhs)
+{
+    if (lhs.renderOrder_ != rhs.renderOrder_)
+        return lhs.renderOrder_ < rhs.renderOrder_;
+    return lhs.distance_ > rhs.distance_;
+}
+
+template <class T>
+bool IsSameKeys(const ea::vector<T>& lhs, const ea::vector<T>& rhs)
+{
+    const auto isSame = [](const T& lhs, const T& rhs) { return !(lhs < rhs) && !(rhs < lhs); };
+    return lhs.size() == rhs.size() && ea::equal(lhs.begin(), lhs.end(), rhs.begin(), isSame);
+}
+
+}
+
+TEST_CASE("Pipeline batches are sorted with radix sort in the same order as with comparison")
+{
+    auto context = MakeShared<Context>();
+    auto workQueue = MakeShared<WorkQueue>(context);
+    workQueue->CreateThreads(3);
+
+    const unsigned size = GENERATE(10u, 1000u, 20000u);
+    RandomEngine re(size);
+
+    {
+        const ea::vector<PipelineBatchByState> batches = CreateBatchesByState(size, re);
+        ea::vector<PipelineBatchByState> expected = batches;
+        ea::sort(expected.begin(), expected.end());
+
+        RadixSorter<PipelineBatchByState> sorter;
+        ea::vector<PipelineBatchByState> sortedBatches = batches;
+        SortPipelineBatches(workQueue, sorter, sortedBatches);
+        REQUIRE(IsSameKeys(sortedBatches, expected));
+    }
+
+    {
+        ea::vector<PipelineBatchBackToFront> batches = CreateBatchesBackToFront(size, re);
+        batches[0].distance_ = -0.0f;
+        batches[1].distance_ = 0.0f;
+        ea::vector<PipelineBatchBackToFront> expected = batches;
+        ea::stable_sort(expected.begin(), expected.end(), CompareBackToFront);
+
+        RadixSorter<PipelineBatchBackToFront> sorter;
+        ea::vector<PipelineBatchBackToFront> sortedBatches = batches;
+        SortPipelineBatches(workQueue, sorter, sortedBatches);
+
+        const auto isSame = [](const PipelineBatchBackToFront& lhs, const PipelineBatchBackToFront& rhs)
+        { return lhs.renderOrder_ == rhs.renderOrder_ && lhs.distance_ == rhs.distance_; };
+        REQUIRE(sortedBatches.size() == expected.size());
+        REQUIRE(ea::equal(sortedBatches.begin(), sortedBatches.end(), expected.begin(), isSame));
+    }
+}
+
+TEST_CASE("Pipeline batch sorting performance is compared between comparison and radix sort", "[.][benchmark]")
+{
+    auto context = MakeShared<Context>();
+    auto workQueue = MakeShared<WorkQueue>(context);
+    workQueue->CreateThreads(3);
+
+    for (const unsigned size : {1000u, 10000u, 100000u})
+    {
+        RandomEngine re(0);
+        const ea::vector<PipelineBatchByState> batchesByState = CreateBatchesByState(size, re);
+        const ea::vector<PipelineBatchBackToFront> batchesBackToFront = CreateBatchesBackToFront(size, re);
+        using SortedByState = ea::vector<PipelineBatchByState>;
+        using SortedBackToFront = ea::vector<PipelineBatchBackToFront>;
+        RadixSorter<PipelineBatchByState> sorterByState;
+        RadixSorter<PipelineBatchBackToFront> sorterBackToFront;
+
+        const ea::string suffix = Format(" for {} batches", size);
+
+        BENCHMARK_ADVANCED((ea::string("ea::sort by state") + suffix).c_str())(Catch::Benchmark::Chronometer meter)
+        {
+            ea::vector<SortedByState> inputs(meter.runs(), batchesByState);
+            meter.measure([&](int run)
+            {
+                auto& sortedByState = inputs[run];
+                ea::sort(sortedByState.begin(), sortedByState.end());
+                return sortedByState.size();
+            });
+        };
+
+        BENCHMARK_ADVANCED((ea::string("Radix sort by state") + suffix).c_str())(Catch::Benchmark::Chronometer meter)
+        {
+            ea::vector<SortedByState> inputs(meter.runs(), batchesByState);
+            meter.measure([&](int run)
+            {
+                auto& sortedByState = inputs[run];
+                SortPipelineBatches(nullptr, sorterByState, sortedByState);
+                return sortedByState.size();
+            });
+        };
+
+        BENCHMARK_ADVANCED((ea::string("Radix sort by state in 4 threads") + suffix).c_str())(Catch::Benchmark::Chronometer meter)
+        {
+            ea::vector<SortedByState> inputs(meter.runs(), batchesByState);
+            meter.measure([&](int run)
+            {
+                auto& sortedByState = inputs[run];
+                SortPipelineBatches(workQueue, sorterByState, sortedByState);
+                return sortedByState.size();
+            });
+        };
+
+        BENCHMARK_ADVANCED((ea::string("ea::sort back to front") + suffix).c_str())(Catch::Benchmark::Chronometer meter)
+        {
+            ea::vector<SortedBackToFront> inputs(meter.runs(), batchesBackToFront);
+            meter.measure([&](int run)
+            {
+                auto& sortedBackToFront = inputs[run];
+                ea::sort(sortedBackToFront.begin(), sortedBackToFront.end(), CompareBackToFront);
+                return sortedBackToFront.size();
+            });
+        };
+
+        BENCHMARK_ADVANCED((ea::string("Radix sort back to front") + suffix).c_str())(Catch::Benchmark::Chronometer meter)
+        {
+            ea::vector<SortedBackToFront> inputs(meter.runs(), batchesBackToFront);
+            meter.measure([&](int run)
+            {
+                auto& sortedBackToFront = inputs[run];
+                SortPipelineBatches(nullptr, sorterBackToFront, sortedBackToFront);
+                return sortedBackToFront.size();
+            });
+        };
+    }
+}
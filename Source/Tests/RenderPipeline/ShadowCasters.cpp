@@ -0,0 +1,242 @@
+//
+// Copyright (c) 2022-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR rhs
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR rhsWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR rhs DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/Graphics/Camera.h>
+#include <Urho3D/Graphics/Light.h>
+#include <Urho3D/Graphics/Model.h>
+#include <Urho3D/Graphics/Octree.h>
+#include <Urho3D/Graphics/OctreeQuery.h>
+#include <Urho3D/Graphics/ReflectionProbe.h>
+#include <Urho3D/Graphics/Renderer.h>
+#include <Urho3D/Graphics/StaticModel.h>
+#include <Urho3D/Graphics/Texture2D.h>
+#include <Urho3D/RenderPipeline/DrawableProcessor.h>
+#include <Urho3D/RenderPipeline/LightProcessor.h>
+#include <Urho3D/RenderPipeline/ShadowSplitProcessor.h>
+#include <Urho3D/Scene/Scene.h>
+
+namespace
+{
+
+class TestRenderPipeline : public RenderPipelineInterface
+{
+public:
+    explicit TestRenderPipeline(Context* context) : context_(context) {}
+
+    Context* GetContext() const override { return context_; }
+    RenderPipelineDebugger* GetDebugger() override { return nullptr; }
+
+private:
+    Context* context_{};
+};
+
+class TestLightProcessorCallback : public LightProcessorCallback
+{
+public:
+    explicit TestLightProcessorCallback(Context* context)
+        : shadowMap_(MakeShared<Texture2D>(context))
+    {
+    }
+
+    bool IsLightShadowed(Light* light) override { return true; }
+    unsigned GetShadowMapSize(Light* light, unsigned numActiveSplits) const override { return 1024; }
+    ShadowMapRegion AllocateTransientShadowMap(const IntVector2& size) override
+    {
+        return ShadowMapRegion{0, shadowMap_, IntRect{IntVector2::ZERO, size}};
+    }
+
+private:
+    SharedPtr<Texture2D> shadowMap_;
+};
+
+/// Scene with a field of shadow casting boxes lit by cascaded directional light.
+struct TestShadowScene
+{
+    SharedPtr<Scene> scene_;
+    Octree* octree_{};
+    Camera* camera_{};
+    Light* light_{};
+};
+
+TestShadowScene CreateTestShadowScene(Context* context, unsigned gridSize)
+{
+    auto model = MakeShared<Model>(context);
+    model->SetBoundingBox(BoundingBox(-0.5f, 0.5f));
+
+    TestShadowScene result;
+    result.scene_ = MakeShared<Scene>(context);
+    result.octree_ = result.scene_->CreateComponent<Octree>();
+    result.octree_->SetSize(BoundingBox(-500.0f, 500.0f), 8);
+
+    for (unsigned x = 0; x < gridSize; ++x)
+    {
+        for (unsigned z = 0; z < gridSize; ++z)
+        {
+            Node* node = result.scene_->CreateChild();
+            node->SetPosition({(x - gridSize * 0.5f) * 2.0f, (x + z) % 5 * 1.0f, z * 2.0f});
+            auto staticModel = node->CreateComponent<StaticModel>();
+            staticModel->SetModel(model);
+            staticModel->SetCastShadows(true);
+        }
+    }
+
+    Node* cameraNode = result.scene_->CreateChild();
+    cameraNode->SetPosition({0.0f, 10.0f, -10.0f});
+    cameraNode->LookAt({0.0f, 0.0f, 40.0f});
+    result.camera_ = cameraNode->CreateComponent<Camera>();
+    result.camera_->SetFarClip(300.0f);
+
+    Node* lightNode = result.scene_->CreateChild();
+    lightNode->SetDirection({0.6f, -1.0f, 0.8f});
+    result.light_ = lightNode->CreateComponent<Light>();
+    result.light_->SetLightType(LIGHT_DIRECTIONAL);
+    result.light_->SetCastShadows(true);
+    result.light_->SetShadowCascade(CascadeParameters(15.0f, 40.0f, 100.0f, 300.0f, 0.8f));
+
+    return result;
+}
+
+FrameInfo CreateFrameInfo(const TestShadowScene& testScene, unsigned frameNumber)
+{
+    FrameInfo frameInfo;
+    frameInfo.frameNumber_ = frameNumber;
+    frameInfo.timeStep_ = 1.0f / 60.0f;
+    frameInfo.viewSize_ = {1024, 768};
+    frameInfo.viewRect_ = {IntVector2::ZERO, frameInfo.viewSize_};
+    frameInfo.scene_ = testScene.scene_;
+    frameInfo.camera_ = testScene.camera_;
+    frameInfo.octree_ = testScene.octree_;
+    frameInfo.reflectionProbeManager_ = testScene.scene_->GetOrCreateComponent<ReflectionProbeManager>(LOCAL);
+    return frameInfo;
+}
+
+void ProcessFrame(DrawableProcessor* drawableProcessor, LightProcessorCallback* callback, const FrameInfo& frameInfo)
+{
+    drawableProcessor->OnUpdateBegin(frameInfo);
+
+    ea::vector<Drawable*> drawables;
+    FrustumOctreeQuery query(drawables, frameInfo.camera_->GetFrustum(), DRAWABLE_GEOMETRY | DRAWABLE_LIGHT);
+    frameInfo.octree_->GetDrawables(query);
+
+    drawableProcessor->ProcessVisibleDrawables(drawables, nullptr);
+    drawableProcessor->ProcessLights(callback);
+}
+
+ea::vector<ea::vector<Drawable*>> GetShadowCasters(const DrawableProcessor* drawableProcessor)
+{
+    ea::vector<ea::vector<Drawable*>> result;
+    for (const LightProcessor* lightProcessor : drawableProcessor->GetLightProcessors())
+    {
+        for (unsigned i = 0; i < lightProcessor->GetNumSplits(); ++i)
+            result.push_back(lightProcessor->GetSplit(i)->GetShadowCasters());
+    }
+    return result;
+}
+
+}
+
+TEST_CASE("Shadow casters collected in worker threads are consistent with single-threaded collection")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    const bool hasRenderer = !!context->GetSubsystem<Renderer>();
+    if (!hasRenderer)
+        context->RegisterSubsystem<Renderer>();
+
+    SharedPtr<WorkQueue> defaultWorkQueue{context->GetSubsystem<WorkQueue>()};
+    auto threadedWorkQueue = MakeShared<WorkQueue>(context);
+    threadedWorkQueue->CreateThreads(3);
+
+    TestRenderPipeline renderPipeline{context};
+    TestLightProcessorCallback callback{context};
+    const TestShadowScene testScene = CreateTestShadowScene(context, 60);
+
+    auto referenceDrawableProcessor = MakeShared<DrawableProcessor>(&renderPipeline);
+    context->RegisterSubsystem(threadedWorkQueue);
+    auto drawableProcessor = MakeShared<DrawableProcessor>(&renderPipeline);
+    context->RegisterSubsystem(defaultWorkQueue);
+
+    for (unsigned frame = 1; frame <= 3; ++frame)
+    {
+        testScene.camera_->GetNode()->Translate(Vector3::FORWARD * 5.0f);
+
+        const FrameInfo frameInfo = CreateFrameInfo(testScene, frame);
+        testScene.octree_->Update(frameInfo);
+
+        ProcessFrame(referenceDrawableProcessor, &callback, frameInfo);
+        const auto expectedShadowCasters = GetShadowCasters(referenceDrawableProcessor);
+
+        ProcessFrame(drawableProcessor, &callback, frameInfo);
+        const auto shadowCasters = GetShadowCasters(drawableProcessor);
+
+        REQUIRE(expectedShadowCasters.size() == 4);
+        REQUIRE(shadowCasters == expectedShadowCasters);
+        for (const auto& splitShadowCasters : shadowCasters)
+            REQUIRE(!splitShadowCasters.empty());
+    }
+
+    if (!hasRenderer)
+        context->RemoveSubsystem<Renderer>();
+}
+
+TEST_CASE("Shadow caster collection", "[.][benchmark]")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    const bool hasRenderer = !!context->GetSubsystem<Renderer>();
+    if (!hasRenderer)
+        context->RegisterSubsystem<Renderer>();
+
+    SharedPtr<WorkQueue> defaultWorkQueue{context->GetSubsystem<WorkQueue>()};
+    auto threadedWorkQueue = MakeShared<WorkQueue>(context);
+    threadedWorkQueue->CreateThreads(3);
+
+    TestRenderPipeline renderPipeline{context};
+    TestLightProcessorCallback callback{context};
+    const TestShadowScene testScene = CreateTestShadowScene(context, 200);
+
+    auto drawableProcessor = MakeShared<DrawableProcessor>(&renderPipeline);
+    context->RegisterSubsystem(threadedWorkQueue);
+    auto threadedDrawableProcessor = MakeShared<DrawableProcessor>(&renderPipeline);
+    context->RegisterSubsystem(defaultWorkQueue);
+
+    unsigned frameNumber = 0;
+    const FrameInfo frameInfo = CreateFrameInfo(testScene, ++frameNumber);
+    testScene.octree_->Update(frameInfo);
+
+    BENCHMARK("Collect shadow casters for 40k drawables and 4 cascades in main thread")
+    {
+        ProcessFrame(drawableProcessor, &callback, CreateFrameInfo(testScene, ++frameNumber));
+        return drawableProcessor->GetLightProcessors().size();
+    };
+
+    BENCHMARK("Collect shadow casters for 40k drawables and 4 cascades in 3 worker threads")
+    {
+        ProcessFrame(threadedDrawableProcessor, &callback, CreateFrameInfo(testScene, ++frameNumber));
+        return threadedDrawableProcessor->GetLightProcessors().size();
+    };
+
+    if (!hasRenderer)
+        context->RemoveSubsystem<Renderer>();
+}
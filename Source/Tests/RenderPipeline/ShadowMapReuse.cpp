@@ -0,0 +1,235 @@
+//
+// Copyright (c) 2022-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR rhs
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR rhsWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR rhs DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/Graphics/Camera.h>
+#include <Urho3D/Graphics/CustomGeometry.h>
+#include <Urho3D/Graphics/Material.h>
+#include <Urho3D/Graphics/Texture2D.h>
+#include <Urho3D/RenderPipeline/ShadowSplitProcessor.h>
+#include <Urho3D/Scene/Scene.h>
+
+namespace
+{
+
+struct TestShadowSplit
+{
+    SharedPtr<Scene> scene_;
+    SharedPtr<Node> casterNode_;
+    SharedPtr<CustomGeometry> caster_;
+    SharedPtr<Material> material_;
+    SharedPtr<Camera> shadowCamera_;
+    SharedPtr<Texture2D> shadowMapTexture_;
+
+    ShadowMapRegion GetShadowMap() const
+    {
+        return ShadowMapRegion{0, shadowMapTexture_, IntRect{0, 0, 512, 512}};
+    }
+
+    PipelineBatch GetBatch() const { return PipelineBatch{caster_, 0}; }
+};
+
+void CommitTriangle(CustomGeometry* customGeometry, float size)
+{
+    customGeometry->SetNumGeometries(1);
+    customGeometry->BeginGeometry(0, TRIANGLE_LIST);
+    customGeometry->DefineVertex({0.0f, 0.0f, 0.0f});
+    customGeometry->DefineVertex({size, 0.0f, 0.0f});
+    customGeometry->DefineVertex({0.0f, 0.0f, size});
+    customGeometry->Commit();
+}
+
+TestShadowSplit CreateTestShadowSplit(Context* context)
+{
+    TestShadowSplit result;
+    result.scene_ = MakeShared<Scene>(context);
+
+    result.casterNode_ = result.scene_->CreateChild();
+    result.caster_ = result.casterNode_->CreateComponent<CustomGeometry>();
+    CommitTriangle(result.caster_, 1.0f);
+    result.material_ = MakeShared<Material>(context);
+    result.caster_->SetMaterial(result.material_);
+    // Evaluate transform as rendering would, otherwise movement of still dirty node is not reported
+    result.casterNode_->GetWorldTransform();
+
+    Node* cameraNode = result.scene_->CreateChild();
+    cameraNode->SetPosition({0.0f, 10.0f, 0.0f});
+    cameraNode->SetDirection(Vector3::DOWN);
+    result.shadowCamera_ = cameraNode->CreateComponent<Camera>();
+    result.shadowMapTexture_ = MakeShared<Texture2D>(context);
+    return result;
+}
+
+ShadowSplitCacheKey CreateKey(const TestShadowSplit& split, const ShadowMapRegion& shadowMap)
+{
+    const PipelineBatch batch = split.GetBatch();
+    PipelineBatchByState sortedBatch;
+    sortedBatch.pipelineBatch_ = &batch;
+
+    PipelineBatchGroup<PipelineBatchByState> batchGroup;
+    batchGroup.batches_ = {&sortedBatch, 1};
+
+    ShadowSplitCacheKey key;
+    key.Define(shadowMap, split.shadowCamera_, batchGroup);
+    return key;
+}
+
+ShadowSplitCacheKey CreateKey(const TestShadowSplit& split)
+{
+    return CreateKey(split, split.GetShadowMap());
+}
+
+}
+
+TEST_CASE("Shadow split cache key is invalidated by shadow caster changes")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    const TestShadowSplit split = CreateTestShadowSplit(context);
+
+    const ShadowSplitCacheKey key = CreateKey(split);
+    REQUIRE(key == CreateKey(split));
+
+    split.casterNode_->SetPosition({1.0f, 0.0f, 1.0f});
+    const ShadowSplitCacheKey movedKey = CreateKey(split);
+    REQUIRE(key != movedKey);
+    REQUIRE(movedKey == CreateKey(split));
+
+    // Geometry data is modified in-place
+    CommitTriangle(split.caster_, 2.0f);
+    const ShadowSplitCacheKey committedKey = CreateKey(split);
+    REQUIRE(movedKey != committedKey);
+    REQUIRE(committedKey == CreateKey(split));
+
+    split.material_->SetShaderParameter("MatDiffColor", Color::RED);
+    REQUIRE(committedKey != CreateKey(split));
+}
+
+TEST_CASE("Shadow split cache key is invalidated by shadow camera and shadow map changes")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    const TestShadowSplit split = CreateTestShadowSplit(context);
+
+    const ShadowSplitCacheKey key = CreateKey(split);
+
+    split.shadowCamera_->GetNode()->Rotate(Quaternion(10.0f, Vector3::RIGHT));
+    const ShadowSplitCacheKey rotatedKey = CreateKey(split);
+    REQUIRE(key != rotatedKey);
+    REQUIRE(rotatedKey == CreateKey(split));
+
+    split.shadowCamera_->SetZoom(0.9f);
+    const ShadowSplitCacheKey zoomedKey = CreateKey(split);
+    REQUIRE(rotatedKey != zoomedKey);
+
+    ShadowMapRegion shadowMap = split.GetShadowMap();
+    shadowMap.rect_ = IntRect{512, 0, 1024, 512};
+    REQUIRE(zoomedKey != CreateKey(split, shadowMap));
+
+    ShadowSplitCacheKey resetKey = zoomedKey;
+    resetKey.Reset();
+    REQUIRE(resetKey != zoomedKey);
+}
+
+TEST_CASE("Only static shadow batches are cached")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    const TestShadowSplit split = CreateTestShadowSplit(context);
+
+    PipelineBatch batch = split.GetBatch();
+    REQUIRE(ShadowSplitCacheKey::IsCacheable(batch));
+
+    batch.geometryType_ = GEOM_STATIC_NOINSTANCING;
+    REQUIRE(ShadowSplitCacheKey::IsCacheable(batch));
+
+    batch.geometryType_ = GEOM_SKINNED;
+    REQUIRE_FALSE(ShadowSplitCacheKey::IsCacheable(batch));
+
+    batch.geometryType_ = GEOM_BILLBOARD;
+    REQUIRE_FALSE(ShadowSplitCacheKey::IsCacheable(batch));
+}
+
+TEST_CASE("Shadow map with only static shadow casters is reused as a whole")
+{
+    ShadowSplitCacheState state;
+
+    // Shadow map is rendered once and then reused while static shadow casters are unchanged
+    REQUIRE(state.Update(1, true, false, false, true, true) == ShadowMapRenderMode::RenderAll);
+    REQUIRE(state.Update(2, true, true, false, true, true) == ShadowMapRenderMode::Reuse);
+    REQUIRE(state.Update(3, true, true, false, true, true) == ShadowMapRenderMode::Reuse);
+
+    // Shadow map is re-rendered if static shadow casters changed
+    REQUIRE(state.Update(4, true, false, false, true, true) == ShadowMapRenderMode::RenderAll);
+    REQUIRE(state.Update(5, true, true, false, true, true) == ShadowMapRenderMode::Reuse);
+
+    // Shadow map is re-rendered if it was not rendered in previous generation
+    REQUIRE(state.Update(7, true, true, false, true, true) == ShadowMapRenderMode::RenderAll);
+    REQUIRE(state.Update(8, true, true, false, true, true) == ShadowMapRenderMode::Reuse);
+
+    // Shadow map is re-rendered if reuse is disabled
+    REQUIRE(state.Update(9, true, true, false, false, true) == ShadowMapRenderMode::RenderAll);
+    REQUIRE(state.Update(10, true, true, false, true, true) == ShadowMapRenderMode::RenderAll);
+    REQUIRE(state.Update(11, true, true, false, true, true) == ShadowMapRenderMode::Reuse);
+}
+
+TEST_CASE("Static shadow casters are kept in static shadow map if there are dynamic shadow casters")
+{
+    ShadowSplitCacheState state;
+
+    // Static shadow casters are rendered once, only dynamic shadow casters are rendered on next frames
+    REQUIRE(state.Update(1, true, false, true, true, true) == ShadowMapRenderMode::UpdateStatic);
+    REQUIRE(state.Update(2, true, true, true, true, true) == ShadowMapRenderMode::RestoreStatic);
+    REQUIRE(state.Update(3, true, true, true, true, true) == ShadowMapRenderMode::RestoreStatic);
+
+    // Static shadow map is updated if static shadow casters changed
+    REQUIRE(state.Update(4, true, false, true, true, true) == ShadowMapRenderMode::UpdateStatic);
+    REQUIRE(state.Update(5, true, true, true, true, true) == ShadowMapRenderMode::RestoreStatic);
+
+    // Static shadow map is valid regardless of shadow map generation
+    REQUIRE(state.Update(7, true, true, true, true, true) == ShadowMapRenderMode::RestoreStatic);
+
+    // Dynamic shadow casters are removed from shadow map, then the shadow map is reused as a whole
+    REQUIRE(state.Update(8, true, true, false, true, true) == ShadowMapRenderMode::RestoreStatic);
+    REQUIRE(state.Update(9, true, true, false, true, true) == ShadowMapRenderMode::Reuse);
+    REQUIRE(state.Update(10, true, true, true, true, true) == ShadowMapRenderMode::RestoreStatic);
+
+    // Static shadow map is not used without static shadow casters
+    REQUIRE(state.Update(11, false, false, true, true, true) == ShadowMapRenderMode::RenderAll);
+    REQUIRE(state.Update(12, true, false, true, true, true) == ShadowMapRenderMode::UpdateStatic);
+}
+
+TEST_CASE("Shadow map with dynamic shadow casters is re-rendered if static shadow maps are not supported")
+{
+    ShadowSplitCacheState state;
+
+    REQUIRE(state.Update(1, true, false, true, true, false) == ShadowMapRenderMode::RenderAll);
+    REQUIRE(state.Update(2, true, true, true, true, false) == ShadowMapRenderMode::RenderAll);
+
+    // Shadow map without dynamic shadow casters is still reused
+    REQUIRE(state.Update(3, true, true, false, true, false) == ShadowMapRenderMode::RenderAll);
+    REQUIRE(state.Update(4, true, true, false, true, false) == ShadowMapRenderMode::Reuse);
+
+    // Static shadow map is invalidated if it was disabled
+    REQUIRE(state.Update(5, true, false, true, true, true) == ShadowMapRenderMode::UpdateStatic);
+    REQUIRE(state.Update(6, true, true, true, true, false) == ShadowMapRenderMode::RenderAll);
+    REQUIRE(state.Update(7, true, true, true, true, true) == ShadowMapRenderMode::UpdateStatic);
+}
@@ -28,6 +28,7 @@
 #include <Urho3D/Graphics/AnimationController.h>
 #include <Urho3D/Graphics/Camera.h>
 #include <Urho3D/Graphics/Octree.h>
+#include <Urho3D/Math/TransformInterpolator.h>
 #include <Urho3D/Scene/Scene.h>
 #include <Urho3D/UI/Text3D.h>
 
@@ -521,6 +522,90 @@ TEST_CASE("Animation is filtered when start bone is specified")
     }
 }
 
+TEST_CASE("Animation LOD skips tracks of deep bones")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    auto model = Tests::GetOrCreateResource<Model>(context, "@Tests/AnimationController/SkinnedModel.mdl", CreateTestSkinnedModel);
+    auto animation = Tests::GetOrCreateResource<Animation>(context, "@Tests/AnimationController/TranslateXZ.ani", CreateTestTranslateXZAnimation);
+
+    // Setup
+    auto scene = MakeShared<Scene>(context);
+    scene->CreateComponent<Octree>();
+
+    auto node = scene->CreateChild("Node");
+    auto animatedModel = node->CreateComponent<AnimatedModel>();
+    animatedModel->SetModel(model);
+
+    auto animationController = node->CreateComponent<AnimationController>();
+    animationController->PlayNew(AnimationParameters{animation}.Looped());
+
+    const Skeleton& skeleton = animatedModel->GetSkeleton();
+    const unsigned quad1Index = skeleton.GetBoneIndex(ea::string{"Quad 1"});
+    const unsigned quad2Index = skeleton.GetBoneIndex(ea::string{"Quad 2"});
+    REQUIRE(skeleton.GetBoneDepth(skeleton.GetBoneIndex(ea::string{"Root"})) == 0);
+    REQUIRE(skeleton.GetBoneDepth(quad1Index) == 1);
+    REQUIRE(skeleton.GetBoneDepth(quad2Index) == 2);
+
+    // Without camera animation LOD distance is zero and all bones are animated
+    animatedModel->SetAnimationLodBoneDepthDistance(1.0f);
+    animatedModel->SetAnimationLodMaxBoneDepth(1);
+    REQUIRE(animatedModel->GetAnimatedBoneDepth() == M_MAX_UNSIGNED);
+
+    // Time 0.5: Translate X to -1, Translate Z to -2
+    Tests::RunFrame(context, 0.5f, 0.05f);
+    Tests::NodeRef quad2{scene, "Quad 2"};
+    REQUIRE(quad2->GetWorldPosition().Equals({-1.0f, 1.0f, -2.0f}, M_LARGE_EPSILON));
+
+    // Sample only bones up to depth 1
+    AnimationState* state = animationController->GetAnimationStates()[0];
+    ea::vector<ModelAnimationOutput> output(skeleton.GetNumBones());
+    TransformInterpolator interpolator;
+    state->CalculateModelTracks(output, interpolator, 1);
+
+    REQUIRE(output[quad1Index].dirty_ == CHANNEL_POSITION);
+    REQUIRE(output[quad1Index].localToParent_.position_.Equals({-1.0f, 0.0f, 0.0f}, M_LARGE_EPSILON));
+    REQUIRE(output[quad2Index].dirty_ == CHANNEL_NONE);
+
+    // Sample all bones
+    output.assign(skeleton.GetNumBones(), ModelAnimationOutput{});
+    state->CalculateModelTracks(output, interpolator);
+
+    REQUIRE(output[quad1Index].dirty_ == CHANNEL_POSITION);
+    REQUIRE(output[quad2Index].dirty_ == CHANNEL_POSITION);
+    REQUIRE(output[quad2Index].localToParent_.position_.Equals({0.0f, 1.0f, -2.0f}, M_LARGE_EPSILON));
+}
+
+TEST_CASE("Bone node moved manually marks skinning dirty")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    auto model = Tests::GetOrCreateResource<Model>(context, "@Tests/AnimationController/SkinnedModel.mdl", CreateTestSkinnedModel);
+
+    auto scene = MakeShared<Scene>(context);
+    scene->CreateComponent<Octree>();
+
+    auto node = scene->CreateChild("Node");
+    auto animatedModel = node->CreateComponent<AnimatedModel>();
+    animatedModel->SetModel(model);
+
+    FrameInfo frameInfo;
+    animatedModel->UpdateGeometry(frameInfo);
+    REQUIRE(animatedModel->GetUpdateGeometryType() == UPDATE_NONE);
+
+    // Bone nodes should not be left dirty by skinning update
+    Node* quad2 = node->GetChild("Quad 2", true);
+    quad2->SetRotation(Quaternion{90.0f, Vector3::UP});
+    REQUIRE(animatedModel->GetUpdateGeometryType() != UPDATE_NONE);
+
+    animatedModel->UpdateGeometry(frameInfo);
+    REQUIRE(animatedModel->GetUpdateGeometryType() == UPDATE_NONE);
+    REQUIRE(quad2->GetWorldRotation().Equals(Quaternion{90.0f, Vector3::UP}));
+
+    quad2->SetPosition({1.0f, 1.0f, 0.0f});
+    REQUIRE(animatedModel->GetUpdateGeometryType() != UPDATE_NONE);
+}
+
 TEST_CASE("VariantCurve is sample with looping and without it")
 {
     VariantCurve curve;
@@ -857,3 +942,39 @@ TEST_CASE("AnimationController merges result in smooth transition")
 
     animationController2->Update(0.25);
 }
+
+TEST_CASE("Animation update of many AnimatedModels", "[.][benchmark]")
+{
+    const int numCharacters = 1000;
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    auto model = Tests::GetOrCreateResource<Model>(context, "@Tests/AnimationController/SkinnedModel.mdl", CreateTestSkinnedModel);
+    auto animationTranslateX = Tests::GetOrCreateResource<Animation>(context, "@Tests/AnimationController/TranslateX.ani", CreateTestTranslateXAnimation);
+    auto animationRotate = Tests::GetOrCreateResource<Animation>(context, "@Tests/AnimationController/Rotation.ani", CreateTestRotationAnimation);
+
+    auto scene = MakeShared<Scene>(context);
+    scene->CreateComponent<Octree>();
+
+    for (int i = 0; i < numCharacters; ++i)
+    {
+        Node* node = scene->CreateChild("Character");
+        node->SetPosition({static_cast<float>(i % 32), 0.0f, static_cast<float>(i / 32)});
+
+        auto animatedModel = node->CreateComponent<AnimatedModel>();
+        animatedModel->SetModel(model);
+
+        // Use partial weights so animations are actually blended
+        auto controller = node->CreateComponent<AnimationController>();
+        controller->Play(animationTranslateX->GetName(), 0, true);
+        controller->Play(animationRotate->GetName(), 1, true);
+        controller->SetWeight(animationRotate->GetName(), 0.5f);
+    }
+
+    Tests::RunFrame(context, 0.1f, 0.1f);
+
+    BENCHMARK("Update 1000 animated characters")
+    {
+        Tests::RunFrame(context, 1.0f / 60, 1.0f / 60);
+        return scene->GetNumChildren();
+    };
+}
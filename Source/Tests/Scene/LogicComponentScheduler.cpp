@@ -0,0 +1,323 @@
+//
+// Copyright (c) 2022-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR rhs
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR rhsWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR rhs DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/Scene/LogicComponent.h>
+#include <Urho3D/Scene/LogicComponentScheduler.h>
+#include <Urho3D/Scene/Scene.h>
+#include <Urho3D/Scene/SceneEvents.h>
+#ifdef URHO3D_PHYSICS
+#include <Urho3D/Physics/PhysicsWorld.h>
+#endif
+
+#include <atomic>
+
+namespace
+{
+
+ea::vector<ea::string> updateLog;
+
+class TestLogicComponentA : public LogicComponent
+{
+    URHO3D_OBJECT(TestLogicComponentA, LogicComponent);
+
+public:
+    using LogicComponent::LogicComponent;
+
+    void DelayedStart() override { updateLog.push_back("DelayedStart " + GetNode()->GetName()); }
+    void Update(float timeStep) override
+    {
+        updateLog.push_back("Update " + GetNode()->GetName());
+        if (componentToRemove_)
+            componentToRemove_->Remove();
+    }
+    void PostUpdate(float timeStep) override { updateLog.push_back("PostUpdate " + GetNode()->GetName()); }
+    void FixedUpdate(float timeStep) override { ++numFixedUpdates_; }
+
+    WeakPtr<Component> componentToRemove_;
+    unsigned numFixedUpdates_{};
+};
+
+class TestLogicComponentB : public TestLogicComponentA
+{
+    URHO3D_OBJECT(TestLogicComponentB, TestLogicComponentA);
+
+public:
+    using TestLogicComponentA::TestLogicComponentA;
+};
+
+class ThreadSafeLogicComponent : public LogicComponent
+{
+    URHO3D_OBJECT(ThreadSafeLogicComponent, LogicComponent);
+
+public:
+    explicit ThreadSafeLogicComponent(Context* context) : LogicComponent(context) { SetUpdateEventMask(USE_UPDATE); }
+
+    bool IsUpdateThreadSafe() const override { return true; }
+    void Update(float timeStep) override { value_ += timeStep; }
+
+    float value_{};
+};
+
+class EventDrivenComponent : public Component
+{
+    URHO3D_OBJECT(EventDrivenComponent, Component);
+
+public:
+    using Component::Component;
+
+    virtual void Update(float timeStep) { value_ += timeStep; }
+
+    float value_{};
+
+protected:
+    void OnSceneSet(Scene* scene) override
+    {
+        if (scene)
+            SubscribeToEvent(scene, E_SCENEUPDATE, URHO3D_HANDLER(EventDrivenComponent, HandleSceneUpdate));
+        else
+            UnsubscribeFromEvent(E_SCENEUPDATE);
+    }
+
+private:
+    void HandleSceneUpdate(StringHash eventType, VariantMap& eventData)
+    {
+        Update(eventData[SceneUpdate::P_TIMESTEP].GetFloat());
+    }
+};
+
+class BatchedComponent : public LogicComponent
+{
+    URHO3D_OBJECT(BatchedComponent, LogicComponent);
+
+public:
+    explicit BatchedComponent(Context* context) : LogicComponent(context) { SetUpdateEventMask(USE_UPDATE); }
+
+    void Update(float timeStep) override { value_ += timeStep; }
+
+    float value_{};
+};
+
+template <class T>
+void RegisterTestComponent(Context* context)
+{
+    if (!context->IsReflected<T>())
+        context->AddFactoryReflection<T>();
+}
+
+template <class T>
+SharedPtr<Scene> CreateSceneWithComponents(Context* context, unsigned numComponents)
+{
+    RegisterTestComponent<T>(context);
+
+    auto scene = MakeShared<Scene>(context);
+    for (unsigned i = 0; i < numComponents; ++i)
+        scene->CreateChild()->CreateComponent<T>();
+    return scene;
+}
+
+}
+
+TEST_CASE("LogicComponent updates are batched by type")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    RegisterTestComponent<TestLogicComponentA>(context);
+    RegisterTestComponent<TestLogicComponentB>(context);
+
+    auto scene = MakeShared<Scene>(context);
+    scene->CreateChild("A1")->CreateComponent<TestLogicComponentA>();
+    scene->CreateChild("B1")->CreateComponent<TestLogicComponentB>();
+    scene->CreateChild("A2")->CreateComponent<TestLogicComponentA>();
+    scene->CreateChild("B2")->CreateComponent<TestLogicComponentB>();
+
+    LogicComponentScheduler* scheduler = scene->GetLogicComponentScheduler();
+    REQUIRE(scheduler->GetNumTypes() == 2);
+    REQUIRE(scheduler->GetNumComponents(LogicComponentPhase::Update) == 4);
+
+    updateLog.clear();
+    scene->Update(0.1f);
+    REQUIRE(updateLog == ea::vector<ea::string>{
+        "DelayedStart A1", "DelayedStart A2", "DelayedStart B1", "DelayedStart B2",
+        "Update A1", "Update A2", "Update B1", "Update B2",
+        "PostUpdate A1", "PostUpdate A2", "PostUpdate B1", "PostUpdate B2"});
+    REQUIRE(scheduler->GetNumComponents(LogicComponentPhase::DelayedStart) == 0);
+
+    updateLog.clear();
+    scene->GetChild("A2")->GetComponent<TestLogicComponentA>()->SetEnabled(false);
+    scene->Update(0.1f);
+    REQUIRE(updateLog == ea::vector<ea::string>{
+        "Update A1", "Update B1", "Update B2",
+        "PostUpdate A1", "PostUpdate B1", "PostUpdate B2"});
+}
+
+TEST_CASE("LogicComponent may be removed and added during scheduled update")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    RegisterTestComponent<TestLogicComponentA>(context);
+
+    auto scene = MakeShared<Scene>(context);
+    auto componentA1 = scene->CreateChild("A1")->CreateComponent<TestLogicComponentA>();
+    auto componentA2 = scene->CreateChild("A2")->CreateComponent<TestLogicComponentA>();
+    scene->Update(0.1f);
+
+    // Remove the next component during update
+    componentA1->componentToRemove_ = componentA2;
+    updateLog.clear();
+    scene->Update(0.1f);
+    REQUIRE(updateLog == ea::vector<ea::string>{"Update A1", "PostUpdate A1"});
+    REQUIRE(scene->GetLogicComponentScheduler()->GetNumComponents(LogicComponentPhase::Update) == 1);
+
+    // Re-add component
+    scene->GetChild("A2")->CreateComponent<TestLogicComponentA>();
+    updateLog.clear();
+    scene->Update(0.1f);
+    REQUIRE(updateLog == ea::vector<ea::string>{"DelayedStart A2", "Update A1", "Update A2", "PostUpdate A1", "PostUpdate A2"});
+
+    // Move component to another scene
+    auto otherScene = MakeShared<Scene>(context);
+    scene->GetChild("A2")->SetParent(otherScene);
+    updateLog.clear();
+    scene->Update(0.1f);
+    REQUIRE(updateLog == ea::vector<ea::string>{"Update A1", "PostUpdate A1"});
+
+    updateLog.clear();
+    otherScene->Update(0.1f);
+    REQUIRE(updateLog == ea::vector<ea::string>{"Update A2", "PostUpdate A2"});
+}
+
+TEST_CASE("LogicComponents are updated in order of scene update subscription")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    RegisterTestComponent<TestLogicComponentA>(context);
+
+    auto scene = MakeShared<Scene>(context);
+    auto receiver = MakeShared<Node>(context);
+    scene->OnSceneUpdate.Subscribe(receiver.Get(), [&](const SceneUpdateEvent&) { updateLog.push_back("Before"); });
+    scene->CreateChild("A1")->CreateComponent<TestLogicComponentA>();
+    scene->OnSceneUpdate.Subscribe(receiver.Get(), [&](const SceneUpdateEvent&) { updateLog.push_back("After"); });
+
+    updateLog.clear();
+    scene->Update(0.1f);
+    REQUIRE(updateLog == ea::vector<ea::string>{"Before", "DelayedStart A1", "Update A1", "After", "PostUpdate A1"});
+}
+
+TEST_CASE("Thread-safe LogicComponent types are updated in parallel")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    const unsigned numComponents = LogicComponentScheduler::ComponentsPerTask * 4 + 1;
+    auto scene = CreateSceneWithComponents<ThreadSafeLogicComponent>(context, numComponents);
+    scene->Update(0.5f);
+    scene->Update(0.5f);
+
+    for (Node* child : scene->GetChildren())
+        REQUIRE(child->GetComponent<ThreadSafeLogicComponent>()->value_ == 1.0f);
+}
+
+TEST_CASE("LogicComponent with blocked events is not updated")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    RegisterTestComponent<TestLogicComponentA>(context);
+
+    auto scene = MakeShared<Scene>(context);
+    auto component = scene->CreateChild("A1")->CreateComponent<TestLogicComponentA>();
+    scene->CreateChild("A2")->CreateComponent<TestLogicComponentA>();
+
+    updateLog.clear();
+    component->SetBlockEvents(true);
+    scene->Update(0.1f);
+    REQUIRE(updateLog == ea::vector<ea::string>{"DelayedStart A2", "Update A2", "PostUpdate A2"});
+
+    updateLog.clear();
+    component->SetBlockEvents(false);
+    scene->Update(0.1f);
+    REQUIRE(updateLog == ea::vector<ea::string>{"DelayedStart A1", "Update A1", "Update A2", "PostUpdate A1", "PostUpdate A2"});
+}
+
+TEST_CASE("LogicComponent is not updated after unsubscribing from all events")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    RegisterTestComponent<TestLogicComponentA>(context);
+
+    auto scene = MakeShared<Scene>(context);
+    auto component = scene->CreateChild("A1")->CreateComponent<TestLogicComponentA>();
+    scene->CreateChild("A2")->CreateComponent<TestLogicComponentA>();
+    scene->Update(0.1f);
+
+    updateLog.clear();
+    component->UnsubscribeFromAllEvents();
+    REQUIRE(scene->GetLogicComponentScheduler()->GetNumComponents(LogicComponentPhase::Update) == 1);
+    scene->Update(0.1f);
+    REQUIRE(updateLog == ea::vector<ea::string>{"Update A2", "PostUpdate A2"});
+
+    // Changing update event mask subscribes the component again
+    updateLog.clear();
+    component->SetUpdateEventMask(USE_UPDATE);
+    scene->Update(0.1f);
+    REQUIRE(updateLog == ea::vector<ea::string>{"Update A2", "Update A1", "PostUpdate A2"});
+}
+
+#ifdef URHO3D_PHYSICS
+TEST_CASE("LogicComponent fixed updates are scheduled")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    RegisterTestComponent<TestLogicComponentA>(context);
+
+    auto scene = MakeShared<Scene>(context);
+    auto physicsWorld = scene->CreateComponent<PhysicsWorld>();
+    physicsWorld->SetFps(10);
+    physicsWorld->SetMaxSubSteps(10);
+    auto component = scene->CreateChild("A1")->CreateComponent<TestLogicComponentA>();
+
+    // Delayed start is executed on scene update, not on fixed update
+    updateLog.clear();
+    scene->Update(0.55f);
+    REQUIRE(component->numFixedUpdates_ == 5);
+    REQUIRE(updateLog.front() == "DelayedStart A1");
+}
+#endif
+
+TEST_CASE("LogicComponent scheduler is compared to event-driven updates", "[.][benchmark]")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    const unsigned numComponents = 100000;
+    auto eventDrivenScene = CreateSceneWithComponents<EventDrivenComponent>(context, numComponents);
+    auto batchedScene = CreateSceneWithComponents<BatchedComponent>(context, numComponents);
+    auto threadSafeScene = CreateSceneWithComponents<ThreadSafeLogicComponent>(context, numComponents);
+
+    BENCHMARK("Event-driven updates")
+    {
+        eventDrivenScene->Update(0.01f);
+    };
+
+    BENCHMARK("Batched updates")
+    {
+        batchedScene->Update(0.01f);
+    };
+
+    BENCHMARK("Batched parallel updates")
+    {
+        threadSafeScene->Update(0.01f);
+    };
+}
@@ -201,7 +201,6 @@ CSHARP_ARRAYS_FIXED(Urho3D::Vector4, global::Urho3DNet.Vector4)
 
 // Containers
 using StringMap = eastl::unordered_map<Urho3D::StringHash, eastl::string>;
-%template(ObjectReflectionMap) eastl::unordered_map<Urho3D::StringHash, Urho3D::SharedPtr<Urho3D::ObjectReflection>>;
 %template(CollisionGeometryDataCache) eastl::unordered_map<eastl::pair<Urho3D::Model*, unsigned>, Urho3D::SharedPtr<Urho3D::CollisionGeometryData>>;
 
 // Declare inheritable classes in this file
@@ -331,6 +330,7 @@ namespace SDL
 %ignore Urho3D::Detail::CriticalSection;
 %ignore Urho3D::MutexLock;
 %ignore Urho3D::ObjectReflectionRegistry::GetReflection(StringHash typeNameHash) const;
+%ignore Urho3D::ObjectReflectionRegistry::GetObjectReflections;
 
 %include "Object.i"
 %director Urho3D::AttributeAccessor;
@@ -474,6 +474,7 @@ public:
 %ignore Urho3D::BackgroundLoader::ThreadFunction;
 %ignore Urho3D::ImageCube::CalculateSphericalHarmonics;
 %rename(GetValueType) Urho3D::PListValue::GetType;
+%ignore Urho3D::ResourceCache::GetAllResources;
 
 %include "generated/Urho3D/_pre_resource.i"
 %include "Urho3D/Resource/Resource.h"
@@ -605,6 +606,8 @@ public:
 %ignore Urho3D::CustomGeometry::MakeCircleGraph;
 %ignore Urho3D::CustomGeometry::ProcessRayQuery;
 %ignore Urho3D::OcclusionBufferData::dataWithSafety_;
+%ignore Urho3D::OcclusionTriangle;
+%ignore Urho3D::OcclusionBuffer::IsVisible(ea::span<const BoundingBox>, ea::span<bool>) const;
 %ignore Urho3D::ScenePassInfo::batchQueue_;
 %ignore Urho3D::LightQueryResult;
 %ignore Urho3D::View::GetLightQueues;
@@ -641,6 +644,10 @@ public:
 %ignore Urho3D::AnimationState::CalculateModelTracks;
 %ignore Urho3D::AnimationState::CalculateNodeTracks;
 %ignore Urho3D::AnimationState::CalculateAttributeTracks;
+// StringHashMap is not wrapped, use GetNumTracks() and GetTrack() instead.
+%ignore Urho3D::Animation::GetTracks;
+%ignore Urho3D::Animation::GetVariantTracks;
+%ignore Urho3D::Animation::GetCompressedTracks;
 %rename(DrawableFlags) Urho3D::DrawableFlag;
 
 %apply void* VOID_INT_PTR {
@@ -657,6 +664,9 @@ public:
 %include "Urho3D/Graphics/OcclusionBuffer.h"
 %include "Urho3D/Graphics/Drawable.h"
 %include "Urho3D/Graphics/OctreeQuery.h"
+%ignore Urho3D::SpatialIndex;
+%ignore Urho3D::Octree::GetSpatialIndex;
+%include "Urho3D/Graphics/SpatialIndex.h"
 %interface_custom("%s", "I%s", Urho3D::Octant);
 %include "Urho3D/Graphics/Octree.h"
 %include "Urho3D/Graphics/RenderPath.h"
@@ -997,11 +1007,9 @@ using ImGuiConfigFlags = unsigned;
 %template(AttributeMap)                 eastl::unordered_map<Urho3D::StringHash, eastl::vector<Urho3D::AttributeInfo>>;
 %template(PackageMap)                   eastl::unordered_map<eastl::string, Urho3D::PackageEntry>;
 %template(JSONObject)                   eastl::map<eastl::string, Urho3D::JSONValue>;
-%template(ResourceGroupMap)             eastl::unordered_map<Urho3D::StringHash, Urho3D::ResourceGroup>;
 %template(ResourceMap)                  eastl::unordered_map<Urho3D::StringHash, Urho3D::SharedPtr<Urho3D::Resource>>;
 %template(PListValueMap)                eastl::unordered_map<eastl::string, Urho3D::PListValue>;
 %template(ValueAnimationInfoMap)        eastl::unordered_map<eastl::string, Urho3D::SharedPtr<Urho3D::ValueAnimationInfo>>;
-%template(AnimationTrackMap)            eastl::unordered_map<Urho3D::StringHash, Urho3D::AnimationTrack>;
 %template(MaterialShaderParameterMap)   eastl::unordered_map<Urho3D::StringHash, Urho3D::MaterialShaderParameter>;
 %template(TextureMap)                   eastl::unordered_map<Urho3D::TextureUnit, Urho3D::SharedPtr<Urho3D::Texture>>;
 %template(AttributeAnimationInfos)      eastl::unordered_map<eastl::string, Urho3D::SharedPtr<Urho3D::AttributeAnimationInfo>>;
@@ -802,9 +802,7 @@ using BoneCollisionShapeFlags = Urho3D::BoneCollisionShape;
 %csattribute(Urho3D::Animation, %arg(ea::string), AnimationName, GetAnimationName, SetAnimationName);
 %csattribute(Urho3D::Animation, %arg(Urho3D::StringHash), AnimationNameHash, GetAnimationNameHash);
 %csattribute(Urho3D::Animation, %arg(float), Length, GetLength, SetLength);
-%csattribute(Urho3D::Animation, %arg(ea::unordered_map<StringHash, AnimationTrack>), Tracks, GetTracks);
 %csattribute(Urho3D::Animation, %arg(unsigned int), NumTracks, GetNumTracks);
-%csattribute(Urho3D::Animation, %arg(ea::unordered_map<StringHash, VariantAnimationTrack>), VariantTracks, GetVariantTracks);
 %csattribute(Urho3D::Animation, %arg(unsigned int), NumVariantTracks, GetNumVariantTracks);
 %csattribute(Urho3D::Animation, %arg(ea::vector<AnimationTriggerPoint>), Triggers, GetTriggers);
 %csattribute(Urho3D::Animation, %arg(unsigned int), NumTriggers, GetNumTriggers, SetNumTriggers);
@@ -890,6 +888,7 @@ using BoneCollisionShapeFlags = Urho3D::BoneCollisionShape;
 %csattribute(Urho3D::Octree, %arg(Urho3D::Zone *), BackgroundZone, GetBackgroundZone);
 %csattribute(Urho3D::Octree, %arg(Urho3D::Octant *), RootOctant, GetRootOctant);
 %csattribute(Urho3D::Octree, %arg(unsigned int), NumLevels, GetNumLevels);
+%csattribute(Urho3D::Octree, %arg(Urho3D::SpatialIndexType), SpatialIndexType, GetSpatialIndexType, SetSpatialIndexType);
 %csattribute(Urho3D::Octree, %arg(ea::vector<Drawable *>), AllDrawables, GetAllDrawables);
 %csattribute(Urho3D::ParticleEffect, %arg(Urho3D::Material *), Material, GetMaterial, SetMaterial);
 %csattribute(Urho3D::ParticleEffect, %arg(unsigned int), NumParticles, GetNumParticles, SetNumParticles);
@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include "../Container/PoolAllocator.h"
 #include "../Core/NonCopyable.h"
 
 #include <Urho3D/Urho3D.h>
@@ -58,6 +59,8 @@ struct AllocatorNode
     /// Data follows.
 };
 
+/// Legacy single-threaded free list functions. Prefer ConcurrentPool and Allocator<T> in new code.
+/// @{
 /// Initialize a fixed-size allocator with the node size and initial capacity.
 URHO3D_API AllocatorBlock* AllocatorInitialize(unsigned nodeSize, unsigned initialCapacity = 1);
 /// Uninitialize a fixed-size allocator. Frees all blocks in the chain.
@@ -66,58 +69,51 @@ URHO3D_API void AllocatorUninitialize(AllocatorBlock* allocator);
 URHO3D_API void* AllocatorReserve(AllocatorBlock* allocator);
 /// Free a node. Does not free any blocks.
 URHO3D_API void AllocatorFree(AllocatorBlock* allocator, void* ptr);
+/// @}
 
-/// %Allocator template class. Allocates objects of a specific class.
+/// %Allocator template class. Allocates objects of a specific class. Objects may be reserved and freed from any thread.
 template <class T> class Allocator : private NonCopyable
 {
+    static_assert(alignof(T) <= ConcurrentPool::NodeHeaderSize, "Allocator doesn't support overaligned types");
+
 public:
-    /// Construct.
+    /// Construct. Initial capacity is used as the number of objects allocated at once.
     explicit Allocator(unsigned initialCapacity = 0) :
-        allocator_(nullptr)
-    {
-        if (initialCapacity)
-            allocator_ = AllocatorInitialize((unsigned)sizeof(T), initialCapacity);
-    }
-
-    /// Destruct.
-    ~Allocator()
+        pool_(static_cast<unsigned>(sizeof(T)), initialCapacity ? initialCapacity : DefaultCapacity)
     {
-        AllocatorUninitialize(allocator_);
     }
 
     /// Reserve and default-construct an object.
     template<typename... Args>
     T* Reserve(Args&&... args)
     {
-        if (!allocator_)
-            allocator_ = AllocatorInitialize((unsigned)sizeof(T));
-        auto* newObject = static_cast<T*>(AllocatorReserve(allocator_));
-        new(newObject) T(ea::forward<Args>(args)...);
-
-        return newObject;
+        void* memory = pool_.Allocate();
+        return new(memory) T(ea::forward<Args>(args)...);
     }
 
     /// Reserve and copy-construct an object.
     T* Reserve(const T& object)
     {
-        if (!allocator_)
-            allocator_ = AllocatorInitialize((unsigned)sizeof(T));
-        auto* newObject = static_cast<T*>(AllocatorReserve(allocator_));
-        new(newObject) T(object);
-
-        return newObject;
+        void* memory = pool_.Allocate();
+        return new(memory) T(object);
     }
 
     /// Destruct and free an object.
     void Free(T* object)
     {
         (object)->~T();
-        AllocatorFree(allocator_, object);
+        pool_.Free(object);
     }
 
+    /// Return statistics.
+    PoolAllocatorStats GetStats() const { return pool_.GetStats(); }
+
 private:
-    /// Allocator block.
-    AllocatorBlock* allocator_;
+    /// Default number of objects allocated at once.
+    static const unsigned DefaultCapacity = 64;
+
+    /// Underlying pool.
+    ConcurrentPool pool_;
 };
 
 }
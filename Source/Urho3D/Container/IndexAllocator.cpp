@@ -0,0 +1,269 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Container/IndexAllocator.h"
+
+#include "../Container/ThreadSlot.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+namespace Detail
+{
+
+/// Cache of free indices owned by one thread. Other threads may only steal indices on Shrink.
+struct alignas(64) IndexCache
+{
+    /// Free indices, 0 if slot is empty.
+    std::atomic<unsigned> indices_[ConcurrentIndexAllocator::CacheSize]{};
+};
+
+}
+
+namespace
+{
+
+/// Pack index and tag of shared stack head.
+unsigned long long PackHead(unsigned index, unsigned tag)
+{
+    return (static_cast<unsigned long long>(tag) << 32) | index;
+}
+
+/// Return index from shared stack head.
+unsigned GetHeadIndex(unsigned long long head)
+{
+    return static_cast<unsigned>(head);
+}
+
+/// Return tag from shared stack head.
+unsigned GetHeadTag(unsigned long long head)
+{
+    return static_cast<unsigned>(head >> 32);
+}
+
+}
+
+ConcurrentIndexAllocator::ConcurrentIndexAllocator()
+{
+    ThreadSlot::AddReleaseCallback(this, [](void* allocator, unsigned slot)
+    {
+        static_cast<ConcurrentIndexAllocator*>(allocator)->FlushThreadCache(slot);
+    });
+}
+
+ConcurrentIndexAllocator::~ConcurrentIndexAllocator()
+{
+    ThreadSlot::RemoveReleaseCallback(this);
+
+    for (auto& cache : caches_)
+        delete cache.load(std::memory_order_relaxed);
+    for (auto& chunk : chunks_)
+        delete[] chunk.load(std::memory_order_relaxed);
+}
+
+unsigned ConcurrentIndexAllocator::Allocate()
+{
+    if (Detail::IndexCache* cache = GetThreadCache())
+    {
+        for (std::atomic<unsigned>& slot : cache->indices_)
+        {
+            if (slot.load(std::memory_order_relaxed) == 0)
+                continue;
+
+            // Exchange because Shrink may steal the index concurrently
+            if (const unsigned index = slot.exchange(0, std::memory_order_acquire))
+            {
+                numFreeIndices_.fetch_sub(1, std::memory_order_relaxed);
+                return index;
+            }
+        }
+    }
+
+    if (const unsigned index = PopShared())
+    {
+        numFreeIndices_.fetch_sub(1, std::memory_order_relaxed);
+        return index;
+    }
+
+    return nextIndex_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ConcurrentIndexAllocator::Release(unsigned index)
+{
+    URHO3D_ASSERT(index != 0 && index < GetNextFreeIndex());
+
+    if (TryReleaseLast(index))
+        return;
+
+    numFreeIndices_.fetch_add(1, std::memory_order_relaxed);
+
+    if (Detail::IndexCache* cache = GetThreadCache())
+    {
+        for (std::atomic<unsigned>& slot : cache->indices_)
+        {
+            unsigned expected = 0;
+            if (slot.load(std::memory_order_relaxed) == 0
+                && slot.compare_exchange_strong(expected, index, std::memory_order_release, std::memory_order_relaxed))
+                return;
+        }
+    }
+
+    PushShared(index);
+}
+
+void ConcurrentIndexAllocator::Shrink()
+{
+    // Take all free indices so nobody can allocate them while high-water mark is lowered
+    ea::vector<unsigned> freeIndices;
+    while (const unsigned index = PopShared())
+        freeIndices.push_back(index);
+
+    for (auto& cachePtr : caches_)
+    {
+        Detail::IndexCache* cache = cachePtr.load(std::memory_order_acquire);
+        if (!cache)
+            continue;
+
+        for (std::atomic<unsigned>& slot : cache->indices_)
+        {
+            if (const unsigned index = slot.exchange(0, std::memory_order_acquire))
+                freeIndices.push_back(index);
+        }
+    }
+
+    ea::sort(freeIndices.begin(), freeIndices.end());
+    while (!freeIndices.empty())
+    {
+        unsigned expected = freeIndices.back() + 1;
+        if (!nextIndex_.compare_exchange_strong(expected, expected - 1, std::memory_order_relaxed))
+            break;
+
+        freeIndices.pop_back();
+        numFreeIndices_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    for (unsigned index : freeIndices)
+        PushShared(index);
+}
+
+void ConcurrentIndexAllocator::Clear()
+{
+    nextIndex_.store(1, std::memory_order_relaxed);
+    numFreeIndices_.store(0, std::memory_order_relaxed);
+    sharedHead_.store(0, std::memory_order_relaxed);
+
+    for (auto& cachePtr : caches_)
+    {
+        if (Detail::IndexCache* cache = cachePtr.load(std::memory_order_relaxed))
+        {
+            for (std::atomic<unsigned>& slot : cache->indices_)
+                slot.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+Detail::IndexCache* ConcurrentIndexAllocator::GetThreadCache()
+{
+    const unsigned slot = ThreadSlot::GetCurrent();
+    if (slot >= MaxThreadCaches)
+        return nullptr;
+
+    // Only the owner thread creates the cache, so there is no race
+    Detail::IndexCache* cache = caches_[slot].load(std::memory_order_relaxed);
+    if (!cache)
+    {
+        cache = new Detail::IndexCache();
+        caches_[slot].store(cache, std::memory_order_release);
+    }
+    return cache;
+}
+
+void ConcurrentIndexAllocator::FlushThreadCache(unsigned slot)
+{
+    if (slot >= MaxThreadCaches)
+        return;
+
+    Detail::IndexCache* cache = caches_[slot].load(std::memory_order_relaxed);
+    if (!cache)
+        return;
+
+    // Exchange because Shrink may steal the index concurrently
+    for (std::atomic<unsigned>& cacheSlot : cache->indices_)
+    {
+        if (const unsigned index = cacheSlot.exchange(0, std::memory_order_acquire))
+            PushShared(index);
+    }
+}
+
+std::atomic<unsigned>& ConcurrentIndexAllocator::GetLink(unsigned index)
+{
+    const unsigned chunkIndex = index / ChunkSize;
+    URHO3D_ASSERT(chunkIndex < MaxChunks, "Too many indices allocated");
+
+    std::atomic<unsigned>* chunk = chunks_[chunkIndex].load(std::memory_order_acquire);
+    if (!chunk)
+    {
+        auto newChunk = new std::atomic<unsigned>[ChunkSize]{};
+        if (chunks_[chunkIndex].compare_exchange_strong(chunk, newChunk, std::memory_order_acq_rel))
+            chunk = newChunk;
+        else
+            delete[] newChunk;
+    }
+    return chunk[index % ChunkSize];
+}
+
+void ConcurrentIndexAllocator::PushShared(unsigned index)
+{
+    std::atomic<unsigned>& link = GetLink(index);
+    unsigned long long head = sharedHead_.load(std::memory_order_relaxed);
+    do
+    {
+        link.store(GetHeadIndex(head), std::memory_order_relaxed);
+    } while (!sharedHead_.compare_exchange_weak(
+        head, PackHead(index, GetHeadTag(head) + 1), std::memory_order_release, std::memory_order_relaxed));
+}
+
+unsigned ConcurrentIndexAllocator::PopShared()
+{
+    unsigned long long head = sharedHead_.load(std::memory_order_acquire);
+    while (const unsigned index = GetHeadIndex(head))
+    {
+        // Link may be stale if the index was popped concurrently, tag ensures that CAS fails in this case
+        const unsigned next = GetLink(index).load(std::memory_order_relaxed);
+        if (sharedHead_.compare_exchange_weak(
+            head, PackHead(next, GetHeadTag(head) + 1), std::memory_order_acquire, std::memory_order_acquire))
+            return index;
+    }
+    return 0;
+}
+
+bool ConcurrentIndexAllocator::TryReleaseLast(unsigned index)
+{
+    unsigned expected = index + 1;
+    return nextIndex_.compare_exchange_strong(expected, index, std::memory_order_relaxed);
+}
+
+}
@@ -22,7 +22,11 @@
 
 #pragma once
 
+#include "../Core/Assert.h"
 #include "../Core/Mutex.h"
+#include "../Core/NonCopyable.h"
+
+#include <Urho3D/Urho3D.h>
 
 #include <EASTL/sort.h>
 #include <EASTL/vector.h>
@@ -111,6 +115,75 @@ private:
     ea::vector<unsigned> unusedIndices_;
 };
 
+namespace Detail
+{
+
+struct IndexCache;
+
+}
+
+/// Lock-free utility to assign unique non-zero IDs to objects from any thread.
+/// Each thread reuses released indices from its own small cache. Overflowing indices are moved to
+/// shared lock-free stack, and new indices are taken by incrementing atomic high-water mark.
+class URHO3D_API ConcurrentIndexAllocator : private NonCopyable
+{
+public:
+    /// Maximum number of live threads that have their own caches. Other threads use shared stack directly.
+    /// Caches of exited threads are flushed to shared stack and reused by new threads.
+    static const unsigned MaxThreadCaches = 64;
+    /// Number of indices that can be cached by one thread.
+    static const unsigned CacheSize = 16;
+    /// Number of indices per chunk of free list links.
+    static const unsigned ChunkSize = 16 * 1024;
+    /// Maximum number of chunks of free list links.
+    static const unsigned MaxChunks = 1024;
+
+    /// Construct.
+    ConcurrentIndexAllocator();
+    /// Destruct.
+    ~ConcurrentIndexAllocator();
+
+    /// Return upper bound of allocated indices.
+    unsigned GetNextFreeIndex() const { return nextIndex_.load(std::memory_order_relaxed); }
+    /// Return number of currently allocated indices. Approximate if other threads are allocating indices.
+    unsigned GetSize() const { return GetNextFreeIndex() - 1 - numFreeIndices_.load(std::memory_order_relaxed); }
+
+    /// Allocate index.
+    unsigned Allocate();
+    /// Release index. Index should be previously returned from Allocate and not released yet.
+    void Release(unsigned index);
+    /// Shrink collection to minimum possible size preserving currently allocated indices.
+    /// Safe to call concurrently with other operations, but may keep some indices if they are being allocated.
+    void Shrink();
+    /// Reset to default state. Not thread-safe.
+    void Clear();
+
+private:
+    /// Return cache of the current thread, or null if the thread doesn't have own cache.
+    Detail::IndexCache* GetThreadCache();
+    /// Move cached indices of the exiting thread to shared stack. Called from the exiting thread.
+    void FlushThreadCache(unsigned slot);
+    /// Return link of free index in shared stack. Allocates storage if needed.
+    std::atomic<unsigned>& GetLink(unsigned index);
+    /// Push index to shared stack.
+    void PushShared(unsigned index);
+    /// Pop index from shared stack. Return 0 if empty.
+    unsigned PopShared();
+    /// Try to decrement high-water mark if index is the last one.
+    bool TryReleaseLast(unsigned index);
+
+    /// Next unused index.
+    std::atomic<unsigned> nextIndex_{1};
+    /// Number of indices in caches and shared stack.
+    std::atomic<unsigned> numFreeIndices_{};
+    /// Head of shared stack. Low 32 bits contain index, high 32 bits contain tag to prevent ABA problem.
+    std::atomic<unsigned long long> sharedHead_{};
+    /// Chunks of free list links. Chunks are never deallocated until destruction.
+    std::atomic<std::atomic<unsigned>*> chunks_[MaxChunks]{};
+    /// Thread caches.
+    std::atomic<Detail::IndexCache*> caches_[MaxThreadCaches]{};
+};
+
 /// Family of unique indices for template type.
 template <class T>
 class IDFamily
@@ -147,11 +220,11 @@ public:
 
 private:
     /// Shared allocator for this family.
-    static IndexAllocator<Mutex> indexAllocator;
+    static ConcurrentIndexAllocator indexAllocator;
     /// Unique object ID.
     unsigned objectId_{};
 };
 
-template <class T> IndexAllocator<Mutex> IDFamily<T>::indexAllocator;
+template <class T> ConcurrentIndexAllocator IDFamily<T>::indexAllocator;
 
 }
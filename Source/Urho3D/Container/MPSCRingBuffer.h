@@ -0,0 +1,141 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Core/Assert.h"
+#include "../Core/NonCopyable.h"
+#include "../Math/MathDefs.h"
+
+#include <EASTL/unique_ptr.h>
+
+#include <atomic>
+#include <new>
+
+namespace Urho3D
+{
+
+/// Bounded lock-free ring buffer with multiple producers and single consumer.
+/// Each cell has a sequence number that tells whether it is ready to be written or read,
+/// so producers only contend on one atomic counter and never wait for each other.
+template <class T>
+class MPSCRingBuffer : private NonCopyable
+{
+public:
+    /// Construct. Capacity is rounded up to power of two.
+    explicit MPSCRingBuffer(unsigned capacity)
+        : capacity_(NextPowerOfTwo(ea::max(capacity, 2u)))
+        , mask_(capacity_ - 1)
+        , cells_(new Cell[capacity_])
+    {
+        for (unsigned i = 0; i < capacity_; ++i)
+            cells_[i].sequence_.store(i, std::memory_order_relaxed);
+    }
+
+    /// Destruct. Destroy remaining elements.
+    ~MPSCRingBuffer()
+    {
+        T value;
+        while (TryPop(value))
+            ;
+    }
+
+    /// Try to push element. May be called from any thread. Value is not touched if buffer is full.
+    bool TryPush(T&& value)
+    {
+        Cell* cell = nullptr;
+        unsigned position = enqueuePosition_.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            cell = &cells_[position & mask_];
+            const unsigned sequence = cell->sequence_.load(std::memory_order_acquire);
+            const int delta = static_cast<int>(sequence - position);
+            if (delta == 0)
+            {
+                if (enqueuePosition_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (delta < 0)
+                return false;
+            else
+                position = enqueuePosition_.load(std::memory_order_relaxed);
+        }
+
+        new (cell->storage_) T(ea::move(value));
+        cell->sequence_.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Try to pop element. Should be called only from consumer thread.
+    bool TryPop(T& value)
+    {
+        const unsigned position = dequeuePosition_.load(std::memory_order_relaxed);
+        Cell& cell = cells_[position & mask_];
+        const unsigned sequence = cell.sequence_.load(std::memory_order_acquire);
+        if (sequence != position + 1)
+            return false;
+
+        T* element = reinterpret_cast<T*>(cell.storage_);
+        value = ea::move(*element);
+        element->~T();
+
+        cell.sequence_.store(position + capacity_, std::memory_order_release);
+        dequeuePosition_.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Return approximate number of elements in the buffer. May be called from any thread.
+    unsigned GetSize() const
+    {
+        const unsigned dequeuePosition = dequeuePosition_.load(std::memory_order_acquire);
+        const unsigned enqueuePosition = enqueuePosition_.load(std::memory_order_acquire);
+        const int size = static_cast<int>(enqueuePosition - dequeuePosition);
+        return static_cast<unsigned>(Clamp(size, 0, static_cast<int>(capacity_)));
+    }
+    /// Return whether the buffer is empty. Exact only when called from consumer thread.
+    bool IsEmpty() const { return GetSize() == 0; }
+    /// Return capacity.
+    unsigned GetCapacity() const { return capacity_; }
+
+private:
+    /// Cell of the buffer.
+    struct Cell
+    {
+        /// Sequence number of the cell.
+        std::atomic<unsigned> sequence_;
+        /// Storage for the element.
+        alignas(T) unsigned char storage_[sizeof(T)];
+    };
+
+    /// Capacity.
+    const unsigned capacity_{};
+    /// Mask to wrap positions.
+    const unsigned mask_{};
+    /// Cells.
+    ea::unique_ptr<Cell[]> cells_;
+    /// Position of the next pushed element. Kept on separate cache line from consumer data.
+    alignas(64) std::atomic<unsigned> enqueuePosition_{};
+    /// Position of the next popped element.
+    alignas(64) std::atomic<unsigned> dequeuePosition_{};
+};
+
+}
@@ -0,0 +1,324 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Container/PoolAllocator.h"
+
+#include "../Container/ThreadSlot.h"
+
+#include <EASTL/vector.h>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+namespace Detail
+{
+
+/// Header of pool node. Contains owner cache when allocated and next free node when free.
+struct alignas(ConcurrentPool::NodeHeaderSize) PoolNode
+{
+    union
+    {
+        PoolNode* next_;
+        PoolCache* owner_;
+    };
+};
+
+static_assert(sizeof(PoolNode) == ConcurrentPool::NodeHeaderSize, "Unexpected size of pool node header");
+
+/// Cache of pool nodes owned by one thread.
+struct PoolCache
+{
+    /// Free nodes. Accessed only by owner thread.
+    PoolNode* localFree_{};
+    /// Nodes freed by other threads.
+    std::atomic<PoolNode*> remoteFree_{};
+    /// Memory blocks owned by the cache.
+    ea::vector<unsigned char*> blocks_;
+
+    /// Number of nodes in use.
+    std::atomic<int> numLive_{};
+    /// Peak number of nodes in use.
+    std::atomic<int> numPeak_{};
+    /// Number of nodes allocated.
+    std::atomic<unsigned> numCapacity_{};
+};
+
+}
+
+namespace
+{
+
+unsigned GetNumSizeClasses()
+{
+    return PoolAllocator::MaxPooledSize / PoolAllocator::SizeClassStep;
+}
+
+/// Return pools for all size classes. Pools are never destroyed because memory may be freed during static destruction.
+ConcurrentPool** GetSizeClassPools()
+{
+    static ConcurrentPool** pools = []
+    {
+        const unsigned numSizeClasses = GetNumSizeClasses();
+        auto result = new ConcurrentPool*[numSizeClasses];
+        for (unsigned i = 0; i < numSizeClasses; ++i)
+            result[i] = new ConcurrentPool((i + 1) * PoolAllocator::SizeClassStep);
+        return result;
+    }();
+    return pools;
+}
+
+}
+
+ConcurrentPool::ConcurrentPool(unsigned nodeSize, unsigned nodesPerBlock)
+    : nodeSize_((ea::max(nodeSize, 1u) + NodeHeaderSize - 1) / NodeHeaderSize * NodeHeaderSize)
+    , nodesPerBlock_(ea::max(nodesPerBlock, 1u))
+{
+    ThreadSlot::AddReleaseCallback(this, [](void* pool, unsigned slot)
+    {
+        static_cast<ConcurrentPool*>(pool)->FlushThreadCache(slot);
+    });
+}
+
+ConcurrentPool::~ConcurrentPool()
+{
+    ThreadSlot::RemoveReleaseCallback(this);
+
+    for (auto& cachePtr : caches_)
+    {
+        Detail::PoolCache* cache = cachePtr.load(std::memory_order_acquire);
+        if (!cache)
+            continue;
+
+        for (unsigned char* block : cache->blocks_)
+            delete[] block;
+        delete cache;
+    }
+}
+
+void* ConcurrentPool::Allocate()
+{
+    if (Detail::PoolCache* cache = GetThreadCache())
+    {
+        // Reuse nodes flushed by exited threads before allocating new block
+        if (!cache->localFree_ && !cache->remoteFree_.load(std::memory_order_relaxed))
+            AdoptSharedNodes(cache);
+        return AllocateFromCache(cache);
+    }
+
+    MutexLock lock(sharedCacheMutex_);
+    return AllocateFromCache(GetSharedCache());
+}
+
+void ConcurrentPool::Free(void* ptr)
+{
+    if (!ptr)
+        return;
+
+    auto node = reinterpret_cast<Detail::PoolNode*>(static_cast<unsigned char*>(ptr) - NodeHeaderSize);
+    Detail::PoolCache* owner = node->owner_;
+    owner->numLive_.fetch_sub(1, std::memory_order_relaxed);
+
+    // Return node to local list if current thread owns the cache
+    const unsigned slot = ThreadSlot::GetCurrent();
+    Detail::PoolCache* threadCache = slot < MaxThreadCaches ? caches_[slot].load(std::memory_order_relaxed) : nullptr;
+    if (threadCache == owner)
+    {
+        node->next_ = owner->localFree_;
+        owner->localFree_ = node;
+        return;
+    }
+
+    if (slot >= MaxThreadCaches && owner == caches_[MaxThreadCaches].load(std::memory_order_relaxed))
+    {
+        MutexLock lock(sharedCacheMutex_);
+        node->next_ = owner->localFree_;
+        owner->localFree_ = node;
+        return;
+    }
+
+    // Push node to remote list of the owner. Owner takes the whole list at once, so there's no ABA problem.
+    Detail::PoolNode* head = owner->remoteFree_.load(std::memory_order_relaxed);
+    do
+    {
+        node->next_ = head;
+    } while (!owner->remoteFree_.compare_exchange_weak(head, node, std::memory_order_release, std::memory_order_relaxed));
+}
+
+PoolAllocatorStats ConcurrentPool::GetStats() const
+{
+    PoolAllocatorStats result;
+    for (const auto& cachePtr : caches_)
+    {
+        const Detail::PoolCache* cache = cachePtr.load(std::memory_order_acquire);
+        if (!cache)
+            continue;
+
+        result.numLiveNodes_ += ea::max(0, cache->numLive_.load(std::memory_order_relaxed));
+        result.numPeakNodes_ += cache->numPeak_.load(std::memory_order_relaxed);
+        result.numCapacityNodes_ += cache->numCapacity_.load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+Detail::PoolCache* ConcurrentPool::GetThreadCache()
+{
+    const unsigned slot = ThreadSlot::GetCurrent();
+    if (slot >= MaxThreadCaches)
+        return nullptr;
+
+    // Only the owner thread creates its cache, so there's no race
+    Detail::PoolCache* cache = caches_[slot].load(std::memory_order_relaxed);
+    if (!cache)
+    {
+        cache = new Detail::PoolCache();
+        caches_[slot].store(cache, std::memory_order_release);
+    }
+    return cache;
+}
+
+Detail::PoolCache* ConcurrentPool::GetSharedCache()
+{
+    Detail::PoolCache* cache = caches_[MaxThreadCaches].load(std::memory_order_relaxed);
+    if (!cache)
+    {
+        cache = new Detail::PoolCache();
+        caches_[MaxThreadCaches].store(cache, std::memory_order_release);
+    }
+    return cache;
+}
+
+void ConcurrentPool::FlushThreadCache(unsigned slot)
+{
+    if (slot >= MaxThreadCaches)
+        return;
+
+    Detail::PoolCache* cache = caches_[slot].load(std::memory_order_relaxed);
+    if (!cache)
+        return;
+
+    // Collect all free nodes of the exiting thread. Nodes freed later are reclaimed by the next owner of the slot.
+    Detail::PoolNode* head = cache->remoteFree_.exchange(nullptr, std::memory_order_acquire);
+    while (Detail::PoolNode* node = cache->localFree_)
+    {
+        cache->localFree_ = node->next_;
+        node->next_ = head;
+        head = node;
+    }
+
+    if (!head)
+        return;
+
+    // Move free nodes to shared cache so they are not stranded if the slot is never reused.
+    // Memory blocks stay owned by the thread cache and are deleted together with the pool.
+    MutexLock lock(sharedCacheMutex_);
+    Detail::PoolCache* sharedCache = GetSharedCache();
+    Detail::PoolNode* tail = head;
+    while (tail->next_)
+        tail = tail->next_;
+    tail->next_ = sharedCache->localFree_;
+    sharedCache->localFree_ = head;
+}
+
+void ConcurrentPool::AdoptSharedNodes(Detail::PoolCache* cache)
+{
+    MutexLock lock(sharedCacheMutex_);
+    if (Detail::PoolCache* sharedCache = caches_[MaxThreadCaches].load(std::memory_order_relaxed))
+    {
+        cache->localFree_ = sharedCache->localFree_;
+        sharedCache->localFree_ = nullptr;
+    }
+}
+
+void* ConcurrentPool::AllocateFromCache(Detail::PoolCache* cache)
+{
+    // Reclaim nodes freed by other threads
+    if (!cache->localFree_)
+        cache->localFree_ = cache->remoteFree_.exchange(nullptr, std::memory_order_acquire);
+
+    // Allocate new block
+    if (!cache->localFree_)
+    {
+        const unsigned stride = NodeHeaderSize + nodeSize_;
+        auto block = new unsigned char[stride * nodesPerBlock_ + NodeHeaderSize];
+        cache->blocks_.push_back(block);
+
+        // Align first node to header size
+        const auto blockAddress = reinterpret_cast<uintptr_t>(block);
+        unsigned char* nodePtr = block + (NodeHeaderSize - blockAddress % NodeHeaderSize) % NodeHeaderSize;
+        for (unsigned i = 0; i < nodesPerBlock_; ++i, nodePtr += stride)
+        {
+            auto node = reinterpret_cast<Detail::PoolNode*>(nodePtr);
+            node->next_ = cache->localFree_;
+            cache->localFree_ = node;
+        }
+        cache->numCapacity_.fetch_add(nodesPerBlock_, std::memory_order_relaxed);
+    }
+
+    Detail::PoolNode* node = cache->localFree_;
+    cache->localFree_ = node->next_;
+    node->owner_ = cache;
+
+    const int numLive = cache->numLive_.fetch_add(1, std::memory_order_relaxed) + 1;
+    if (numLive > cache->numPeak_.load(std::memory_order_relaxed))
+        cache->numPeak_.store(numLive, std::memory_order_relaxed);
+
+    return reinterpret_cast<unsigned char*>(node) + NodeHeaderSize;
+}
+
+void* PoolAllocator::Allocate(size_t size)
+{
+    if (size == 0 || size > MaxPooledSize)
+        return new unsigned char[size];
+
+    const unsigned sizeClass = static_cast<unsigned>((size - 1) / SizeClassStep);
+    return GetSizeClassPools()[sizeClass]->Allocate();
+}
+
+void PoolAllocator::Free(void* ptr, size_t size)
+{
+    if (!ptr)
+        return;
+
+    if (size == 0 || size > MaxPooledSize)
+    {
+        delete[] static_cast<unsigned char*>(ptr);
+        return;
+    }
+
+    const unsigned sizeClass = static_cast<unsigned>((size - 1) / SizeClassStep);
+    GetSizeClassPools()[sizeClass]->Free(ptr);
+}
+
+PoolAllocatorStats PoolAllocator::GetStats()
+{
+    PoolAllocatorStats result;
+    ConcurrentPool** pools = GetSizeClassPools();
+    for (unsigned i = 0; i < GetNumSizeClasses(); ++i)
+        result += pools[i]->GetStats();
+    return result;
+}
+
+}
@@ -0,0 +1,164 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Core/Assert.h"
+#include "../Core/Mutex.h"
+#include "../Core/NonCopyable.h"
+
+#include <Urho3D/Urho3D.h>
+
+#include <atomic>
+#include <cstddef>
+
+namespace Urho3D
+{
+
+namespace Detail
+{
+
+struct PoolCache;
+
+}
+
+/// Statistics of pool allocator.
+struct PoolAllocatorStats
+{
+    /// Number of nodes currently in use.
+    unsigned numLiveNodes_{};
+    /// Peak number of nodes in use. Peaks are tracked per thread, so this is an upper estimate.
+    unsigned numPeakNodes_{};
+    /// Number of nodes allocated from heap.
+    unsigned numCapacityNodes_{};
+
+    /// Accumulate statistics of another pool.
+    PoolAllocatorStats& operator+=(const PoolAllocatorStats& rhs)
+    {
+        numLiveNodes_ += rhs.numLiveNodes_;
+        numPeakNodes_ += rhs.numPeakNodes_;
+        numCapacityNodes_ += rhs.numCapacityNodes_;
+        return *this;
+    }
+};
+
+/// Thread-safe pool of fixed-size memory nodes.
+/// Each thread allocates nodes from its own cache and returns them there without synchronization.
+/// Nodes freed by other threads are pushed to the lock-free list of the owner cache and reclaimed by the owner.
+class URHO3D_API ConcurrentPool : private NonCopyable
+{
+public:
+    /// Maximum number of live threads that have their own caches. Other threads share one cache protected by mutex.
+    /// Caches of exited threads are reused by new threads.
+    static const unsigned MaxThreadCaches = 64;
+    /// Size of node header. Data is aligned to this size.
+    static const unsigned NodeHeaderSize = 16;
+
+    /// Construct.
+    explicit ConcurrentPool(unsigned nodeSize, unsigned nodesPerBlock = 64);
+    /// Destruct. All nodes should be freed at this point.
+    ~ConcurrentPool();
+
+    /// Allocate node. Never returns null.
+    void* Allocate();
+    /// Free node allocated by this pool. May be called from any thread.
+    void Free(void* ptr);
+
+    /// Return node size.
+    unsigned GetNodeSize() const { return nodeSize_; }
+    /// Return statistics.
+    PoolAllocatorStats GetStats() const;
+
+private:
+    /// Return cache of the current thread, or null if the thread should use shared cache.
+    Detail::PoolCache* GetThreadCache();
+    /// Return shared cache. Should be called under sharedCacheMutex_.
+    Detail::PoolCache* GetSharedCache();
+    /// Allocate node from cache owned by current thread.
+    void* AllocateFromCache(Detail::PoolCache* cache);
+    /// Move free nodes of the exiting thread to shared cache. Called from the exiting thread.
+    void FlushThreadCache(unsigned slot);
+    /// Move free nodes of shared cache to the cache of current thread.
+    void AdoptSharedNodes(Detail::PoolCache* cache);
+
+    /// Node size, rounded up to header size.
+    const unsigned nodeSize_{};
+    /// Number of nodes allocated at once.
+    const unsigned nodesPerBlock_{};
+    /// Thread caches. The last one is shared between threads that don't have own cache.
+    std::atomic<Detail::PoolCache*> caches_[MaxThreadCaches + 1]{};
+    /// Mutex for shared cache.
+    Mutex sharedCacheMutex_;
+};
+
+/// Thread-safe allocator with pools for small size classes. Big allocations fall back to heap.
+class URHO3D_API PoolAllocator
+{
+public:
+    /// Size class granularity.
+    static const unsigned SizeClassStep = 16;
+    /// Maximum size of pooled allocation.
+    static const unsigned MaxPooledSize = 512;
+
+    /// Allocate memory. Memory is aligned to SizeClassStep.
+    static void* Allocate(size_t size);
+    /// Free memory. Size should be the same as on allocation. May be called from any thread.
+    static void Free(void* ptr, size_t size);
+    /// Return statistics accumulated for all size classes.
+    static PoolAllocatorStats GetStats();
+};
+
+/// EASTL allocator that uses PoolAllocator. Suitable for node-based containers.
+class PoolEASTLAllocator
+{
+public:
+    /// Construct.
+    explicit PoolEASTLAllocator(const char* /*name*/ = nullptr) {}
+    /// Construct copy with name.
+    PoolEASTLAllocator(const PoolEASTLAllocator& /*other*/, const char* /*name*/) {}
+
+    /// EASTL allocator interface
+    /// @{
+    void* allocate(size_t n, int /*flags*/ = 0) { return PoolAllocator::Allocate(n); }
+    void* allocate(size_t n, size_t alignment, size_t /*offset*/, int /*flags*/ = 0)
+    {
+        URHO3D_ASSERT(alignment <= PoolAllocator::SizeClassStep);
+        return PoolAllocator::Allocate(n);
+    }
+    void deallocate(void* p, size_t n) { PoolAllocator::Free(p, n); }
+    const char* get_name() const { return "PoolEASTLAllocator"; }
+    void set_name(const char* /*name*/) {}
+    /// @}
+};
+
+inline bool operator==(const PoolEASTLAllocator& /*lhs*/, const PoolEASTLAllocator& /*rhs*/) { return true; }
+inline bool operator!=(const PoolEASTLAllocator& /*lhs*/, const PoolEASTLAllocator& /*rhs*/) { return false; }
+
+/// Base class for objects allocated from PoolAllocator. Objects may be created and destroyed from any thread.
+class PooledObject
+{
+public:
+    static void* operator new(size_t size) { return PoolAllocator::Allocate(size); }
+    static void operator delete(void* ptr, size_t size) { PoolAllocator::Free(ptr, size); }
+};
+
+}
@@ -0,0 +1,529 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Core/Assert.h"
+#include "../Math/MathDefs.h"
+#include "../Math/StringHash.h"
+
+#include <EASTL/initializer_list.h>
+#include <EASTL/iterator.h>
+#include <EASTL/tuple.h>
+#include <EASTL/utility.h>
+
+#include <iterator>
+#include <memory>
+#include <new>
+
+namespace Urho3D
+{
+
+/// Flat hash map keyed by StringHash. Uses open addressing with Robin Hood linear probing and backward shift erase.
+/// Elements are stored in one contiguous array, so lookups and iteration don't chase pointers.
+/// Unlike ea::unordered_map, insertion may move elements and invalidate pointers and iterators.
+/// Erase invalidates only iterators pointing to erased element and elements after it in the same probe sequence;
+/// erase(iterator) returns iterator that is safe to continue iteration from.
+template <class V>
+class StringHashMap
+{
+public:
+    using key_type = StringHash;
+    using mapped_type = V;
+    using value_type = ea::pair<StringHash, V>;
+    using size_type = eastl_size_t;
+    using difference_type = ptrdiff_t;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+
+    /// Maximum load factor.
+    static constexpr float MaxLoadFactor = 0.875f;
+
+    /// Iterator over elements.
+    template <bool IsConst>
+    class Iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = typename StringHashMap::value_type;
+        using difference_type = ptrdiff_t;
+        using pointer = ea::conditional_t<IsConst, const value_type*, value_type*>;
+        using reference = ea::conditional_t<IsConst, const value_type&, value_type&>;
+        using DistancePointer = const signed char*;
+
+        /// Construct default.
+        Iterator() = default;
+        /// Construct from position. Skips empty slots.
+        Iterator(DistancePointer distance, pointer value)
+            : distance_(distance)
+            , value_(value)
+        {
+            SkipEmpty();
+        }
+        /// Construct const iterator from non-const.
+        template <bool OtherConst, class = ea::enable_if_t<IsConst && !OtherConst>>
+        Iterator(const Iterator<OtherConst>& other)
+            : distance_(other.distance_)
+            , value_(other.value_)
+        {
+        }
+
+        /// Dereference.
+        reference operator*() const { return *value_; }
+        /// Dereference.
+        pointer operator->() const { return value_; }
+        /// Advance to the next element.
+        Iterator& operator++()
+        {
+            ++distance_;
+            ++value_;
+            SkipEmpty();
+            return *this;
+        }
+        /// Advance to the next element.
+        Iterator operator++(int)
+        {
+            Iterator copy = *this;
+            ++*this;
+            return copy;
+        }
+
+        /// Compare iterators.
+        template <bool OtherConst>
+        bool operator==(const Iterator<OtherConst>& rhs) const { return value_ == rhs.value_; }
+        /// Compare iterators.
+        template <bool OtherConst>
+        bool operator!=(const Iterator<OtherConst>& rhs) const { return value_ != rhs.value_; }
+
+    private:
+        /// Skip empty slots. Array of distances is terminated with non-empty sentinel.
+        void SkipEmpty()
+        {
+            while (*distance_ < 0)
+            {
+                ++distance_;
+                ++value_;
+            }
+        }
+
+        /// Distance of current slot from ideal position, negative for empty slots.
+        DistancePointer distance_{};
+        /// Current slot.
+        pointer value_{};
+
+        template <bool> friend class Iterator;
+        friend class StringHashMap;
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    /// Construct empty.
+    StringHashMap() = default;
+    /// Construct from initializer list.
+    StringHashMap(std::initializer_list<value_type> list)
+    {
+        reserve(list.size());
+        for (const value_type& value : list)
+            insert(value);
+    }
+    /// Copy-construct.
+    StringHashMap(const StringHashMap& other)
+    {
+        CopyFrom(other);
+    }
+    /// Move-construct.
+    StringHashMap(StringHashMap&& other) noexcept
+    {
+        swap(other);
+    }
+    /// Destruct.
+    ~StringHashMap()
+    {
+        Deallocate();
+    }
+
+    /// Copy-assign.
+    StringHashMap& operator=(const StringHashMap& other)
+    {
+        if (this != &other)
+        {
+            Deallocate();
+            CopyFrom(other);
+        }
+        return *this;
+    }
+    /// Move-assign.
+    StringHashMap& operator=(StringHashMap&& other) noexcept
+    {
+        if (this != &other)
+        {
+            Deallocate();
+            swap(other);
+        }
+        return *this;
+    }
+
+    /// Swap with another map.
+    void swap(StringHashMap& other) noexcept
+    {
+        ea::swap(distances_, other.distances_);
+        ea::swap(values_, other.values_);
+        ea::swap(size_, other.size_);
+        ea::swap(capacity_, other.capacity_);
+        ea::swap(numSlots_, other.numSlots_);
+        ea::swap(shift_, other.shift_);
+        ea::swap(maxDistance_, other.maxDistance_);
+    }
+
+    /// Return iterator to the first element.
+    iterator begin() { return {distances_, values_}; }
+    /// Return iterator to the first element.
+    const_iterator begin() const { return {distances_, values_}; }
+    /// Return iterator to the first element.
+    const_iterator cbegin() const { return begin(); }
+    /// Return iterator to the end.
+    iterator end() { return {distances_ + numSlots_, values_ + numSlots_}; }
+    /// Return iterator to the end.
+    const_iterator end() const { return {distances_ + numSlots_, values_ + numSlots_}; }
+    /// Return iterator to the end.
+    const_iterator cend() const { return end(); }
+
+    /// Return number of elements.
+    size_type size() const { return size_; }
+    /// Return whether the map is empty.
+    bool empty() const { return size_ == 0; }
+    /// Return number of elements that can be stored without rehashing.
+    size_type capacity() const { return static_cast<size_type>(capacity_ * MaxLoadFactor); }
+
+    /// Find element by key.
+    iterator find(const key_type& key)
+    {
+        const unsigned index = FindIndex(key);
+        return index != M_MAX_UNSIGNED ? IteratorAt(index) : end();
+    }
+    /// Find element by key.
+    const_iterator find(const key_type& key) const
+    {
+        const unsigned index = FindIndex(key);
+        return index != M_MAX_UNSIGNED ? IteratorAt(index) : end();
+    }
+    /// Return whether the map contains key.
+    bool contains(const key_type& key) const { return FindIndex(key) != M_MAX_UNSIGNED; }
+    /// Return number of elements with key.
+    size_type count(const key_type& key) const { return contains(key) ? 1 : 0; }
+
+    /// Return element by key, insert default-constructed one if not found.
+    V& operator[](const key_type& key) { return try_emplace(key).first->second; }
+
+    /// Insert element if key is not present.
+    ea::pair<iterator, bool> insert(const value_type& value) { return try_emplace(value.first, value.second); }
+    /// Insert element if key is not present.
+    ea::pair<iterator, bool> insert(value_type&& value) { return try_emplace(value.first, ea::move(value.second)); }
+    /// Insert range of elements.
+    template <class InputIterator>
+    void insert(InputIterator first, InputIterator last)
+    {
+        for (; first != last; ++first)
+            insert(*first);
+    }
+    /// Construct element if key is not present.
+    template <class... Args>
+    ea::pair<iterator, bool> emplace(const key_type& key, Args&&... args) { return try_emplace(key, ea::forward<Args>(args)...); }
+    /// Insert element or assign existing one.
+    template <class T>
+    ea::pair<iterator, bool> insert_or_assign(const key_type& key, T&& value)
+    {
+        const auto result = try_emplace(key, ea::forward<T>(value));
+        if (!result.second)
+            result.first->second = ea::forward<T>(value);
+        return result;
+    }
+
+    /// Construct element if key is not present.
+    template <class... Args>
+    ea::pair<iterator, bool> try_emplace(const key_type& key, Args&&... args)
+    {
+        const unsigned existingIndex = FindIndex(key);
+        if (existingIndex != M_MAX_UNSIGNED)
+            return {IteratorAt(existingIndex), false};
+
+        if (size_ + 1 > capacity())
+            Rehash(ea::max(capacity_ * 2, MinCapacity));
+
+        unsigned index{};
+        while (!TryInsertNew(key, index))
+            Rehash(capacity_ * 2);
+
+        new (&values_[index]) value_type(ea::piecewise_construct, ea::forward_as_tuple(key),
+            ea::forward_as_tuple(ea::forward<Args>(args)...));
+        ++size_;
+        return {IteratorAt(index), true};
+    }
+
+    /// Erase element by key. Return number of erased elements.
+    size_type erase(const key_type& key)
+    {
+        const unsigned index = FindIndex(key);
+        if (index == M_MAX_UNSIGNED)
+            return 0;
+
+        EraseAt(index);
+        return 1;
+    }
+    /// Erase element. Return iterator to the next element.
+    iterator erase(const_iterator iter)
+    {
+        const auto index = static_cast<unsigned>(iter.value_ - values_);
+        EraseAt(index);
+        // Next element may have been shifted into erased slot
+        return IteratorAt(index);
+    }
+
+    /// Remove all elements and keep memory.
+    void clear()
+    {
+        for (unsigned i = 0; i < numSlots_; ++i)
+        {
+            if (distances_[i] >= 0)
+            {
+                values_[i].~value_type();
+                distances_[i] = EmptySlot;
+            }
+        }
+        size_ = 0;
+    }
+
+    /// Reserve memory for given number of elements.
+    void reserve(size_type numElements)
+    {
+        const auto requiredCapacity = static_cast<unsigned>(CeilToInt(numElements / MaxLoadFactor));
+        if (requiredCapacity > capacity_)
+            Rehash(ea::max(NextPowerOfTwo(requiredCapacity), MinCapacity));
+    }
+
+    /// Compare maps.
+    bool operator==(const StringHashMap& rhs) const
+    {
+        if (size_ != rhs.size_)
+            return false;
+
+        for (const value_type& value : *this)
+        {
+            const auto iter = rhs.find(value.first);
+            if (iter == rhs.end() || !(iter->second == value.second))
+                return false;
+        }
+        return true;
+    }
+    /// Compare maps.
+    bool operator!=(const StringHashMap& rhs) const { return !(*this == rhs); }
+
+private:
+    /// Distance value for empty slot.
+    static const signed char EmptySlot = -1;
+    /// Minimum capacity.
+    static const unsigned MinCapacity = 8;
+
+    /// Return iterator at slot.
+    iterator IteratorAt(unsigned index) { return {distances_ + index, values_ + index}; }
+    /// Return iterator at slot.
+    const_iterator IteratorAt(unsigned index) const { return {distances_ + index, values_ + index}; }
+
+    /// Return ideal slot for the key.
+    unsigned GetIdealIndex(const key_type& key) const
+    {
+        // Fibonacci hashing spreads sequential and low-entropy hashes over all slots
+        return (key.Value() * 2654435769u) >> shift_;
+    }
+
+    /// Return index of the element or M_MAX_UNSIGNED if not found.
+    unsigned FindIndex(const key_type& key) const
+    {
+        if (size_ == 0)
+            return M_MAX_UNSIGNED;
+
+        // Probe sequence is terminated by slot with distance lower than probe distance
+        unsigned index = GetIdealIndex(key);
+        for (signed char distance = 0; distances_[index] >= distance; ++index, ++distance)
+        {
+            if (values_[index].first == key)
+                return index;
+        }
+        return M_MAX_UNSIGNED;
+    }
+
+    /// Prepare empty slot for new key that is not present in the map. Return false if rehash is needed.
+    bool TryInsertNew(const key_type& key, unsigned& insertIndex)
+    {
+        // Find first slot that is owned by "richer" element
+        unsigned index = GetIdealIndex(key);
+        signed char distance = 0;
+        while (distances_[index] >= distance)
+        {
+            ++index;
+            ++distance;
+        }
+        if (distance > maxDistance_)
+            return false;
+
+        // Find empty slot at the end of the cluster, every element shifted there gets one step further from ideal slot
+        unsigned emptyIndex = index;
+        while (distances_[emptyIndex] != EmptySlot)
+        {
+            if (distances_[emptyIndex] + 1 > maxDistance_)
+                return false;
+            ++emptyIndex;
+        }
+        if (emptyIndex + 1 >= numSlots_)
+            return false;
+
+        // Shift cluster by one slot to the right
+        for (unsigned i = emptyIndex; i > index; --i)
+        {
+            new (&values_[i]) value_type(ea::move(values_[i - 1]));
+            values_[i - 1].~value_type();
+            distances_[i] = distances_[i - 1] + 1;
+        }
+
+        distances_[index] = distance;
+        insertIndex = index;
+        return true;
+    }
+
+    /// Erase element at slot and shift following elements back.
+    void EraseAt(unsigned index)
+    {
+        values_[index].~value_type();
+        --size_;
+
+        unsigned next = index + 1;
+        while (distances_[next] > 0)
+        {
+            new (&values_[next - 1]) value_type(ea::move(values_[next]));
+            values_[next].~value_type();
+            distances_[next - 1] = distances_[next] - 1;
+            ++next;
+        }
+        distances_[next - 1] = EmptySlot;
+    }
+
+    /// Reallocate storage and reinsert all elements.
+    void Rehash(unsigned newCapacity)
+    {
+        StringHashMap newMap;
+        newMap.Allocate(newCapacity);
+
+        for (unsigned i = 0; i < numSlots_; ++i)
+        {
+            if (distances_[i] < 0)
+                continue;
+
+            unsigned index{};
+            while (!newMap.TryInsertNew(values_[i].first, index))
+            {
+                // Very unlikely, keep already moved elements and grow further
+                newMap.Rehash(newMap.capacity_ * 2);
+            }
+            new (&newMap.values_[index]) value_type(ea::move(values_[i]));
+            ++newMap.size_;
+        }
+
+        swap(newMap);
+    }
+
+    /// Allocate empty storage. Should be called only for empty map without storage.
+    void Allocate(unsigned capacity)
+    {
+        URHO3D_ASSERT(IsPowerOfTwo(capacity));
+        capacity_ = capacity;
+        shift_ = 32 - LogBaseTwo(capacity);
+        maxDistance_ = static_cast<signed char>(ea::max(4u, LogBaseTwo(capacity)));
+        // Probe sequence never wraps around, extra slots are reserved at the end.
+        // Last slot is sentinel that terminates both probe and iteration.
+        numSlots_ = capacity_ + maxDistance_ + 1;
+
+        distances_ = new signed char[numSlots_ + 1];
+        for (unsigned i = 0; i < numSlots_; ++i)
+            distances_[i] = EmptySlot;
+        distances_[numSlots_] = 0;
+        values_ = std::allocator<value_type>().allocate(numSlots_ + 1);
+    }
+
+    /// Destroy elements and deallocate storage.
+    void Deallocate()
+    {
+        if (!values_)
+            return;
+
+        clear();
+        delete[] distances_;
+        std::allocator<value_type>().deallocate(values_, numSlots_ + 1);
+
+        distances_ = EmptyDistances();
+        values_ = nullptr;
+        capacity_ = 0;
+        numSlots_ = 0;
+        shift_ = 32;
+        maxDistance_ = 0;
+    }
+
+    /// Copy elements from another map. Should be called only for empty map without storage.
+    void CopyFrom(const StringHashMap& other)
+    {
+        if (!other.values_)
+            return;
+
+        Allocate(other.capacity_);
+        for (unsigned i = 0; i < numSlots_; ++i)
+        {
+            if (other.distances_[i] >= 0)
+                new (&values_[i]) value_type(other.values_[i]);
+            distances_[i] = other.distances_[i];
+        }
+        size_ = other.size_;
+    }
+
+    /// Return distances for map without storage. Contains only end sentinel.
+    static signed char* EmptyDistances()
+    {
+        static signed char distances[1]{0};
+        return distances;
+    }
+
+    /// Distances of elements from ideal slots, negative for empty slots.
+    signed char* distances_{EmptyDistances()};
+    /// Elements.
+    value_type* values_{};
+    /// Number of elements.
+    unsigned size_{};
+    /// Number of ideal slots, power of two.
+    unsigned capacity_{};
+    /// Number of slots including overflow slots and sentinel.
+    unsigned numSlots_{};
+    /// Shift applied to hash to get ideal slot.
+    unsigned shift_{32};
+    /// Maximum distance of element from ideal slot.
+    signed char maxDistance_{};
+};
+
+}
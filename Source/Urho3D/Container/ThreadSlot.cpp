@@ -0,0 +1,129 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Container/ThreadSlot.h"
+
+#include "../Core/Mutex.h"
+
+#include <EASTL/algorithm.h>
+#include <EASTL/vector.h>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+namespace
+{
+
+/// Slot of the thread that didn't request slot yet.
+const unsigned UnassignedSlot = ThreadSlot::Invalid - 1;
+
+/// Registry of thread slots and release callbacks.
+struct ThreadSlotRegistry
+{
+    /// Mutex for all members.
+    Mutex mutex_;
+    /// Released slots.
+    ea::vector<unsigned> freeSlots_;
+    /// Next slot that was never used.
+    unsigned nextSlot_{};
+    /// Callbacks invoked on slot release.
+    ea::vector<ea::pair<void*, ThreadSlot::ReleaseCallback>> callbacks_;
+};
+
+/// Return registry. Registry is never destroyed because threads may exit during static destruction.
+ThreadSlotRegistry& GetRegistry()
+{
+    static auto registry = new ThreadSlotRegistry();
+    return *registry;
+}
+
+/// Slot of the current thread.
+thread_local unsigned currentThreadSlot = UnassignedSlot;
+
+/// Owner of the thread slot. Acquires the slot on construction and releases it on thread exit.
+struct ThreadSlotHolder
+{
+    ThreadSlotHolder()
+    {
+        ThreadSlotRegistry& registry = GetRegistry();
+        MutexLock lock(registry.mutex_);
+
+        // Prefer the lowest slot so slots stay dense
+        if (!registry.freeSlots_.empty())
+        {
+            const auto iter = ea::min_element(registry.freeSlots_.begin(), registry.freeSlots_.end());
+            slot_ = *iter;
+            registry.freeSlots_.erase_unsorted(iter);
+        }
+        else
+            slot_ = registry.nextSlot_++;
+
+        currentThreadSlot = slot_;
+    }
+
+    ~ThreadSlotHolder()
+    {
+        ThreadSlotRegistry& registry = GetRegistry();
+        MutexLock lock(registry.mutex_);
+
+        for (const auto& [owner, callback] : registry.callbacks_)
+            callback(owner, slot_);
+
+        registry.freeSlots_.push_back(slot_);
+        currentThreadSlot = ThreadSlot::Invalid;
+    }
+
+    /// Acquired slot.
+    unsigned slot_{};
+};
+
+thread_local ThreadSlotHolder threadSlotHolder;
+
+}
+
+unsigned ThreadSlot::GetCurrent()
+{
+    const unsigned slot = currentThreadSlot;
+    // First access to the holder constructs it and assigns the slot
+    return slot != UnassignedSlot ? slot : threadSlotHolder.slot_;
+}
+
+void ThreadSlot::AddReleaseCallback(void* owner, ReleaseCallback callback)
+{
+    ThreadSlotRegistry& registry = GetRegistry();
+    MutexLock lock(registry.mutex_);
+    registry.callbacks_.emplace_back(owner, callback);
+}
+
+void ThreadSlot::RemoveReleaseCallback(void* owner)
+{
+    ThreadSlotRegistry& registry = GetRegistry();
+    MutexLock lock(registry.mutex_);
+    ea::erase_if(registry.callbacks_, [&](const auto& item) { return item.first == owner; });
+}
+
+}
@@ -0,0 +1,50 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include <Urho3D/Urho3D.h>
+
+namespace Urho3D
+{
+
+/// Small dense index of the current thread used to find per-thread caches in concurrent allocators.
+/// Slot is assigned on first use and returned to the free list when the thread exits,
+/// so the number of slots in use never exceeds the number of live threads.
+class URHO3D_API ThreadSlot
+{
+public:
+    /// Slot of the thread that has already released its slot during thread exit.
+    static const unsigned Invalid = 0xffffffff;
+    /// Callback invoked on the exiting thread right before its slot is released.
+    using ReleaseCallback = void (*)(void* owner, unsigned slot);
+
+    /// Return slot of the current thread. Assigns new slot on the first call.
+    static unsigned GetCurrent();
+    /// Register callback invoked when any thread releases its slot.
+    static void AddReleaseCallback(void* owner, ReleaseCallback callback);
+    /// Unregister callback. Waits until callback is no longer executed by other threads.
+    static void RemoveReleaseCallback(void* owner);
+};
+
+}
@@ -0,0 +1,169 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/FrameAllocator.h"
+#include "../Core/WorkQueue.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+LinearAllocator::LinearAllocator(unsigned blockSize)
+    : blockSize_(blockSize)
+{
+}
+
+LinearAllocator::~LinearAllocator()
+{
+    FreeBlocks();
+}
+
+void* LinearAllocator::Allocate(size_t size, size_t alignment)
+{
+    const auto alignPointer = [alignment](unsigned char* ptr)
+    {
+        const auto address = reinterpret_cast<uintptr_t>(ptr);
+        return reinterpret_cast<unsigned char*>((address + alignment - 1) & ~(alignment - 1));
+    };
+
+    unsigned char* result = alignPointer(current_);
+    if (!current_ || result + size > end_)
+    {
+        AllocateBlock(size + alignment);
+        result = alignPointer(current_);
+    }
+
+    current_ = result + size;
+    stats_.allocatedBytes_ += size;
+    stats_.peakAllocatedBytes_ = ea::max(stats_.peakAllocatedBytes_, stats_.allocatedBytes_);
+    ++stats_.numAllocations_;
+    return result;
+}
+
+void LinearAllocator::Reset()
+{
+    stats_.allocatedBytes_ = 0;
+    stats_.numAllocations_ = 0;
+
+    // Merge blocks so next frame doesn't have to allocate memory
+    if (blocks_.size() > 1)
+    {
+        const size_t totalSize = static_cast<size_t>(stats_.capacity_);
+        FreeBlocks();
+        AllocateBlock(totalSize);
+    }
+    else if (!blocks_.empty())
+    {
+        current_ = blocks_.back().data_;
+        end_ = current_ + blocks_.back().size_;
+    }
+}
+
+void LinearAllocator::AllocateBlock(size_t minSize)
+{
+    Block block;
+    block.size_ = ea::max(minSize, blockSize_);
+    block.data_ = new unsigned char[block.size_];
+    blocks_.push_back(block);
+
+    current_ = block.data_;
+    end_ = block.data_ + block.size_;
+    stats_.capacity_ += block.size_;
+    ++stats_.numBlockAllocations_;
+}
+
+void LinearAllocator::FreeBlocks()
+{
+    for (const Block& block : blocks_)
+        delete[] block.data_;
+    blocks_.clear();
+
+    current_ = nullptr;
+    end_ = nullptr;
+    stats_.capacity_ = 0;
+}
+
+void* FrameMemory::Allocate(size_t size, size_t alignment)
+{
+    const unsigned threadIndex = WorkQueue::GetThreadIndex();
+    if (threadIndex < threadAllocators_.size())
+        return threadAllocators_[threadIndex]->Allocate(size, alignment);
+
+    MutexLock lock(sharedAllocatorMutex_);
+    return sharedAllocator_.Allocate(size, alignment);
+}
+
+void FrameMemory::SetNumThreads(unsigned numThreads)
+{
+    while (threadAllocators_.size() < numThreads)
+        threadAllocators_.push_back(ea::make_unique<LinearAllocator>());
+}
+
+void FrameMemory::Reset()
+{
+    for (const auto& allocator : threadAllocators_)
+        allocator->Reset();
+
+    MutexLock lock(sharedAllocatorMutex_);
+    sharedAllocator_.Reset();
+}
+
+LinearAllocatorStats FrameMemory::GetThreadStats(unsigned threadIndex) const
+{
+    return threadIndex < threadAllocators_.size() ? threadAllocators_[threadIndex]->GetStats() : LinearAllocatorStats{};
+}
+
+LinearAllocatorStats FrameMemory::GetStats() const
+{
+    LinearAllocatorStats result;
+    for (const auto& allocator : threadAllocators_)
+        result += allocator->GetStats();
+
+    MutexLock lock(sharedAllocatorMutex_);
+    result += sharedAllocator_.GetStats();
+    return result;
+}
+
+void* FrameAllocator::allocate(size_t n, int flags)
+{
+    if (!memory_)
+        return EASTLAllocatorType().allocate(n, flags);
+    return memory_->Allocate(n, alignof(std::max_align_t));
+}
+
+void* FrameAllocator::allocate(size_t n, size_t alignment, size_t offset, int flags)
+{
+    if (!memory_)
+        return EASTLAllocatorType().allocate(n, alignment, offset, flags);
+    return memory_->Allocate(n, alignment);
+}
+
+void FrameAllocator::deallocate(void* p, size_t n)
+{
+    if (!memory_)
+        EASTLAllocatorType().deallocate(p, n);
+}
+
+}
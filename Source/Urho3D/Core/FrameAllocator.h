@@ -0,0 +1,178 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Core/Mutex.h"
+#include "../Core/NonCopyable.h"
+
+#include <Urho3D/Urho3D.h>
+
+#include <EASTL/unique_ptr.h>
+#include <EASTL/vector.h>
+
+#include <cstddef>
+
+namespace Urho3D
+{
+
+/// Statistics of linear allocator.
+struct LinearAllocatorStats
+{
+    /// Number of bytes allocated since last reset.
+    unsigned long long allocatedBytes_{};
+    /// Maximum number of bytes allocated between two resets.
+    unsigned long long peakAllocatedBytes_{};
+    /// Total size of memory blocks owned by allocator.
+    unsigned long long capacity_{};
+    /// Number of allocations since last reset.
+    unsigned numAllocations_{};
+    /// Number of memory blocks allocated from heap during the lifetime of allocator.
+    unsigned numBlockAllocations_{};
+
+    /// Accumulate statistics of another allocator.
+    LinearAllocatorStats& operator+=(const LinearAllocatorStats& rhs)
+    {
+        allocatedBytes_ += rhs.allocatedBytes_;
+        peakAllocatedBytes_ += rhs.peakAllocatedBytes_;
+        capacity_ += rhs.capacity_;
+        numAllocations_ += rhs.numAllocations_;
+        numBlockAllocations_ += rhs.numBlockAllocations_;
+        return *this;
+    }
+};
+
+/// Linear memory allocator. Allocation bumps the pointer in the current memory block.
+/// Memory is never released individually, all allocations are released at once on Reset.
+/// Not thread-safe.
+class URHO3D_API LinearAllocator : private NonCopyable
+{
+public:
+    /// Default size of memory block.
+    static const unsigned DefaultBlockSize = 64 * 1024;
+
+    /// Construct.
+    explicit LinearAllocator(unsigned blockSize = DefaultBlockSize);
+    /// Destruct.
+    ~LinearAllocator();
+
+    /// Allocate memory. Alignment should be power of two.
+    void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+    /// Release all allocated memory. Blocks are merged so peak usage fits into single block next time.
+    void Reset();
+
+    /// Return statistics.
+    const LinearAllocatorStats& GetStats() const { return stats_; }
+
+private:
+    /// Memory block.
+    struct Block
+    {
+        unsigned char* data_{};
+        size_t size_{};
+    };
+
+    /// Allocate new block and make it current.
+    void AllocateBlock(size_t minSize);
+    /// Free all blocks.
+    void FreeBlocks();
+
+    /// Default block size.
+    const size_t blockSize_{};
+    /// Owned blocks. Last block is current.
+    ea::vector<Block> blocks_;
+    /// Current position in current block.
+    unsigned char* current_{};
+    /// End of current block.
+    unsigned char* end_{};
+    /// Statistics.
+    LinearAllocatorStats stats_;
+};
+
+/// Set of per-thread linear allocators for memory that is used only within current frame.
+/// Owned by WorkQueue, which sizes it according to the number of threads and resets it at the end of the frame.
+/// Allocation is safe from any thread, threads not owned by WorkQueue share one locked allocator.
+class URHO3D_API FrameMemory : private NonCopyable
+{
+public:
+    /// Allocate memory for current frame using allocator of current thread.
+    void* Allocate(size_t size, size_t alignment);
+    /// Make sure that each of specified number of threads has its own allocator.
+    /// Should not be called when allocators are in use.
+    void SetNumThreads(unsigned numThreads);
+    /// Release memory of all allocators. Should be called when no other thread is using allocators.
+    void Reset();
+
+    /// Return statistics of the allocator used by specified WorkQueue thread.
+    LinearAllocatorStats GetThreadStats(unsigned threadIndex) const;
+    /// Return statistics accumulated for all threads.
+    LinearAllocatorStats GetStats() const;
+
+private:
+    /// Allocators used by WorkQueue threads.
+    ea::vector<ea::unique_ptr<LinearAllocator>> threadAllocators_;
+    /// Allocator shared by threads not owned by WorkQueue.
+    LinearAllocator sharedAllocator_;
+    /// Mutex for shared allocator.
+    mutable Mutex sharedAllocatorMutex_;
+};
+
+/// EASTL allocator that allocates memory from FrameMemory.
+/// Deallocation is no-op, all memory is released at the end of the frame by WorkQueue.
+/// Containers should not outlive the frame and should contain only trivially destructible elements
+/// unless they are destroyed before the end of the frame.
+/// Default-constructed allocator has no FrameMemory and falls back to the heap.
+class URHO3D_API FrameAllocator
+{
+public:
+    /// Construct heap allocator.
+    explicit FrameAllocator(const char* /*name*/ = nullptr) {}
+    /// Construct allocator for frame memory.
+    explicit FrameAllocator(FrameMemory* memory) : memory_(memory) {}
+    /// Construct copy with name.
+    FrameAllocator(const FrameAllocator& other, const char* /*name*/) : memory_(other.memory_) {}
+
+    /// EASTL allocator interface
+    /// @{
+    void* allocate(size_t n, int flags = 0);
+    void* allocate(size_t n, size_t alignment, size_t offset, int flags = 0);
+    void deallocate(void* p, size_t n);
+    const char* get_name() const { return "FrameAllocator"; }
+    void set_name(const char* /*name*/) {}
+    /// @}
+
+    /// Return frame memory. Null if the allocator uses the heap.
+    FrameMemory* GetMemory() const { return memory_; }
+
+private:
+    /// Frame memory.
+    FrameMemory* memory_{};
+};
+
+inline bool operator==(const FrameAllocator& lhs, const FrameAllocator& rhs) { return lhs.GetMemory() == rhs.GetMemory(); }
+inline bool operator!=(const FrameAllocator& lhs, const FrameAllocator& rhs) { return lhs.GetMemory() != rhs.GetMemory(); }
+
+/// Vector with memory allocated for current frame. Should be constructed with FrameAllocator from WorkQueue.
+template <class T>
+using FrameVector = ea::vector<T, FrameAllocator>;
+
+}
@@ -0,0 +1,336 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Container/ThreadSlot.h"
+#include "../Core/Metrics.h"
+#include "../Core/Mutex.h"
+#include "../IO/Archive.h"
+#include "../IO/ArchiveSerialization.h"
+#include "../IO/Log.h"
+
+#include <EASTL/unique_ptr.h>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+namespace
+{
+
+const char* const metricTypeNames[] =
+{
+    "Counter",
+    "Timer",
+    "Histogram",
+    nullptr
+};
+
+/// Samples of one metric recorded by one thread.
+struct MetricSlot
+{
+    /// Number of samples.
+    std::atomic<unsigned long long> count_{};
+    /// Sum of samples.
+    std::atomic<unsigned long long> sum_{};
+    /// Minimum sample.
+    std::atomic<unsigned long long> min_{ea::numeric_limits<unsigned long long>::max()};
+    /// Maximum sample.
+    std::atomic<unsigned long long> max_{};
+    /// Histogram buckets.
+    std::atomic<unsigned long long> buckets_[MetricSnapshot::NumBuckets]{};
+};
+
+/// Samples of all metrics recorded by one thread. Aligned to avoid false sharing with other shards.
+struct alignas(64) MetricsShard
+{
+    /// Slots for all metrics.
+    MetricSlot slots_[MetricsRegistry::MaxMetrics];
+};
+
+/// Increment value owned by the current thread. Readers may observe stale value but never torn one.
+void Increment(std::atomic<unsigned long long>& value, unsigned long long delta)
+{
+    value.store(value.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+/// Return histogram bucket for the value.
+unsigned GetBucketIndex(unsigned long long value)
+{
+    unsigned index = 0;
+    while (value != 0 && index + 1 < MetricSnapshot::NumBuckets)
+    {
+        value >>= 1;
+        ++index;
+    }
+    return index;
+}
+
+/// Add sample to the slot.
+void RecordSample(MetricSlot& slot, unsigned long long value)
+{
+    Increment(slot.count_, 1);
+    Increment(slot.sum_, value);
+    if (value < slot.min_.load(std::memory_order_relaxed))
+        slot.min_.store(value, std::memory_order_relaxed);
+    if (value > slot.max_.load(std::memory_order_relaxed))
+        slot.max_.store(value, std::memory_order_relaxed);
+    Increment(slot.buckets_[GetBucketIndex(value)], 1);
+}
+
+/// Add samples from one slot to another and reset source slot.
+void MoveSamples(MetricSlot& dest, MetricSlot& source)
+{
+    const unsigned long long count = source.count_.load(std::memory_order_relaxed);
+    if (count == 0)
+        return;
+
+    Increment(dest.count_, count);
+    Increment(dest.sum_, source.sum_.load(std::memory_order_relaxed));
+    dest.min_.store(ea::min(dest.min_.load(std::memory_order_relaxed), source.min_.load(std::memory_order_relaxed)),
+        std::memory_order_relaxed);
+    dest.max_.store(ea::max(dest.max_.load(std::memory_order_relaxed), source.max_.load(std::memory_order_relaxed)),
+        std::memory_order_relaxed);
+    for (unsigned i = 0; i < MetricSnapshot::NumBuckets; ++i)
+    {
+        Increment(dest.buckets_[i], source.buckets_[i].load(std::memory_order_relaxed));
+        source.buckets_[i].store(0, std::memory_order_relaxed);
+    }
+
+    source.count_.store(0, std::memory_order_relaxed);
+    source.sum_.store(0, std::memory_order_relaxed);
+    source.min_.store(ea::numeric_limits<unsigned long long>::max(), std::memory_order_relaxed);
+    source.max_.store(0, std::memory_order_relaxed);
+}
+
+}
+
+struct MetricsRegistry::Impl
+{
+    /// Return shard for the thread slot. Only the owner thread creates its shard, so there's no race.
+    MetricsShard* GetThreadShard(unsigned slot)
+    {
+        MetricsShard* shard = shards_[slot].load(std::memory_order_relaxed);
+        if (!shard)
+        {
+            shard = new MetricsShard();
+            shards_[slot].store(shard, std::memory_order_release);
+        }
+        return shard;
+    }
+
+    /// Move samples of the exiting thread to the retired shard. Shard itself is reused by the next owner of the slot.
+    void RetireThreadShard(unsigned slot)
+    {
+        if (slot >= MaxThreadShards)
+            return;
+
+        MetricsShard* shard = shards_[slot].load(std::memory_order_relaxed);
+        if (!shard)
+            return;
+
+        MutexLock lock(mutex_);
+        for (unsigned id = 0; id < MaxMetrics; ++id)
+            MoveSamples(retiredShard_.slots_[id], shard->slots_[id]);
+    }
+
+    /// Mutex that protects registration, shard creation and retired shard.
+    Mutex mutex_;
+    /// Names of metrics.
+    ea::string names_[MaxMetrics];
+    /// Types of metrics.
+    MetricType types_[MaxMetrics]{};
+    /// Shards indexed by thread slot.
+    std::atomic<MetricsShard*> shards_[MaxThreadShards]{};
+    /// Samples of exited threads and threads without own shard.
+    MetricsShard retiredShard_;
+};
+
+unsigned long long MetricSnapshot::GetPercentile(float percentile) const
+{
+    if (count_ == 0 || buckets_.empty())
+        return 0;
+
+    const auto threshold = static_cast<unsigned long long>(ea::max(0.0f, percentile) * count_);
+    unsigned long long numSamples = 0;
+    for (unsigned i = 0; i < buckets_.size(); ++i)
+    {
+        numSamples += buckets_[i];
+        if (numSamples > threshold || numSamples == count_)
+        {
+            // Last bucket is unbounded
+            if (i + 1 == buckets_.size())
+                return max_;
+            const unsigned long long bucketMax = i == 0 ? 0 : (1ull << i) - 1;
+            return ea::min(bucketMax, max_);
+        }
+    }
+    return max_;
+}
+
+void MetricSnapshot::SerializeInBlock(Archive& archive)
+{
+    SerializeValue(archive, "name", name_);
+    SerializeEnum(archive, "type", type_, metricTypeNames);
+    SerializeValue(archive, "count", count_);
+    SerializeValue(archive, "sum", sum_);
+    SerializeValue(archive, "min", min_);
+    SerializeValue(archive, "max", max_);
+    if (type_ != MetricType::Counter)
+        SerializeVector(archive, "buckets", buckets_, "bucket");
+}
+
+const MetricSnapshot* MetricsSnapshot::FindMetric(ea::string_view name) const
+{
+    const auto iter = ea::find_if(metrics_.begin(), metrics_.end(),
+        [&](const MetricSnapshot& metric) { return metric.name_ == name; });
+    return iter != metrics_.end() ? &*iter : nullptr;
+}
+
+void MetricsSnapshot::SerializeInBlock(Archive& archive)
+{
+    SerializeVectorAsObjects(archive, "metrics", metrics_, "metric");
+}
+
+MetricsRegistry& MetricsRegistry::Get()
+{
+    static MetricsRegistry registry;
+    return registry;
+}
+
+MetricsRegistry::MetricsRegistry()
+    : impl_(new Impl)
+{
+    ThreadSlot::AddReleaseCallback(impl_, [](void* impl, unsigned slot)
+    {
+        static_cast<Impl*>(impl)->RetireThreadShard(slot);
+    });
+}
+
+MetricsRegistry::~MetricsRegistry()
+{
+    ThreadSlot::RemoveReleaseCallback(impl_);
+
+    for (auto& shardPtr : impl_->shards_)
+        delete shardPtr.load(std::memory_order_acquire);
+    delete impl_;
+}
+
+MetricId MetricsRegistry::RegisterMetric(const ea::string& name, MetricType type)
+{
+    MutexLock lock(impl_->mutex_);
+
+    const unsigned numMetrics = numMetrics_.load(std::memory_order_relaxed);
+    for (unsigned id = 0; id < numMetrics; ++id)
+    {
+        if (impl_->names_[id] == name)
+        {
+            URHO3D_ASSERT(impl_->types_[id] == type, "Metric is already registered with different type");
+            return id;
+        }
+    }
+
+    if (numMetrics >= MaxMetrics)
+    {
+        URHO3D_LOGERROR("Cannot register metric '{}': too many metrics", name);
+        return InvalidMetric;
+    }
+
+    impl_->names_[numMetrics] = name;
+    impl_->types_[numMetrics] = type;
+    numMetrics_.store(numMetrics + 1, std::memory_order_release);
+    return numMetrics;
+}
+
+void MetricsRegistry::Record(MetricId id, unsigned long long value)
+{
+    if (id >= MaxMetrics || !IsEnabled())
+        return;
+
+    const unsigned threadSlot = ThreadSlot::GetCurrent();
+    if (threadSlot >= MaxThreadShards)
+    {
+        MutexLock lock(impl_->mutex_);
+        RecordSample(impl_->retiredShard_.slots_[id], value);
+        return;
+    }
+
+    RecordSample(impl_->GetThreadShard(threadSlot)->slots_[id], value);
+}
+
+unsigned MetricsRegistry::GetNumShards() const
+{
+    unsigned result = 0;
+    for (const auto& shardPtr : impl_->shards_)
+    {
+        if (shardPtr.load(std::memory_order_relaxed))
+            ++result;
+    }
+    return result;
+}
+
+MetricsSnapshot MetricsRegistry::TakeSnapshot() const
+{
+    MutexLock lock(impl_->mutex_);
+
+    MetricsSnapshot result;
+    const unsigned numMetrics = numMetrics_.load(std::memory_order_relaxed);
+    result.metrics_.resize(numMetrics);
+    for (unsigned id = 0; id < numMetrics; ++id)
+    {
+        MetricSnapshot& metric = result.metrics_[id];
+        metric.name_ = impl_->names_[id];
+        metric.type_ = impl_->types_[id];
+        metric.min_ = ea::numeric_limits<unsigned long long>::max();
+        if (metric.type_ != MetricType::Counter)
+            metric.buckets_.resize(MetricSnapshot::NumBuckets);
+
+        const auto addSamples = [&](const MetricSlot& slot)
+        {
+            const unsigned long long count = slot.count_.load(std::memory_order_relaxed);
+            if (count == 0)
+                return;
+
+            metric.count_ += count;
+            metric.sum_ += slot.sum_.load(std::memory_order_relaxed);
+            metric.min_ = ea::min(metric.min_, slot.min_.load(std::memory_order_relaxed));
+            metric.max_ = ea::max(metric.max_, slot.max_.load(std::memory_order_relaxed));
+            for (unsigned i = 0; i < metric.buckets_.size(); ++i)
+                metric.buckets_[i] += slot.buckets_[i].load(std::memory_order_relaxed);
+        };
+
+        for (const auto& shardPtr : impl_->shards_)
+        {
+            if (const MetricsShard* shard = shardPtr.load(std::memory_order_acquire))
+                addSamples(shard->slots_[id]);
+        }
+        addSamples(impl_->retiredShard_.slots_[id]);
+
+        if (metric.count_ == 0)
+            metric.min_ = 0;
+    }
+    return result;
+}
+
+}
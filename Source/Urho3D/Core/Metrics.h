@@ -0,0 +1,182 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Container/Str.h"
+#include "../Core/Macros.h"
+#include "../Core/NonCopyable.h"
+
+#include <Urho3D/Urho3D.h>
+
+#include <EASTL/vector.h>
+
+#include <atomic>
+#include <chrono>
+
+namespace Urho3D
+{
+
+class Archive;
+
+/// Type of metric.
+enum class MetricType
+{
+    /// Monotonic counter. Samples are added together.
+    Counter,
+    /// Duration of scope in nanoseconds.
+    Timer,
+    /// Distribution of arbitrary non-negative values.
+    Histogram,
+};
+
+/// Index of metric in registry.
+using MetricId = unsigned;
+
+/// Aggregated state of metric.
+struct URHO3D_API MetricSnapshot
+{
+    /// Number of histogram buckets. Bucket N contains samples in range [2^(N-1), 2^N), bucket 0 contains zeros.
+    static const unsigned NumBuckets = 32;
+
+    /// Name of metric.
+    ea::string name_;
+    /// Type of metric.
+    MetricType type_{};
+    /// Number of recorded samples.
+    unsigned long long count_{};
+    /// Sum of recorded samples.
+    unsigned long long sum_{};
+    /// Minimum recorded sample.
+    unsigned long long min_{};
+    /// Maximum recorded sample.
+    unsigned long long max_{};
+    /// Histogram buckets. Empty for counters.
+    ea::vector<unsigned long long> buckets_;
+
+    /// Return average sample.
+    double GetAverage() const { return count_ ? static_cast<double>(sum_) / count_ : 0.0; }
+    /// Return approximate percentile (0..1) estimated from histogram buckets.
+    unsigned long long GetPercentile(float percentile) const;
+    /// Serialize metric.
+    void SerializeInBlock(Archive& archive);
+};
+
+/// Aggregated state of all metrics.
+struct URHO3D_API MetricsSnapshot
+{
+    /// Metrics.
+    ea::vector<MetricSnapshot> metrics_;
+
+    /// Return metric by name.
+    const MetricSnapshot* FindMetric(ea::string_view name) const;
+    /// Serialize metrics.
+    void SerializeInBlock(Archive& archive);
+};
+
+/// Registry of lightweight metrics that don't depend on the profiler.
+/// Each thread writes samples to its own shard without synchronization, shards are merged on snapshot.
+/// Shards are indexed by ThreadSlot: samples of exited thread are moved to retired shard and its shard is reused.
+class URHO3D_API MetricsRegistry : private NonCopyable
+{
+public:
+    /// Maximum number of metrics.
+    static const unsigned MaxMetrics = 256;
+    /// Maximum number of per-thread shards. Threads with higher slots write to retired shard under lock.
+    static const unsigned MaxThreadShards = 64;
+    /// Invalid metric identifier.
+    static const MetricId InvalidMetric = 0xffffffff;
+
+    /// Return global registry.
+    static MetricsRegistry& Get();
+
+    /// Register metric or return existing metric with the same name.
+    MetricId RegisterMetric(const ea::string& name, MetricType type);
+    /// Record sample from any thread.
+    void Record(MetricId id, unsigned long long value);
+    /// Set whether the metrics are recorded.
+    void SetEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+
+    /// Return whether the metrics are recorded.
+    bool IsEnabled() const { return enabled_.load(std::memory_order_relaxed); }
+    /// Return number of registered metrics.
+    unsigned GetNumMetrics() const { return numMetrics_.load(std::memory_order_acquire); }
+    /// Return aggregated state of all metrics.
+    MetricsSnapshot TakeSnapshot() const;
+    /// Return number of allocated per-thread shards.
+    unsigned GetNumShards() const;
+
+private:
+    MetricsRegistry();
+    ~MetricsRegistry();
+
+    struct Impl;
+
+    /// Implementation.
+    Impl* impl_{};
+    /// Number of registered metrics.
+    std::atomic<unsigned> numMetrics_{};
+    /// Whether the metrics are recorded.
+    std::atomic<bool> enabled_{true};
+};
+
+/// Records execution time of the scope.
+class ScopedMetricTimer : private NonCopyable
+{
+public:
+    /// Construct and start timer.
+    explicit ScopedMetricTimer(MetricId id)
+        : id_(MetricsRegistry::Get().IsEnabled() ? id : MetricsRegistry::InvalidMetric)
+    {
+        if (id_ != MetricsRegistry::InvalidMetric)
+            startTime_ = std::chrono::steady_clock::now();
+    }
+
+    /// Destruct and record elapsed time.
+    ~ScopedMetricTimer()
+    {
+        if (id_ != MetricsRegistry::InvalidMetric)
+        {
+            const auto duration = std::chrono::steady_clock::now() - startTime_;
+            const auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+            MetricsRegistry::Get().Record(id_, static_cast<unsigned long long>(nanoseconds));
+        }
+    }
+
+private:
+    /// Metric.
+    const MetricId id_{};
+    /// Time when scope was entered.
+    std::chrono::steady_clock::time_point startTime_;
+};
+
+}
+
+#define URHO3D_METRIC_ID(name, type) \
+    [] { static const Urho3D::MetricId id = Urho3D::MetricsRegistry::Get().RegisterMetric(name, type); return id; }()
+
+#define URHO3D_METRIC_TIMER(name) \
+    const Urho3D::ScopedMetricTimer CONCATENATE(metricTimer, __LINE__){URHO3D_METRIC_ID(name, Urho3D::MetricType::Timer)}
+#define URHO3D_METRIC_COUNTER(name, value) \
+    Urho3D::MetricsRegistry::Get().Record(URHO3D_METRIC_ID(name, Urho3D::MetricType::Counter), value)
+#define URHO3D_METRIC_HISTOGRAM(name, value) \
+    Urho3D::MetricsRegistry::Get().Record(URHO3D_METRIC_ID(name, Urho3D::MetricType::Histogram), value)
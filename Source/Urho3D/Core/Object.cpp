@@ -442,6 +442,16 @@ bool Object::HasSubscribedToEvent(Object* sender, StringHash eventType) const
         return FindSpecificEventHandler(sender, eventType) != eventHandlers_.end();
 }
 
+bool Object::HasEventReceivers(StringHash eventType) const
+{
+    EventReceiverGroup* group = context_->GetEventReceivers(const_cast<Object*>(this), eventType);
+    if (group && !group->receivers_.empty())
+        return true;
+
+    EventReceiverGroup* groupNonSpec = context_->GetEventReceivers(eventType);
+    return groupNonSpec && !groupNonSpec->receivers_.empty();
+}
+
 const ea::string& Object::GetCategory() const
 {
     const ea::unordered_map<ea::string, ea::vector<StringHash> >& objectCategories = context_->GetObjectCategories();
@@ -145,7 +145,7 @@ public:
     /// Unsubscribe from a specific sender's events.
     void UnsubscribeFromEvents(Object* sender);
     /// Unsubscribe from all events.
-    void UnsubscribeFromAllEvents();
+    virtual void UnsubscribeFromAllEvents();
     /// Unsubscribe from all events except those listed, and optionally only those with userdata (script registered events).
     void UnsubscribeFromAllEventsExcept(const ea::vector<StringHash>& exceptions, bool onlyUserData);
     /// Unsubscribe from all events except those with listed senders, and optionally only those with userdata (script registered events.)
@@ -186,6 +186,9 @@ public:
     /// Return whether has subscribed to a specific sender's event.
     bool HasSubscribedToEvent(Object* sender, StringHash eventType) const;
 
+    /// Return whether there are VariantMap event receivers for event of this sender.
+    bool HasEventReceivers(StringHash eventType) const;
+
     /// Return whether has subscribed to any event.
     bool HasEventHandlers() const { return !eventHandlers_.empty(); }
 
@@ -25,6 +25,7 @@
 #include "../Core/Attribute.h"
 #include "../Core/Signal.h"
 #include "../Container/Ptr.h"
+#include "../Container/StringHashMap.h"
 
 #include <EASTL/functional.h>
 #include <EASTL/type_traits.h>
@@ -149,7 +150,7 @@ public:
     SharedPtr<Object> CreateObject(StringHash typeNameHash);
 
     /// Return reflections of all objects.
-    const ea::unordered_map<StringHash, SharedPtr<ObjectReflection>>& GetObjectReflections() const { return reflections_; }
+    const StringHashMap<SharedPtr<ObjectReflection>>& GetObjectReflections() const { return reflections_; }
     /// Return categories of reflected objects.
     const ea::unordered_map<ea::string, ea::vector<StringHash>>& GetObjectCategories() const { return categories_; }
 
@@ -163,7 +164,7 @@ private:
 
     Context* context_{};
 
-    ea::unordered_map<StringHash, SharedPtr<ObjectReflection>> reflections_;
+    StringHashMap<SharedPtr<ObjectReflection>> reflections_;
     ea::unordered_map<ea::string, ea::vector<StringHash>> categories_;
 };
 
@@ -0,0 +1,170 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Core/WorkQueue.h"
+
+#include <EASTL/array.h>
+#include <EASTL/sort.h>
+#include <EASTL/span.h>
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+/// Stable least significant digit radix sort of elements by 64-bit key.
+/// Big arrays are split into chunks and sorted in worker threads.
+/// Temporary buffers are kept between calls to avoid reallocations.
+template <class T>
+class RadixSorter
+{
+public:
+    /// Number of bits sorted per pass.
+    static constexpr unsigned DigitBits = 8;
+    /// Number of buckets per pass.
+    static constexpr unsigned NumBuckets = 1u << DigitBits;
+    /// Number of passes for 64-bit key.
+    static constexpr unsigned NumDigits = 64 / DigitBits;
+    /// Arrays not bigger than this are sorted with insertion sort.
+    static constexpr unsigned MaxInsertionSortSize = 64;
+    /// Minimal number of elements processed by one thread.
+    static constexpr unsigned MinChunkSize = 4096;
+
+    /// Sort elements by key. Order of elements with equal keys is preserved.
+    /// Signature of getKey: unsigned long long(const T& element)
+    template <class KeyGetter>
+    void Sort(WorkQueue* workQueue, ea::span<T> elements, const KeyGetter& getKey)
+    {
+        const unsigned size = elements.size();
+        if (size <= MaxInsertionSortSize)
+        {
+            ea::insertion_sort(elements.begin(), elements.end(),
+                [&](const T& lhs, const T& rhs) { return getKey(lhs) < getKey(rhs); });
+            return;
+        }
+
+        const unsigned maxChunks = workQueue ? workQueue->GetNumThreads() + 1 : 1;
+        const unsigned numChunks = ea::max(1u, ea::min(size / MinChunkSize, maxChunks));
+        const unsigned chunkSize = (size + numChunks - 1) / numChunks;
+
+        buffer_.resize(size);
+        histograms_.resize(numChunks * NumDigits);
+
+        // Count all digits at once to skip digits that are equal for all elements
+        ForEachParallel(workQueue, chunkSize, size, [&](unsigned beginIndex, unsigned endIndex)
+        {
+            Histogram* histograms = &histograms_[beginIndex / chunkSize * NumDigits];
+            for (unsigned digit = 0; digit < NumDigits; ++digit)
+                histograms[digit].fill(0);
+
+            for (unsigned i = beginIndex; i < endIndex; ++i)
+            {
+                const unsigned long long key = getKey(elements[i]);
+                for (unsigned digit = 0; digit < NumDigits; ++digit)
+                    ++histograms[digit][GetDigit(key, digit)];
+            }
+        });
+
+        T* source = elements.data();
+        T* destination = buffer_.data();
+        bool isFirstPass = true;
+        for (unsigned digit = 0; digit < NumDigits; ++digit)
+        {
+            if (IsDigitConstant(digit, numChunks, size))
+                continue;
+
+            // Histograms of the first pass are still valid, recount the rest after elements are moved
+            if (!isFirstPass)
+            {
+                ForEachParallel(workQueue, chunkSize, size, [&](unsigned beginIndex, unsigned endIndex)
+                {
+                    Histogram& histogram = histograms_[beginIndex / chunkSize * NumDigits + digit];
+                    histogram.fill(0);
+                    for (unsigned i = beginIndex; i < endIndex; ++i)
+                        ++histogram[GetDigit(getKey(source[i]), digit)];
+                });
+            }
+            isFirstPass = false;
+
+            // Convert counts to output offsets, chunks are ordered within each bucket to keep sort stable
+            unsigned offset = 0;
+            for (unsigned bucket = 0; bucket < NumBuckets; ++bucket)
+            {
+                for (unsigned chunk = 0; chunk < numChunks; ++chunk)
+                {
+                    unsigned& count = histograms_[chunk * NumDigits + digit][bucket];
+                    const unsigned bucketSize = count;
+                    count = offset;
+                    offset += bucketSize;
+                }
+            }
+
+            ForEachParallel(workQueue, chunkSize, size, [&](unsigned beginIndex, unsigned endIndex)
+            {
+                Histogram& offsets = histograms_[beginIndex / chunkSize * NumDigits + digit];
+                for (unsigned i = beginIndex; i < endIndex; ++i)
+                {
+                    const unsigned bucket = GetDigit(getKey(source[i]), digit);
+                    destination[offsets[bucket]++] = ea::move(source[i]);
+                }
+            });
+
+            ea::swap(source, destination);
+        }
+
+        if (source != elements.data())
+            ea::move(source, source + size, elements.data());
+    }
+
+private:
+    using Histogram = ea::array<unsigned, NumBuckets>;
+
+    /// Return digit of the key.
+    static unsigned GetDigit(unsigned long long key, unsigned digit)
+    {
+        return static_cast<unsigned>(key >> (digit * DigitBits)) & (NumBuckets - 1);
+    }
+
+    /// Return whether all elements have the same value of the digit. Valid only for initial histograms.
+    bool IsDigitConstant(unsigned digit, unsigned numChunks, unsigned size) const
+    {
+        for (unsigned bucket = 0; bucket < NumBuckets; ++bucket)
+        {
+            unsigned total = 0;
+            for (unsigned chunk = 0; chunk < numChunks; ++chunk)
+                total += histograms_[chunk * NumDigits + digit][bucket];
+            if (total == size)
+                return true;
+            if (total != 0)
+                return false;
+        }
+        return false;
+    }
+
+    /// Temporary storage for elements.
+    ea::vector<T> buffer_;
+    /// Histograms for each chunk and digit.
+    ea::vector<Histogram> histograms_;
+};
+
+}
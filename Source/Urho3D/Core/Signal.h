@@ -114,6 +114,12 @@ public:
                 subscription.receiver_ = nullptr;
         }
 
+        for (Subscription& subscription : pendingSubscriptions_)
+        {
+            if (subscription.receiver_ == receiver)
+                subscription.receiver_ = nullptr;
+        }
+
         if (!invocationInProgress_)
             RemoveExpiredElements();
     }
@@ -144,12 +150,37 @@ public:
 
         if (hasExpiredElements)
             RemoveExpiredElements();
+
+        if (!pendingSubscriptions_.empty())
+            CommitPendingSubscriptions();
     }
 
     /// Returns true when event has at least one subscription.
-    bool HasSubscriptions() const { return !subscriptions_.empty(); }
+    bool HasSubscriptions() const { return !subscriptions_.empty() || !pendingSubscriptions_.empty(); }
 
 protected:
+    /// Add subscription. Subscriptions added during invocation are not invoked until the next invocation.
+    void AddSubscription(Subscription subscription)
+    {
+        if (invocationInProgress_)
+            pendingSubscriptions_.push_back(ea::move(subscription));
+        else if constexpr (HasPriority)
+            subscriptions_.insert(ea::move(subscription));
+        else
+            subscriptions_.push_back(ea::move(subscription));
+    }
+
+    /// Move subscriptions added during invocation to the main collection.
+    void CommitPendingSubscriptions()
+    {
+        for (Subscription& subscription : pendingSubscriptions_)
+        {
+            if (subscription.receiver_)
+                AddSubscription(ea::move(subscription));
+        }
+        pendingSubscriptions_.clear();
+    }
+
     void RemoveExpiredElements()
     {
         assert(!invocationInProgress_);
@@ -235,6 +266,8 @@ protected:
 
     /// Vector of subscriptions. May contain expired elements.
     SubscriptionVector subscriptions_;
+    /// Subscriptions added during invocation. Handlers stored in subscriptions_ should not move while they are invoked.
+    ea::vector<Subscription> pendingSubscriptions_;
     /// Whether the invocation is in progress. If true, cannot execute RemoveExpiredElements().
     bool invocationInProgress_{};
 };
@@ -255,7 +288,7 @@ public:
     {
         WeakPtr<RefCounted> weakReceiver(static_cast<RefCounted*>(receiver));
         auto wrappedHandler = this->template WrapHandler<Receiver>(handler);
-        this->subscriptions_.emplace_back(ea::move(weakReceiver), ea::move(wrappedHandler));
+        this->AddSubscription({ea::move(weakReceiver), ea::move(wrappedHandler)});
     }
 
     /// Subscribe to event. Callback receives sender and signal arguments.
@@ -264,7 +297,7 @@ public:
     {
         WeakPtr<RefCounted> weakReceiver(static_cast<RefCounted*>(receiver));
         auto wrappedHandler = this->template WrapHandlerWithSender<Receiver>(handler);
-        this->subscriptions_.emplace_back(ea::move(weakReceiver), ea::move(wrappedHandler));
+        this->AddSubscription({ea::move(weakReceiver), ea::move(wrappedHandler)});
     }
 };
 
@@ -282,7 +315,7 @@ public:
     {
         WeakPtr<RefCounted> weakReceiver(static_cast<RefCounted*>(receiver));
         auto wrappedHandler = this->template WrapHandler<Receiver>(handler);
-        this->subscriptions_.emplace(ea::move(weakReceiver), priority, ea::move(wrappedHandler));
+        this->AddSubscription({ea::move(weakReceiver), priority, ea::move(wrappedHandler)});
     }
 
     /// Subscribe to event. Callback receives sender and signal arguments.
@@ -291,7 +324,7 @@ public:
     {
         WeakPtr<RefCounted> weakReceiver(static_cast<RefCounted*>(receiver));
         auto wrappedHandler = this->template WrapHandlerWithSender<Receiver>(handler);
-        this->subscriptions_.emplace(ea::move(weakReceiver), priority, ea::move(wrappedHandler));
+        this->AddSubscription({ea::move(weakReceiver), priority, ea::move(wrappedHandler)});
     }
 };
 
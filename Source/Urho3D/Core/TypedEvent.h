@@ -0,0 +1,93 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Core/Object.h"
+#include "../Core/Signal.h"
+
+namespace Urho3D
+{
+
+/// Declare typed event payload. Should be used inside payload struct.
+/// Payload struct should also implement `void ToVariantMap(VariantMap& eventData) const` for VariantMap subscribers.
+#define URHO3D_TYPED_EVENT(eventID) \
+    static Urho3D::StringHash GetEventType() { return eventID; }
+
+/// Typed event sent by specific object. Signal with struct payload, bridged to VariantMap events.
+/// Typed receivers are invoked first. VariantMap subscribers of the same event type are notified after them,
+/// and the VariantMap payload is built only if there are any.
+/// Receivers added during sending are not notified until the next event.
+template <class T>
+class TypedEvent : private Signal<void(const T&), Object>
+{
+public:
+    using Base = Signal<void(const T&), Object>;
+    using Base::HasSubscriptions;
+    using Base::Unsubscribe;
+
+    /// Construct.
+    explicit TypedEvent(Object* sender) : sender_(sender) {}
+
+    /// Subscribe to event. Callback is either member function of receiver or callable that accepts payload.
+    /// Receiver is unsubscribed automatically when expired.
+    /// Member functions of Object receivers are not invoked while the receiver blocks events.
+    template <class Receiver, class Callback>
+    void Subscribe(Receiver* receiver, Callback callback)
+    {
+        if constexpr (ea::is_member_function_pointer_v<Callback> && ea::is_base_of_v<Object, Receiver>)
+        {
+            Base::Subscribe(receiver, [callback](Receiver* receiver, const T& payload)
+            {
+                if (!receiver->GetBlockEvents())
+                    (receiver->*callback)(payload);
+            });
+        }
+        else
+            Base::Subscribe(receiver, ea::move(callback));
+    }
+
+    /// Send event to typed receivers, then to VariantMap receivers if any. Should be called from main thread.
+    void Send(const T& payload)
+    {
+        if (sender_->GetBlockEvents())
+            return;
+
+        (*this)(sender_, payload);
+
+        if (sender_->HasEventReceivers(T::GetEventType()))
+        {
+            VariantMap& eventData = sender_->GetEventDataMap();
+            payload.ToVariantMap(eventData);
+            sender_->SendEvent(T::GetEventType(), eventData);
+        }
+    }
+
+    /// Return number of subscriptions, including expired ones.
+    unsigned GetNumSubscriptions() const { return this->subscriptions_.size() + this->pendingSubscriptions_.size(); }
+
+private:
+    /// Event sender.
+    Object* sender_{};
+};
+
+}
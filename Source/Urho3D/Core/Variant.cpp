@@ -125,11 +125,11 @@ Variant& Variant::operator =(const Variant& rhs)
         break;
 
     case VAR_MATRIX3:
-        *value_.matrix3_ = *rhs.value_.matrix3_;
+        value_.matrix3_ = rhs.value_.matrix3_;
         break;
 
     case VAR_MATRIX3X4:
-        *value_.matrix3x4_ = *rhs.value_.matrix3x4_;
+        value_.matrix3x4_ = rhs.value_.matrix3x4_;
         break;
 
     case VAR_MATRIX4:
@@ -152,6 +152,80 @@ Variant& Variant::operator =(const Variant& rhs)
     return *this;
 }
 
+Variant& Variant::operator =(Variant&& rhs) noexcept
+{
+    if (this == &rhs)
+        return *this;
+
+    switch (rhs.type_)
+    {
+    case VAR_CUSTOM:
+        // Assign value in place if types match
+        if (CustomVariantValue* thisValue = GetCustomVariantValuePtr())
+        {
+            if (rhs.value_.AsCustomValue().CopyTo(*thisValue))
+                break;
+        }
+        SetType(VAR_CUSTOM);
+        value_.AsCustomValue().~CustomVariantValue();
+        rhs.value_.AsCustomValue().MoveTo(value_.storage_);
+        break;
+
+    case VAR_STRING:
+        SetType(VAR_STRING);
+        value_.string_ = ea::move(rhs.value_.string_);
+        break;
+
+    case VAR_BUFFER:
+        SetType(VAR_BUFFER);
+        value_.buffer_ = ea::move(rhs.value_.buffer_);
+        break;
+
+    case VAR_RESOURCEREF:
+        SetType(VAR_RESOURCEREF);
+        value_.resourceRef_ = ea::move(rhs.value_.resourceRef_);
+        break;
+
+    case VAR_RESOURCEREFLIST:
+        SetType(VAR_RESOURCEREFLIST);
+        value_.resourceRefList_ = ea::move(rhs.value_.resourceRefList_);
+        break;
+
+    case VAR_VARIANTVECTOR:
+        SetType(VAR_VARIANTVECTOR);
+        value_.variantVector_ = ea::move(rhs.value_.variantVector_);
+        break;
+
+    case VAR_STRINGVECTOR:
+        SetType(VAR_STRINGVECTOR);
+        value_.stringVector_ = ea::move(rhs.value_.stringVector_);
+        break;
+
+    case VAR_PTR:
+        SetType(VAR_PTR);
+        value_.weakPtr_ = ea::move(rhs.value_.weakPtr_);
+        break;
+
+    case VAR_VARIANTMAP:
+    case VAR_MATRIX4:
+    case VAR_VARIANTCURVE:
+    case VAR_STRINGVARIANTMAP:
+        // Steal heap-allocated value
+        SetType(VAR_NONE);
+        memcpy(&value_, &rhs.value_, sizeof(VariantValue));     // NOLINT(bugprone-undefined-memory-manipulation)
+        type_ = rhs.type_;
+        rhs.type_ = VAR_NONE;
+        break;
+
+    default:
+        SetType(rhs.type_);
+        memcpy(&value_, &rhs.value_, sizeof(VariantValue));     // NOLINT(bugprone-undefined-memory-manipulation)
+        break;
+    }
+
+    return *this;
+}
+
 Variant& Variant::operator =(const VectorBuffer& rhs)
 {
     SetType(VAR_BUFFER);
@@ -235,10 +309,10 @@ bool Variant::operator ==(const Variant& rhs) const
         return value_.intVector3_ == rhs.value_.intVector3_;
 
     case VAR_MATRIX3:
-        return *value_.matrix3_ == *rhs.value_.matrix3_;
+        return value_.matrix3_ == rhs.value_.matrix3_;
 
     case VAR_MATRIX3X4:
-        return *value_.matrix3x4_ == *rhs.value_.matrix3x4_;
+        return value_.matrix3x4_ == rhs.value_.matrix3x4_;
 
     case VAR_MATRIX4:
         return *value_.matrix4_ == *rhs.value_.matrix4_;
@@ -628,10 +702,10 @@ ea::string Variant::ToString() const
         return value_.intVector3_.ToString();
 
     case VAR_MATRIX3:
-        return value_.matrix3_->ToString();
+        return value_.matrix3_.ToString();
 
     case VAR_MATRIX3X4:
-        return value_.matrix3x4_->ToString();
+        return value_.matrix3x4_.ToString();
 
     case VAR_MATRIX4:
         return value_.matrix4_->ToString();
@@ -730,10 +804,10 @@ bool Variant::IsZero() const
         return value_.weakPtr_ == nullptr;
 
     case VAR_MATRIX3:
-        return *value_.matrix3_ == Matrix3::IDENTITY;
+        return value_.matrix3_ == Matrix3::IDENTITY;
 
     case VAR_MATRIX3X4:
-        return *value_.matrix3x4_ == Matrix3x4::IDENTITY;
+        return value_.matrix3x4_ == Matrix3x4::IDENTITY;
 
     case VAR_MATRIX4:
         return *value_.matrix4_ == Matrix4::IDENTITY;
@@ -797,14 +871,6 @@ void Variant::SetType(VariantType newType)
         value_.weakPtr_.~WeakPtr<RefCounted>();
         break;
 
-    case VAR_MATRIX3:
-        delete value_.matrix3_;
-        break;
-
-    case VAR_MATRIX3X4:
-        delete value_.matrix3x4_;
-        break;
-
     case VAR_MATRIX4:
         delete value_.matrix4_;
         break;
@@ -862,11 +928,11 @@ void Variant::SetType(VariantType newType)
         break;
 
     case VAR_MATRIX3:
-        value_.matrix3_ = new Matrix3();
+        new(&value_.matrix3_) Matrix3();
         break;
 
     case VAR_MATRIX3X4:
-        value_.matrix3x4_ = new Matrix3x4();
+        new(&value_.matrix3x4_) Matrix3x4();
         break;
 
     case VAR_MATRIX4:
@@ -233,6 +233,8 @@ public:
     virtual bool CopyTo(CustomVariantValue& dest) const { return false; }
     /// Clone object over destination.
     virtual void CloneTo(void* dest) const { }
+    /// Move object over destination. Source object stays in valid but unspecified state.
+    virtual void MoveTo(void* dest) { CloneTo(dest); }
     /// Get size.
     virtual unsigned GetSize() const { return sizeof(CustomVariantValue); }
 
@@ -347,6 +349,12 @@ public:
     {
         Traits::Copy(value_, value);
     }
+    /// Construct from temporary value.
+    explicit CustomVariantValueImpl(T&& value)
+        : CustomVariantValue(typeid(T))
+        , value_(ea::move(value))
+    {
+    }
     /// Get value.
     T& GetValue() { return value_; }
     /// Get const value.
@@ -364,6 +372,8 @@ public:
     }
     /// Clone object over destination.
     void CloneTo(void* dest) const override { new (dest) ClassName(value_); }
+    /// Move object over destination.
+    void MoveTo(void* dest) override { new (dest) ClassName(ea::move(value_)); }
     /// Get size.
     unsigned GetSize() const override { return sizeof(ClassName); }
 
@@ -385,13 +395,14 @@ private:
     T value_;
 };
 
-/// Size of variant value. 16 bytes on 32-bit platform, 32 bytes on 64-bit platform.
-static const unsigned VARIANT_VALUE_SIZE = sizeof(void*) * 4;
+/// Size of variant value. Fits Matrix3x4 or four pointers, whichever is bigger.
+static const unsigned VARIANT_VALUE_SIZE = sizeof(Matrix3x4) > sizeof(void*) * 4 ? sizeof(Matrix3x4) : sizeof(void*) * 4;
 
 /// Checks whether the custom variant type could be stored on stack.
 template <class T> constexpr bool IsCustomTypeOnStack() { return sizeof(CustomVariantValueImpl<T>) <= VARIANT_VALUE_SIZE; }
 
 /// Union for the possible variant values. Objects exceeding the VARIANT_VALUE_SIZE are allocated on the heap.
+/// Storage is big enough to keep Matrix3x4 inline. Strings up to 23 characters don't allocate thanks to ea::string SSO.
 union VariantValue
 {
     unsigned char storage_[VARIANT_VALUE_SIZE];
@@ -409,8 +420,8 @@ union VariantValue
     IntVector2 intVector2_;
     IntVector3 intVector3_;
     IntRect intRect_;
-    Matrix3* matrix3_;
-    Matrix3x4* matrix3x4_;
+    Matrix3 matrix3_;
+    Matrix3x4 matrix3x4_;
     Matrix4* matrix4_;
     Quaternion quaternion_;
     Color color_;
@@ -437,7 +448,7 @@ union VariantValue
     const CustomVariantValue& AsCustomValue() const { return *reinterpret_cast<const CustomVariantValue*>(&storage_[0]); }
 };
 
-// TODO: static_assert(sizeof(VariantValue) == VARIANT_VALUE_SIZE, "Unexpected size of VariantValue");
+static_assert(sizeof(VariantValue) == VARIANT_VALUE_SIZE, "Unexpected size of VariantValue");
 static_assert(sizeof(CustomVariantValueImpl<SharedPtr<RefCounted>>) <= VARIANT_VALUE_SIZE, "SharedPtr<> does not fit into variant.");
 
 /// Variable that supports a fixed set of types.
@@ -531,6 +542,12 @@ public:
         *this = value;
     }
 
+    /// Construct from a string. Value is moved.
+    Variant(ea::string&& value)             // NOLINT(google-explicit-constructor)
+    {
+        *this = ea::move(value);
+    }
+
     /// Construct from a C string.
     Variant(const char* value)          // NOLINT(google-explicit-constructor)
     {
@@ -543,6 +560,12 @@ public:
         *this = value;
     }
 
+    /// Construct from a buffer. Value is moved.
+    Variant(VariantBuffer&& value)           // NOLINT(google-explicit-constructor)
+    {
+        *this = ea::move(value);
+    }
+
     /// Construct from a %VectorBuffer and store as a buffer.
     Variant(const VectorBuffer& value)  // NOLINT(google-explicit-constructor)
     {
@@ -573,18 +596,36 @@ public:
         *this = value;
     }
 
+    /// Construct from a variant vector. Value is moved.
+    Variant(VariantVector&& value)      // NOLINT(google-explicit-constructor)
+    {
+        *this = ea::move(value);
+    }
+
     /// Construct from a variant map.
     Variant(const VariantMap& value)    // NOLINT(google-explicit-constructor)
     {
         *this = value;
     }
 
+    /// Construct from a variant map. Value is moved.
+    Variant(VariantMap&& value)         // NOLINT(google-explicit-constructor)
+    {
+        *this = ea::move(value);
+    }
+
     /// Construct from a string vector.
     Variant(const StringVector& value)  // NOLINT(google-explicit-constructor)
     {
         *this = value;
     }
 
+    /// Construct from a string vector. Value is moved.
+    Variant(StringVector&& value)       // NOLINT(google-explicit-constructor)
+    {
+        *this = ea::move(value);
+    }
+
     /// Construct from a rect.
     Variant(const Rect& value)          // NOLINT(google-explicit-constructor)
     {
@@ -678,6 +719,12 @@ public:
         *this = value;
     }
 
+    /// Move-construct from another variant. Source variant is left empty or in moved-from state.
+    Variant(Variant&& value) noexcept
+    {
+        *this = ea::move(value);
+    }
+
     /// Destruct.
     ~Variant()
     {
@@ -692,6 +739,8 @@ public:
 
     /// Assign from another variant.
     Variant& operator =(const Variant& rhs);
+    /// Move-assign from another variant. Source variant is left empty or in moved-from state.
+    Variant& operator =(Variant&& rhs) noexcept;
 
     /// Assign from an integer.
     Variant& operator =(int rhs)
@@ -805,6 +854,14 @@ public:
         return *this;
     }
 
+    /// Assign from a string. Value is moved.
+    Variant& operator =(ea::string&& rhs)
+    {
+        SetType(VAR_STRING);
+        value_.string_ = ea::move(rhs);
+        return *this;
+    }
+
     /// Assign from a C string.
     Variant& operator =(const char* rhs)
     {
@@ -821,6 +878,14 @@ public:
         return *this;
     }
 
+    /// Assign from a buffer. Value is moved.
+    Variant& operator =(VariantBuffer&& rhs)
+    {
+        SetType(VAR_BUFFER);
+        value_.buffer_ = ea::move(rhs);
+        return *this;
+    }
+
     /// Assign from a %VectorBuffer and store as a buffer.
     Variant& operator =(const VectorBuffer& rhs);
 
@@ -856,6 +921,14 @@ public:
         return *this;
     }
 
+    /// Assign from a variant vector. Value is moved.
+    Variant& operator =(VariantVector&& rhs)
+    {
+        SetType(VAR_VARIANTVECTOR);
+        value_.variantVector_ = ea::move(rhs);
+        return *this;
+    }
+
     /// Assign from a string vector.
     Variant& operator =(const StringVector& rhs)
     {
@@ -864,6 +937,14 @@ public:
         return *this;
     }
 
+    /// Assign from a string vector. Value is moved.
+    Variant& operator =(StringVector&& rhs)
+    {
+        SetType(VAR_STRINGVECTOR);
+        value_.stringVector_ = ea::move(rhs);
+        return *this;
+    }
+
     /// Assign from a variant map.
     Variant& operator =(const VariantMap& rhs)
     {
@@ -872,6 +953,14 @@ public:
         return *this;
     }
 
+    /// Assign from a variant map. Value is moved.
+    Variant& operator =(VariantMap&& rhs)
+    {
+        SetType(VAR_VARIANTMAP);
+        *value_.variantMap_ = ea::move(rhs);
+        return *this;
+    }
+
     /// Assign from a rect.
     Variant& operator =(const Rect& rhs)
     {
@@ -916,7 +1005,7 @@ public:
     Variant& operator =(const Matrix3& rhs)
     {
         SetType(VAR_MATRIX3);
-        *value_.matrix3_ = rhs;
+        value_.matrix3_ = rhs;
         return *this;
     }
 
@@ -924,7 +1013,7 @@ public:
     Variant& operator =(const Matrix3x4& rhs)
     {
         SetType(VAR_MATRIX3X4);
-        *value_.matrix3x4_ = rhs;
+        value_.matrix3x4_ = rhs;
         return *this;
     }
 
@@ -1094,13 +1183,13 @@ public:
     /// Test for equality with a Matrix3. To return true, both the type and value must match.
     bool operator ==(const Matrix3& rhs) const
     {
-        return type_ == VAR_MATRIX3 ? *value_.matrix3_ == rhs : false;
+        return type_ == VAR_MATRIX3 ? value_.matrix3_ == rhs : false;
     }
 
     /// Test for equality with a Matrix3x4. To return true, both the type and value must match.
     bool operator ==(const Matrix3x4& rhs) const
     {
-        return type_ == VAR_MATRIX3X4 ? *value_.matrix3x4_ == rhs : false;
+        return type_ == VAR_MATRIX3X4 ? value_.matrix3x4_ == rhs : false;
     }
 
     /// Test for equality with a Matrix4. To return true, both the type and value must match.
@@ -1436,13 +1525,13 @@ public:
     /// Return a Matrix3 or identity on type mismatch.
     const Matrix3& GetMatrix3() const
     {
-        return type_ == VAR_MATRIX3 ? *value_.matrix3_ : Matrix3::IDENTITY;
+        return type_ == VAR_MATRIX3 ? value_.matrix3_ : Matrix3::IDENTITY;
     }
 
     /// Return a Matrix3x4 or identity on type mismatch.
     const Matrix3x4& GetMatrix3x4() const
     {
-        return type_ == VAR_MATRIX3X4 ? *value_.matrix3x4_ : Matrix3x4::IDENTITY;
+        return type_ == VAR_MATRIX3X4 ? value_.matrix3x4_ : Matrix3x4::IDENTITY;
     }
 
     /// Return a Matrix4 or identity on type mismatch.
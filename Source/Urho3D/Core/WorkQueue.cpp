@@ -23,6 +23,7 @@
 #include "../Precompiled.h"
 
 #include "../Core/CoreEvents.h"
+#include "../Core/FrameAllocator.h"
 #include "../Core/ProcessUtils.h"
 #include "../Core/Profiler.h"
 #include "../Core/Thread.h"
@@ -30,6 +31,8 @@
 #include "../Core/WorkQueue.h"
 #include "../IO/Log.h"
 
+#include <EASTL/deque.h>
+
 namespace Urho3D
 {
 
@@ -68,6 +71,48 @@ private:
     unsigned index_;
 };
 
+/// Deque of ready tasks owned by one thread.
+class WorkTaskDeque
+{
+public:
+    /// Push task to the back.
+    void PushBack(SharedPtr<WorkTask> task)
+    {
+        MutexLock<SpinLockMutex> lock(mutex_);
+        tasks_.push_back(ea::move(task));
+    }
+
+    /// Pop task from the back. Used by owner thread.
+    SharedPtr<WorkTask> PopBack()
+    {
+        MutexLock<SpinLockMutex> lock(mutex_);
+        if (tasks_.empty())
+            return nullptr;
+
+        SharedPtr<WorkTask> task = ea::move(tasks_.back());
+        tasks_.pop_back();
+        return task;
+    }
+
+    /// Pop task from the front. Used by other threads.
+    SharedPtr<WorkTask> PopFront()
+    {
+        MutexLock<SpinLockMutex> lock(mutex_);
+        if (tasks_.empty())
+            return nullptr;
+
+        SharedPtr<WorkTask> task = ea::move(tasks_.front());
+        tasks_.pop_front();
+        return task;
+    }
+
+private:
+    /// Mutex. Contention is expected only when threads are stealing tasks.
+    SpinLockMutex mutex_;
+    /// Tasks.
+    ea::deque<SharedPtr<WorkTask>> tasks_;
+};
+
 WorkQueue::WorkQueue(Context* context) :
     Object(context),
     shutDown_(false),
@@ -81,7 +126,10 @@ WorkQueue::WorkQueue(Context* context) :
     currentThreadIndex = 0;
     maxThreadIndex = 1;
     mainThreadTasks_.Clear();
+    taskDeques_.push_back(ea::make_unique<WorkTaskDeque>());
+    frameMemory_.SetNumThreads(maxThreadIndex);
     SubscribeToEvent(E_BEGINFRAME, URHO3D_HANDLER(WorkQueue, HandleBeginFrame));
+    SubscribeToEvent(E_ENDFRAME, URHO3D_HANDLER(WorkQueue, HandleEndFrame));
 }
 
 WorkQueue::~WorkQueue()
@@ -89,6 +137,7 @@ WorkQueue::~WorkQueue()
     // Stop the worker threads. First make sure they are not waiting for work items
     shutDown_ = true;
     Resume();
+    WakeUpThreads(true);
 
     for (unsigned i = 0; i < threads_.size(); ++i)
         threads_[i]->Stop();
@@ -106,6 +155,10 @@ void WorkQueue::CreateThreads(unsigned numThreads)
     Pause();
 
     maxThreadIndex = numThreads + 1;
+    while (taskDeques_.size() < maxThreadIndex)
+        taskDeques_.push_back(ea::make_unique<WorkTaskDeque>());
+    frameMemory_.SetNumThreads(maxThreadIndex);
+
     for (unsigned i = 0; i < numThreads; ++i)
     {
         SharedPtr<WorkerThread> thread(new WorkerThread(this, i + 1));
@@ -130,6 +183,166 @@ void WorkQueue::CallFromMainThread(WorkFunction workFunction)
     mainThreadTasks_.Insert(ea::move(workFunction));
 }
 
+SharedPtr<WorkTask> WorkQueue::CreateTask(WorkFunction workFunction)
+{
+    return MakeShared<WorkTask>(ea::move(workFunction));
+}
+
+void WorkQueue::AddDependency(WorkTask* task, WorkTask* dependency)
+{
+    URHO3D_ASSERT(!task->submitted_, "Dependencies cannot be added to submitted task");
+
+    MutexLock<SpinLockMutex> lock(dependency->dependentsMutex_);
+    if (dependency->completed_.load(std::memory_order_relaxed))
+        return;
+
+    task->numPendingDependencies_.fetch_add(1, std::memory_order_relaxed);
+    dependency->dependents_.emplace_back(task);
+}
+
+void WorkQueue::SubmitTask(WorkTask* task)
+{
+    URHO3D_ASSERT(!task->submitted_, "Task cannot be submitted twice");
+
+    task->submitted_ = true;
+    numPendingTasks_.fetch_add(1, std::memory_order_relaxed);
+
+    const unsigned threadIndex = GetThreadIndex();
+    if (task->numPendingDependencies_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        PushTask(SharedPtr<WorkTask>(task), threadIndex);
+
+    // Worker threads may be paused only when main thread is waiting
+    if (threadIndex == 0)
+        Resume();
+}
+
+SharedPtr<WorkTask> WorkQueue::ScheduleTask(WorkFunction workFunction, ea::span<const SharedPtr<WorkTask>> dependencies)
+{
+    SharedPtr<WorkTask> task = CreateTask(ea::move(workFunction));
+    for (const SharedPtr<WorkTask>& dependency : dependencies)
+        AddDependency(task, dependency);
+    SubmitTask(task);
+    return task;
+}
+
+void WorkQueue::WaitForTask(WorkTask* task)
+{
+    const unsigned threadIndex = GetThreadIndex();
+    while (!task->IsCompleted())
+    {
+        // Threads not owned by WorkQueue cannot execute tasks
+        if (threadIndex >= taskDeques_.size() || !TryExecuteTask(threadIndex))
+            Time::Sleep(0);
+    }
+
+    // Process delayed work if there's no more tasks in flight
+    if (threadIndex == 0 && numPendingTasks_.load(std::memory_order_acquire) == 0)
+    {
+        PauseIfIdle();
+        ProcessMainThreadTasks();
+    }
+}
+
+void WorkQueue::WaitForTasks(ea::span<const SharedPtr<WorkTask>> tasks)
+{
+    for (const SharedPtr<WorkTask>& task : tasks)
+        WaitForTask(task);
+}
+
+void WorkQueue::PushTask(SharedPtr<WorkTask> task, unsigned threadIndex)
+{
+    // Tasks submitted from foreign threads are given to main thread
+    if (threadIndex >= taskDeques_.size())
+        threadIndex = 0;
+
+    taskDeques_[threadIndex]->PushBack(ea::move(task));
+    WakeUpThreads(false);
+}
+
+SharedPtr<WorkTask> WorkQueue::PopTask(unsigned threadIndex)
+{
+    if (SharedPtr<WorkTask> task = taskDeques_[threadIndex]->PopBack())
+        return task;
+
+    const unsigned numDeques = taskDeques_.size();
+    for (unsigned i = 1; i < numDeques; ++i)
+    {
+        if (SharedPtr<WorkTask> task = taskDeques_[(threadIndex + i) % numDeques]->PopFront())
+            return task;
+    }
+    return nullptr;
+}
+
+bool WorkQueue::TryExecuteTask(unsigned threadIndex)
+{
+    const SharedPtr<WorkTask> task = PopTask(threadIndex);
+    if (!task)
+        return false;
+
+    task->function_(threadIndex);
+    task->function_ = nullptr;
+
+    // Dependents are already counted as pending, so the counter cannot reach zero until they are executed too.
+    // Decrement before completion so waiters never observe completed task that is still pending.
+    numPendingTasks_.fetch_sub(1, std::memory_order_release);
+
+    ea::vector<SharedPtr<WorkTask>> dependents;
+    {
+        MutexLock<SpinLockMutex> lock(task->dependentsMutex_);
+        task->completed_.store(true, std::memory_order_release);
+        dependents.swap(task->dependents_);
+    }
+
+    for (SharedPtr<WorkTask>& dependent : dependents)
+    {
+        if (dependent->numPendingDependencies_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            PushTask(ea::move(dependent), threadIndex);
+    }
+
+    return true;
+}
+
+void WorkQueue::WakeUpThreads(bool wakeAll)
+{
+    // Paired with WaitForWork: either the sleeping thread observes new generation,
+    // or this thread observes the sleeping thread and notifies it under the mutex.
+    wakeGeneration_.fetch_add(1, std::memory_order_seq_cst);
+    if (numSleepingThreads_.load(std::memory_order_seq_cst) == 0)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+    }
+
+    if (wakeAll)
+        wakeCondition_.notify_all();
+    else
+        wakeCondition_.notify_one();
+}
+
+void WorkQueue::WaitForWork(unsigned wakeGeneration)
+{
+    numSleepingThreads_.fetch_add(1, std::memory_order_seq_cst);
+    {
+        std::unique_lock<std::mutex> lock(wakeMutex_);
+        wakeCondition_.wait(lock, [&]
+        {
+            return shutDown_ || wakeGeneration_.load(std::memory_order_seq_cst) != wakeGeneration;
+        });
+    }
+    numSleepingThreads_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void WorkQueue::PauseIfIdle()
+{
+    if (threads_.empty() || paused_)
+        return;
+
+    Pause();
+    if (!queue_.empty() || numPendingTasks_.load(std::memory_order_acquire) != 0)
+        Resume();
+}
+
 SharedPtr<WorkItem> WorkQueue::GetFreeItem()
 {
     if (!poolItems_.empty())
@@ -163,6 +376,17 @@ void WorkQueue::AddWorkItem(const SharedPtr<WorkItem>& item)
     workItems_.push_back(item);
     item->completed_ = false;
 
+    // Immediate items are executed as tasks to avoid contention on the queue mutex
+    if (item->priority_ == M_MAX_UNSIGNED)
+    {
+        SubmitTask(CreateTask([itemPtr = item.Get()](unsigned threadIndex)
+        {
+            itemPtr->workFunction_(itemPtr, threadIndex);
+            itemPtr->completed_ = true;
+        }));
+        return;
+    }
+
     // Make sure worker threads' list is safe to modify
     if (threads_.size() && !paused_)
         queueMutex_.Acquire();
@@ -192,6 +416,7 @@ void WorkQueue::AddWorkItem(const SharedPtr<WorkItem>& item)
     {
         queueMutex_.Release();
         paused_ = false;
+        WakeUpThreads(true);
     }
 }
 
@@ -303,14 +528,12 @@ void WorkQueue::Complete(unsigned priority)
             }
         }
 
-        // Wait for threaded work to complete
+        // Wait for threaded work to complete, help with tasks meanwhile
         while (!IsCompleted(priority))
-        {
-        }
+            TryExecuteTask(0);
 
         // If no work at all remaining, pause worker threads by leaving the mutex locked
-        if (queue_.empty())
-            Pause();
+        PauseIfIdle();
     }
     else
     {
@@ -322,6 +545,10 @@ void WorkQueue::Complete(unsigned priority)
             item->workFunction_(item, 0);
             item->completed_ = true;
         }
+
+        while (!IsCompleted(priority) && TryExecuteTask(0))
+        {
+        }
     }
 
     PurgeCompleted(priority);
@@ -369,6 +596,14 @@ void WorkQueue::ProcessItems(unsigned threadIndex)
         if (shutDown_)
             return;
 
+        // Remember generation before looking for work so the wake-up cannot be missed
+        const unsigned wakeGeneration = wakeGeneration_.load(std::memory_order_seq_cst);
+        if (TryExecuteTask(threadIndex))
+        {
+            wasActive = true;
+            continue;
+        }
+
         if (pausing_ && !wasActive)
             Time::Sleep(0);
         else
@@ -389,7 +624,7 @@ void WorkQueue::ProcessItems(unsigned threadIndex)
                 wasActive = false;
 
                 queueMutex_.Release();
-                Time::Sleep(0);
+                WaitForWork(wakeGeneration);
             }
         }
     }
@@ -458,6 +693,16 @@ void WorkQueue::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
 {
     ProcessMainThreadTasks();
 
+    // If no worker threads, complete tasks here. Otherwise make sure that tasks are not stuck in paused queue
+    if (threads_.empty())
+    {
+        while (TryExecuteTask(0))
+        {
+        }
+    }
+    else if (numPendingTasks_.load(std::memory_order_acquire) != 0)
+        Resume();
+
     // If no worker threads, complete low-priority work here
     if (threads_.empty() && !queue_.empty())
     {
@@ -479,6 +724,12 @@ void WorkQueue::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
     PurgePool();
 }
 
+void WorkQueue::HandleEndFrame(StringHash eventType, VariantMap& eventData)
+{
+    // Memory allocated for the frame is not used anymore
+    frameMemory_.Reset();
+}
+
 unsigned WorkQueue::GetThreadIndex()
 {
     return currentThreadIndex;
@@ -22,13 +22,20 @@
 
 #pragma once
 
+#include "../Core/FrameAllocator.h"
 #include "../Core/Mutex.h"
 #include "../Core/Object.h"
 #include "../Container/MultiVector.h"
+#include "../Container/PoolAllocator.h"
 
+#include <EASTL/fixed_vector.h>
 #include <EASTL/list.h>
+#include <EASTL/shared_ptr.h>
 #include <EASTL/span.h>
+#include <EASTL/unique_ptr.h>
 #include <atomic>
+#include <condition_variable>
+#include <mutex>
 
 namespace Urho3D
 {
@@ -40,6 +47,7 @@ URHO3D_EVENT(E_WORKITEMCOMPLETED, WorkItemCompleted)
 }
 
 class WorkerThread;
+class WorkTaskDeque;
 
 /// Vector-like collection that can be safely filled from different WorkQueue threads simultaneously.
 template <class T>
@@ -61,7 +69,7 @@ using WorkFunction = ea::function<void(unsigned threadIndex)>;
 
 /// Work queue item.
 /// @nobind
-struct WorkItem : public RefCounted
+struct WorkItem : public RefCounted, public PooledObject
 {
     friend class WorkQueue;
 
@@ -87,6 +95,37 @@ private:
     WorkFunction workLambda_;
 };
 
+/// Task in the dependency graph of WorkQueue.
+/// Task is executed by any WorkQueue thread as soon as it's submitted and all its dependencies are completed.
+/// @nobind
+class URHO3D_API WorkTask : public RefCounted, public PooledObject
+{
+    friend class WorkQueue;
+
+public:
+    /// Construct.
+    explicit WorkTask(WorkFunction function) : function_(ea::move(function)) {}
+
+    /// Return whether the task is submitted.
+    bool IsSubmitted() const { return submitted_; }
+    /// Return whether the task is completed.
+    bool IsCompleted() const { return completed_.load(std::memory_order_acquire); }
+
+private:
+    /// Work function.
+    WorkFunction function_;
+    /// Number of incomplete dependencies. Extra one is held until the task is submitted.
+    std::atomic<unsigned> numPendingDependencies_{1};
+    /// Tasks that depend on this task. Protected by dependentsMutex_.
+    ea::vector<SharedPtr<WorkTask>> dependents_;
+    /// Mutex for dependents_ and completion.
+    SpinLockMutex dependentsMutex_;
+    /// Whether the task is submitted.
+    bool submitted_{};
+    /// Whether the task is completed.
+    std::atomic<bool> completed_{};
+};
+
 /// Work queue subsystem for multithreading.
 class URHO3D_API WorkQueue : public Object
 {
@@ -106,13 +145,31 @@ public:
     /// Invoke callback from main thread. May be called immediately.
     void CallFromMainThread(WorkFunction workFunction);
 
+    /// Create task. Dependencies may be added to the task until it's submitted.
+    SharedPtr<WorkTask> CreateTask(WorkFunction workFunction);
+    /// Make task wait for completion of another task. Should be called before the task is submitted.
+    void AddDependency(WorkTask* task, WorkTask* dependency);
+    /// Submit task for execution. Task is executed after all dependencies are completed.
+    /// Should be called from main thread or from another task.
+    void SubmitTask(WorkTask* task);
+    /// Create and submit task that depends on specified tasks.
+    SharedPtr<WorkTask> ScheduleTask(WorkFunction workFunction, ea::span<const SharedPtr<WorkTask>> dependencies = {});
+    /// Execute tasks in the calling thread until specified task is completed.
+    /// Task and all its dependencies should be submitted.
+    /// If called from main thread when no more tasks are pending, also process callbacks queued by CallFromMainThread.
+    void WaitForTask(WorkTask* task);
+    /// Execute tasks in the calling thread until all specified tasks are completed.
+    void WaitForTasks(ea::span<const SharedPtr<WorkTask>> tasks);
+
     /// Get pointer to an usable WorkItem from the item pool. Allocate one if no more free items.
     SharedPtr<WorkItem> GetFreeItem();
     /// Add a work item and resume worker threads.
+    /// Items with M_MAX_UNSIGNED priority are executed as tasks, other items are queued by priority.
     void AddWorkItem(const SharedPtr<WorkItem>& item);
     /// Add a work item and resume worker threads.
     SharedPtr<WorkItem> AddWorkItem(WorkFunction workFunction, unsigned priority = 0);
     /// Remove a work item before it has started executing. Return true if successfully removed.
+    /// Items with M_MAX_UNSIGNED priority are considered started as soon as they are added.
     bool RemoveWorkItem(SharedPtr<WorkItem> item);
     /// Remove a number of work items before they have started executing. Return the number of items successfully removed.
     unsigned RemoveWorkItems(const ea::vector<SharedPtr<WorkItem> >& items);
@@ -138,6 +195,12 @@ public:
     bool IsCompleted(unsigned priority) const;
     /// Return whether the queue is currently completing work in the main thread.
     bool IsCompleting() const { return completing_; }
+    /// Return number of submitted tasks that are not completed yet.
+    unsigned GetNumPendingTasks() const { return numPendingTasks_.load(std::memory_order_relaxed); }
+    /// Return memory for temporary allocations that is released at the end of the frame.
+    FrameMemory* GetFrameMemory() { return &frameMemory_; }
+    /// Return allocator for containers that don't outlive the current frame.
+    FrameAllocator GetFrameAllocator() { return FrameAllocator(&frameMemory_); }
 
     /// Return the pool tolerance.
     int GetTolerance() const { return tolerance_; }
@@ -151,6 +214,18 @@ public:
     static unsigned GetMaxThreadIndex();
 
 private:
+    /// Push ready task to the deque of specified thread.
+    void PushTask(SharedPtr<WorkTask> task, unsigned threadIndex);
+    /// Pop task from the deque of specified thread or steal it from other threads.
+    SharedPtr<WorkTask> PopTask(unsigned threadIndex);
+    /// Execute one ready task if any. Return whether the task was executed.
+    bool TryExecuteTask(unsigned threadIndex);
+    /// Wake up sleeping worker threads. Should be called after new work is made available.
+    void WakeUpThreads(bool wakeAll);
+    /// Put worker thread to sleep unless new work was made available since the specified wake-up generation.
+    void WaitForWork(unsigned wakeGeneration);
+    /// Pause worker threads if there's no work remaining.
+    void PauseIfIdle();
     /// Process main thread tasks.
     void ProcessMainThreadTasks();
     /// Process work items until shut down. Called by the worker threads.
@@ -163,6 +238,8 @@ private:
     void ReturnToPool(SharedPtr<WorkItem>& item);
     /// Handle frame start event. Purge completed work from the main thread queue, and perform work if no threads at all.
     void HandleBeginFrame(StringHash eventType, VariantMap& eventData);
+    /// Handle frame end event. Release memory allocated by FrameAllocator.
+    void HandleEndFrame(StringHash eventType, VariantMap& eventData);
 
     /// Worker threads.
     ea::vector<SharedPtr<WorkerThread> > threads_;
@@ -176,6 +253,20 @@ private:
     ea::list<WorkItem*> queue_;
     /// Worker queue mutex.
     Mutex queueMutex_;
+    /// Per-thread deques of ready tasks. Each thread pops tasks from the back of its own deque and steals from the front of others.
+    ea::vector<ea::unique_ptr<WorkTaskDeque>> taskDeques_;
+    /// Number of submitted tasks that are not completed yet.
+    std::atomic<unsigned> numPendingTasks_{};
+    /// Incremented every time new work is made available. Used by worker threads to detect missed wake-ups.
+    std::atomic<unsigned> wakeGeneration_{};
+    /// Number of worker threads sleeping or going to sleep.
+    std::atomic<unsigned> numSleepingThreads_{};
+    /// Mutex for sleeping worker threads.
+    std::mutex wakeMutex_;
+    /// Condition variable for sleeping worker threads.
+    std::condition_variable wakeCondition_;
+    /// Per-thread memory for the current frame.
+    FrameMemory frameMemory_;
     /// Shutting down flag.
     std::atomic<bool> shutDown_;
     /// Pausing flag. Indicates the worker threads should not contend for the queue mutex.
@@ -208,23 +299,66 @@ void ForEachParallel(WorkQueue* workQueue, unsigned bucket, unsigned size, Callb
     }
 
     std::atomic<unsigned> offset = 0;
-    const unsigned maxThreads = workQueue->GetNumThreads() + 1;
-    for (unsigned i = 0; i < maxThreads; ++i)
+    auto processBuckets = [=, &offset](unsigned /*threadIndex*/) mutable
+    {
+        while (true)
+        {
+            const unsigned beginIndex = offset.fetch_add(bucket, std::memory_order_relaxed);
+            if (beginIndex >= size)
+                break;
+
+            const unsigned endIndex = ea::min(beginIndex + bucket, size);
+            callback(beginIndex, endIndex);
+        }
+    };
+
+    // Spawn tasks for worker threads and process buckets in the current thread too
+    ea::fixed_vector<SharedPtr<WorkTask>, 16> tasks;
+    const unsigned numTasks = ea::min(workQueue->GetNumThreads(), (size - 1) / bucket);
+    for (unsigned i = 0; i < numTasks; ++i)
+        tasks.push_back(workQueue->ScheduleTask(processBuckets));
+
+    processBuckets(WorkQueue::GetThreadIndex());
+    workQueue->WaitForTasks(tasks);
+}
+
+/// Schedule processing of arbitrary array in multiple threads. Callback is copied internally.
+/// Return task that is completed when the whole array is processed.
+/// Signature of callback: void(unsigned beginIndex, unsigned endIndex)
+template <class Callback>
+SharedPtr<WorkTask> ScheduleForEachParallel(WorkQueue* workQueue, unsigned bucket, unsigned size, Callback callback,
+    ea::span<const SharedPtr<WorkTask>> dependencies = {})
+{
+    const unsigned numBuckets = (size + bucket - 1) / bucket;
+    const unsigned numTasks = ea::min(workQueue->GetNumThreads() + 1, numBuckets);
+
+    const auto offset = ea::make_shared<std::atomic<unsigned>>(0u);
+    auto processBuckets = [=](unsigned /*threadIndex*/) mutable
     {
-        workQueue->AddWorkItem([=, &offset](unsigned /*threadIndex*/) mutable
+        while (true)
         {
-            while (true)
-            {
-                const unsigned beginIndex = offset.fetch_add(bucket, std::memory_order_relaxed);
-                if (beginIndex >= size)
-                    break;
-
-                const unsigned endIndex = ea::min(beginIndex + bucket, size);
-                callback(beginIndex, endIndex);
-            }
-        }, M_MAX_UNSIGNED);
+            const unsigned beginIndex = offset->fetch_add(bucket, std::memory_order_relaxed);
+            if (beginIndex >= size)
+                break;
+
+            const unsigned endIndex = ea::min(beginIndex + bucket, size);
+            callback(beginIndex, endIndex);
+        }
+    };
+
+    const SharedPtr<WorkTask> joinTask = workQueue->CreateTask([](unsigned /*threadIndex*/) {});
+    for (unsigned i = 0; i < numTasks; ++i)
+    {
+        const SharedPtr<WorkTask> task = workQueue->CreateTask(processBuckets);
+        for (const SharedPtr<WorkTask>& dependency : dependencies)
+            workQueue->AddDependency(task, dependency);
+        workQueue->AddDependency(joinTask, task);
+        workQueue->SubmitTask(task);
     }
-    workQueue->Complete(M_MAX_UNSIGNED);
+    for (const SharedPtr<WorkTask>& dependency : dependencies)
+        workQueue->AddDependency(joinTask, dependency);
+    workQueue->SubmitTask(joinTask);
+    return joinTask;
 }
 
 /// Process collection in multiple threads.
@@ -25,6 +25,7 @@
 #include "../Audio/Audio.h"
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
+#include "../Core/Metrics.h"
 #include "../Core/Profiler.h"
 #include "../Core/ProcessUtils.h"
 #include "../Core/Thread.h"
@@ -87,8 +88,10 @@
 #ifdef URHO3D_COMPUTE
 #include "../Graphics/ComputeDevice.h"
 #endif
+#include "../Utility/AnimationCompressor.h"
 #include "../Utility/AssetPipeline.h"
 #include "../Utility/AssetTransformer.h"
+#include "../Utility/HierarchicalLodGenerator.h"
 #include "../Utility/SceneViewerApplication.h"
 
 #if defined(__EMSCRIPTEN__) && defined(URHO3D_TESTING)
@@ -211,6 +214,8 @@ Engine::Engine(Context* context) :
     SceneViewerApplication::RegisterObject();
     context_->AddFactoryReflection<AssetPipeline>();
     context_->AddFactoryReflection<AssetTransformer>();
+    HierarchicalLodGenerator::RegisterObject(context_);
+    AnimationCompressor::RegisterObject(context_);
 
     SubscribeToEvent(E_EXITREQUESTED, URHO3D_HANDLER(Engine, HandleExitRequested));
     SubscribeToEvent(E_ENDFRAME, URHO3D_HANDLER(Engine, HandleEndFrame));
@@ -236,6 +241,7 @@ bool Engine::Initialize(const StringVariantMap& parameters)
             log->SetLevel(static_cast<LogLevel>(GetParameter(EP_LOG_LEVEL).GetInt()));
         log->SetQuiet(GetParameter(EP_LOG_QUIET).GetBool());
         log->Open(GetParameter(EP_LOG_NAME).GetString());
+        log->SetAsync(GetParameter(EP_LOG_ASYNC).GetBool());
     }
 
     // Initialize app preferences directory
@@ -565,6 +571,7 @@ bool Engine::InitializeResourceCache(const StringVariantMap& parameters, bool re
 void Engine::RunFrame()
 {
     URHO3D_PROFILE("RunFrame");
+    URHO3D_METRIC_TIMER("Engine::RunFrame");
     {
         assert(initialized_);
 
@@ -735,7 +742,7 @@ void Engine::DumpResources(bool dumpFileName)
         return;
 
     auto* cache = GetSubsystem<ResourceCache>();
-    const ea::unordered_map<StringHash, ResourceGroup>& resourceGroups = cache->GetAllResources();
+    const StringHashMap<ResourceGroup>& resourceGroups = cache->GetAllResources();
     if (dumpFileName)
     {
         URHO3D_LOGINFO("Used resources:");
@@ -1162,6 +1169,7 @@ void Engine::PopulateDefaultParameters()
     parameterDesc_[EP_GPU_DEBUG].SetDefault(false);
     parameterDesc_[EP_HEADLESS].SetDefault(false);
     parameterDesc_[EP_HIGH_DPI].SetDefault(true);
+    parameterDesc_[EP_LOG_ASYNC].SetDefault(false);
     parameterDesc_[EP_LOG_LEVEL].SetDefault(LOG_TRACE);
     parameterDesc_[EP_LOG_NAME].SetDefault("Urho3D.log");
     parameterDesc_[EP_LOG_QUIET].SetDefault(false);
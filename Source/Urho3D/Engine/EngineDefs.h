@@ -47,6 +47,7 @@ URHO3D_GLOBAL_CONSTANT(ConstString EP_FULL_SCREEN{"FullScreen"});
 URHO3D_GLOBAL_CONSTANT(ConstString EP_GPU_DEBUG{"GPUDebug"});
 URHO3D_GLOBAL_CONSTANT(ConstString EP_HEADLESS{"Headless"});
 URHO3D_GLOBAL_CONSTANT(ConstString EP_HIGH_DPI{"HighDPI"});
+URHO3D_GLOBAL_CONSTANT(ConstString EP_LOG_ASYNC{"LogAsync"});
 URHO3D_GLOBAL_CONSTANT(ConstString EP_LOG_LEVEL{"LogLevel"});
 URHO3D_GLOBAL_CONSTANT(ConstString EP_LOG_NAME{"LogName"});
 URHO3D_GLOBAL_CONSTANT(ConstString EP_LOG_QUIET{"LogQuiet"});
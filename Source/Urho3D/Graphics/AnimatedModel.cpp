@@ -98,6 +98,8 @@ void AnimatedModel::RegisterObject(Context* context)
     URHO3D_ACCESSOR_ATTRIBUTE("Shadow Distance", GetShadowDistance, SetShadowDistance, float, 0.0f, AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("LOD Bias", GetLodBias, SetLodBias, float, 1.0f, AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("Animation LOD Bias", GetAnimationLodBias, SetAnimationLodBias, float, 1.0f, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Animation LOD Bone Depth Distance", GetAnimationLodBoneDepthDistance, SetAnimationLodBoneDepthDistance, float, 0.0f, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Animation LOD Max Bone Depth", GetAnimationLodMaxBoneDepth, SetAnimationLodMaxBoneDepth, unsigned, DefaultAnimationLodMaxBoneDepth, AM_DEFAULT);
     URHO3D_COPY_BASE_ATTRIBUTES(Drawable);
     URHO3D_MIXED_ACCESSOR_ATTRIBUTE("Bone Animation Enabled", GetBonesEnabledAttr, SetBonesEnabledAttr, VariantVector,
         Variant::emptyVariantVector, AM_FILE | AM_NOEDIT);
@@ -283,13 +285,14 @@ void AnimatedModel::Update(const FrameInfo& frame)
 
         if (transformsDirty)
         {
+            // Write back only bones touched by animation, other bones already have actual transforms
             Octree* octree = octant_->GetOctree();
             for (unsigned boneIndex = 0; boneIndex < skeleton_.GetNumBones(); ++boneIndex)
             {
                 Node* node = skeleton_.GetBone(boneIndex)->node_;
-                const Transform& transform = skeletonData_[boneIndex].localToParent_;
-                if (node)
-                    octree->QueueNodeTransformUpdate(node, transform);
+                const ModelAnimationOutput& output = skeletonData_[boneIndex];
+                if (node && output.dirty_)
+                    octree->QueueNodeTransformUpdate(node, output.localToParent_);
             }
         }
     }
@@ -531,6 +534,16 @@ void AnimatedModel::SetAnimationLodBias(float bias)
     animationLodBias_ = Max(bias, 0.0f);
 }
 
+void AnimatedModel::SetAnimationLodBoneDepthDistance(float distance)
+{
+    animationLodBoneDepthDistance_ = Max(distance, 0.0f);
+}
+
+void AnimatedModel::SetAnimationLodMaxBoneDepth(unsigned depth)
+{
+    animationLodMaxBoneDepth_ = depth;
+}
+
 void AnimatedModel::SetUpdateInvisible(bool enable)
 {
     updateInvisible_ = enable;
@@ -1063,6 +1076,13 @@ bool AnimatedModel::UpdateAndCheckAnimationTimers(float timeStep)
     return true;
 }
 
+unsigned AnimatedModel::GetAnimatedBoneDepth() const
+{
+    if (animationLodBoneDepthDistance_ > 0.0f && animationLodDistance_ > animationLodBoneDepthDistance_)
+        return animationLodMaxBoneDepth_;
+    return M_MAX_UNSIGNED;
+}
+
 void AnimatedModel::CalculateAnimations()
 {
     URHO3D_ASSERT(isMaster_);
@@ -1070,8 +1090,9 @@ void AnimatedModel::CalculateAnimations()
     // AnimationStateSource is a weak pointer which may or may not be an issue
     if (AnimationStateSource* animationStateSource = animationStateSource_)
     {
+        const unsigned maxBoneDepth = GetAnimatedBoneDepth();
         for (AnimationState* state : animationStateSource->GetAnimationStates())
-            state->CalculateModelTracks(skeletonData_);
+            state->CalculateModelTracks(skeletonData_, animationInterpolator_, maxBoneDepth);
     }
 
     animationDirty_ = false;
@@ -1110,13 +1131,55 @@ void AnimatedModel::ConnectToAnimationStateSource(AnimationStateSource* source)
     animationStateSource_ = source;
 }
 
-void AnimatedModel::UpdateSkinning()
+void AnimatedModel::CalculateBoneWorldTransforms()
 {
-    // Note: the model's world transform will be baked in the skin matrices
     const ea::vector<Bone>& bones = skeleton_.GetBones();
+    const ea::vector<unsigned>& bonesOrder = skeleton_.GetBonesOrder();
     // Use model's world transform in case a bone is missing
     const Matrix3x4& worldTransform = node_->GetWorldTransform();
 
+    boneWorldTransforms_.resize(bones.size());
+
+    // Fallback to node transforms if bone hierarchy is malformed
+    if (bonesOrder.size() != bones.size())
+    {
+        for (unsigned i = 0; i < bones.size(); ++i)
+            boneWorldTransforms_[i] = bones[i].node_ ? bones[i].node_->GetWorldTransform() : worldTransform;
+        return;
+    }
+
+    // Accumulate transforms from parents to children in flat array instead of evaluating bone nodes one by one.
+    // Node is used only if it's not attached to the node of the parent bone.
+    // Results are written back to bone nodes, otherwise they stay dirty and further changes are not reported.
+    for (unsigned boneIndex : bonesOrder)
+    {
+        const Bone& bone = bones[boneIndex];
+        Node* boneNode = bone.node_;
+        if (!boneNode)
+        {
+            boneWorldTransforms_[boneIndex] = worldTransform;
+            continue;
+        }
+
+        const bool isRoot = bone.parentIndex_ == boneIndex;
+        Node* parentBoneNode = !isRoot ? bones[bone.parentIndex_].node_.Get() : nullptr;
+        if (parentBoneNode && boneNode->GetParent() == parentBoneNode)
+        {
+            boneWorldTransforms_[boneIndex] = boneWorldTransforms_[bone.parentIndex_] * boneNode->GetTransform();
+            if (boneNode->IsDirty())
+                boneNode->SetCachedWorldTransform(boneWorldTransforms_[boneIndex]);
+        }
+        else
+            boneWorldTransforms_[boneIndex] = boneNode->GetWorldTransform();
+    }
+}
+
+void AnimatedModel::UpdateSkinning()
+{
+    // Note: the model's world transform will be baked in the skin matrices
+    const ea::vector<Bone>& bones = skeleton_.GetBones();
+    CalculateBoneWorldTransforms();
+
     // Skinning with global matrices only
     if (!geometrySkinMatrices_.size())
     {
@@ -1124,9 +1187,9 @@ void AnimatedModel::UpdateSkinning()
         {
             const Bone& bone = bones[i];
             if (bone.node_)
-                skinMatrices_[i] = bone.node_->GetWorldTransform() * bone.offsetMatrix_;
+                skinMatrices_[i] = boneWorldTransforms_[i] * bone.offsetMatrix_;
             else
-                skinMatrices_[i] = worldTransform;
+                skinMatrices_[i] = boneWorldTransforms_[i];
         }
     }
     // Skinning with per-geometry matrices
@@ -1136,9 +1199,9 @@ void AnimatedModel::UpdateSkinning()
         {
             const Bone& bone = bones[i];
             if (bone.node_)
-                skinMatrices_[i] = bone.node_->GetWorldTransform() * bone.offsetMatrix_;
+                skinMatrices_[i] = boneWorldTransforms_[i] * bone.offsetMatrix_;
             else
-                skinMatrices_[i] = worldTransform;
+                skinMatrices_[i] = boneWorldTransforms_[i];
 
             // Copy the skin matrix to per-geometry matrices as needed
             for (unsigned j = 0; j < geometrySkinMatrixPtrs_[i].size(); ++j)
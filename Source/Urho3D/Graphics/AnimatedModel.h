@@ -26,6 +26,7 @@
 #include "../Graphics/Model.h"
 #include "../Graphics/Skeleton.h"
 #include "../Graphics/StaticModel.h"
+#include "../Math/TransformInterpolator.h"
 
 namespace Urho3D
 {
@@ -42,6 +43,9 @@ class URHO3D_API AnimatedModel : public StaticModel
     friend class AnimationState;
 
 public:
+    /// Default max depth of animated bones beyond animation LOD bone depth distance.
+    static const unsigned DefaultAnimationLodMaxBoneDepth = 3;
+
     /// Construct.
     explicit AnimatedModel(Context* context);
     /// Destruct.
@@ -86,6 +90,12 @@ public:
     /// Set animation LOD bias.
     /// @property
     void SetAnimationLodBias(float bias);
+    /// Set animation LOD distance beyond which only bones up to max LOD bone depth are animated. Zero disables.
+    /// @property
+    void SetAnimationLodBoneDepthDistance(float distance);
+    /// Set max depth of animated bones beyond animation LOD bone depth distance.
+    /// @property
+    void SetAnimationLodMaxBoneDepth(unsigned depth);
     /// Set whether to update animation and the bounding box when not visible. Recommended to enable for physically controlled models like ragdolls.
     /// @property
     void SetUpdateInvisible(bool enable);
@@ -113,6 +123,17 @@ public:
     /// @property
     float GetAnimationLodBias() const { return animationLodBias_; }
 
+    /// Return animation LOD distance beyond which only bones up to max LOD bone depth are animated.
+    /// @property
+    float GetAnimationLodBoneDepthDistance() const { return animationLodBoneDepthDistance_; }
+
+    /// Return max depth of animated bones beyond animation LOD bone depth distance.
+    /// @property
+    unsigned GetAnimationLodMaxBoneDepth() const { return animationLodMaxBoneDepth_; }
+
+    /// Return max depth of bones that should be animated at current animation LOD distance.
+    unsigned GetAnimatedBoneDepth() const;
+
     /// Return whether to update animation when not visible.
     /// @property
     bool GetUpdateInvisible() const { return updateInvisible_; }
@@ -201,6 +222,7 @@ private:
     void CalculateAnimations();
     void ApplyBoneTransformsToNodes();
 
+    void CalculateBoneWorldTransforms();
     void UpdateSkinning();
     void UpdateMorphs();
     /// @}
@@ -217,6 +239,10 @@ private:
     Skeleton skeleton_;
     /// Animation data of Skeleton, used only during Update.
     ea::vector<ModelAnimationOutput> skeletonData_;
+    /// Temporary storage used to sample and blend animation tracks in batches.
+    TransformInterpolator animationInterpolator_;
+    /// World transforms of bones, used only during UpdateSkinning.
+    ea::vector<Matrix3x4> boneWorldTransforms_;
     /// Component that provides animation states for the model.
     WeakPtr<AnimationStateSource> animationStateSource_;
     /// Software model animator.
@@ -243,6 +269,10 @@ private:
     float animationLodTimer_;
     /// Animation LOD distance, the minimum of all LOD view distances last frame.
     float animationLodDistance_;
+    /// Animation LOD distance beyond which deep bones are not animated.
+    float animationLodBoneDepthDistance_{};
+    /// Max depth of animated bones beyond animation LOD bone depth distance.
+    unsigned animationLodMaxBoneDepth_{DefaultAnimationLodMaxBoneDepth};
     /// Update animation when invisible flag.
     bool updateInvisible_;
     /// Software skinning flag.
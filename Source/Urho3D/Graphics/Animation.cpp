@@ -286,6 +286,19 @@ bool Animation::BeginLoad(Deserializer& source)
         }
     }
 
+    // Read compressed tracks
+    if (version >= compressedTrackVersion)
+    {
+        const unsigned compressedTracks = source.ReadUInt();
+        for (unsigned i = 0; i < compressedTracks; ++i)
+        {
+            CompressedAnimationTrack newTrack;
+            newTrack.Read(source);
+            memoryUse += newTrack.GetMemoryUse();
+            compressedTracks_.emplace(newTrack.nameHash_, ea::move(newTrack));
+        }
+    }
+
     // Optionally read triggers from an XML file
     ea::string xmlName = ReplaceExtension(GetName(), ".xml");
 
@@ -375,6 +388,11 @@ bool Animation::Save(Serializer& dest) const
         }
     }
 
+    // Write compressed tracks
+    dest.WriteUInt(compressedTracks_.size());
+    for (const auto& item : compressedTracks_)
+        item.second.Write(dest);
+
     // If triggers have been defined, write an XML file for them
     if (!triggers_.empty() || HasMetadata())
     {
@@ -452,6 +470,7 @@ bool Animation::RemoveTrack(const ea::string& name)
     unsigned numRemoved = 0;
     numRemoved += tracks_.erase(nameHash);
     numRemoved += variantTracks_.erase(nameHash);
+    numRemoved += compressedTracks_.erase(nameHash);
     return numRemoved > 0;
 }
 
@@ -459,6 +478,26 @@ void Animation::RemoveAllTracks()
 {
     tracks_.clear();
     variantTracks_.clear();
+    compressedTracks_.clear();
+}
+
+void Animation::Compress(const AnimationCompressionSettings& settings)
+{
+    unsigned removedMemoryUse = 0;
+    unsigned addedMemoryUse = 0;
+    for (const auto& [nameHash, track] : tracks_)
+    {
+        CompressedAnimationTrack& compressedTrack = compressedTracks_[nameHash];
+        compressedTrack.Compress(track, length_, settings);
+
+        removedMemoryUse += sizeof(AnimationTrack) + track.keyFrames_.size() * sizeof(AnimationKeyFrame);
+        addedMemoryUse += compressedTrack.GetMemoryUse();
+    }
+    tracks_.clear();
+
+    // Memory use is not tracked for dynamically created tracks
+    const unsigned memoryUse = GetMemoryUse();
+    SetMemoryUse(memoryUse > removedMemoryUse ? memoryUse - removedMemoryUse + addedMemoryUse : addedMemoryUse);
 }
 
 void Animation::SetTrigger(unsigned index, const AnimationTriggerPoint& trigger)
@@ -512,6 +551,7 @@ SharedPtr<Animation> Animation::Clone(const ea::string& cloneName) const
     ret->SetAnimationName(animationName_);
     ret->length_ = length_;
     ret->tracks_ = tracks_;
+    ret->compressedTracks_ = compressedTracks_;
     ret->triggers_ = triggers_;
     ret->CopyMetadata(*this);
     ret->SetMemoryUse(GetMemoryUse());
@@ -561,6 +601,12 @@ VariantAnimationTrack* Animation::GetVariantTrack(StringHash nameHash)
     return iter != variantTracks_.end() ? &iter->second : nullptr;
 }
 
+const CompressedAnimationTrack* Animation::GetCompressedTrack(StringHash nameHash) const
+{
+    const auto iter = compressedTracks_.find(nameHash);
+    return iter != compressedTracks_.end() ? &iter->second : nullptr;
+}
+
 AnimationTriggerPoint* Animation::GetTrigger(unsigned index)
 {
     return index < triggers_.size() ? &triggers_[index] : nullptr;
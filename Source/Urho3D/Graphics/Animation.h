@@ -25,7 +25,9 @@
 #pragma once
 
 #include "../Graphics/AnimationTrack.h"
+#include "../Graphics/CompressedAnimationTrack.h"
 #include "../Container/Ptr.h"
+#include "../Container/StringHashMap.h"
 #include "../Resource/Resource.h"
 
 namespace Urho3D
@@ -71,8 +73,10 @@ public:
     /// @property
     void SetLength(float length);
     /// Create and return a track by name. If track by same name already exists, returns the existing.
+    /// Returned pointer is invalidated when another track is created.
     AnimationTrack* CreateTrack(const ea::string& name);
     /// Create and return generic variant track by name. If variant track by same name already exists, returns the existing.
+    /// Returned pointer is invalidated when another variant track is created.
     VariantAnimationTrack* CreateVariantTrack(const ea::string& name);
     /// Remove a track by name. Return true if was found and removed successfully. This is unsafe if the animation is currently used in playback.
     bool RemoveTrack(const ea::string& name);
@@ -92,6 +96,8 @@ public:
     /// Resize trigger point vector.
     /// @property
     void SetNumTriggers(unsigned num);
+    /// Compress all transform tracks. Source tracks are replaced with compressed ones and cannot be edited anymore.
+    void Compress(const AnimationCompressionSettings& settings);
     /// Clone the animation.
     SharedPtr<Animation> Clone(const ea::string& cloneName = EMPTY_STRING) const;
 
@@ -107,7 +113,7 @@ public:
     float GetLength() const { return length_; }
 
     /// Return all animation tracks.
-    const ea::unordered_map<StringHash, AnimationTrack>& GetTracks() const { return tracks_; }
+    const StringHashMap<AnimationTrack>& GetTracks() const { return tracks_; }
 
     /// Return number of animation tracks.
     /// @property
@@ -124,13 +130,21 @@ public:
 
     /// Return generic variant animation tracks.
     /// @{
-    const ea::unordered_map<StringHash, VariantAnimationTrack>& GetVariantTracks() const { return variantTracks_; }
+    const StringHashMap<VariantAnimationTrack>& GetVariantTracks() const { return variantTracks_; }
     unsigned GetNumVariantTracks() const { return variantTracks_.size(); }
     VariantAnimationTrack* GetVariantTrack(unsigned index);
     VariantAnimationTrack* GetVariantTrack(const ea::string& name);
     VariantAnimationTrack* GetVariantTrack(StringHash nameHash);
     /// @}
 
+    /// Return compressed transform tracks.
+    /// @{
+    const StringHashMap<CompressedAnimationTrack>& GetCompressedTracks() const { return compressedTracks_; }
+    unsigned GetNumCompressedTracks() const { return compressedTracks_.size(); }
+    const CompressedAnimationTrack* GetCompressedTrack(StringHash nameHash) const;
+    bool IsCompressed() const { return !compressedTracks_.empty(); }
+    /// @}
+
     /// Return animation trigger points.
     const ea::vector<AnimationTriggerPoint>& GetTriggers() const { return triggers_; }
 
@@ -152,7 +166,9 @@ private:
     static const unsigned legacyVersion = 1; // Fake version for legacy unversioned UANI file
     static const unsigned variantTrackVersion = 2; // VariantAnimationTrack support added here
 
-    static const unsigned currentVersion = variantTrackVersion;
+    static const unsigned compressedTrackVersion = 3; // CompressedAnimationTrack support added here
+
+    static const unsigned currentVersion = compressedTrackVersion;
     /// @}
 
     /// Animation name.
@@ -162,9 +178,11 @@ private:
     /// Animation length.
     float length_;
     /// Animation tracks.
-    ea::unordered_map<StringHash, AnimationTrack> tracks_;
+    StringHashMap<AnimationTrack> tracks_;
     /// Generic variant animation tracks.
-    ea::unordered_map<StringHash, VariantAnimationTrack> variantTracks_;
+    StringHashMap<VariantAnimationTrack> variantTracks_;
+    /// Compressed transform tracks.
+    StringHashMap<CompressedAnimationTrack> compressedTracks_;
     /// Animation trigger points.
     ea::vector<AnimationTriggerPoint> triggers_;
 };
@@ -1172,35 +1172,40 @@ void AnimationController::UpdateAnimationStateTracks(AnimationState* state)
         startNode = node_;
 
     // Setup model and node tracks
-    const auto& tracks = animation->GetTracks();
-    for (const auto& item : tracks)
+    const auto addTransformTrack = [&](StringHash nameHash, const AnimationTrack* track, const CompressedAnimationTrack* compressedTrack)
     {
-        const AnimationTrack& track = item.second;
-
         // Try to find bone first, filter by start bone node
-        const unsigned trackBoneIndex = model ? model->GetSkeleton().GetBoneIndex(track.nameHash_) : M_MAX_UNSIGNED;
+        const unsigned trackBoneIndex = model ? model->GetSkeleton().GetBoneIndex(nameHash) : M_MAX_UNSIGNED;
         Bone* trackBone = trackBoneIndex != M_MAX_UNSIGNED ? model->GetSkeleton().GetBone(trackBoneIndex) : nullptr;
         if (trackBone && trackBone->node_ && (startNode == node_ || trackBone->node_->IsChildOf(startNode)))
         {
             ModelAnimationStateTrack stateTrack;
-            stateTrack.track_ = &track;
+            stateTrack.track_ = track;
+            stateTrack.compressedTrack_ = compressedTrack;
             stateTrack.boneIndex_ = trackBoneIndex;
+            stateTrack.boneDepth_ = model->GetSkeleton().GetBoneDepth(trackBoneIndex);
             stateTrack.node_ = trackBone->node_;
             stateTrack.bone_ = trackBone;
             state->AddModelTrack(stateTrack);
-            continue;
+            return;
         }
 
         // Find stray node otherwise
-        Node* trackNode = GetTrackNodeByNameHash(track.nameHash_, startNode);
+        Node* trackNode = GetTrackNodeByNameHash(nameHash, startNode);
         if (trackNode)
         {
             NodeAnimationStateTrack stateTrack;
-            stateTrack.track_ = &track;
+            stateTrack.track_ = track;
+            stateTrack.compressedTrack_ = compressedTrack;
             stateTrack.node_ = trackNode;
             state->AddNodeTrack(stateTrack);
         }
-    }
+    };
+
+    for (const auto& item : animation->GetTracks())
+        addTransformTrack(item.second.nameHash_, &item.second, nullptr);
+    for (const auto& item : animation->GetCompressedTracks())
+        addTransformTrack(item.second.nameHash_, nullptr, &item.second);
 
     // Setup generic tracks
     const auto& variantTracks = animation->GetVariantTracks();
@@ -28,6 +28,7 @@
 #include "../Graphics/AnimationState.h"
 #include "../Graphics/DrawableEvents.h"
 #include "../IO/Log.h"
+#include "../Math/TransformInterpolator.h"
 
 #include "../DebugNew.h"
 
@@ -232,22 +233,131 @@ float AnimationState::GetLength() const
 }
 
 void AnimationState::CalculateModelTracks(ea::vector<ModelAnimationOutput>& output) const
+{
+    TransformInterpolator interpolator;
+    CalculateModelTracks(output, interpolator);
+}
+
+void AnimationState::CalculateModelTracks(ea::vector<ModelAnimationOutput>& output, TransformInterpolator& interpolator,
+    unsigned maxBoneDepth) const
 {
     if (!animation_ || !IsEnabled())
         return;
 
+    // Return channels of the track that should be applied
+    const auto getTrackChannels = [maxBoneDepth](const ModelAnimationStateTrack& stateTrack) -> AnimationChannelFlags
+    {
+        // Do not apply if the bone has animation disabled or is culled by animation LOD
+        if (!stateTrack.bone_->animated_ || stateTrack.boneDepth_ > maxBoneDepth)
+            return CHANNEL_NONE;
+        if (const CompressedAnimationTrack* track = stateTrack.compressedTrack_)
+            return track->channelMask_;
+        if (const AnimationTrack* track = stateTrack.track_)
+            return !track->keyFrames_.empty() ? track->channelMask_ : CHANNEL_NONE;
+        return CHANNEL_NONE;
+    };
+
+    // Sample all tracks at once
+    const float length = animation_->GetLength();
+    interpolator.Clear();
     for (const ModelAnimationStateTrack& stateTrack : modelTracks_)
     {
-        // Do not apply if the bone has animation disabled
-        if (!stateTrack.bone_->animated_)
+        if (!getTrackChannels(stateTrack))
+            continue;
+
+        if (const CompressedAnimationTrack* compressedTrack = stateTrack.compressedTrack_)
+        {
+            Transform value;
+            Transform nextValue;
+            Vector3 blendFactors;
+            compressedTrack->GetKeyFrames(time_, length, looped_, value, nextValue, blendFactors);
+            interpolator.Add(value, nextValue, blendFactors);
+        }
+        else
+        {
+            const AnimationTrack* track = stateTrack.track_;
+            unsigned nextFrame{};
+            float blendFactor{};
+            track->GetKeyFrames(time_, length, looped_, stateTrack.keyFrame_, nextFrame, blendFactor);
+            if (blendFactor < M_EPSILON)
+                blendFactor = 0.0f;
+            interpolator.Add(track->keyFrames_[stateTrack.keyFrame_], track->keyFrames_[nextFrame], Vector3::ONE * blendFactor);
+        }
+    }
+    interpolator.Evaluate();
+
+    // Blend with the output in batch only in interpolation mode with partial weight, it's the only expensive case
+    const bool isBatchBlending = blendingMode_ == ABM_LERP && !Equals(weight_, 1.0f);
+
+    unsigned index = 0;
+    for (const ModelAnimationStateTrack& stateTrack : modelTracks_)
+    {
+        const AnimationChannelFlags channelMask = getTrackChannels(stateTrack);
+        if (!channelMask)
             continue;
 
         URHO3D_ASSERT(output.size() > stateTrack.boneIndex_);
         ModelAnimationOutput& trackOutput = output[stateTrack.boneIndex_];
+        const Transform sampledValue = interpolator.GetResult(index);
 
-        unsigned keyFrame = stateTrack.keyFrame_;
-        CalulcateTransformTrack(trackOutput, *stateTrack.track_, keyFrame, weight_);
-        stateTrack.keyFrame_ = keyFrame;
+        if (isBatchBlending)
+        {
+            // Uninitialized channels are interpolated between the same values
+            Transform blendFrom = trackOutput.localToParent_;
+            Vector3 blendFactors = Vector3::ONE;
+            if ((channelMask & trackOutput.dirty_).Test(CHANNEL_POSITION))
+                blendFactors.x_ = weight_;
+            else
+                blendFrom.position_ = sampledValue.position_;
+            if ((channelMask & trackOutput.dirty_).Test(CHANNEL_ROTATION))
+                blendFactors.y_ = weight_;
+            else
+                blendFrom.rotation_ = sampledValue.rotation_;
+            if ((channelMask & trackOutput.dirty_).Test(CHANNEL_SCALE))
+                blendFactors.z_ = weight_;
+            else
+                blendFrom.scale_ = sampledValue.scale_;
+            interpolator.Set(index, blendFrom, sampledValue, blendFactors);
+        }
+        else
+        {
+            Transform baseValue;
+            if (blendingMode_ == ABM_ADDITIVE)
+            {
+                if (stateTrack.compressedTrack_)
+                    baseValue = stateTrack.compressedTrack_->GetBaseValue();
+                else
+                    baseValue = stateTrack.track_->keyFrames_.front();
+            }
+            BlendTransformTrack(trackOutput, channelMask, baseValue, sampledValue, weight_);
+        }
+
+        ++index;
+    }
+
+    if (!isBatchBlending)
+        return;
+
+    interpolator.Evaluate();
+
+    index = 0;
+    for (const ModelAnimationStateTrack& stateTrack : modelTracks_)
+    {
+        const AnimationChannelFlags channelMask = getTrackChannels(stateTrack);
+        if (!channelMask)
+            continue;
+
+        ModelAnimationOutput& trackOutput = output[stateTrack.boneIndex_];
+        const Transform blendedValue = interpolator.GetResult(index);
+        if (channelMask.Test(CHANNEL_POSITION))
+            trackOutput.localToParent_.position_ = blendedValue.position_;
+        if (channelMask.Test(CHANNEL_ROTATION))
+            trackOutput.localToParent_.rotation_ = blendedValue.rotation_;
+        if (channelMask.Test(CHANNEL_SCALE))
+            trackOutput.localToParent_.scale_ = blendedValue.scale_;
+        trackOutput.dirty_ |= channelMask;
+
+        ++index;
     }
 }
 
@@ -260,9 +370,7 @@ void AnimationState::CalculateNodeTracks(ea::unordered_map<Node*, NodeAnimationO
     {
         NodeAnimationOutput& trackOutput = output[stateTrack.node_.Get()];
 
-        unsigned keyFrame = stateTrack.keyFrame_;
-        CalulcateTransformTrack(trackOutput, *stateTrack.track_, keyFrame, weight_);
-        stateTrack.keyFrame_ = keyFrame;
+        CalulcateTransformTrack(trackOutput, stateTrack, weight_);
     }
 }
 
@@ -281,27 +389,43 @@ void AnimationState::CalculateAttributeTracks(ea::unordered_map<AnimatedAttribut
     }
 }
 
-void AnimationState::CalulcateTransformTrack(NodeAnimationOutput& output, const AnimationTrack& track, unsigned& frame, float weight) const
+void AnimationState::CalulcateTransformTrack(NodeAnimationOutput& output, const NodeAnimationStateTrack& stateTrack, float weight) const
 {
-    if (track.keyFrames_.empty())
-        return;
+    Transform sampledValue;
+    if (const CompressedAnimationTrack* track = stateTrack.compressedTrack_)
+    {
+        if (track->IsEmpty())
+            return;
 
-    const bool isFullWeight = Equals(weight, 1.0f);
-    const AnimationKeyFrame& baseValue = track.keyFrames_.front();
+        track->Sample(time_, animation_->GetLength(), looped_, sampledValue);
+        const Transform baseValue = blendingMode_ == ABM_ADDITIVE ? track->GetBaseValue() : Transform{};
+        BlendTransformTrack(output, track->channelMask_, baseValue, sampledValue, weight);
+    }
+    else if (const AnimationTrack* track = stateTrack.track_)
+    {
+        if (track->keyFrames_.empty())
+            return;
 
-    Transform sampledValue;
-    track.Sample(time_, animation_->GetLength(), looped_, frame, sampledValue);
+        track->Sample(time_, animation_->GetLength(), looped_, stateTrack.keyFrame_, sampledValue);
+        BlendTransformTrack(output, track->channelMask_, track->keyFrames_.front(), sampledValue, weight);
+    }
+}
+
+void AnimationState::BlendTransformTrack(NodeAnimationOutput& output, AnimationChannelFlags channelMask,
+    const Transform& baseValue, const Transform& sampledValue, float weight) const
+{
+    const bool isFullWeight = Equals(weight, 1.0f);
 
     if (blendingMode_ == ABM_ADDITIVE)
     {
         // In additive mode, check for output being already initialzed
-        if ((track.channelMask_ & output.dirty_).Test(CHANNEL_POSITION))
+        if ((channelMask & output.dirty_).Test(CHANNEL_POSITION))
         {
             const Vector3 delta = sampledValue.position_ - baseValue.position_;
             output.localToParent_.position_ += delta * weight;
         }
 
-        if ((track.channelMask_ & output.dirty_).Test(CHANNEL_ROTATION))
+        if ((channelMask & output.dirty_).Test(CHANNEL_ROTATION))
         {
             const Quaternion delta = sampledValue.rotation_ * baseValue.rotation_.Inverse();
             if (isFullWeight)
@@ -310,7 +434,7 @@ void AnimationState::CalulcateTransformTrack(NodeAnimationOutput& output, const
                 output.localToParent_.rotation_ = Quaternion::IDENTITY.Slerp(delta, weight) * output.localToParent_.rotation_;
         }
 
-        if ((track.channelMask_ & output.dirty_).Test(CHANNEL_SCALE))
+        if ((channelMask & output.dirty_).Test(CHANNEL_SCALE))
         {
             const Vector3 delta = sampledValue.scale_ - baseValue.scale_;
             output.localToParent_.scale_ += delta * weight;
@@ -319,7 +443,7 @@ void AnimationState::CalulcateTransformTrack(NodeAnimationOutput& output, const
     else
     {
         // In interpolation mode, disable interpolation if output is not initialzed yet
-        if (track.channelMask_.Test(CHANNEL_POSITION))
+        if (channelMask.Test(CHANNEL_POSITION))
         {
             if (!isFullWeight && output.dirty_.Test(CHANNEL_POSITION))
                 output.localToParent_.position_ = output.localToParent_.position_.Lerp(sampledValue.position_, weight);
@@ -330,7 +454,7 @@ void AnimationState::CalulcateTransformTrack(NodeAnimationOutput& output, const
             }
         }
 
-        if (track.channelMask_.Test(CHANNEL_ROTATION))
+        if (channelMask.Test(CHANNEL_ROTATION))
         {
             if (!isFullWeight && output.dirty_.Test(CHANNEL_ROTATION))
                 output.localToParent_.rotation_ = output.localToParent_.rotation_.Slerp(sampledValue.rotation_, weight);
@@ -341,7 +465,7 @@ void AnimationState::CalulcateTransformTrack(NodeAnimationOutput& output, const
             }
         }
 
-        if (track.channelMask_.Test(CHANNEL_SCALE))
+        if (channelMask.Test(CHANNEL_SCALE))
         {
             if (!isFullWeight && output.dirty_.Test(CHANNEL_SCALE))
                 output.localToParent_.scale_ = output.localToParent_.scale_.Lerp(sampledValue.scale_, weight);
@@ -42,7 +42,9 @@ class Node;
 class Serializer;
 class Serializable;
 class Skeleton;
+class TransformInterpolator;
 struct AnimationTrack;
+struct CompressedAnimationTrack;
 struct VariantAnimationTrack;
 struct Bone;
 
@@ -56,9 +58,11 @@ enum AnimationBlendMode
 };
 
 /// Transform track applied to the Node that is not used as Bone for AnimatedModel.
+/// Either source or compressed track is set.
 struct NodeAnimationStateTrack
 {
     const AnimationTrack* track_{};
+    const CompressedAnimationTrack* compressedTrack_{};
     WeakPtr<Node> node_;
     // It's temporary cache and it's never accessed from multiple threads, so it's okay to have it mutable here.
     mutable unsigned keyFrame_{};
@@ -77,6 +81,8 @@ struct NodeAnimationOutput
 struct ModelAnimationStateTrack : public NodeAnimationStateTrack
 {
     unsigned boneIndex_{};
+    /// Depth of the bone in skeleton hierarchy, used by animation LOD.
+    unsigned boneDepth_{};
     Bone* bone_{};
 };
 
@@ -210,6 +216,10 @@ public:
 
     /// Calculate animation for the model skeleton.
     void CalculateModelTracks(ea::vector<ModelAnimationOutput>& output) const;
+    /// Calculate animation for the model skeleton. All tracks are sampled and blended in batches using temporary interpolator.
+    /// Tracks of bones deeper than maxBoneDepth are skipped.
+    void CalculateModelTracks(ea::vector<ModelAnimationOutput>& output, TransformInterpolator& interpolator,
+        unsigned maxBoneDepth = M_MAX_UNSIGNED) const;
     /// Apply animation to a scene node hierarchy.
     void CalculateNodeTracks(ea::unordered_map<Node*, NodeAnimationOutput>& output) const;
     /// Apply animation to attributes.
@@ -217,7 +227,10 @@ public:
 
 private:
     /// Apply value of transformation track to the output.
-    void CalulcateTransformTrack(NodeAnimationOutput& output, const AnimationTrack& track, unsigned& frame, float weight) const;
+    void CalulcateTransformTrack(NodeAnimationOutput& output, const NodeAnimationStateTrack& stateTrack, float weight) const;
+    /// Blend sampled value of transformation track into the output.
+    void BlendTransformTrack(NodeAnimationOutput& output, AnimationChannelFlags channelMask,
+        const Transform& baseValue, const Transform& sampledValue, float weight) const;
     /// Apply single attribute track to target object. Key frame hint is updated on call.
     void CalulcateAttributeTrack(Variant& output, const VariantAnimationTrack& track, unsigned& frame, float weight) const;
 
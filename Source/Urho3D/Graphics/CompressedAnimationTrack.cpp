@@ -0,0 +1,472 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Graphics/CompressedAnimationTrack.h"
+#include "../IO/Deserializer.h"
+#include "../IO/Serializer.h"
+
+#include <EASTL/algorithm.h>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+namespace
+{
+
+/// Max value of quantized time or vector component.
+const float MaxQuantizedValue = 65535.0f;
+/// Max value of quantized quaternion component.
+const float MaxQuantizedRotation = 32767.0f;
+/// Bit used to store index of the largest quaternion component.
+const unsigned short RotationIndexBit = 0x8000;
+/// Mask of quantized quaternion component.
+const unsigned short RotationValueMask = 0x7fff;
+/// Smallest three components of unit quaternion are within [-1/sqrt(2), 1/sqrt(2)].
+const float MaxSmallestComponent = 0.70710678f;
+
+unsigned short QuantizeUnit(float value, float maxValue)
+{
+    return static_cast<unsigned short>(RoundToInt(Clamp(value, 0.0f, 1.0f) * maxValue));
+}
+
+/// Return max error between two quaternions, ignoring sign.
+float GetRotationError(const Quaternion& lhs, const Quaternion& rhs)
+{
+    const Quaternion diff = lhs.DotProduct(rhs) >= 0.0f ? lhs - rhs : lhs + rhs;
+    return ea::max({Abs(diff.w_), Abs(diff.x_), Abs(diff.y_), Abs(diff.z_)});
+}
+
+float GetVectorError(const Vector3& lhs, const Vector3& rhs)
+{
+    return ea::max({Abs(lhs.x_ - rhs.x_), Abs(lhs.y_ - rhs.y_), Abs(lhs.z_ - rhs.z_)});
+}
+
+/// Select keys that reproduce all source keys within tolerance when linearly interpolated.
+/// The first and the last keys are always kept.
+template <class T, class Interpolate, class Error>
+ea::vector<unsigned> ReduceKeys(const ea::vector<float>& times, const ea::vector<T>& values, float tolerance,
+    const Interpolate& interpolate, const Error& error)
+{
+    const unsigned numKeys = values.size();
+    ea::vector<unsigned> result{0};
+
+    unsigned anchor = 0;
+    while (anchor + 1 < numKeys)
+    {
+        // Extend segment while all skipped keys are within tolerance
+        unsigned end = anchor + 1;
+        while (end + 1 < numKeys)
+        {
+            const unsigned candidate = end + 1;
+            const float interval = times[candidate] - times[anchor];
+
+            bool isValid = true;
+            for (unsigned i = anchor + 1; i < candidate && isValid; ++i)
+            {
+                const float factor = interval > 0.0f ? (times[i] - times[anchor]) / interval : 0.0f;
+                const T value = interpolate(values[anchor], values[candidate], factor);
+                isValid = error(value, values[i]) <= tolerance;
+            }
+
+            if (!isValid)
+                break;
+            end = candidate;
+        }
+
+        result.push_back(end);
+        anchor = end;
+    }
+    return result;
+}
+
+/// Return whether all values are within tolerance from the first one.
+template <class T, class Error>
+bool IsConstant(const ea::vector<T>& values, float tolerance, const Error& error)
+{
+    return ea::all_of(values.begin(), values.end(), [&](const T& value) { return error(value, values.front()) <= tolerance; });
+}
+
+ea::vector<unsigned short> QuantizeTimes(const ea::vector<float>& times, const ea::vector<unsigned>& keys, float timeStep)
+{
+    ea::vector<unsigned short> result;
+    result.reserve(keys.size());
+    for (unsigned key : keys)
+        result.push_back(QuantizeUnit(times[key] / timeStep / MaxQuantizedValue, MaxQuantizedValue));
+    return result;
+}
+
+void CompressVectorChannel(CompressedVectorChannel& channel, const ea::vector<float>& times,
+    const ea::vector<Vector3>& values, float timeStep, float tolerance)
+{
+    const auto lerp = [](const Vector3& lhs, const Vector3& rhs, float factor) { return lhs.Lerp(rhs, factor); };
+    const ea::vector<unsigned> keys = IsConstant(values, tolerance, GetVectorError)
+        ? ea::vector<unsigned>{0}
+        : ReduceKeys(times, values, tolerance, lerp, GetVectorError);
+
+    Vector3 minValue = values[keys.front()];
+    Vector3 maxValue = minValue;
+    for (unsigned key : keys)
+    {
+        minValue = VectorMin(minValue, values[key]);
+        maxValue = VectorMax(maxValue, values[key]);
+    }
+
+    channel.times_ = QuantizeTimes(times, keys, timeStep);
+    channel.origin_ = minValue;
+    channel.step_ = (maxValue - minValue) / MaxQuantizedValue;
+
+    const Vector3 range = maxValue - minValue;
+    const Vector3 invRange{
+        range.x_ > 0.0f ? 1.0f / range.x_ : 0.0f,
+        range.y_ > 0.0f ? 1.0f / range.y_ : 0.0f,
+        range.z_ > 0.0f ? 1.0f / range.z_ : 0.0f};
+
+    channel.values_.clear();
+    channel.values_.reserve(keys.size() * 3);
+    for (unsigned key : keys)
+    {
+        const Vector3 normalized = (values[key] - minValue) * invRange;
+        channel.values_.push_back(QuantizeUnit(normalized.x_, MaxQuantizedValue));
+        channel.values_.push_back(QuantizeUnit(normalized.y_, MaxQuantizedValue));
+        channel.values_.push_back(QuantizeUnit(normalized.z_, MaxQuantizedValue));
+    }
+}
+
+void EncodeRotation(ea::vector<unsigned short>& dest, const Quaternion& rotation)
+{
+    const Quaternion normalized = rotation.Normalized();
+    float components[4]{normalized.w_, normalized.x_, normalized.y_, normalized.z_};
+
+    unsigned largestIndex = 0;
+    for (unsigned i = 1; i < 4; ++i)
+    {
+        if (Abs(components[i]) > Abs(components[largestIndex]))
+            largestIndex = i;
+    }
+
+    // Largest component is always positive, so it can be restored from the other three
+    const float sign = components[largestIndex] < 0.0f ? -1.0f : 1.0f;
+
+    unsigned short encoded[3]{};
+    unsigned index = 0;
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        if (i == largestIndex)
+            continue;
+        const float value = components[i] * sign / MaxSmallestComponent;
+        encoded[index++] = QuantizeUnit((value + 1.0f) * 0.5f, MaxQuantizedRotation);
+    }
+
+    if (largestIndex & 1)
+        encoded[0] |= RotationIndexBit;
+    if (largestIndex & 2)
+        encoded[1] |= RotationIndexBit;
+
+    dest.insert(dest.end(), ea::begin(encoded), ea::end(encoded));
+}
+
+void CompressRotationChannel(CompressedRotationChannel& channel, const ea::vector<float>& times,
+    const ea::vector<Quaternion>& values, float timeStep, float tolerance)
+{
+    const auto slerp = [](const Quaternion& lhs, const Quaternion& rhs, float factor) { return lhs.Slerp(rhs, factor); };
+    const ea::vector<unsigned> keys = IsConstant(values, tolerance, GetRotationError)
+        ? ea::vector<unsigned>{0}
+        : ReduceKeys(times, values, tolerance, slerp, GetRotationError);
+
+    channel.times_ = QuantizeTimes(times, keys, timeStep);
+    channel.values_.clear();
+    channel.values_.reserve(keys.size() * 3);
+    for (unsigned key : keys)
+        EncodeRotation(channel.values_, values[key]);
+}
+
+/// Find keys to interpolate between. Return false if there are no keys.
+bool FindKeys(const ea::vector<unsigned short>& times, float timeStep, float time, float duration, bool isLooped,
+    unsigned& index, unsigned& nextIndex, float& blendFactor)
+{
+    const unsigned numKeys = times.size();
+    if (numKeys == 0)
+        return false;
+
+    const float quantizedTime = ea::max(0.0f, time) / timeStep;
+    const auto iter = ea::upper_bound(times.begin(), times.end(), quantizedTime,
+        [](float lhs, unsigned short rhs) { return lhs < static_cast<float>(rhs); });
+    index = iter != times.begin() ? static_cast<unsigned>(iter - times.begin()) - 1 : 0;
+
+    nextIndex = isLooped ? (index + 1) % numKeys : ea::min(index + 1, numKeys - 1);
+
+    blendFactor = 0.0f;
+    if (index != nextIndex)
+    {
+        const float keyTime = times[index] * timeStep;
+        const float nextKeyTime = times[nextIndex] * timeStep;
+
+        float timeInterval = nextKeyTime - keyTime;
+        if (timeInterval < 0.0f)
+            timeInterval += duration;
+        blendFactor = timeInterval > 0.0f ? Clamp((time - keyTime) / timeInterval, 0.0f, 1.0f) : 1.0f;
+    }
+    return true;
+}
+
+float GetVectorKeys(const CompressedVectorChannel& channel, float timeStep,
+    float time, float duration, bool isLooped, Vector3& value, Vector3& nextValue)
+{
+    unsigned index{};
+    unsigned nextIndex{};
+    float blendFactor{};
+    FindKeys(channel.times_, timeStep, time, duration, isLooped, index, nextIndex, blendFactor);
+
+    value = channel.Decode(index);
+    nextValue = channel.Decode(nextIndex);
+    return blendFactor >= M_EPSILON ? blendFactor : 0.0f;
+}
+
+float GetRotationKeys(const CompressedRotationChannel& channel, float timeStep,
+    float time, float duration, bool isLooped, Quaternion& value, Quaternion& nextValue)
+{
+    unsigned index{};
+    unsigned nextIndex{};
+    float blendFactor{};
+    FindKeys(channel.times_, timeStep, time, duration, isLooped, index, nextIndex, blendFactor);
+
+    value = channel.Decode(index);
+    nextValue = channel.Decode(nextIndex);
+    return blendFactor >= M_EPSILON ? blendFactor : 0.0f;
+}
+
+void WriteShortArray(Serializer& dest, const ea::vector<unsigned short>& values)
+{
+    dest.WriteVLE(values.size());
+    if (!values.empty())
+        dest.Write(values.data(), values.size() * sizeof(unsigned short));
+}
+
+void ReadShortArray(Deserializer& source, ea::vector<unsigned short>& values)
+{
+    values.resize(source.ReadVLE());
+    if (!values.empty())
+        source.Read(values.data(), values.size() * sizeof(unsigned short));
+}
+
+}
+
+bool CompressedVectorChannel::operator==(const CompressedVectorChannel& rhs) const
+{
+    return times_ == rhs.times_ && values_ == rhs.values_ && origin_ == rhs.origin_ && step_ == rhs.step_;
+}
+
+Quaternion CompressedRotationChannel::Decode(unsigned index) const
+{
+    const unsigned short* value = &values_[index * 3];
+    const unsigned largestIndex = ((value[0] & RotationIndexBit) ? 1 : 0) | ((value[1] & RotationIndexBit) ? 2 : 0);
+
+    float components[4]{};
+    float sumSquares = 0.0f;
+    unsigned encodedIndex = 0;
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        if (i == largestIndex)
+            continue;
+        const float normalized = (value[encodedIndex++] & RotationValueMask) / MaxQuantizedRotation;
+        components[i] = (normalized * 2.0f - 1.0f) * MaxSmallestComponent;
+        sumSquares += components[i] * components[i];
+    }
+    components[largestIndex] = Sqrt(ea::max(0.0f, 1.0f - sumSquares));
+
+    return Quaternion{components[0], components[1], components[2], components[3]};
+}
+
+bool CompressedRotationChannel::operator==(const CompressedRotationChannel& rhs) const
+{
+    return times_ == rhs.times_ && values_ == rhs.values_;
+}
+
+void CompressedAnimationTrack::Compress(const AnimationTrack& track, float length, const AnimationCompressionSettings& settings)
+{
+    name_ = track.name_;
+    nameHash_ = track.nameHash_;
+    channelMask_ = track.channelMask_;
+    position_ = {};
+    rotation_ = {};
+    scale_ = {};
+
+    if (track.keyFrames_.empty())
+    {
+        channelMask_ = {};
+        timeStep_ = 0.0f;
+        return;
+    }
+
+    const unsigned numKeys = track.keyFrames_.size();
+    ea::vector<float> times(numKeys);
+    ea::vector<Vector3> positions(numKeys);
+    ea::vector<Quaternion> rotations(numKeys);
+    ea::vector<Vector3> scales(numKeys);
+    for (unsigned i = 0; i < numKeys; ++i)
+    {
+        const AnimationKeyFrame& keyFrame = track.keyFrames_[i];
+        times[i] = keyFrame.time_;
+        positions[i] = keyFrame.position_;
+        rotations[i] = keyFrame.rotation_;
+        scales[i] = keyFrame.scale_;
+    }
+
+    const float maxTime = ea::max(length, times.back());
+    timeStep_ = maxTime > 0.0f ? maxTime / MaxQuantizedValue : 1.0f;
+
+    if (channelMask_.Test(CHANNEL_POSITION))
+        CompressVectorChannel(position_, times, positions, timeStep_, settings.positionTolerance_);
+    if (channelMask_.Test(CHANNEL_ROTATION))
+        CompressRotationChannel(rotation_, times, rotations, timeStep_, settings.rotationTolerance_);
+    if (channelMask_.Test(CHANNEL_SCALE))
+        CompressVectorChannel(scale_, times, scales, timeStep_, settings.scaleTolerance_);
+}
+
+void CompressedAnimationTrack::Sample(float time, float duration, bool isLooped, Transform& value) const
+{
+    Transform firstValue;
+    Transform secondValue;
+    Vector3 blendFactors;
+    GetKeyFrames(time, duration, isLooped, firstValue, secondValue, blendFactors);
+
+    if (channelMask_.Test(CHANNEL_POSITION))
+        value.position_ = firstValue.position_.Lerp(secondValue.position_, blendFactors.x_);
+    if (channelMask_.Test(CHANNEL_ROTATION))
+        value.rotation_ = firstValue.rotation_.Slerp(secondValue.rotation_, blendFactors.y_);
+    if (channelMask_.Test(CHANNEL_SCALE))
+        value.scale_ = firstValue.scale_.Lerp(secondValue.scale_, blendFactors.z_);
+}
+
+void CompressedAnimationTrack::GetKeyFrames(float time, float duration, bool isLooped,
+    Transform& value, Transform& nextValue, Vector3& blendFactors) const
+{
+    blendFactors = Vector3::ZERO;
+    if (channelMask_.Test(CHANNEL_POSITION))
+    {
+        blendFactors.x_ = GetVectorKeys(position_, timeStep_, time, duration, isLooped,
+            value.position_, nextValue.position_);
+    }
+    if (channelMask_.Test(CHANNEL_ROTATION))
+    {
+        blendFactors.y_ = GetRotationKeys(rotation_, timeStep_, time, duration, isLooped,
+            value.rotation_, nextValue.rotation_);
+    }
+    if (channelMask_.Test(CHANNEL_SCALE))
+    {
+        blendFactors.z_ = GetVectorKeys(scale_, timeStep_, time, duration, isLooped,
+            value.scale_, nextValue.scale_);
+    }
+}
+
+Transform CompressedAnimationTrack::GetBaseValue() const
+{
+    Transform value;
+    if (channelMask_.Test(CHANNEL_POSITION))
+        value.position_ = position_.Decode(0);
+    if (channelMask_.Test(CHANNEL_ROTATION))
+        value.rotation_ = rotation_.Decode(0);
+    if (channelMask_.Test(CHANNEL_SCALE))
+        value.scale_ = scale_.Decode(0);
+    return value;
+}
+
+bool CompressedAnimationTrack::IsEmpty() const
+{
+    return !channelMask_;
+}
+
+unsigned CompressedAnimationTrack::GetMemoryUse() const
+{
+    const unsigned numShorts = position_.times_.size() + position_.values_.size()
+        + rotation_.times_.size() + rotation_.values_.size()
+        + scale_.times_.size() + scale_.values_.size();
+    return sizeof(CompressedAnimationTrack) + numShorts * sizeof(unsigned short);
+}
+
+void CompressedAnimationTrack::Write(Serializer& dest) const
+{
+    dest.WriteString(name_);
+    dest.WriteUByte(channelMask_.AsInteger());
+    dest.WriteFloat(timeStep_);
+
+    if (channelMask_.Test(CHANNEL_POSITION))
+    {
+        dest.WriteVector3(position_.origin_);
+        dest.WriteVector3(position_.step_);
+        WriteShortArray(dest, position_.times_);
+        WriteShortArray(dest, position_.values_);
+    }
+    if (channelMask_.Test(CHANNEL_ROTATION))
+    {
+        WriteShortArray(dest, rotation_.times_);
+        WriteShortArray(dest, rotation_.values_);
+    }
+    if (channelMask_.Test(CHANNEL_SCALE))
+    {
+        dest.WriteVector3(scale_.origin_);
+        dest.WriteVector3(scale_.step_);
+        WriteShortArray(dest, scale_.times_);
+        WriteShortArray(dest, scale_.values_);
+    }
+}
+
+void CompressedAnimationTrack::Read(Deserializer& source)
+{
+    name_ = source.ReadString();
+    nameHash_ = name_;
+    channelMask_ = AnimationChannelFlags(source.ReadUByte());
+    timeStep_ = source.ReadFloat();
+
+    if (channelMask_.Test(CHANNEL_POSITION))
+    {
+        position_.origin_ = source.ReadVector3();
+        position_.step_ = source.ReadVector3();
+        ReadShortArray(source, position_.times_);
+        ReadShortArray(source, position_.values_);
+    }
+    if (channelMask_.Test(CHANNEL_ROTATION))
+    {
+        ReadShortArray(source, rotation_.times_);
+        ReadShortArray(source, rotation_.values_);
+    }
+    if (channelMask_.Test(CHANNEL_SCALE))
+    {
+        scale_.origin_ = source.ReadVector3();
+        scale_.step_ = source.ReadVector3();
+        ReadShortArray(source, scale_.times_);
+        ReadShortArray(source, scale_.values_);
+    }
+}
+
+bool CompressedAnimationTrack::operator==(const CompressedAnimationTrack& rhs) const
+{
+    return name_ == rhs.name_ && channelMask_ == rhs.channelMask_ && timeStep_ == rhs.timeStep_
+        && position_ == rhs.position_ && rotation_ == rhs.rotation_ && scale_ == rhs.scale_;
+}
+
+}
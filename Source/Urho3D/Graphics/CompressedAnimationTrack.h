@@ -0,0 +1,131 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+/// \file
+
+#pragma once
+
+#include "../Graphics/AnimationTrack.h"
+
+namespace Urho3D
+{
+
+class Deserializer;
+class Serializer;
+
+/// Tolerances of skeletal animation compression.
+/// Keys are removed while linear interpolation of remaining keys stays within tolerance.
+/// Quantization error is added on top of it and is usually much smaller.
+struct URHO3D_API AnimationCompressionSettings
+{
+    /// Max position error in world units.
+    float positionTolerance_{0.001f};
+    /// Max rotation error as absolute difference of quaternion components.
+    float rotationTolerance_{0.0005f};
+    /// Max scale error.
+    float scaleTolerance_{0.001f};
+};
+
+/// Compressed channel of vector keys. Values are quantized to 16 bits per component within channel range.
+struct URHO3D_API CompressedVectorChannel
+{
+    /// Quantized key times.
+    ea::vector<unsigned short> times_;
+    /// Quantized key values, three per key.
+    ea::vector<unsigned short> values_;
+    /// Value corresponding to zero quantized value.
+    Vector3 origin_;
+    /// Value step per quantized unit.
+    Vector3 step_;
+
+    /// Return value of key.
+    Vector3 Decode(unsigned index) const
+    {
+        const unsigned short* value = &values_[index * 3];
+        return origin_ + step_ * Vector3{static_cast<float>(value[0]), static_cast<float>(value[1]), static_cast<float>(value[2])};
+    }
+
+    bool operator==(const CompressedVectorChannel& rhs) const;
+};
+
+/// Compressed channel of rotation keys. Values are encoded as smallest three components, 15 bits each.
+struct URHO3D_API CompressedRotationChannel
+{
+    /// Quantized key times.
+    ea::vector<unsigned short> times_;
+    /// Quantized key values, three per key.
+    ea::vector<unsigned short> values_;
+
+    /// Return value of key.
+    Quaternion Decode(unsigned index) const;
+
+    bool operator==(const CompressedRotationChannel& rhs) const;
+};
+
+/// Compressed skeletal animation track. Constant channels are stored as single key,
+/// animated channels keep only keys that are required to stay within tolerance.
+/// Each channel has its own set of keys, so keyframe hints are not used.
+struct URHO3D_API CompressedAnimationTrack
+{
+    /// Bone or scene node name.
+    ea::string name_;
+    /// Name hash.
+    StringHash nameHash_;
+    /// Bitmask of included data (position, rotation, scale).
+    AnimationChannelFlags channelMask_{};
+    /// Duration of quantized time unit.
+    float timeStep_{};
+
+    /// Channels
+    /// @{
+    CompressedVectorChannel position_;
+    CompressedRotationChannel rotation_;
+    CompressedVectorChannel scale_;
+    /// @}
+
+    /// Compress track of animation with given length.
+    void Compress(const AnimationTrack& track, float length, const AnimationCompressionSettings& settings);
+    /// Sample value at given time.
+    void Sample(float time, float duration, bool isLooped, Transform& value) const;
+    /// Return keys to interpolate between at given time.
+    /// Blend factors of position, rotation and scale are returned as components of vector.
+    void GetKeyFrames(float time, float duration, bool isLooped,
+        Transform& value, Transform& nextValue, Vector3& blendFactors) const;
+    /// Return value of the first keys, used as base value for additive blending.
+    Transform GetBaseValue() const;
+    /// Return whether the track has no keys.
+    bool IsEmpty() const;
+    /// Return memory used by keys.
+    unsigned GetMemoryUse() const;
+
+    /// Serialize track.
+    /// @{
+    void Write(Serializer& dest) const;
+    void Read(Deserializer& source);
+    /// @}
+
+    bool operator==(const CompressedAnimationTrack& rhs) const;
+    bool operator!=(const CompressedAnimationTrack& rhs) const { return !(*this == rhs); }
+};
+
+}
@@ -79,6 +79,13 @@ public:
         return {{ currentBufferIndex_, offset, size }, data };
     }
 
+    /// Return data of previously allocated block.
+    unsigned char* GetBlockData(const ConstantBufferCollectionRef& ref)
+    {
+        assert(ref.index_ <= currentBufferIndex_ && ref.offset_ + ref.size_ <= buffers_[ref.index_].second);
+        return &buffers_[ref.index_].first[ref.offset_];
+    }
+
     /// Return number of buffers.
     unsigned GetNumBuffers() const { return currentBufferIndex_ + 1; }
 
@@ -404,6 +404,7 @@ void CustomGeometry::Commit()
 
     vertexBuffer_->ClearDataLost();
     SetNumGeometries(geometries_.size());
+    MarkContentsDirty();
 }
 
 void CustomGeometry::SetMaterial(Material* material)
@@ -67,6 +67,7 @@ void DrawCommandQueue::Reset(bool preferConstantBuffers)
     // Clear arrays and draw commands
     shaderResources_.clear();
     drawCommands_.clear();
+    patchableGroups_.clear();
     scissorRects_.clear();
     scissorRects_.push_back(IntRect::ZERO);
 }
@@ -61,6 +61,19 @@ struct ShaderParameterRange { unsigned first; unsigned second; };
 /// Shader resource group, range in array.
 using ShaderResourceRange = ea::pair<unsigned, unsigned>;
 
+/// Constant buffer block that can be rewritten after the queue is recorded.
+struct PatchableShaderParameterGroup
+{
+    /// Shader parameter group.
+    ShaderParameterGroup group_{};
+    /// Layout of the shader program that used the block.
+    ShaderProgramLayout* layout_{};
+    /// Block in constant buffer collection.
+    ConstantBufferCollectionRef constantBuffer_{};
+    /// Arbitrary value provided by the producer of the block.
+    float userValue_{};
+};
+
 /// Description of draw command.
 struct DrawCommandDescription
 {
@@ -191,6 +204,28 @@ public:
         }
     }
 
+    /// Remember current shader parameter group so it can be rewritten later via BeginShaderParameterGroupPatch.
+    /// Shall be called only if BeginShaderParameterGroup returned true. Ignored if constant buffers are not used.
+    void MarkShaderParameterGroupPatchable(float userValue = 0.0f)
+    {
+        if (useConstantBuffers_)
+        {
+            const ShaderParameterGroup group = constantBuffers_.currentGroup_;
+            patchableGroups_.push_back(PatchableShaderParameterGroup{
+                group, constantBuffers_.currentLayout_, currentDrawCommand_.constantBuffers_[group], userValue});
+        }
+    }
+
+    /// Begin rewriting of patchable shader parameter group of recorded queue.
+    /// Parameters shall be added via AddShaderParameter and committed via CommitShaderParameterGroup.
+    void BeginShaderParameterGroupPatch(const PatchableShaderParameterGroup& patchableGroup)
+    {
+        assert(useConstantBuffers_);
+        constantBuffers_.currentLayout_ = patchableGroup.layout_;
+        constantBuffers_.currentData_ = constantBuffers_.collection_.GetBlockData(patchableGroup.constantBuffer_);
+        constantBuffers_.currentGroup_ = patchableGroup.group_;
+    }
+
     /// Commit shader parameter group. Shall be called only if BeginShaderParameterGroup returned true.
     void CommitShaderParameterGroup(ShaderParameterGroup group)
     {
@@ -290,9 +325,16 @@ public:
         drawCommands_.push_back(currentDrawCommand_);
     }
 
-    /// Execute commands in the queue.
+    /// Execute commands in the queue. Recorded queue may be executed multiple times.
     void Execute();
 
+    /// Return whether the queue uses constant buffers. Only such queues can be patched.
+    bool IsUsingConstantBuffers() const { return useConstantBuffers_; }
+    /// Return shader parameter groups that can be patched.
+    const ea::vector<PatchableShaderParameterGroup>& GetPatchableShaderParameterGroups() const { return patchableGroups_; }
+    /// Return number of draw commands.
+    unsigned GetNumDrawCommands() const { return drawCommands_.size(); }
+
 private:
     /// Cached pointer to Graphics.
     Graphics* graphics_{};
@@ -331,6 +373,8 @@ private:
     ea::vector<IntRect> scissorRects_;
     /// Draw operations.
     ea::vector<DrawCommandDescription> drawCommands_;
+    /// Shader parameter groups that can be patched.
+    ea::vector<PatchableShaderParameterGroup> patchableGroups_;
 
     /// Current draw operation.
     DrawCommandDescription currentDrawCommand_;
@@ -25,6 +25,8 @@
 
 #include <EASTL/sort.h>
 
+#include <atomic>
+
 #include "../Core/Context.h"
 #include "../Core/WorkQueue.h"
 #include "../Graphics/Camera.h"
@@ -48,6 +50,13 @@
 namespace Urho3D
 {
 
+/// Return next unique revision of Drawable.
+static unsigned GetNextDrawableRevision()
+{
+    static std::atomic<unsigned> revisionCounter{};
+    return revisionCounter.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
 static const ea::vector<ea::string> giTypeNames = {
     "None",
     "Use LightMap",
@@ -96,7 +105,8 @@ Drawable::Drawable(Context* context, DrawableFlags drawableFlags) :
     lodBias_(1.0f),
     basePassFlags_(0),
     maxLights_(0),
-    firstLight_(nullptr)
+    firstLight_(nullptr),
+    revision_(GetNextDrawableRevision())
 {
 }
 
@@ -269,6 +279,11 @@ void Drawable::MarkForUpdate()
         octant_->GetOctree()->QueueUpdate(this);
 }
 
+void Drawable::MarkContentsDirty()
+{
+    revision_ = GetNextDrawableRevision();
+}
+
 const BoundingBox& Drawable::GetWorldBoundingBox()
 {
     if (worldBoundingBoxDirty_)
@@ -423,6 +438,7 @@ void Drawable::OnSceneSet(Scene* scene)
 void Drawable::OnMarkedDirty(Node* node)
 {
     worldBoundingBoxDirty_ = true;
+    revision_ = GetNextDrawableRevision();
     if (!updateQueued_ && octant_)
         octant_->GetOctree()->QueueUpdate(this);
 
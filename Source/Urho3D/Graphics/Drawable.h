@@ -55,6 +55,7 @@ static const float ANIMATION_LOD_BASESCALE = 2500.0f;
 class Camera;
 class File;
 class Geometry;
+class HierarchicalLodProxy;
 class Light;
 class Material;
 class OcclusionBuffer;
@@ -281,6 +282,11 @@ public:
     void SetReflectionMode(ReflectionMode mode);
     /// Mark for update and octree reinsertion. Update is automatically queued when the drawable's scene node moves or changes scale.
     void MarkForUpdate();
+    /// Mark drawable contents changed without transform change, e.g. when geometry data is modified in-place.
+    /// Updates revision so cached rendering results like shadow maps are invalidated.
+    void MarkContentsDirty();
+    /// Set hierarchical LOD proxy that replaces this drawable when the cluster is small on the screen.
+    void SetLodProxy(HierarchicalLodProxy* proxy) { lodProxy_ = proxy; }
 
     /// Return local space bounding box. May not be applicable or properly updated on all drawables.
     /// @property
@@ -392,6 +398,13 @@ public:
     /// Return whether current zone is inconclusive or dirty due to the drawable moving.
     bool IsZoneDirty() const { return zoneDirty_; }
 
+    /// Return revision of the drawable. Revision changes whenever the drawable is marked dirty.
+    /// Revisions are unique among all drawables, so the pair of pointer and revision identifies the state.
+    unsigned GetRevision() const { return revision_; }
+
+    /// Return hierarchical LOD proxy of the drawable. Proxy drawable returns itself.
+    HierarchicalLodProxy* GetLodProxy() const { return lodProxy_; }
+
     /// Return distance from camera.
     float GetDistance() const { return distance_; }
 
@@ -509,8 +522,14 @@ protected:
     bool updateQueued_;
     /// Zone inconclusive or dirtied flag.
     bool zoneDirty_;
+    /// Revision of the drawable.
+    unsigned revision_{};
+    /// Hierarchical LOD proxy.
+    HierarchicalLodProxy* lodProxy_{};
     /// Octree octant.
     Octant* octant_;
+    /// Index of Drawable in octant.
+    unsigned octantIndex_{ M_MAX_UNSIGNED };
     /// Index of Drawable in Scene. May be updated.
     unsigned drawableIndex_{ M_MAX_UNSIGNED };
     /// Current zone.
@@ -0,0 +1,571 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/Assert.h"
+#include "../Graphics/DebugRenderer.h"
+#include "../Graphics/Drawable.h"
+#include "../Graphics/DrawableBVH.h"
+#include "../Graphics/OctreeQuery.h"
+
+#include <EASTL/fixed_vector.h>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+namespace
+{
+
+/// Max number of drawables passed to query at once.
+const unsigned MaxQueryBatchSize = 64;
+
+/// Leaf is reinserted if its fat box is this many times larger than needed.
+const float MaxFatAreaRatio = 2.0f;
+
+/// Expected max depth of traversal. Deeper trees use heap memory.
+const unsigned MaxTraversalStackSize = 64;
+
+/// Batch of drawables passed to query at once.
+struct QueryBatch
+{
+    QueryBatch(OctreeQuery& query, bool inside) : query_(query), inside_(inside) {}
+    ~QueryBatch() { Flush(); }
+
+    void Add(Drawable* drawable)
+    {
+        drawables_[size_++] = drawable;
+        if (size_ == MaxQueryBatchSize)
+            Flush();
+    }
+
+    void Flush()
+    {
+        if (size_ > 0)
+            query_.TestDrawables(drawables_, drawables_ + size_, inside_);
+        size_ = 0;
+    }
+
+    OctreeQuery& query_;
+    const bool inside_;
+    Drawable* drawables_[MaxQueryBatchSize];
+    unsigned size_{};
+};
+
+bool IsBounded(const BoundingBox& box)
+{
+    return box.Defined() && box.min_.x_ > -M_LARGE_VALUE && box.min_.y_ > -M_LARGE_VALUE && box.min_.z_ > -M_LARGE_VALUE
+        && box.max_.x_ < M_LARGE_VALUE && box.max_.y_ < M_LARGE_VALUE && box.max_.z_ < M_LARGE_VALUE;
+}
+
+BoundingBox MergeBoxes(const BoundingBox& lhs, const BoundingBox& rhs)
+{
+    BoundingBox result = lhs;
+    result.Merge(rhs);
+    return result;
+}
+
+float GetSurfaceArea(const BoundingBox& box)
+{
+    const Vector3 size = box.Size();
+    return 2.0f * (size.x_ * size.y_ + size.y_ * size.z_ + size.z_ * size.x_);
+}
+
+bool CheckDrawable(const Drawable* drawable, DrawableFlags drawableFlags, unsigned viewMask)
+{
+    return (drawable->GetDrawableFlags() & drawableFlags) && (drawable->GetViewMask() & viewMask);
+}
+
+}
+
+DrawableBVH::DrawableBVH(float fatMargin)
+    : fatMargin_(fatMargin)
+{
+}
+
+DrawableBVH::~DrawableBVH() = default;
+
+void DrawableBVH::AddDrawable(Drawable* drawable)
+{
+    if (leaves_.contains(drawable))
+    {
+        URHO3D_ASSERTLOG(0, "Drawable is already added to DrawableBVH");
+        return;
+    }
+
+    const BoundingBox& box = drawable->GetWorldBoundingBox();
+    if (IsBounded(box))
+        leaves_.emplace(drawable, CreateLeaf(drawable, box));
+    else
+    {
+        leaves_.emplace(drawable, NullNode);
+        unboundedDrawables_.push_back(drawable);
+    }
+}
+
+void DrawableBVH::RemoveDrawable(Drawable* drawable)
+{
+    const auto iter = leaves_.find(drawable);
+    if (iter == leaves_.end())
+        return;
+
+    const unsigned leaf = iter->second;
+    if (leaf != NullNode)
+    {
+        RemoveLeaf(leaf);
+        FreeNode(leaf);
+    }
+    else
+        unboundedDrawables_.erase_first_unsorted(drawable);
+
+    leaves_.erase(iter);
+}
+
+void DrawableBVH::UpdateDrawable(Drawable* drawable)
+{
+    const auto iter = leaves_.find(drawable);
+    if (iter == leaves_.end())
+        return;
+
+    unsigned& leaf = iter->second;
+    const BoundingBox& box = drawable->GetWorldBoundingBox();
+    const bool isBounded = IsBounded(box);
+
+    if (leaf == NullNode)
+    {
+        if (isBounded)
+        {
+            unboundedDrawables_.erase_first_unsorted(drawable);
+            leaf = CreateLeaf(drawable, box);
+        }
+        return;
+    }
+
+    if (!isBounded)
+    {
+        RemoveLeaf(leaf);
+        FreeNode(leaf);
+        leaf = NullNode;
+        unboundedDrawables_.push_back(drawable);
+        return;
+    }
+
+    // Keep the leaf if drawable is still inside of fat box, and the fat box is not too large
+    TreeNode& node = nodes_[leaf];
+    const Vector3 displacement = box.Center() - node.drawableCenter_;
+    node.drawableCenter_ = box.Center();
+    if (node.box_.IsInside(box) == INSIDE)
+    {
+        const float maxArea = MaxFatAreaRatio * GetSurfaceArea(GetFatBox(box, displacement));
+        if (GetSurfaceArea(node.box_) <= maxArea)
+            return;
+    }
+
+    RemoveLeaf(leaf);
+    nodes_[leaf].box_ = GetFatBox(box, displacement);
+    InsertLeaf(leaf);
+    ++numReinsertions_;
+}
+
+void DrawableBVH::GetDrawables(OctreeQuery& query) const
+{
+    if (!unboundedDrawables_.empty())
+    {
+        auto** start = const_cast<Drawable**>(unboundedDrawables_.data());
+        query.TestDrawables(start, start + unboundedDrawables_.size(), false);
+    }
+
+    if (root_ == NullNode)
+        return;
+
+    QueryBatch intersectingBatch{query, false};
+    QueryBatch insideBatch{query, true};
+
+    ea::fixed_vector<ea::pair<unsigned, bool>, MaxTraversalStackSize> stack;
+    stack.emplace_back(root_, false);
+    while (!stack.empty())
+    {
+        const auto [index, parentInside] = stack.back();
+        stack.pop_back();
+
+        const TreeNode& node = nodes_[index];
+        if (node.IsLeaf())
+        {
+            // Drawables are tested by the query itself, like drawables in octants
+            if (parentInside)
+                insideBatch.Add(node.drawable_);
+            else
+                intersectingBatch.Add(node.drawable_);
+            continue;
+        }
+
+        const Intersection result = query.TestOctant(node.box_, parentInside);
+        if (result == OUTSIDE)
+            continue;
+
+        const bool inside = result == INSIDE;
+        stack.emplace_back(node.children_[0], inside);
+        stack.emplace_back(node.children_[1], inside);
+    }
+}
+
+void DrawableBVH::GetDrawables(RayOctreeQuery& query, ea::vector<Drawable*>& drawables) const
+{
+    for (Drawable* drawable : unboundedDrawables_)
+    {
+        if (CheckDrawable(drawable, query.drawableFlags_, query.viewMask_))
+            drawables.push_back(drawable);
+    }
+
+    if (root_ == NullNode)
+        return;
+
+    ea::fixed_vector<unsigned, MaxTraversalStackSize> stack;
+    stack.push_back(root_);
+    while (!stack.empty())
+    {
+        const TreeNode& node = nodes_[stack.back()];
+        stack.pop_back();
+
+        if (query.ray_.HitDistance(node.box_) >= query.maxDistance_)
+            continue;
+
+        if (node.IsLeaf())
+        {
+            if (CheckDrawable(node.drawable_, query.drawableFlags_, query.viewMask_))
+                drawables.push_back(node.drawable_);
+        }
+        else
+        {
+            stack.push_back(node.children_[0]);
+            stack.push_back(node.children_[1]);
+        }
+    }
+}
+
+void DrawableBVH::DrawDebugGeometry(DebugRenderer* debug, bool depthTest) const
+{
+    if (!debug || root_ == NullNode)
+        return;
+
+    ea::fixed_vector<unsigned, MaxTraversalStackSize> stack;
+    stack.push_back(root_);
+    while (!stack.empty())
+    {
+        const TreeNode& node = nodes_[stack.back()];
+        stack.pop_back();
+
+        if (!debug->IsInside(node.box_))
+            continue;
+
+        if (node.IsLeaf())
+            debug->AddBoundingBox(node.box_, Color(0.25f, 0.5f, 0.25f), depthTest);
+        else
+        {
+            debug->AddBoundingBox(node.box_, Color(0.25f, 0.25f, 0.25f), depthTest);
+            stack.push_back(node.children_[0]);
+            stack.push_back(node.children_[1]);
+        }
+    }
+}
+
+unsigned DrawableBVH::GetHeight() const
+{
+    return root_ != NullNode ? nodes_[root_].height_ : 0;
+}
+
+BoundingBox DrawableBVH::GetBoundingBox() const
+{
+    return root_ != NullNode ? nodes_[root_].box_ : BoundingBox{};
+}
+
+BoundingBox DrawableBVH::GetFatBox(const BoundingBox& box) const
+{
+    // Use uniform margin so flat drawables can move along their thin side
+    const float margin = box.HalfSize().Length() * fatMargin_;
+    return BoundingBox(box.min_ - Vector3::ONE * margin, box.max_ + Vector3::ONE * margin);
+}
+
+BoundingBox DrawableBVH::GetFatBox(const BoundingBox& box, const Vector3& displacement) const
+{
+    // Predict further movement so the drawable moving with constant velocity stays inside of fat box longer.
+    // Don't predict teleportation.
+    BoundingBox fatBox = GetFatBox(box);
+    if (displacement.LengthSquared() > box.Size().LengthSquared())
+        return fatBox;
+
+    const Vector3 offset = displacement * DisplacementMultiplier;
+    fatBox.Merge(BoundingBox(fatBox.min_ + offset, fatBox.max_ + offset));
+    return fatBox;
+}
+
+unsigned DrawableBVH::AllocateNode()
+{
+    if (freeList_ == NullNode)
+    {
+        nodes_.emplace_back();
+        return nodes_.size() - 1;
+    }
+
+    const unsigned index = freeList_;
+    freeList_ = nodes_[index].parent_;
+    nodes_[index] = TreeNode{};
+    return index;
+}
+
+void DrawableBVH::FreeNode(unsigned index)
+{
+    TreeNode& node = nodes_[index];
+    node.drawable_ = nullptr;
+    node.height_ = -1;
+    node.parent_ = freeList_;
+    freeList_ = index;
+}
+
+unsigned DrawableBVH::CreateLeaf(Drawable* drawable, const BoundingBox& box)
+{
+    const unsigned leaf = AllocateNode();
+    TreeNode& node = nodes_[leaf];
+    node.box_ = GetFatBox(box);
+    node.drawableCenter_ = box.Center();
+    node.drawable_ = drawable;
+    InsertLeaf(leaf);
+    return leaf;
+}
+
+void DrawableBVH::InsertLeaf(unsigned leaf)
+{
+    if (root_ == NullNode)
+    {
+        root_ = leaf;
+        nodes_[leaf].parent_ = NullNode;
+        return;
+    }
+
+    // Find the best sibling by surface area heuristic
+    const BoundingBox leafBox = nodes_[leaf].box_;
+    const auto getDescendCost = [&](unsigned child)
+    {
+        const TreeNode& childNode = nodes_[child];
+        const float mergedArea = GetSurfaceArea(MergeBoxes(childNode.box_, leafBox));
+        return childNode.IsLeaf() ? mergedArea : mergedArea - GetSurfaceArea(childNode.box_);
+    };
+
+    unsigned index = root_;
+    while (!nodes_[index].IsLeaf())
+    {
+        const TreeNode& node = nodes_[index];
+        const float area = GetSurfaceArea(node.box_);
+        const float combinedArea = GetSurfaceArea(MergeBoxes(node.box_, leafBox));
+
+        // Cost of creating new parent for this node and the leaf
+        const float cost = 2.0f * combinedArea;
+        // Minimum cost of pushing the leaf further down the tree
+        const float inheritanceCost = 2.0f * (combinedArea - area);
+
+        const float cost0 = getDescendCost(node.children_[0]) + inheritanceCost;
+        const float cost1 = getDescendCost(node.children_[1]) + inheritanceCost;
+        if (cost < cost0 && cost < cost1)
+            break;
+
+        index = cost0 < cost1 ? node.children_[0] : node.children_[1];
+    }
+
+    // Create new parent for the sibling and the leaf
+    const unsigned sibling = index;
+    const unsigned oldParent = nodes_[sibling].parent_;
+    const unsigned newParent = AllocateNode();
+
+    TreeNode& parentNode = nodes_[newParent];
+    parentNode.parent_ = oldParent;
+    parentNode.box_ = MergeBoxes(nodes_[sibling].box_, leafBox);
+    parentNode.height_ = nodes_[sibling].height_ + 1;
+    parentNode.children_[0] = sibling;
+    parentNode.children_[1] = leaf;
+    nodes_[sibling].parent_ = newParent;
+    nodes_[leaf].parent_ = newParent;
+
+    if (oldParent != NullNode)
+        ReplaceChild(oldParent, sibling, newParent);
+    else
+        root_ = newParent;
+
+    RefitAncestors(newParent);
+}
+
+void DrawableBVH::RemoveLeaf(unsigned leaf)
+{
+    if (leaf == root_)
+    {
+        root_ = NullNode;
+        return;
+    }
+
+    const unsigned parent = nodes_[leaf].parent_;
+    const unsigned grandParent = nodes_[parent].parent_;
+    const unsigned sibling = nodes_[parent].children_[0] == leaf ? nodes_[parent].children_[1] : nodes_[parent].children_[0];
+
+    // Replace parent with sibling
+    nodes_[sibling].parent_ = grandParent;
+    if (grandParent != NullNode)
+        ReplaceChild(grandParent, parent, sibling);
+    else
+        root_ = sibling;
+
+    FreeNode(parent);
+    nodes_[leaf].parent_ = NullNode;
+    RefitAncestors(grandParent);
+}
+
+void DrawableBVH::ReplaceChild(unsigned parent, unsigned oldChild, unsigned newChild)
+{
+    TreeNode& parentNode = nodes_[parent];
+    if (parentNode.children_[0] == oldChild)
+        parentNode.children_[0] = newChild;
+    else
+    {
+        URHO3D_ASSERT(parentNode.children_[1] == oldChild);
+        parentNode.children_[1] = newChild;
+    }
+}
+
+void DrawableBVH::RefitAncestors(unsigned index)
+{
+    while (index != NullNode)
+    {
+        index = Balance(index);
+
+        TreeNode& node = nodes_[index];
+        const TreeNode& child0 = nodes_[node.children_[0]];
+        const TreeNode& child1 = nodes_[node.children_[1]];
+        node.height_ = 1 + ea::max(child0.height_, child1.height_);
+        node.box_ = MergeBoxes(child0.box_, child1.box_);
+
+        index = node.parent_;
+    }
+}
+
+unsigned DrawableBVH::Balance(unsigned indexA)
+{
+    TreeNode& nodeA = nodes_[indexA];
+    if (nodeA.IsLeaf() || nodeA.height_ < 2)
+        return indexA;
+
+    const unsigned indexB = nodeA.children_[0];
+    const unsigned indexC = nodeA.children_[1];
+    TreeNode& nodeB = nodes_[indexB];
+    TreeNode& nodeC = nodes_[indexC];
+
+    const int balance = nodeC.height_ - nodeB.height_;
+
+    // Rotate C up
+    if (balance > 1)
+    {
+        const unsigned indexF = nodeC.children_[0];
+        const unsigned indexG = nodeC.children_[1];
+        TreeNode& nodeF = nodes_[indexF];
+        TreeNode& nodeG = nodes_[indexG];
+
+        // Swap A and C
+        nodeC.children_[0] = indexA;
+        nodeC.parent_ = nodeA.parent_;
+        nodeA.parent_ = indexC;
+
+        if (nodeC.parent_ != NullNode)
+            ReplaceChild(nodeC.parent_, indexA, indexC);
+        else
+            root_ = indexC;
+
+        // Move the lower child of C to A
+        if (nodeF.height_ > nodeG.height_)
+        {
+            nodeC.children_[1] = indexF;
+            nodeA.children_[1] = indexG;
+            nodeG.parent_ = indexA;
+            nodeA.box_ = MergeBoxes(nodeB.box_, nodeG.box_);
+            nodeC.box_ = MergeBoxes(nodeA.box_, nodeF.box_);
+            nodeA.height_ = 1 + ea::max(nodeB.height_, nodeG.height_);
+            nodeC.height_ = 1 + ea::max(nodeA.height_, nodeF.height_);
+        }
+        else
+        {
+            nodeC.children_[1] = indexG;
+            nodeA.children_[1] = indexF;
+            nodeF.parent_ = indexA;
+            nodeA.box_ = MergeBoxes(nodeB.box_, nodeF.box_);
+            nodeC.box_ = MergeBoxes(nodeA.box_, nodeG.box_);
+            nodeA.height_ = 1 + ea::max(nodeB.height_, nodeF.height_);
+            nodeC.height_ = 1 + ea::max(nodeA.height_, nodeG.height_);
+        }
+
+        return indexC;
+    }
+
+    // Rotate B up
+    if (balance < -1)
+    {
+        const unsigned indexD = nodeB.children_[0];
+        const unsigned indexE = nodeB.children_[1];
+        TreeNode& nodeD = nodes_[indexD];
+        TreeNode& nodeE = nodes_[indexE];
+
+        // Swap A and B
+        nodeB.children_[0] = indexA;
+        nodeB.parent_ = nodeA.parent_;
+        nodeA.parent_ = indexB;
+
+        if (nodeB.parent_ != NullNode)
+            ReplaceChild(nodeB.parent_, indexA, indexB);
+        else
+            root_ = indexB;
+
+        // Move the lower child of B to A
+        if (nodeD.height_ > nodeE.height_)
+        {
+            nodeB.children_[1] = indexD;
+            nodeA.children_[0] = indexE;
+            nodeE.parent_ = indexA;
+            nodeA.box_ = MergeBoxes(nodeC.box_, nodeE.box_);
+            nodeB.box_ = MergeBoxes(nodeA.box_, nodeD.box_);
+            nodeA.height_ = 1 + ea::max(nodeC.height_, nodeE.height_);
+            nodeB.height_ = 1 + ea::max(nodeA.height_, nodeD.height_);
+        }
+        else
+        {
+            nodeB.children_[1] = indexE;
+            nodeA.children_[0] = indexD;
+            nodeD.parent_ = indexA;
+            nodeA.box_ = MergeBoxes(nodeC.box_, nodeD.box_);
+            nodeB.box_ = MergeBoxes(nodeA.box_, nodeE.box_);
+            nodeA.height_ = 1 + ea::max(nodeC.height_, nodeD.height_);
+            nodeB.height_ = 1 + ea::max(nodeA.height_, nodeE.height_);
+        }
+
+        return indexB;
+    }
+
+    return indexA;
+}
+
+}
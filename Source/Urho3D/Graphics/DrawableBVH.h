@@ -0,0 +1,132 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+/// \file
+
+#pragma once
+
+#include "../Graphics/SpatialIndex.h"
+#include "../Math/BoundingBox.h"
+
+#include <EASTL/unordered_map.h>
+
+namespace Urho3D
+{
+
+/// Dynamic bounding volume hierarchy of drawables.
+/// Leaves are fattened so small movements don't change the tree. When drawable leaves its fat box,
+/// its leaf is reinserted by surface area heuristic, and the tree is kept balanced by rotations.
+/// Drawables with undefined or infinite bounding boxes are stored separately and are never culled.
+class URHO3D_API DrawableBVH : public SpatialIndex
+{
+public:
+    /// Default margin of fattened leaves relative to the size of drawable.
+    static constexpr float DefaultFatMargin = 0.1f;
+    /// Fattened leaves are extended in the direction of movement by this many last displacements.
+    static constexpr float DisplacementMultiplier = 2.0f;
+
+    /// Construct.
+    explicit DrawableBVH(float fatMargin = DefaultFatMargin);
+    /// Destruct.
+    ~DrawableBVH() override;
+
+    /// Implement SpatialIndex.
+    /// @{
+    void AddDrawable(Drawable* drawable) override;
+    void RemoveDrawable(Drawable* drawable) override;
+    void UpdateDrawable(Drawable* drawable) override;
+    void GetDrawables(OctreeQuery& query) const override;
+    void GetDrawables(RayOctreeQuery& query, ea::vector<Drawable*>& drawables) const override;
+    void DrawDebugGeometry(DebugRenderer* debug, bool depthTest) const override;
+    /// @}
+
+    /// Return number of drawables.
+    unsigned GetNumDrawables() const { return leaves_.size(); }
+    /// Return height of the tree.
+    unsigned GetHeight() const;
+    /// Return number of leaf reinsertions since construction.
+    unsigned GetNumReinsertions() const { return numReinsertions_; }
+    /// Return bounding box of all bounded drawables.
+    BoundingBox GetBoundingBox() const;
+
+private:
+    /// Index of non-existing node.
+    static const unsigned NullNode = M_MAX_UNSIGNED;
+
+    /// Tree node.
+    struct TreeNode
+    {
+        /// Return whether the node is leaf.
+        bool IsLeaf() const { return children_[0] == NullNode; }
+
+        /// Bounding box. Fattened for leaves.
+        BoundingBox box_;
+        /// Center of drawable bounding box on last update.
+        Vector3 drawableCenter_;
+        /// Drawable of leaf node.
+        Drawable* drawable_{};
+        /// Parent node. Next free node if the node is not used.
+        unsigned parent_{NullNode};
+        /// Child nodes.
+        unsigned children_[2]{NullNode, NullNode};
+        /// Height of subtree. Leaves have zero height.
+        int height_{};
+    };
+
+    /// Return fattened bounding box for leaf.
+    BoundingBox GetFatBox(const BoundingBox& box) const;
+    /// Return fattened bounding box for leaf that is expected to keep moving by displacement.
+    BoundingBox GetFatBox(const BoundingBox& box, const Vector3& displacement) const;
+    /// Allocate new node.
+    unsigned AllocateNode();
+    /// Return node to the free list.
+    void FreeNode(unsigned index);
+    /// Create leaf for drawable.
+    unsigned CreateLeaf(Drawable* drawable, const BoundingBox& box);
+    /// Insert leaf into the tree.
+    void InsertLeaf(unsigned leaf);
+    /// Remove leaf from the tree. Leaf node is not freed.
+    void RemoveLeaf(unsigned leaf);
+    /// Replace child of the node.
+    void ReplaceChild(unsigned parent, unsigned oldChild, unsigned newChild);
+    /// Update bounding boxes and heights of the node and its ancestors, balance the tree along the way.
+    void RefitAncestors(unsigned index);
+    /// Balance node by rotation if needed. Return index of node that took place of the original node.
+    unsigned Balance(unsigned index);
+
+    /// Margin of fattened leaves relative to the size of drawable.
+    float fatMargin_{};
+    /// Nodes.
+    ea::vector<TreeNode> nodes_;
+    /// Root node.
+    unsigned root_{NullNode};
+    /// First free node.
+    unsigned freeList_{NullNode};
+    /// Leaf index of each drawable, NullNode for unbounded drawables.
+    ea::unordered_map<Drawable*, unsigned> leaves_;
+    /// Drawables with undefined or infinite bounding boxes.
+    ea::vector<Drawable*> unboundedDrawables_;
+    /// Number of leaf reinsertions.
+    unsigned numReinsertions_{};
+};
+
+}
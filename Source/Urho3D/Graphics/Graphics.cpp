@@ -37,6 +37,7 @@
 #include "../Graphics/Graphics.h"
 #include "../Graphics/GraphicsEvents.h"
 #include "../Graphics/GraphicsImpl.h"
+#include "../Graphics/HierarchicalLodProxy.h"
 #include "../Graphics/IndexBuffer.h"
 #include "../Graphics/LightBaker.h"
 #include "../Graphics/LightProbeGroup.h"
@@ -655,6 +656,7 @@ void RegisterGraphicsLibrary(Context* context)
     GlobalIllumination::RegisterObject(context);
     StaticModel::RegisterObject(context);
     StaticModelGroup::RegisterObject(context);
+    HierarchicalLodProxy::RegisterObject(context);
     Skybox::RegisterObject(context);
     AnimatedModel::RegisterObject(context);
     AnimationController::RegisterObject(context);
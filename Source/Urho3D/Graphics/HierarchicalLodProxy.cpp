@@ -0,0 +1,230 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Graphics/Camera.h"
+#include "../Graphics/HierarchicalLodProxy.h"
+#include "../Scene/Scene.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+static const StringVector clusterNodesStructureElementNames =
+{
+    "Node Count",
+    "   NodeID"
+};
+
+HierarchicalLodProxy::HierarchicalLodProxy(Context* context) :
+    StaticModel(context)
+{
+    // Proxy is swapped together with its cluster
+    lodProxy_ = this;
+
+    // Initialize the default node IDs attribute
+    UpdateNodeIDs();
+}
+
+HierarchicalLodProxy::~HierarchicalLodProxy()
+{
+    RemoveAllClusterNodes();
+}
+
+void HierarchicalLodProxy::RegisterObject(Context* context)
+{
+    context->AddFactoryReflection<HierarchicalLodProxy>(Category_Geometry);
+
+    URHO3D_COPY_BASE_ATTRIBUTES(StaticModel);
+    URHO3D_ACCESSOR_ATTRIBUTE("Switch Screen Size", GetSwitchScreenSize, SetSwitchScreenSize, float, DefaultSwitchScreenSize, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Cluster Nodes", GetNodeIDsAttr, SetNodeIDsAttr,
+        VariantVector, Variant::emptyVariantVector, AM_DEFAULT | AM_NODEIDVECTOR)
+        .SetMetadata(AttributeMetadata::P_VECTOR_STRUCT_ELEMENTS, clusterNodesStructureElementNames);
+}
+
+void HierarchicalLodProxy::ApplyAttributes()
+{
+    if (!nodesDirty_)
+        return;
+
+    // Remove all old cluster nodes before searching for new
+    for (Node* node : clusterNodes_)
+    {
+        if (node)
+            AssignDrawables(node, nullptr);
+    }
+
+    clusterNodes_.clear();
+
+    Scene* scene = GetScene();
+    if (scene)
+    {
+        // The first index stores the number of IDs redundantly. This is for editing
+        for (unsigned i = 1; i < nodeIDsAttr_.size(); ++i)
+        {
+            Node* node = scene->GetNode(nodeIDsAttr_[i].GetUInt());
+            if (node)
+            {
+                AssignDrawables(node, this);
+                clusterNodes_.emplace_back(node);
+            }
+        }
+    }
+
+    nodesDirty_ = false;
+}
+
+void HierarchicalLodProxy::AddClusterNode(Node* node)
+{
+    if (!node)
+        return;
+
+    WeakPtr<Node> clusterWeak(node);
+    if (clusterNodes_.contains(clusterWeak))
+        return;
+
+    AssignDrawables(node, this);
+    clusterNodes_.push_back(clusterWeak);
+    nodeIDsDirty_ = true;
+}
+
+void HierarchicalLodProxy::RemoveClusterNode(Node* node)
+{
+    if (!node)
+        return;
+
+    WeakPtr<Node> clusterWeak(node);
+    auto iter = clusterNodes_.find(clusterWeak);
+    if (iter == clusterNodes_.end())
+        return;
+
+    AssignDrawables(node, nullptr);
+    clusterNodes_.erase(iter);
+    nodeIDsDirty_ = true;
+}
+
+void HierarchicalLodProxy::RemoveAllClusterNodes()
+{
+    for (Node* node : clusterNodes_)
+    {
+        if (node)
+            AssignDrawables(node, nullptr);
+    }
+
+    clusterNodes_.clear();
+    nodeIDsDirty_ = true;
+}
+
+Node* HierarchicalLodProxy::GetClusterNode(unsigned index) const
+{
+    return index < clusterNodes_.size() ? clusterNodes_[index].Get() : nullptr;
+}
+
+bool HierarchicalLodProxy::IsProxyUsed(const Camera* camera) const
+{
+    // World bounding box is kept up to date by octree update, so it's safe to read it here
+    if (!model_ || !IsEnabledEffective() || !worldBoundingBox_.Defined())
+        return false;
+
+    const float distance = camera->GetDistance(worldBoundingBox_.Center());
+    const float viewHeight = 2.0f * camera->GetViewSizeAt(distance).y_;
+    if (viewHeight <= M_EPSILON)
+        return false;
+
+    const float relativeSize = worldBoundingBox_.Size().Length() / viewHeight;
+    return relativeSize < switchScreenSize_;
+}
+
+void HierarchicalLodProxy::SetNodeIDsAttr(const VariantVector& value)
+{
+    // Just remember the node IDs. They need to go through the SceneResolver, and we actually find the nodes during
+    // ApplyAttributes()
+    nodeIDsAttr_.clear();
+    if (value.size())
+    {
+        unsigned index = 0;
+        unsigned numNodes = value[index++].GetUInt();
+        // Prevent crash on entering negative value in the editor
+        if (numNodes > M_MAX_INT)
+            numNodes = 0;
+
+        nodeIDsAttr_.push_back(numNodes);
+        while (numNodes--)
+        {
+            // If vector contains less IDs than should, fill the rest with zeroes
+            if (index < value.size())
+                nodeIDsAttr_.push_back(value[index++].GetUInt());
+            else
+                nodeIDsAttr_.push_back(0);
+        }
+    }
+    else
+        nodeIDsAttr_.push_back(0);
+
+    nodesDirty_ = true;
+    nodeIDsDirty_ = false;
+}
+
+const VariantVector& HierarchicalLodProxy::GetNodeIDsAttr() const
+{
+    if (nodeIDsDirty_)
+        UpdateNodeIDs();
+
+    return nodeIDsAttr_;
+}
+
+void HierarchicalLodProxy::AssignDrawables(Node* node, HierarchicalLodProxy* proxy)
+{
+    ea::vector<Drawable*> drawables;
+    node->GetDerivedComponents<Drawable>(drawables);
+    for (Drawable* drawable : drawables)
+    {
+        if (drawable == this || !(drawable->GetDrawableFlags() & DRAWABLE_GEOMETRY))
+            continue;
+
+        // Don't steal drawables of other proxies when resetting
+        if (proxy || drawable->GetLodProxy() == this)
+            drawable->SetLodProxy(proxy);
+    }
+}
+
+void HierarchicalLodProxy::UpdateNodeIDs() const
+{
+    const unsigned numNodes = clusterNodes_.size();
+
+    nodeIDsAttr_.clear();
+    nodeIDsAttr_.push_back(numNodes);
+
+    for (unsigned i = 0; i < numNodes; ++i)
+    {
+        Node* node = clusterNodes_[i];
+        nodeIDsAttr_.push_back(node ? node->GetID() : 0);
+    }
+
+    nodeIDsDirty_ = false;
+}
+
+}
@@ -0,0 +1,104 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+/// \file
+
+#pragma once
+
+#include "../Graphics/StaticModel.h"
+
+namespace Urho3D
+{
+
+/// Merged low-detail model that replaces a cluster of static drawables when the cluster is small on the screen.
+/// Cluster drawables are hidden while the proxy is used and vice versa, so the whole cluster is swapped at once.
+/// Geometry drawables of cluster nodes are collected when the nodes are assigned. Child nodes are not affected.
+/// Usually generated offline by HierarchicalLodGenerator.
+class URHO3D_API HierarchicalLodProxy : public StaticModel
+{
+    URHO3D_OBJECT(HierarchicalLodProxy, StaticModel);
+
+public:
+    /// Default relative screen size of the cluster below which the proxy is used.
+    static constexpr float DefaultSwitchScreenSize = 0.1f;
+
+    /// Construct.
+    explicit HierarchicalLodProxy(Context* context);
+    /// Destruct.
+    ~HierarchicalLodProxy() override;
+    /// Register object factory. StaticModel must be registered first.
+    /// @nobind
+    static void RegisterObject(Context* context);
+
+    /// Apply attribute changes that can not be applied immediately. Called after scene load or a network update.
+    void ApplyAttributes() override;
+
+    /// Add cluster node. Geometry drawables of the node are replaced by the proxy.
+    void AddClusterNode(Node* node);
+    /// Remove cluster node.
+    void RemoveClusterNode(Node* node);
+    /// Remove all cluster nodes.
+    void RemoveAllClusterNodes();
+
+    /// Return number of cluster nodes.
+    /// @property
+    unsigned GetNumClusterNodes() const { return clusterNodes_.size(); }
+    /// Return cluster node by index.
+    /// @property{get_clusterNodes}
+    Node* GetClusterNode(unsigned index) const;
+
+    /// Set relative screen size of the cluster (fraction of view height) below which the proxy is used.
+    /// @property
+    void SetSwitchScreenSize(float size) { switchScreenSize_ = size; }
+    /// Return relative screen size of the cluster below which the proxy is used.
+    /// @property
+    float GetSwitchScreenSize() const { return switchScreenSize_; }
+
+    /// Return whether the proxy should be rendered instead of cluster drawables for given camera.
+    /// Safe to call from multiple threads after octree update.
+    bool IsProxyUsed(const Camera* camera) const;
+
+    /// Set node IDs attribute.
+    void SetNodeIDsAttr(const VariantVector& value);
+    /// Return node IDs attribute.
+    const VariantVector& GetNodeIDsAttr() const;
+
+private:
+    /// Assign or reset proxy of the geometry drawables in the node.
+    void AssignDrawables(Node* node, HierarchicalLodProxy* proxy);
+    /// Update node IDs attribute from the actual nodes.
+    void UpdateNodeIDs() const;
+
+    /// Cluster nodes.
+    ea::vector<WeakPtr<Node>> clusterNodes_;
+    /// Relative screen size below which the proxy is used.
+    float switchScreenSize_{DefaultSwitchScreenSize};
+    /// IDs of cluster nodes for serialization.
+    mutable VariantVector nodeIDsAttr_;
+    /// Whether node IDs have been set and nodes should be searched for during ApplyAttributes.
+    mutable bool nodesDirty_{};
+    /// Whether nodes have been manipulated by the API and node ID attribute should be refreshed.
+    mutable bool nodeIDsDirty_{};
+};
+
+}
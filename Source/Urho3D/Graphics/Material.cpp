@@ -24,6 +24,8 @@
 
 #include <EASTL/sort.h>
 
+#include <atomic>
+
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
 #include "../Core/Profiler.h"
@@ -116,6 +118,13 @@ StringHash ParseTextureTypeXml(ResourceCache* cache, const ea::string& filename)
 
 static TechniqueEntry noEntry;
 
+/// Return next unique revision of Material.
+static unsigned GetNextMaterialRevision()
+{
+    static std::atomic<unsigned> revisionCounter{};
+    return revisionCounter.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
 TechniqueEntry::TechniqueEntry() noexcept :
     qualityLevel_(QUALITY_LOW),
     lodDistance_(0.0f)
@@ -1039,6 +1048,7 @@ void Material::SetTextureInternal(TextureUnit unit, Texture* texture)
 {
     if (unit < MAX_TEXTURE_UNITS)
     {
+        revision_ = GetNextMaterialRevision();
         if (texture)
             textures_[unit] = texture;
         else
@@ -1346,6 +1356,7 @@ void Material::RefreshShaderParameterHash()
         temp.WriteVariant(i->second.value_);
     }
 
+    revision_ = GetNextMaterialRevision();
     shaderParameterHash_ = 0;
     const unsigned char* data = temp.GetData();
     unsigned dataSize = temp.GetSize();
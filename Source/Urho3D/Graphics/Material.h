@@ -340,6 +340,8 @@ public:
 
     /// Return shader parameter hash value. Used as an optimization to avoid setting shader parameters unnecessarily.
     unsigned GetShaderParameterHash() const { return shaderParameterHash_; }
+    /// Return revision of shader parameters and textures. Revisions are unique among all materials.
+    unsigned GetRevision() const { return revision_; }
 
     /// Return name for texture unit.
     static ea::string GetTextureUnitName(TextureUnit unit);
@@ -399,6 +401,8 @@ private:
     std::atomic_uint32_t auxViewFrameNumber_{ 0 };
     /// Shader parameter hash value.
     unsigned shaderParameterHash_{};
+    /// Revision of shader parameters and textures.
+    unsigned revision_{};
     /// Alpha-to-coverage flag.
     bool alphaToCoverage_{};
     /// Line antialiasing flag.
@@ -22,6 +22,7 @@
 
 #include "../Precompiled.h"
 
+#include "../Core/Assert.h"
 #include "../Core/Context.h"
 #include "../Core/WorkQueue.h"
 #include "../Core/Profiler.h"
@@ -29,6 +30,10 @@
 #include "../Graphics/OcclusionBuffer.h"
 #include "../IO/Log.h"
 
+#ifdef URHO3D_SSE
+#include <emmintrin.h>
+#endif
+
 #include "../DebugNew.h"
 
 namespace Urho3D
@@ -45,12 +50,38 @@ enum ClipMask : unsigned
 };
 URHO3D_FLAGSET(ClipMask, ClipMaskFlags);
 
-void DrawOcclusionBatchWork(const WorkItem* item, unsigned threadIndex)
+namespace
+{
+
+/// Fill span of depth buffer with interpolated depth, keeping the closest value.
+inline void FillSpan(int* dest, int* end, int invZ, int dInvZdX)
 {
-    URHO3D_PROFILE("DrawOcclusionBatchWork");
-    auto* buffer = reinterpret_cast<OcclusionBuffer*>(item->aux_);
-    OcclusionBatch& batch = *reinterpret_cast<OcclusionBatch*>(item->start_);
-    buffer->DrawBatch(batch, threadIndex);
+#ifdef URHO3D_SSE
+    if (end - dest >= 4)
+    {
+        __m128i z = _mm_add_epi32(_mm_set1_epi32(invZ), _mm_setr_epi32(0, dInvZdX, 2 * dInvZdX, 3 * dInvZdX));
+        const __m128i step = _mm_set1_epi32(4 * dInvZdX);
+        for (; end - dest >= 4; dest += 4)
+        {
+            // There's no _mm_min_epi32 in SSE2
+            const __m128i depth = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dest));
+            const __m128i closer = _mm_cmplt_epi32(z, depth);
+            const __m128i result = _mm_or_si128(_mm_and_si128(closer, z), _mm_andnot_si128(closer, depth));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), result);
+            z = _mm_add_epi32(z, step);
+        }
+        invZ = _mm_cvtsi128_si32(z);
+    }
+#endif
+
+    for (; dest < end; ++dest)
+    {
+        if (invZ < *dest)
+            *dest = invZ;
+        invZ += dInvZdX;
+    }
+}
+
 }
 
 OcclusionBuffer::OcclusionBuffer(Context* context) :
@@ -71,6 +102,8 @@ bool OcclusionBuffer::SetSize(int width, int height, bool threaded)
     if (height & 1u)
         ++height;
 
+    threaded_ = threaded && GetSubsystem<WorkQueue>()->GetNumThreads() > 0;
+
     if (width == width_ && height == height_)
         return true;
 
@@ -86,17 +119,13 @@ bool OcclusionBuffer::SetSize(int width, int height, bool threaded)
     width_ = width;
     height_ = height;
 
-    // Build work buffers for threading
-    unsigned numThreadBuffers = threaded ? GetSubsystem<WorkQueue>()->GetNumThreads() + 1 : 1;
-    buffers_.resize(numThreadBuffers);
-    for (unsigned i = 0; i < numThreadBuffers; ++i)
-    {
-        // Reserve extra memory in case 3D clipping is not exact
-        OcclusionBufferData& buffer = buffers_[i];
-        buffer.dataWithSafety_ = new int[width * (height + 2) + 2];
-        buffer.data_ = buffer.dataWithSafety_.get() + width + 1;
-        buffer.used_ = false;
-    }
+    // Reserve extra memory in case 3D clipping is not exact
+    buffer_.dataWithSafety_ = new int[width * (height + 2) + 2];
+    buffer_.data_ = buffer_.dataWithSafety_.get() + width + 1;
+    buffer_.used_ = false;
+
+    // Threads rasterize bins of rows independently
+    bins_.resize((height + OCCLUSION_BIN_HEIGHT - 1) / OCCLUSION_BIN_HEIGHT);
 
     mipBuffers_.clear();
 
@@ -113,7 +142,7 @@ bool OcclusionBuffer::SetSize(int width, int height, bool threaded)
     }
 
     URHO3D_LOGDEBUG("Set occlusion buffer size " + ea::to_string(width_) + "x" + ea::to_string(height_) + " with " +
-             ea::to_string(mipBuffers_.size()) + " mip levels and " + ea::to_string(numThreadBuffers) + " thread buffers");
+             ea::to_string(mipBuffers_.size()) + " mip levels and " + ea::to_string(bins_.size()) + " bins");
 
     CalculateViewport();
     return true;
@@ -159,12 +188,7 @@ void OcclusionBuffer::Reset()
 void OcclusionBuffer::Clear()
 {
     Reset();
-
-    // Only clear the main thread buffer. Rest are cleared on-demand when drawing the first batch
-    ClearBuffer(0);
-    for (unsigned i = 1; i < buffers_.size(); ++i)
-        buffers_[i].used_ = false;
-
+    ClearBuffer();
     depthHierarchyDirty_ = true;
 }
 
@@ -206,41 +230,37 @@ bool OcclusionBuffer::AddTriangles(const Matrix3x4& model, const void* vertexDat
 
 void OcclusionBuffer::DrawTriangles()
 {
-    if (buffers_.size() == 1)
-    {
-        // Not threaded
-        for (auto i = batches_.begin(); i != batches_.end(); ++i)
-            DrawBatch(*i, 0);
+    if (!buffer_.data_)
+        return;
 
-        depthHierarchyDirty_ = true;
+    if (!threaded_)
+    {
+        for (const OcclusionBatch& batch : batches_)
+            DrawBatch(batch);
     }
-    else if (buffers_.size() > 1)
+    else
     {
-        // Threaded
+        // Transform and clip triangles in worker threads, then rasterize bins of rows in worker threads
         auto* queue = GetSubsystem<WorkQueue>();
-
-        for (auto i = batches_.begin(); i != batches_.end(); ++i)
+        threadTriangles_.Clear();
+        ForEachParallel(queue, 1, batches_.size(),
+            [&](unsigned beginIndex, unsigned endIndex)
         {
-            SharedPtr<WorkItem> item = queue->GetFreeItem();
-            item->priority_ = M_MAX_UNSIGNED;
-            item->workFunction_ = DrawOcclusionBatchWork;
-            item->aux_ = this;
-            item->start_ = &(*i);
-            queue->AddWorkItem(item);
-        }
+            URHO3D_PROFILE("DrawOcclusionBatchWork");
+            for (unsigned i = beginIndex; i < endIndex; ++i)
+                DrawBatch(batches_[i]);
+        });
 
-        queue->Complete(M_MAX_UNSIGNED);
-
-        MergeBuffers();
-        depthHierarchyDirty_ = true;
+        DrawBinnedTriangles();
     }
 
+    depthHierarchyDirty_ = true;
     batches_.clear();
 }
 
 void OcclusionBuffer::BuildDepthHierarchy()
 {
-    if (buffers_.empty() || !depthHierarchyDirty_)
+    if (!buffer_.data_ || !depthHierarchyDirty_)
         return;
 
     URHO3D_PROFILE("BuildDepthHierarchy");
@@ -252,7 +272,7 @@ void OcclusionBuffer::BuildDepthHierarchy()
     {
         for (int y = 0; y < height; ++y)
         {
-            int* src = buffers_[0].data_ + (y * 2) * width_;
+            int* src = buffer_.data_ + (y * 2) * width_;
             DepthValue* dest = mipBuffers_[0].get() + y * width;
             DepthValue* end = dest + width;
 
@@ -342,7 +362,7 @@ void OcclusionBuffer::ResetUseTimer()
 
 bool OcclusionBuffer::IsVisible(const BoundingBox& worldSpaceBox) const
 {
-    if (buffers_.empty())
+    if (!buffer_.data_)
         return true;
 
     // Transform corners to projection space
@@ -386,6 +406,103 @@ bool OcclusionBuffer::IsVisible(const BoundingBox& worldSpaceBox) const
         if (projected.z_ < minZ) minZ = projected.z_;
     }
 
+    return IsRectVisible(minX, minY, maxX, maxY, minZ);
+}
+
+void OcclusionBuffer::IsVisible(ea::span<const BoundingBox> worldSpaceBoxes, ea::span<bool> result) const
+{
+    URHO3D_ASSERT(worldSpaceBoxes.size() == result.size());
+
+    const unsigned numBoxes = worldSpaceBoxes.size();
+    if (!buffer_.data_)
+    {
+        ea::fill(result.begin(), result.end(), true);
+        return;
+    }
+
+    unsigned index = 0;
+#ifdef URHO3D_SSE
+    // Project 4 boxes at once, each lane is a box. Results are the same as for IsVisible(const BoundingBox&)
+    const Matrix4& m = viewProj_;
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 relativeBias = _mm_set1_ps(OCCLUSION_RELATIVE_BIAS);
+    const __m128 zScale = _mm_set1_ps(OCCLUSION_Z_SCALE);
+    const __m128 scaleX = _mm_set1_ps(scaleX_);
+    const __m128 scaleY = _mm_set1_ps(scaleY_);
+    const __m128 offsetX = _mm_set1_ps(offsetX_);
+    const __m128 offsetY = _mm_set1_ps(offsetY_);
+
+    const auto transformRow = [](float m0, float m1, float m2, float m3, __m128 x, __m128 y, __m128 z)
+    {
+        const __m128 xy = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(m0), x), _mm_mul_ps(_mm_set1_ps(m1), y));
+        return _mm_add_ps(_mm_add_ps(xy, _mm_mul_ps(_mm_set1_ps(m2), z)), _mm_set1_ps(m3));
+    };
+
+    for (; index + 4 <= numBoxes; index += 4)
+    {
+        const BoundingBox* boxes = &worldSpaceBoxes[index];
+        const __m128 boxMinX = _mm_setr_ps(boxes[0].min_.x_, boxes[1].min_.x_, boxes[2].min_.x_, boxes[3].min_.x_);
+        const __m128 boxMinY = _mm_setr_ps(boxes[0].min_.y_, boxes[1].min_.y_, boxes[2].min_.y_, boxes[3].min_.y_);
+        const __m128 boxMinZ = _mm_setr_ps(boxes[0].min_.z_, boxes[1].min_.z_, boxes[2].min_.z_, boxes[3].min_.z_);
+        const __m128 boxMaxX = _mm_setr_ps(boxes[0].max_.x_, boxes[1].max_.x_, boxes[2].max_.x_, boxes[3].max_.x_);
+        const __m128 boxMaxY = _mm_setr_ps(boxes[0].max_.y_, boxes[1].max_.y_, boxes[2].max_.y_, boxes[3].max_.y_);
+        const __m128 boxMaxZ = _mm_setr_ps(boxes[0].max_.z_, boxes[1].max_.z_, boxes[2].max_.z_, boxes[3].max_.z_);
+
+        __m128 minX = _mm_set1_ps(M_INFINITY);
+        __m128 minY = _mm_set1_ps(M_INFINITY);
+        __m128 minZ = _mm_set1_ps(M_INFINITY);
+        __m128 maxX = _mm_set1_ps(-M_INFINITY);
+        __m128 maxY = _mm_set1_ps(-M_INFINITY);
+        __m128 crossesNearPlane = zero;
+
+        for (unsigned corner = 0; corner < 8; ++corner)
+        {
+            const __m128 x = (corner & 1u) ? boxMaxX : boxMinX;
+            const __m128 y = (corner & 2u) ? boxMaxY : boxMinY;
+            const __m128 z = (corner & 4u) ? boxMaxZ : boxMinZ;
+
+            const __m128 clipX = transformRow(m.m00_, m.m01_, m.m02_, m.m03_, x, y, z);
+            const __m128 clipY = transformRow(m.m10_, m.m11_, m.m12_, m.m13_, x, y, z);
+            const __m128 clipZ = _mm_sub_ps(transformRow(m.m20_, m.m21_, m.m22_, m.m23_, x, y, z), relativeBias);
+            const __m128 clipW = transformRow(m.m30_, m.m31_, m.m32_, m.m33_, x, y, z);
+            crossesNearPlane = _mm_or_ps(crossesNearPlane, _mm_cmple_ps(clipZ, zero));
+
+            const __m128 invW = _mm_div_ps(one, clipW);
+            const __m128 projectedX = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(invW, clipX), scaleX), offsetX);
+            const __m128 projectedY = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(invW, clipY), scaleY), offsetY);
+            const __m128 projectedZ = _mm_mul_ps(_mm_mul_ps(invW, clipZ), zScale);
+
+            minX = _mm_min_ps(minX, projectedX);
+            minY = _mm_min_ps(minY, projectedY);
+            minZ = _mm_min_ps(minZ, projectedZ);
+            maxX = _mm_max_ps(maxX, projectedX);
+            maxY = _mm_max_ps(maxY, projectedY);
+        }
+
+        alignas(16) float rects[5][4];
+        _mm_store_ps(rects[0], minX);
+        _mm_store_ps(rects[1], minY);
+        _mm_store_ps(rects[2], maxX);
+        _mm_store_ps(rects[3], maxY);
+        _mm_store_ps(rects[4], minZ);
+        const int nearMask = _mm_movemask_ps(crossesNearPlane);
+
+        for (unsigned lane = 0; lane < 4; ++lane)
+        {
+            // If any of the corners cross the near plane, assume visible
+            result[index + lane] = (nearMask & (1 << lane))
+                || IsRectVisible(rects[0][lane], rects[1][lane], rects[2][lane], rects[3][lane], rects[4][lane]);
+        }
+    }
+#endif
+
+    for (; index < numBoxes; ++index)
+        result[index] = IsVisible(worldSpaceBoxes[index]);
+}
+
+bool OcclusionBuffer::IsRectVisible(float minX, float minY, float maxX, float maxY, float minZ) const
+{
     // Expand the bounding box 1 pixel in each direction to be conservative and correct rasterization offset
     IntRect rect((int)(minX - 1.5f), (int)(minY - 1.5f), RoundToInt(maxX), RoundToInt(maxY));
 
@@ -444,8 +561,8 @@ bool OcclusionBuffer::IsVisible(const BoundingBox& worldSpaceBox) const
     }
 
     // If no conclusive result, finally check the pixel-level data
-    int* row = buffers_[0].data_ + rect.top_ * width_;
-    int* endRow = buffers_[0].data_ + rect.bottom_ * width_;
+    int* row = buffer_.data_ + rect.top_ * width_;
+    int* endRow = buffer_.data_ + rect.bottom_ * width_;
     while (row <= endRow)
     {
         int* src = row + rect.left_;
@@ -468,15 +585,8 @@ unsigned OcclusionBuffer::GetUseTimer()
 }
 
 
-void OcclusionBuffer::DrawBatch(const OcclusionBatch& batch, unsigned threadIndex)
+void OcclusionBuffer::DrawBatch(const OcclusionBatch& batch)
 {
-    // If buffer not yet used, clear it
-    if (threadIndex > 0 && !buffers_[threadIndex].used_)
-    {
-        ClearBuffer(threadIndex);
-        buffers_[threadIndex].used_ = true;
-    }
-
     Matrix4 modelViewProj = viewProj_ * batch.model_;
 
     // Theoretical max. amount of vertices if each of the 6 clipping planes doubles the triangle count
@@ -496,7 +606,7 @@ void OcclusionBuffer::DrawBatch(const OcclusionBatch& batch, unsigned threadInde
             vertices[0] = ModelTransform(modelViewProj, v0);
             vertices[1] = ModelTransform(modelViewProj, v1);
             vertices[2] = ModelTransform(modelViewProj, v2);
-            DrawTriangle(vertices, threadIndex);
+            DrawTriangle(vertices);
 
             index += 3;
         }
@@ -520,7 +630,7 @@ void OcclusionBuffer::DrawBatch(const OcclusionBatch& batch, unsigned threadInde
                 vertices[0] = ModelTransform(modelViewProj, v0);
                 vertices[1] = ModelTransform(modelViewProj, v1);
                 vertices[2] = ModelTransform(modelViewProj, v2);
-                DrawTriangle(vertices, threadIndex);
+                DrawTriangle(vertices);
 
                 indices += 3;
             }
@@ -539,7 +649,7 @@ void OcclusionBuffer::DrawBatch(const OcclusionBatch& batch, unsigned threadInde
                 vertices[0] = ModelTransform(modelViewProj, v0);
                 vertices[1] = ModelTransform(modelViewProj, v1);
                 vertices[2] = ModelTransform(modelViewProj, v2);
-                DrawTriangle(vertices, threadIndex);
+                DrawTriangle(vertices);
 
                 indices += 3;
             }
@@ -593,7 +703,7 @@ void OcclusionBuffer::CalculateViewport()
     projOffsetScaleY_ = projection_.m11_ * scaleY_;
 }
 
-void OcclusionBuffer::DrawTriangle(Vector4* vertices, unsigned threadIndex)
+void OcclusionBuffer::DrawTriangle(Vector4* vertices)
 {
     ClipMaskFlags clipMask{};
     ClipMaskFlags andClipMask{};
@@ -640,7 +750,7 @@ void OcclusionBuffer::DrawTriangle(Vector4* vertices, unsigned threadIndex)
         bool clockwise = SignedArea(projected[0], projected[1], projected[2]) < 0.0f;
         if (cullMode_ == CULL_NONE || (cullMode_ == CULL_CCW && clockwise) || (cullMode_ == CULL_CW && !clockwise))
         {
-            DrawTriangle2D(projected, clockwise, threadIndex);
+            SubmitTriangle2D(projected, clockwise);
             drawOk = true;
         }
     }
@@ -678,7 +788,7 @@ void OcclusionBuffer::DrawTriangle(Vector4* vertices, unsigned threadIndex)
                 bool clockwise = SignedArea(projected[0], projected[1], projected[2]) < 0.0f;
                 if (cullMode_ == CULL_NONE || (cullMode_ == CULL_CCW && clockwise) || (cullMode_ == CULL_CW && !clockwise))
                 {
-                    DrawTriangle2D(projected, clockwise, threadIndex);
+                    SubmitTriangle2D(projected, clockwise);
                     drawOk = true;
                 }
             }
@@ -809,6 +919,20 @@ struct Edge
         invZStep_ = RoundToInt(slope * gradients.dInvZdX_ + gradients.dInvZdY_);
     }
 
+    /// Advance to the next row.
+    void Step()
+    {
+        x_ += xStep_;
+        invZ_ += invZStep_;
+    }
+
+    /// Advance by the number of rows.
+    void Advance(int numRows)
+    {
+        x_ += xStep_ * numRows;
+        invZ_ += invZStep_ * numRows;
+    }
+
     /// X coordinate.
     int x_;
     /// X coordinate step.
@@ -819,7 +943,42 @@ struct Edge
     int invZStep_;
 };
 
-void OcclusionBuffer::DrawTriangle2D(const Vector3* vertices, bool clockwise, unsigned threadIndex)
+/// Draw spans between edges for rows [y0, y1) clipped to rows [beginRow, endRow) and to buffer width.
+/// Edges are advanced to row y1 even if some rows are skipped.
+static void DrawSpans(int* bufferData, int width, int y0, int y1, int beginRow, int endRow, Edge& left, Edge& right, int dInvZdX)
+{
+    const int firstRow = Max(y0, beginRow);
+    const int lastRow = Min(y1, endRow);
+    if (firstRow >= lastRow)
+    {
+        left.Advance(y1 - y0);
+        right.Advance(y1 - y0);
+        return;
+    }
+
+    left.Advance(firstRow - y0);
+    right.Advance(firstRow - y0);
+
+    int* row = bufferData + firstRow * width;
+    for (int y = firstRow; y < lastRow; ++y)
+    {
+        const int leftX = left.x_ >> 16u;
+        const int rightX = right.x_ >> 16u;
+        const int beginX = Max(leftX, 0);
+        const int endX = Min(rightX, width);
+        if (beginX < endX)
+            FillSpan(row + beginX, row + endX, left.invZ_ + (beginX - leftX) * dInvZdX, dInvZdX);
+
+        left.Step();
+        right.Step();
+        row += width;
+    }
+
+    left.Advance(y1 - lastRow);
+    right.Advance(y1 - lastRow);
+}
+
+void OcclusionBuffer::DrawTriangle2D(const Vector3* vertices, bool clockwise, int beginRow, int endRow)
 {
     int top, middle, bottom;
     bool middleIsRight;
@@ -896,7 +1055,7 @@ void OcclusionBuffer::DrawTriangle2D(const Vector3* vertices, bool clockwise, un
     Gradients gradients(vertices);
     Edge topToBottom(gradients, vertices[top], vertices[bottom], topY);
 
-    int* bufferData = buffers_[threadIndex].data_;
+    int* bufferData = buffer_.data_;
 
     if (middleIsRight)
     {
@@ -904,52 +1063,15 @@ void OcclusionBuffer::DrawTriangle2D(const Vector3* vertices, bool clockwise, un
         if (!topDegenerate)
         {
             Edge topToMiddle(gradients, vertices[top], vertices[middle], topY);
-            int* row = bufferData + topY * width_;
-            int* endRow = bufferData + middleY * width_;
-            while (row < endRow)
-            {
-                int invZ = topToBottom.invZ_;
-                int* dest = row + (topToBottom.x_ >> 16u);
-                int* end = row + (topToMiddle.x_ >> 16u);
-                while (dest < end)
-                {
-                    if (invZ < *dest)
-                        *dest = invZ;
-                    invZ += gradients.dInvZdXInt_;
-                    ++dest;
-                }
-
-                topToBottom.x_ += topToBottom.xStep_;
-                topToBottom.invZ_ += topToBottom.invZStep_;
-                topToMiddle.x_ += topToMiddle.xStep_;
-                row += width_;
-            }
+            DrawSpans(bufferData, width_, topY, middleY, beginRow, endRow, topToBottom, topToMiddle, gradients.dInvZdXInt_);
         }
 
         // Bottom half
         if (!bottomDegenerate)
         {
             Edge middleToBottom(gradients, vertices[middle], vertices[bottom], middleY);
-            int* row = bufferData + middleY * width_;
-            int* endRow = bufferData + bottomY * width_;
-            while (row < endRow)
-            {
-                int invZ = topToBottom.invZ_;
-                int* dest = row + (topToBottom.x_ >> 16u);
-                int* end = row + (middleToBottom.x_ >> 16u);
-                while (dest < end)
-                {
-                    if (invZ < *dest)
-                        *dest = invZ;
-                    invZ += gradients.dInvZdXInt_;
-                    ++dest;
-                }
-
-                topToBottom.x_ += topToBottom.xStep_;
-                topToBottom.invZ_ += topToBottom.invZStep_;
-                middleToBottom.x_ += middleToBottom.xStep_;
-                row += width_;
-            }
+            DrawSpans(bufferData, width_, middleY, bottomY, beginRow, endRow, topToBottom, middleToBottom,
+                gradients.dInvZdXInt_);
         }
     }
     else
@@ -958,91 +1080,76 @@ void OcclusionBuffer::DrawTriangle2D(const Vector3* vertices, bool clockwise, un
         if (!topDegenerate)
         {
             Edge topToMiddle(gradients, vertices[top], vertices[middle], topY);
-            int* row = bufferData + topY * width_;
-            int* endRow = bufferData + middleY * width_;
-            while (row < endRow)
-            {
-                int invZ = topToMiddle.invZ_;
-                int* dest = row + (topToMiddle.x_ >> 16u);
-                int* end = row + (topToBottom.x_ >> 16u);
-                while (dest < end)
-                {
-                    if (invZ < *dest)
-                        *dest = invZ;
-                    invZ += gradients.dInvZdXInt_;
-                    ++dest;
-                }
-
-                topToMiddle.x_ += topToMiddle.xStep_;
-                topToMiddle.invZ_ += topToMiddle.invZStep_;
-                topToBottom.x_ += topToBottom.xStep_;
-                row += width_;
-            }
+            DrawSpans(bufferData, width_, topY, middleY, beginRow, endRow, topToMiddle, topToBottom, gradients.dInvZdXInt_);
         }
 
         // Bottom half
         if (!bottomDegenerate)
         {
             Edge middleToBottom(gradients, vertices[middle], vertices[bottom], middleY);
-            int* row = bufferData + middleY * width_;
-            int* endRow = bufferData + bottomY * width_;
-            while (row < endRow)
-            {
-                int invZ = middleToBottom.invZ_;
-                int* dest = row + (middleToBottom.x_ >> 16u);
-                int* end = row + (topToBottom.x_ >> 16u);
-                while (dest < end)
-                {
-                    if (invZ < *dest)
-                        *dest = invZ;
-                    invZ += gradients.dInvZdXInt_;
-                    ++dest;
-                }
-
-                middleToBottom.x_ += middleToBottom.xStep_;
-                middleToBottom.invZ_ += middleToBottom.invZStep_;
-                topToBottom.x_ += topToBottom.xStep_;
-                row += width_;
-            }
+            DrawSpans(bufferData, width_, middleY, bottomY, beginRow, endRow, middleToBottom, topToBottom,
+                gradients.dInvZdXInt_);
         }
     }
 }
 
-void OcclusionBuffer::MergeBuffers()
+void OcclusionBuffer::SubmitTriangle2D(const Vector3* vertices, bool clockwise)
 {
-    URHO3D_PROFILE("MergeBuffers");
+    if (threaded_)
+        threadTriangles_.Emplace(OcclusionTriangle{{vertices[0], vertices[1], vertices[2]}, clockwise});
+    else
+        DrawTriangle2D(vertices, clockwise, 0, height_);
+}
 
-    for (unsigned i = 1; i < buffers_.size(); ++i)
+void OcclusionBuffer::DrawBinnedTriangles()
+{
+    URHO3D_PROFILE("DrawBinnedTriangles");
+
+    threadTriangles_.CopyTo(triangles_);
+    for (ea::vector<unsigned>& bin : bins_)
+        bin.clear();
+
+    // Sort triangles into bins by rows they cover
+    const unsigned numTriangles = triangles_.size();
+    for (unsigned i = 0; i < numTriangles; ++i)
     {
-        if (!buffers_[i].used_)
+        const Vector3* vertices = triangles_[i].vertices_;
+        const auto topY = static_cast<int>(Min(vertices[0].y_, Min(vertices[1].y_, vertices[2].y_)));
+        const auto bottomY = static_cast<int>(Max(vertices[0].y_, Max(vertices[1].y_, vertices[2].y_)));
+        if (topY == bottomY || bottomY <= 0 || topY >= height_)
             continue;
 
-        int* src = buffers_[i].data_;
-        int* dest = buffers_[0].data_;
-        int count = width_ * height_;
+        const int firstBin = Max(topY, 0) / OCCLUSION_BIN_HEIGHT;
+        const int lastBin = (Min(bottomY, height_) - 1) / OCCLUSION_BIN_HEIGHT;
+        for (int bin = firstBin; bin <= lastBin; ++bin)
+            bins_[bin].push_back(i);
+    }
 
-        while (count--)
+    // Each bin is rasterized by one thread, so threads never write the same pixels
+    auto* queue = GetSubsystem<WorkQueue>();
+    ForEachParallel(queue, 1, bins_.size(),
+        [&](unsigned beginIndex, unsigned endIndex)
+    {
+        URHO3D_PROFILE("DrawOcclusionBinWork");
+        for (unsigned binIndex = beginIndex; binIndex < endIndex; ++binIndex)
         {
-            // If thread buffer's depth value is closer, overwrite the original
-            if (*src < *dest)
-                *dest = *src;
-            ++src;
-            ++dest;
+            const int beginRow = binIndex * OCCLUSION_BIN_HEIGHT;
+            const int endRow = Min(beginRow + OCCLUSION_BIN_HEIGHT, height_);
+            for (unsigned triangleIndex : bins_[binIndex])
+            {
+                const OcclusionTriangle& triangle = triangles_[triangleIndex];
+                DrawTriangle2D(triangle.vertices_, triangle.clockwise_, beginRow, endRow);
+            }
         }
-    }
+    });
 }
 
-void OcclusionBuffer::ClearBuffer(unsigned threadIndex)
+void OcclusionBuffer::ClearBuffer()
 {
-    if (threadIndex >= buffers_.size())
+    if (!buffer_.data_)
         return;
 
-    int* dest = buffers_[threadIndex].data_;
-    int count = width_ * height_;
-    auto fillValue = (int)OCCLUSION_Z_SCALE;
-
-    while (count--)
-        *dest++ = fillValue;
+    ea::fill(buffer_.data_, buffer_.data_ + width_ * height_, static_cast<int>(OCCLUSION_Z_SCALE));
 }
 
 }
@@ -25,9 +25,11 @@
 #pragma once
 
 #include <EASTL/shared_array.h>
+#include <EASTL/span.h>
 
 #include "../Core/Object.h"
 #include "../Core/Timer.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/GraphicsDefs.h"
 #include "../Math/Frustum.h"
 
@@ -51,15 +53,24 @@ struct DepthValue
     int max_;
 };
 
-/// Per-thread occlusion buffer data.
+/// Occlusion buffer data.
 struct OcclusionBufferData
 {
     /// Full buffer data with safety padding.
     ea::shared_array<int> dataWithSafety_;
     /// Buffer data.
-    int* data_;
+    int* data_{};
     /// Use flag.
-    bool used_;
+    bool used_{};
+};
+
+/// Clipped occluder triangle in screen space, ready for rasterization.
+struct OcclusionTriangle
+{
+    /// Vertices in screen space.
+    Vector3 vertices_[3];
+    /// Whether the triangle is clockwise.
+    bool clockwise_{};
 };
 
 /// Stored occlusion render job.
@@ -87,6 +98,7 @@ static const float OCCLUSION_RELATIVE_BIAS = 0.00001f;
 static const int OCCLUSION_FIXED_BIAS = 16;
 static const float OCCLUSION_X_SCALE = 65536.0f;
 static const float OCCLUSION_Z_SCALE = 16777216.0f;
+static const int OCCLUSION_BIN_HEIGHT = 16;
 
 /// Software renderer for occlusion.
 class URHO3D_API OcclusionBuffer : public Object
@@ -102,7 +114,7 @@ public:
     /// Register object with the engine.
     static void RegisterObject(Context* context);
 
-    /// Set occlusion buffer size and whether to reserve multiple buffers for threading optimization.
+    /// Set occlusion buffer size and whether to rasterize in multiple threads.
     bool SetSize(int width, int height, bool threaded);
     /// Set camera view to render from.
     void SetView(Camera* camera);
@@ -127,7 +139,7 @@ public:
     void ResetUseTimer();
 
     /// Return highest level depth values.
-    int* GetBuffer() const { return buffers_.size() ? buffers_[0].data_ : nullptr; }
+    int* GetBuffer() const { return buffer_.data_; }
 
     /// Return view transform matrix.
     const Matrix3x4& GetView() const { return view_; }
@@ -151,15 +163,18 @@ public:
     CullMode GetCullMode() const { return cullMode_; }
 
     /// Return whether is using threads to speed up rendering.
-    bool IsThreaded() const { return buffers_.size() > 1; }
+    bool IsThreaded() const { return threaded_; }
 
     /// Test a bounding box for visibility. For best performance, build depth hierarchy first.
     bool IsVisible(const BoundingBox& worldSpaceBox) const;
+    /// Test bounding boxes for visibility. Boxes are projected in groups using SIMD if available.
+    /// For best performance, build depth hierarchy first.
+    void IsVisible(ea::span<const BoundingBox> worldSpaceBoxes, ea::span<bool> result) const;
     /// Return time since last use in milliseconds.
     unsigned GetUseTimer();
 
-    /// Draw a batch. Called internally.
-    void DrawBatch(const OcclusionBatch& batch, unsigned threadIndex);
+    /// Draw a batch. Called internally. If threaded, triangles are stored for binned rasterization.
+    void DrawBatch(const OcclusionBatch& batch);
 
 private:
     /// Apply modelview transform to vertex.
@@ -173,18 +188,30 @@ private:
     /// Calculate viewport transform.
     void CalculateViewport();
     /// Draw a triangle.
-    void DrawTriangle(Vector4* vertices, unsigned threadIndex);
+    void DrawTriangle(Vector4* vertices);
     /// Clip vertices against a plane.
     void ClipVertices(const Vector4& plane, Vector4* vertices, bool* triangles, unsigned& numTriangles);
-    /// Draw a clipped triangle.
-    void DrawTriangle2D(const Vector3* vertices, bool clockwise, unsigned threadIndex);
-    /// Clear a thread work buffer.
-    void ClearBuffer(unsigned threadIndex);
-    /// Merge thread work buffers into the first buffer.
-    void MergeBuffers();
-
-    /// Highest-level buffer data per thread.
-    ea::vector<OcclusionBufferData> buffers_;
+    /// Draw a clipped triangle or store it for binned rasterization.
+    void SubmitTriangle2D(const Vector3* vertices, bool clockwise);
+    /// Draw a clipped triangle within the range of rows.
+    void DrawTriangle2D(const Vector3* vertices, bool clockwise, int beginRow, int endRow);
+    /// Rasterize stored triangles in multiple threads. Each thread owns a horizontal bin of rows.
+    void DrawBinnedTriangles();
+    /// Test projected bounding rectangle for visibility.
+    bool IsRectVisible(float minX, float minY, float maxX, float maxY, float minZ) const;
+    /// Clear the buffer.
+    void ClearBuffer();
+
+    /// Highest-level buffer data.
+    OcclusionBufferData buffer_;
+    /// Whether to rasterize in multiple threads.
+    bool threaded_{};
+    /// Clipped triangles collected by threads.
+    WorkQueueVector<OcclusionTriangle> threadTriangles_;
+    /// Clipped triangles to rasterize.
+    ea::vector<OcclusionTriangle> triangles_;
+    /// Indices of triangles that overlap each bin of rows.
+    ea::vector<ea::vector<unsigned>> bins_;
     /// Reduced size depth buffers.
     ea::vector<ea::shared_array<DepthValue> > mipBuffers_;
     /// Submitted render jobs.
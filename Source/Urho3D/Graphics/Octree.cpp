@@ -26,9 +26,11 @@
 
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
+#include "../Core/Metrics.h"
 #include "../Core/Profiler.h"
 #include "../Core/Thread.h"
 #include "../Graphics/DebugRenderer.h"
+#include "../Graphics/DrawableBVH.h"
 #include "../Graphics/Graphics.h"
 #include "../Graphics/Octree.h"
 #include "../Graphics/ReflectionProbe.h"
@@ -53,26 +55,20 @@ namespace
 /// Unused vector of drawables.
 static ea::vector<Drawable*> unusedDrawablesVector;
 
+const char* spatialIndexTypeNames[] = {
+    "Octree",
+    "BVH",
+    nullptr
+};
+
 }
 
 static const float DEFAULT_OCTREE_SIZE = 1000.0f;
 static const int DEFAULT_OCTREE_LEVELS = 8;
-
-void UpdateDrawablesWork(const WorkItem* item, unsigned threadIndex)
-{
-    URHO3D_PROFILE("UpdateDrawablesWork");
-    const FrameInfo& frame = *(reinterpret_cast<FrameInfo*>(item->aux_));
-    auto** start = reinterpret_cast<Drawable**>(item->start_);
-    auto** end = reinterpret_cast<Drawable**>(item->end_);
-
-    while (start != end)
-    {
-        Drawable* drawable = *start;
-        if (drawable)
-            drawable->Update(frame);
-        ++start;
-    }
-}
+static const unsigned DRAWABLE_UPDATES_PER_TASK = 64;
+static const unsigned NODE_TRANSFORMS_PER_TASK = 1024;
+static const unsigned DRAWABLES_PER_FRUSTUM_TEST = 64;
+static const unsigned MAX_OCTANT_PATH_LENGTH = 21;
 
 inline bool CompareRayQueryResults(const RayQueryResult& lhs, const RayQueryResult& rhs)
 {
@@ -98,10 +94,13 @@ Octant::~Octant()
         for (auto i = drawables_.begin(); i != drawables_.end(); ++i)
         {
             (*i)->SetOctant(rootOctant);
+            (*i)->octantIndex_ = rootOctant->drawables_.size();
             rootOctant->drawables_.push_back(*i);
+            rootOctant->drawableBounds_.PushBack((*i)->GetWorldBoundingBox());
             octree_->QueueUpdate(*i);
         }
         drawables_.clear();
+        drawableBounds_.Clear();
         numDrawables_ = 0;
     }
 
@@ -114,26 +113,7 @@ Octant* Octant::GetOrCreateChild(unsigned index)
     if (children_[index])
         return children_[index];
 
-    Vector3 newMin = worldBoundingBox_.min_;
-    Vector3 newMax = worldBoundingBox_.max_;
-    Vector3 oldCenter = worldBoundingBox_.Center();
-
-    if (index & 1u)
-        newMin.x_ = oldCenter.x_;
-    else
-        newMax.x_ = oldCenter.x_;
-
-    if (index & 2u)
-        newMin.y_ = oldCenter.y_;
-    else
-        newMax.y_ = oldCenter.y_;
-
-    if (index & 4u)
-        newMin.z_ = oldCenter.z_;
-    else
-        newMax.z_ = oldCenter.z_;
-
-    children_[index] = new Octant(BoundingBox(newMin, newMax), level_ + 1, this, octree_, index);
+    children_[index] = new Octant(GetChildBoundingBox(worldBoundingBox_, index), level_ + 1, this, octree_, index);
     return children_[index];
 }
 
@@ -144,6 +124,50 @@ void Octant::DeleteChild(unsigned index)
     children_[index] = nullptr;
 }
 
+void Octant::AddDrawable(Drawable* drawable)
+{
+    drawable->SetOctant(this);
+    drawable->octantIndex_ = drawables_.size();
+    drawables_.push_back(drawable);
+    drawableBounds_.PushBack(drawable->GetWorldBoundingBox());
+    IncDrawableCount();
+}
+
+void Octant::RemoveDrawable(Drawable* drawable)
+{
+    if (drawable->octant_ != this)
+        return;
+
+    const unsigned index = drawable->octantIndex_;
+    drawable->SetOctant(nullptr);
+    drawable->octantIndex_ = M_MAX_UNSIGNED;
+    RemoveDrawableAt(index);
+}
+
+void Octant::RemoveDrawableAt(unsigned index)
+{
+    URHO3D_ASSERT(index < drawables_.size());
+
+    drawables_.erase_at(index);
+    drawableBounds_.EraseAt(index);
+    for (unsigned i = index; i < drawables_.size(); ++i)
+        drawables_[i]->octantIndex_ = i;
+
+    DecDrawableCount();
+}
+
+void Octant::UpdateDrawableBounds(Drawable* drawable, const BoundingBox& box)
+{
+    URHO3D_ASSERT(drawable->octant_ == this);
+    drawableBounds_.Set(drawable->octantIndex_, box);
+}
+
+void Octant::InvalidateDrawableBounds(Drawable* drawable)
+{
+    URHO3D_ASSERT(drawable->octant_ == this);
+    drawableBounds_.Invalidate(drawable->octantIndex_);
+}
+
 void Octant::InsertDrawable(Drawable* drawable)
 {
     const BoundingBox& box = drawable->GetWorldBoundingBox();
@@ -157,44 +181,46 @@ void Octant::InsertDrawable(Drawable* drawable)
         insertHere = CheckDrawableFit(box);
 
     if (insertHere)
-    {
-        Octant* oldOctant = drawable->octant_;
-        if (oldOctant != this)
-        {
-            // Add first, then remove, because drawable count going to zero deletes the octree branch in question
-            AddDrawable(drawable);
-            if (oldOctant)
-                oldOctant->RemoveDrawable(drawable, false);
-        }
-    }
+        InsertDrawableHere(drawable);
     else
-    {
-        Vector3 boxCenter = box.Center();
-        unsigned x = boxCenter.x_ < center_.x_ ? 0 : 1;
-        unsigned y = boxCenter.y_ < center_.y_ ? 0 : 2;
-        unsigned z = boxCenter.z_ < center_.z_ ? 0 : 4;
+        GetOrCreateChild(GetChildIndex(box.Center(), center_))->InsertDrawable(drawable);
+}
 
-        GetOrCreateChild(x + y + z)->InsertDrawable(drawable);
+void Octant::InsertDrawableHere(Drawable* drawable)
+{
+    Octant* oldOctant = drawable->octant_;
+    if (oldOctant != this)
+    {
+        const unsigned oldIndex = drawable->octantIndex_;
+        // Add first, then remove, because drawable count going to zero deletes the octree branch in question
+        AddDrawable(drawable);
+        if (oldOctant)
+            oldOctant->RemoveDrawableAt(oldIndex);
     }
 }
 
 bool Octant::CheckDrawableFit(const BoundingBox& box) const
 {
-    Vector3 boxSize = box.Size();
+    return CheckDrawableFit(box, worldBoundingBox_, level_, octree_->GetNumLevels());
+}
+
+bool Octant::CheckDrawableFit(const BoundingBox& box, const BoundingBox& octantBox, unsigned level, unsigned numLevels)
+{
+    const Vector3 boxSize = box.Size();
+    const Vector3 halfSize = 0.5f * octantBox.Size();
 
     // If max split level, size always OK, otherwise check that box is at least half size of octant
-    if (level_ >= octree_->GetNumLevels() || boxSize.x_ >= halfSize_.x_ || boxSize.y_ >= halfSize_.y_ ||
-        boxSize.z_ >= halfSize_.z_)
+    if (level >= numLevels || boxSize.x_ >= halfSize.x_ || boxSize.y_ >= halfSize.y_ || boxSize.z_ >= halfSize.z_)
         return true;
     // Also check if the box can not fit a child octant's culling box, in that case size OK (must insert here)
     else
     {
-        if (box.min_.x_ <= worldBoundingBox_.min_.x_ - 0.5f * halfSize_.x_ ||
-            box.max_.x_ >= worldBoundingBox_.max_.x_ + 0.5f * halfSize_.x_ ||
-            box.min_.y_ <= worldBoundingBox_.min_.y_ - 0.5f * halfSize_.y_ ||
-            box.max_.y_ >= worldBoundingBox_.max_.y_ + 0.5f * halfSize_.y_ ||
-            box.min_.z_ <= worldBoundingBox_.min_.z_ - 0.5f * halfSize_.z_ ||
-            box.max_.z_ >= worldBoundingBox_.max_.z_ + 0.5f * halfSize_.z_)
+        if (box.min_.x_ <= octantBox.min_.x_ - 0.5f * halfSize.x_ ||
+            box.max_.x_ >= octantBox.max_.x_ + 0.5f * halfSize.x_ ||
+            box.min_.y_ <= octantBox.min_.y_ - 0.5f * halfSize.y_ ||
+            box.max_.y_ >= octantBox.max_.y_ + 0.5f * halfSize.y_ ||
+            box.min_.z_ <= octantBox.min_.z_ - 0.5f * halfSize.z_ ||
+            box.max_.z_ >= octantBox.max_.z_ + 0.5f * halfSize.z_)
             return true;
     }
 
@@ -202,6 +228,38 @@ bool Octant::CheckDrawableFit(const BoundingBox& box) const
     return false;
 }
 
+unsigned Octant::GetChildIndex(const Vector3& point, const Vector3& octantCenter)
+{
+    const unsigned x = point.x_ < octantCenter.x_ ? 0 : 1;
+    const unsigned y = point.y_ < octantCenter.y_ ? 0 : 2;
+    const unsigned z = point.z_ < octantCenter.z_ ? 0 : 4;
+    return x + y + z;
+}
+
+BoundingBox Octant::GetChildBoundingBox(const BoundingBox& octantBox, unsigned index)
+{
+    Vector3 newMin = octantBox.min_;
+    Vector3 newMax = octantBox.max_;
+    const Vector3 oldCenter = octantBox.Center();
+
+    if (index & 1u)
+        newMin.x_ = oldCenter.x_;
+    else
+        newMax.x_ = oldCenter.x_;
+
+    if (index & 2u)
+        newMin.y_ = oldCenter.y_;
+    else
+        newMax.y_ = oldCenter.y_;
+
+    if (index & 4u)
+        newMin.z_ = oldCenter.z_;
+    else
+        newMax.z_ = oldCenter.z_;
+
+    return BoundingBox(newMin, newMax);
+}
+
 void Octant::SetRootSize(const BoundingBox& box)
 {
     // If drawables exist, they are temporarily moved to the root
@@ -220,6 +278,7 @@ void Octant::ResetOctree()
     for (Drawable* drawable : drawables_)
     {
         drawable->SetOctant(nullptr);
+        drawable->octantIndex_ = M_MAX_UNSIGNED;
         drawable->SetDrawableIndex(M_MAX_UNSIGNED);
     }
 
@@ -230,6 +289,27 @@ void Octant::ResetOctree()
     }
 }
 
+void Octant::ClearDrawables()
+{
+    for (Drawable* drawable : drawables_)
+    {
+        drawable->SetOctant(nullptr);
+        drawable->octantIndex_ = M_MAX_UNSIGNED;
+    }
+    drawables_.clear();
+    drawableBounds_.Clear();
+    numDrawables_ = 0;
+
+    for (unsigned i = 0; i < NUM_OCTANTS; ++i)
+    {
+        if (children_[i])
+        {
+            children_[i]->ClearDrawables();
+            DeleteChild(i);
+        }
+    }
+}
+
 void Octant::DrawDebugGeometry(DebugRenderer* debug, bool depthTest)
 {
     if (debug && debug->IsInside(worldBoundingBox_))
@@ -268,9 +348,15 @@ void Octant::GetDrawablesInternal(OctreeQuery& query, bool inside) const
 
     if (drawables_.size())
     {
-        auto** start = const_cast<Drawable**>(&drawables_[0]);
-        Drawable** end = start + drawables_.size();
-        query.TestDrawables(start, end, inside);
+        const Frustum* frustum = !inside ? query.GetCullingFrustum() : nullptr;
+        if (frustum)
+            TestDrawablesInFrustum(query, *frustum);
+        else
+        {
+            auto** start = const_cast<Drawable**>(&drawables_[0]);
+            Drawable** end = start + drawables_.size();
+            query.TestDrawables(start, end, inside);
+        }
     }
 
     for (auto child : children_)
@@ -280,6 +366,37 @@ void Octant::GetDrawablesInternal(OctreeQuery& query, bool inside) const
     }
 }
 
+void Octant::TestDrawablesInFrustum(OctreeQuery& query, const Frustum& frustum) const
+{
+    unsigned visibleIndices[DRAWABLES_PER_FRUSTUM_TEST];
+    Drawable* visibleDrawables[DRAWABLES_PER_FRUSTUM_TEST];
+    Drawable* invalidDrawables[DRAWABLES_PER_FRUSTUM_TEST];
+
+    const unsigned numDrawables = drawables_.size();
+    for (unsigned beginIndex = 0; beginIndex < numDrawables; beginIndex += DRAWABLES_PER_FRUSTUM_TEST)
+    {
+        const unsigned endIndex = ea::min(beginIndex + DRAWABLES_PER_FRUSTUM_TEST, numDrawables);
+        const unsigned numVisible = drawableBounds_.CullFrustum(frustum, beginIndex, endIndex, visibleIndices);
+
+        // Drawables with invalid cached bounds are tested by the query as usual
+        unsigned numVisibleDrawables = 0;
+        unsigned numInvalidDrawables = 0;
+        for (unsigned i = 0; i < numVisible; ++i)
+        {
+            const unsigned index = visibleIndices[i];
+            if (drawableBounds_.IsValid(index))
+                visibleDrawables[numVisibleDrawables++] = drawables_[index];
+            else
+                invalidDrawables[numInvalidDrawables++] = drawables_[index];
+        }
+
+        if (numVisibleDrawables > 0)
+            query.TestDrawables(visibleDrawables, visibleDrawables + numVisibleDrawables, true);
+        if (numInvalidDrawables > 0)
+            query.TestDrawables(invalidDrawables, invalidDrawables + numInvalidDrawables, false);
+    }
+}
+
 void Octant::GetDrawablesInternal(RayOctreeQuery& query) const
 {
     float octantDist = query.ray_.HitDistance(cullingBox_);
@@ -444,6 +561,16 @@ Octree::~Octree()
     // Reset root pointer from all child octants now so that they do not move their drawables to root
     drawableUpdates_.clear();
     rootOctant_.ResetOctree();
+
+    // Drawables in spatial index are not stored in octants
+    if (spatialIndex_)
+    {
+        for (Drawable* drawable : drawables_)
+        {
+            drawable->SetOctant(nullptr);
+            drawable->SetDrawableIndex(M_MAX_UNSIGNED);
+        }
+    }
 }
 
 void Octree::RegisterObject(Context* context)
@@ -456,6 +583,8 @@ void Octree::RegisterObject(Context* context)
     URHO3D_ATTRIBUTE_EX("Bounding Box Min", Vector3, worldBoundingBox_.min_, UpdateOctreeSize, defaultBoundsMin, AM_DEFAULT);
     URHO3D_ATTRIBUTE_EX("Bounding Box Max", Vector3, worldBoundingBox_.max_, UpdateOctreeSize, defaultBoundsMax, AM_DEFAULT);
     URHO3D_ATTRIBUTE_EX("Number of Levels", int, numLevels_, UpdateOctreeSize, DEFAULT_OCTREE_LEVELS, AM_DEFAULT);
+    URHO3D_ENUM_ACCESSOR_ATTRIBUTE("Spatial Index", GetSpatialIndexType, SetSpatialIndexType, SpatialIndexType,
+        spatialIndexTypeNames, SpatialIndexType::Octree, AM_DEFAULT);
 }
 
 void Octree::DrawDebugGeometry(DebugRenderer* debug, bool depthTest)
@@ -464,7 +593,10 @@ void Octree::DrawDebugGeometry(DebugRenderer* debug, bool depthTest)
     {
         URHO3D_PROFILE("OctreeDrawDebug");
 
-        rootOctant_.DrawDebugGeometry(debug, depthTest);
+        if (spatialIndex_)
+            spatialIndex_->DrawDebugGeometry(debug, depthTest);
+        else
+            rootOctant_.DrawDebugGeometry(debug, depthTest);
     }
 }
 
@@ -477,6 +609,28 @@ void Octree::SetSize(const BoundingBox& box, unsigned numLevels)
     numLevels_ = Max(numLevels, 1U);
 }
 
+void Octree::SetSpatialIndexType(SpatialIndexType type)
+{
+    if (type == spatialIndexType_)
+        return;
+
+    URHO3D_PROFILE("ChangeSpatialIndex");
+
+    // Detach drawables from the old index and insert them into the new one
+    rootOctant_.ClearDrawables();
+    for (Drawable* drawable : drawables_)
+        drawable->SetOctant(nullptr);
+
+    spatialIndexType_ = type;
+    if (type == SpatialIndexType::BVH)
+        spatialIndex_ = ea::make_unique<DrawableBVH>();
+    else
+        spatialIndex_ = nullptr;
+
+    for (Drawable* drawable : drawables_)
+        InsertDrawable(drawable);
+}
+
 void Octree::Update(const FrameInfo& frame)
 {
     if (!Thread::IsMainThread())
@@ -485,6 +639,8 @@ void Octree::Update(const FrameInfo& frame)
         return;
     }
 
+    URHO3D_METRIC_TIMER("Octree::Update");
+
     // Let drawables update themselves before reinsertion. This can be used for animation
     if (!drawableUpdates_.empty())
     {
@@ -497,43 +653,30 @@ void Octree::Update(const FrameInfo& frame)
         scene->BeginThreadedUpdate();
 
         pendingNodeTransforms_.Clear();
+        threadedDrawableUpdates_.Clear();
 
-        int numWorkItems = queue->GetNumThreads() + 1; // Worker threads + main thread
-        int drawablesPerItem = Max((int)(drawableUpdates_.size() / numWorkItems), 1);
-
-        auto start = drawableUpdates_.begin();
-        // Create a work item for each thread
-        for (int i = 0; i < numWorkItems; ++i)
+        // Buckets are small enough for the threads to balance uneven update costs by stealing
+        ForEachParallel(queue, DRAWABLE_UPDATES_PER_TASK, drawableUpdates_.size(),
+            [&](unsigned beginIndex, unsigned endIndex)
         {
-            SharedPtr<WorkItem> item = queue->GetFreeItem();
-            item->priority_ = M_MAX_UNSIGNED;
-            item->workFunction_ = UpdateDrawablesWork;
-            item->aux_ = const_cast<FrameInfo*>(&frame);
-
-            auto end = drawableUpdates_.end();
-            if (i < numWorkItems - 1 && end - start > drawablesPerItem)
-                end = start + drawablesPerItem;
-
-            item->start_ = &(*start);
-            item->end_ = &(*end);
-            queue->AddWorkItem(item);
-
-            start = end;
-        }
+            URHO3D_PROFILE("UpdateDrawablesWork");
+            for (unsigned i = beginIndex; i < endIndex; ++i)
+            {
+                if (Drawable* drawable = drawableUpdates_[i])
+                    drawable->Update(frame);
+            }
+        });
 
-        queue->Complete(M_MAX_UNSIGNED);
         scene->EndThreadedUpdate();
     }
 
     // If any drawables were inserted during threaded update, update them now from the main thread
-    if (!threadedDrawableUpdates_.empty())
+    if (threadedDrawableUpdates_.Size() != 0)
     {
         URHO3D_PROFILE("UpdateDrawablesQueuedDuringUpdate");
 
-        for (auto i = threadedDrawableUpdates_.begin(); i !=
-            threadedDrawableUpdates_.end(); ++i)
+        for (Drawable* drawable : threadedDrawableUpdates_)
         {
-            Drawable* drawable = *i;
             if (drawable)
             {
                 drawable->Update(frame);
@@ -541,14 +684,42 @@ void Octree::Update(const FrameInfo& frame)
             }
         }
 
-        threadedDrawableUpdates_.clear();
+        threadedDrawableUpdates_.Clear();
     }
 
-    // Commit delayed Node transforms
-    if (!drawableUpdates_.empty())
+    // Commit delayed Node transforms. Transforms are assigned silently in parallel,
+    // and only dirty flags are propagated from the main thread
+    if (!drawableUpdates_.empty() && pendingNodeTransforms_.Size() != 0)
     {
+        URHO3D_PROFILE("CommitNodeTransforms");
+
+        // The same node may be queued more than once, keep only the last transform so each node is written by one thread.
+        // Nodes keep the position of the first entry because parent bones are usually queued first
+        committedNodeTransforms_.clear();
+        committedNodeIndices_.clear();
         for (const auto& [node, transform] : pendingNodeTransforms_)
-            node->SetTransform(transform.position_, transform.rotation_, transform.scale_);
+        {
+            const auto [iter, inserted] = committedNodeIndices_.emplace(node, committedNodeTransforms_.size());
+            if (inserted)
+                committedNodeTransforms_.emplace_back(node, transform);
+            else
+                committedNodeTransforms_[iter->second].second = transform;
+        }
+
+        auto* queue = GetSubsystem<WorkQueue>();
+        ForEachParallel(queue, NODE_TRANSFORMS_PER_TASK, committedNodeTransforms_.size(),
+            [&](unsigned beginIndex, unsigned endIndex)
+        {
+            for (unsigned i = beginIndex; i < endIndex; ++i)
+            {
+                const auto& [node, transform] = committedNodeTransforms_[i];
+                node->SetTransformSilent(transform.position_, transform.rotation_, transform.scale_);
+            }
+        });
+
+        // Parent bones are usually queued first, so marking of their children returns early
+        for (const auto& [node, transform] : committedNodeTransforms_)
+            node->MarkDirty();
     }
 
     // Notify drawable update being finished. Custom animation (eg. IK) can be done at this point
@@ -566,36 +737,7 @@ void Octree::Update(const FrameInfo& frame)
     // Reinsert drawables that have been moved or resized, or that have been newly added to the octree and do not sit inside
     // the proper octant yet
     if (!drawableUpdates_.empty())
-    {
-        URHO3D_PROFILE("ReinsertToOctree");
-
-        for (auto i = drawableUpdates_.begin(); i != drawableUpdates_.end(); ++i)
-        {
-            Drawable* drawable = *i;
-            drawable->updateQueued_ = false;
-            Octant* octant = drawable->GetOctant();
-            const BoundingBox& box = drawable->GetWorldBoundingBox();
-
-            // Skip if no octant or does not belong to this octree anymore
-            if (!octant || octant->GetOctree() != this)
-                continue;
-            // Skip if still fits the current octant
-            if (drawable->IsOccludee() && octant->GetCullingBox().IsInside(box) == INSIDE && octant->CheckDrawableFit(box))
-                continue;
-
-            rootOctant_.InsertDrawable(drawable);
-
-#ifdef _DEBUG
-            // Verify that the drawable will be culled correctly
-            octant = drawable->GetOctant();
-            if (octant != GetRootOctant() && octant->GetCullingBox().IsInside(box) != INSIDE)
-            {
-                URHO3D_LOGERROR("Drawable is not fully inside its octant's culling bounds: drawable box " + box.ToString() +
-                         " octant box " + octant->GetCullingBox().ToString());
-            }
-#endif
-        }
-    }
+        ReinsertDrawables();
 
     drawableUpdates_.clear();
 
@@ -646,7 +788,7 @@ void Octree::AddDrawable(Drawable* drawable)
     drawable->SetDrawableIndex(index);
 
     // Insert drawable to common Octree
-    rootOctant_.InsertDrawable(drawable);
+    InsertDrawable(drawable);
 
     // Insert drawable to zone index
     if (drawable->GetDrawableFlags().Test(DRAWABLE_ZONE))
@@ -673,7 +815,13 @@ void Octree::RemoveDrawable(Drawable* drawable, Octant* octant)
     }
 
     // Remove drawable from Octree
-    octant->RemoveDrawable(drawable);
+    if (spatialIndex_)
+    {
+        spatialIndex_->RemoveDrawable(drawable);
+        drawable->SetOctant(nullptr);
+    }
+    else
+        octant->RemoveDrawable(drawable);
 
     // Remove drawable from Zone index
     if (drawable->GetDrawableFlags().Test(DRAWABLE_ZONE))
@@ -706,7 +854,10 @@ void Octree::MarkZoneDirty(Zone* zone)
 void Octree::GetDrawables(OctreeQuery& query) const
 {
     query.result_.clear();
-    rootOctant_.GetDrawablesInternal(query, false);
+    if (spatialIndex_)
+        spatialIndex_->GetDrawables(query);
+    else
+        rootOctant_.GetDrawablesInternal(query, false);
 }
 
 void Octree::Raycast(RayOctreeQuery& query) const
@@ -714,7 +865,15 @@ void Octree::Raycast(RayOctreeQuery& query) const
     URHO3D_PROFILE("Raycast");
 
     query.result_.clear();
-    rootOctant_.GetDrawablesInternal(query);
+    if (spatialIndex_)
+    {
+        ea::vector<Drawable*> drawables;
+        spatialIndex_->GetDrawables(query, drawables);
+        for (Drawable* drawable : drawables)
+            drawable->ProcessRayQuery(query, query.result_);
+    }
+    else
+        rootOctant_.GetDrawablesInternal(query);
     ea::quick_sort(query.result_.begin(), query.result_.end(), CompareRayQueryResults);
 }
 
@@ -724,7 +883,10 @@ void Octree::RaycastSingle(RayOctreeQuery& query) const
 
     query.result_.clear();
     rayQueryDrawables_.clear();
-    rootOctant_.GetDrawablesOnlyInternal(query, rayQueryDrawables_);
+    if (spatialIndex_)
+        spatialIndex_->GetDrawables(query, rayQueryDrawables_);
+    else
+        rootOctant_.GetDrawablesOnlyInternal(query, rayQueryDrawables_);
 
     // Sort by increasing hit distance to AABB
     for (auto i = rayQueryDrawables_.begin(); i != rayQueryDrawables_.end(); ++i)
@@ -778,11 +940,17 @@ void Octree::QueueUpdate(Drawable* drawable)
     Scene* scene = GetScene();
     if (scene && scene->IsThreadedUpdate())
     {
-        MutexLock lock(octreeMutex_);
-        threadedDrawableUpdates_.push_back(drawable);
+        threadedDrawableUpdates_.Insert(drawable);
     }
     else
+    {
         drawableUpdates_.push_back(drawable);
+        // Bounds may change before reinsertion, drawable should not be culled by cached bounds until then.
+        // Drawables queued during threaded update are reinserted before any query.
+        Octant* octant = drawable->GetOctant();
+        if (octant && !spatialIndex_)
+            octant->InvalidateDrawableBounds(drawable);
+    }
 
     drawable->updateQueued_ = true;
 }
@@ -795,6 +963,139 @@ void Octree::CancelUpdate(Drawable* drawable)
     drawable->updateQueued_ = false;
 }
 
+void Octree::ReinsertDrawables()
+{
+    URHO3D_PROFILE("ReinsertToOctree");
+    URHO3D_METRIC_TIMER("Octree::Reinsert");
+    URHO3D_METRIC_COUNTER("Octree::NumUpdatedDrawables", drawableUpdates_.size());
+
+    if (spatialIndex_)
+    {
+        for (Drawable* drawable : drawableUpdates_)
+        {
+            drawable->updateQueued_ = false;
+            Octant* octant = drawable->GetOctant();
+            if (octant && octant->GetOctree() == this)
+                spatialIndex_->UpdateDrawable(drawable);
+        }
+        return;
+    }
+
+    // Find target octants in worker threads. Octants are not changed here except cached bounds of drawables that stay.
+    auto* queue = GetSubsystem<WorkQueue>();
+    pendingReinsertions_.Clear();
+    {
+        URHO3D_PROFILE("FindTargetOctants");
+        URHO3D_METRIC_TIMER("Octree::ReinsertFindOctants");
+
+        ForEachParallel(queue, DRAWABLE_UPDATES_PER_TASK, drawableUpdates_.size(),
+            [&](unsigned beginIndex, unsigned endIndex)
+        {
+            for (unsigned i = beginIndex; i < endIndex; ++i)
+            {
+                Drawable* drawable = drawableUpdates_[i];
+                drawable->updateQueued_ = false;
+                Octant* octant = drawable->GetOctant();
+                const BoundingBox& box = drawable->GetWorldBoundingBox();
+
+                // Skip if no octant or does not belong to this octree anymore
+                if (!octant || octant->GetOctree() != this)
+                    continue;
+
+                // Skip if still fits the current octant
+                if (drawable->IsOccludee() && octant->GetCullingBox().IsInside(box) == INSIDE && octant->CheckDrawableFit(box))
+                {
+                    octant->UpdateDrawableBounds(drawable, box);
+                    continue;
+                }
+
+                pendingReinsertions_.Insert(FindOctantPath(drawable, box));
+            }
+        });
+    }
+
+    // Move drawables in main thread
+    {
+        URHO3D_PROFILE("MoveDrawables");
+        URHO3D_METRIC_TIMER("Octree::ReinsertMoveDrawables");
+
+        unsigned numReinsertions = 0;
+        for (const DrawableReinsertion& reinsertion : pendingReinsertions_)
+        {
+            Drawable* drawable = reinsertion.drawable_;
+            Octant* oldOctant = drawable->GetOctant();
+            Octant* octant = &rootOctant_;
+            for (unsigned i = 0; i < reinsertion.octantPathLength_; ++i)
+                octant = octant->GetOrCreateChild((reinsertion.octantPath_ >> (3 * i)) & 7u);
+
+            if (reinsertion.isComplete_)
+                octant->InsertDrawableHere(drawable);
+            else
+                octant->InsertDrawable(drawable);
+
+            // Drawable may stay in the same octant
+            const BoundingBox& box = drawable->GetWorldBoundingBox();
+            drawable->GetOctant()->UpdateDrawableBounds(drawable, box);
+            if (drawable->GetOctant() != oldOctant)
+                ++numReinsertions;
+
+#ifdef _DEBUG
+            // Verify that the drawable will be culled correctly
+            octant = drawable->GetOctant();
+            if (octant != GetRootOctant() && octant->GetCullingBox().IsInside(box) != INSIDE)
+            {
+                URHO3D_LOGERROR("Drawable is not fully inside its octant's culling bounds: drawable box " + box.ToString() +
+                         " octant box " + octant->GetCullingBox().ToString());
+            }
+#endif
+        }
+
+        URHO3D_METRIC_COUNTER("Octree::NumReinsertedDrawables", numReinsertions);
+    }
+}
+
+Octree::DrawableReinsertion Octree::FindOctantPath(Drawable* drawable, const BoundingBox& box) const
+{
+    DrawableReinsertion result;
+    result.drawable_ = drawable;
+
+    // Follow the same rules as Octant::InsertDrawable, but compute child octants instead of creating them
+    if (!drawable->IsOccludee() || rootOctant_.GetCullingBox().IsInside(box) != INSIDE || rootOctant_.CheckDrawableFit(box))
+    {
+        result.isComplete_ = true;
+        return result;
+    }
+
+    const Vector3 boxCenter = box.Center();
+    BoundingBox octantBox = rootOctant_.GetWorldBoundingBox();
+    while (result.octantPathLength_ < MAX_OCTANT_PATH_LENGTH)
+    {
+        const unsigned childIndex = Octant::GetChildIndex(boxCenter, octantBox.Center());
+        octantBox = Octant::GetChildBoundingBox(octantBox, childIndex);
+        result.octantPath_ |= static_cast<unsigned long long>(childIndex) << (3 * result.octantPathLength_);
+        ++result.octantPathLength_;
+
+        if (Octant::CheckDrawableFit(box, octantBox, result.octantPathLength_, numLevels_))
+        {
+            result.isComplete_ = true;
+            break;
+        }
+    }
+    return result;
+}
+
+void Octree::InsertDrawable(Drawable* drawable)
+{
+    if (spatialIndex_)
+    {
+        // Drawable refers to root octant to find the octree
+        drawable->SetOctant(&rootOctant_);
+        spatialIndex_->AddDrawable(drawable);
+    }
+    else
+        rootOctant_.InsertDrawable(drawable);
+}
+
 void Octree::QueueNodeTransformUpdate(Node* node, const Transform& transform)
 {
     pendingNodeTransforms_.Emplace(node, transform);
@@ -27,8 +27,12 @@
 #include "../Core/WorkQueue.h"
 #include "../Graphics/Drawable.h"
 #include "../Graphics/OctreeQuery.h"
+#include "../Graphics/SpatialIndex.h"
+#include "../Math/BoundingBoxArray.h"
 #include "../Math/Transform.h"
 
+#include <EASTL/unordered_map.h>
+
 namespace Urho3D
 {
 
@@ -56,27 +60,24 @@ public:
     void InsertDrawable(Drawable* drawable);
     /// Check if a drawable object fits.
     bool CheckDrawableFit(const BoundingBox& box) const;
+    /// Insert a drawable object to this octant without checking for fit. Drawable object is removed from previous octant.
+    void InsertDrawableHere(Drawable* drawable);
 
-    /// Add a drawable object to this octant.
-    void AddDrawable(Drawable* drawable)
-    {
-        drawable->SetOctant(this);
-        drawables_.push_back(drawable);
-        IncDrawableCount();
-    }
+    /// Check if a drawable object fits octant with given world bounding box and subdivision level.
+    static bool CheckDrawableFit(const BoundingBox& box, const BoundingBox& octantBox, unsigned level, unsigned numLevels);
+    /// Return index of child octant that should contain the point.
+    static unsigned GetChildIndex(const Vector3& point, const Vector3& octantCenter);
+    /// Return world bounding box of child octant.
+    static BoundingBox GetChildBoundingBox(const BoundingBox& octantBox, unsigned index);
 
+    /// Add a drawable object to this octant.
+    void AddDrawable(Drawable* drawable);
     /// Remove a drawable object from this octant.
-    void RemoveDrawable(Drawable* drawable, bool resetOctant = true)
-    {
-        auto it = drawables_.find(drawable);
-        if (it != drawables_.end())
-        {
-            drawables_.erase(it);
-            if (resetOctant)
-                drawable->SetOctant(nullptr);
-            DecDrawableCount();
-        }
-    }
+    void RemoveDrawable(Drawable* drawable);
+    /// Update cached world bounding box of a drawable object in this octant.
+    void UpdateDrawableBounds(Drawable* drawable, const BoundingBox& box);
+    /// Invalidate cached world bounding box of a drawable object in this octant.
+    void InvalidateDrawableBounds(Drawable* drawable);
 
     /// Return world-space bounding box.
     /// @property
@@ -104,6 +105,8 @@ public:
     void SetRootSize(const BoundingBox& box);
     /// Reset octree pointer recursively. Called when the whole octree is being destroyed.
     void ResetOctree();
+    /// Remove all drawable objects from this octant and child octants, and delete child octants.
+    void ClearDrawables();
     /// Draw bounds to the debug graphics recursively.
     /// @nobind
     void DrawDebugGeometry(DebugRenderer* debug, bool depthTest);
@@ -118,6 +121,10 @@ public:
 protected:
     /// Initialize bounding box.
     void Initialize(const BoundingBox& box);
+    /// Remove a drawable object at index without resetting its octant.
+    void RemoveDrawableAt(unsigned index);
+    /// Test drawables of this octant against query frustum using cached bounding boxes.
+    void TestDrawablesInFrustum(OctreeQuery& query, const Frustum& frustum) const;
 
     /// Increase drawable object count recursively.
     void IncDrawableCount()
@@ -149,6 +156,8 @@ protected:
     BoundingBox cullingBox_;
     /// Drawable objects.
     ea::vector<Drawable*> drawables_;
+    /// World bounding boxes of drawable objects as of last reinsertion. Boxes of drawables queued for update are invalid.
+    BoundingBoxArray drawableBounds_;
     /// Child octants.
     Octant* children_[NUM_OCTANTS]{};
     /// World bounding box center.
@@ -229,6 +238,8 @@ public:
 
     /// Set size and maximum subdivision levels. If octree is not empty, drawable objects will be temporarily moved to the root.
     void SetSize(const BoundingBox& box, unsigned numLevels);
+    /// Set type of spatial index. Drawable objects are moved to the new index.
+    void SetSpatialIndexType(SpatialIndexType type);
     /// Update and reinsert drawable objects.
     void Update(const FrameInfo& frame);
     /// Add a drawable manually.
@@ -267,6 +278,13 @@ public:
     /// @property
     unsigned GetNumLevels() const { return numLevels_; }
 
+    /// Return type of spatial index.
+    /// @property
+    SpatialIndexType GetSpatialIndexType() const { return spatialIndexType_; }
+
+    /// Return spatial index used instead of octants, or null if octants are used.
+    SpatialIndex* GetSpatialIndex() const { return spatialIndex_.get(); }
+
     /// Return all drawables in all octants.
     const ea::vector<Drawable*>& GetAllDrawables() const { return drawables_; }
 
@@ -275,33 +293,60 @@ public:
     /// Cancel drawable object's update.
     void CancelUpdate(Drawable* drawable);
     /// Queue Node transform update to be applied after threaded update.
-    /// Should be called only during Drawable::Update.
+    /// Should be called only during Drawable::Update. If the node is queued more than once, the last transform is applied.
     void QueueNodeTransformUpdate(Node* node, const Transform& transform);
     /// Visualize the component as debug geometry.
     void DrawDebugGeometry(bool depthTest);
 
 private:
+    /// Drawable object that should be moved to another octant.
+    struct DrawableReinsertion
+    {
+        /// Drawable object.
+        Drawable* drawable_{};
+        /// Indices of child octants from root octant to target octant, 3 bits per level.
+        unsigned long long octantPath_{};
+        /// Length of octant path.
+        unsigned octantPathLength_{};
+        /// Whether the path ends at target octant. Otherwise the drawable is inserted recursively from the end of the path.
+        bool isComplete_{};
+    };
+
+    /// Reinsert drawable objects that have been moved or resized.
+    void ReinsertDrawables();
+    /// Find path to the octant where drawable object should be inserted. Octants are not accessed except root.
+    DrawableReinsertion FindOctantPath(Drawable* drawable, const BoundingBox& box) const;
     /// Handle render update in case of headless execution.
     void HandleRenderUpdate(StringHash eventType, VariantMap& eventData);
     /// Update octree size.
     void UpdateOctreeSize() { SetSize(worldBoundingBox_, numLevels_); }
+    /// Insert drawable into octants or spatial index.
+    void InsertDrawable(Drawable* drawable);
 
     /// Root octant.
     Octant rootOctant_;
     /// Drawable objects that require update.
     ea::vector<Drawable*> drawableUpdates_;
     /// Drawable objects that were inserted during threaded update phase.
-    ea::vector<Drawable*> threadedDrawableUpdates_;
+    WorkQueueVector<Drawable*> threadedDrawableUpdates_;
+    /// Drawable objects that should be moved to another octant.
+    WorkQueueVector<DrawableReinsertion> pendingReinsertions_;
     /// Node transforms to be applied before reinsertion.
     WorkQueueVector<ea::pair<Node*, Transform>> pendingNodeTransforms_;
+    /// Node transforms without duplicates, applied in parallel.
+    ea::vector<ea::pair<Node*, Transform>> committedNodeTransforms_;
+    /// Index of node in committed transforms.
+    ea::unordered_map<Node*, unsigned> committedNodeIndices_;
     /// All Drawable objects.
     ea::vector<Drawable*> drawables_;
-    /// Mutex for octree reinsertions.
-    Mutex octreeMutex_;
     /// Ray query temporary list of drawables.
     mutable ea::vector<Drawable*> rayQueryDrawables_;
     /// Subdivision level.
     unsigned numLevels_;
+    /// Type of spatial index.
+    SpatialIndexType spatialIndexType_{};
+    /// Spatial index used instead of octants. Drawable objects refer to root octant but are not stored in octants.
+    ea::unique_ptr<SpatialIndex> spatialIndex_;
     /// World bounding box.
     BoundingBox worldBoundingBox_;
     /// Zones.
@@ -56,6 +56,9 @@ public:
     virtual Intersection TestOctant(const BoundingBox& box, bool inside) = 0;
     /// Intersection test for drawables.
     virtual void TestDrawables(Drawable** start, Drawable** end, bool inside) = 0;
+    /// Return frustum that can be used to cull drawables before TestDrawables.
+    /// Drawables outside of the frustum are skipped, drawables inside are tested with inside flag set.
+    virtual const Frustum* GetCullingFrustum() const { return nullptr; }
 
     /// Result vector reference.
     ea::vector<Drawable*>& result_;
@@ -148,6 +151,8 @@ public:
     Intersection TestOctant(const BoundingBox& box, bool inside) override;
     /// Intersection test for drawables.
     void TestDrawables(Drawable** start, Drawable** end, bool inside) override;
+    /// Return frustum.
+    const Frustum* GetCullingFrustum() const override { return &frustum_; }
 
     /// Frustum.
     Frustum frustum_;
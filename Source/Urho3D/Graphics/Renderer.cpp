@@ -757,6 +757,50 @@ unsigned Renderer::GetNumOccluders(bool allViews) const
     return numOccluders;
 }
 
+unsigned Renderer::GetNumCacheableDrawQueues() const
+{
+    unsigned numQueues = 0;
+    for (const RenderPipelineView* view : renderPipelineViews_)
+    {
+        if (view)
+            numQueues += view->GetStats().numCacheableDrawQueues_;
+    }
+    return numQueues;
+}
+
+unsigned Renderer::GetNumReusedDrawQueues() const
+{
+    unsigned numQueues = 0;
+    for (const RenderPipelineView* view : renderPipelineViews_)
+    {
+        if (view)
+            numQueues += view->GetStats().numReusedDrawQueues_;
+    }
+    return numQueues;
+}
+
+unsigned Renderer::GetNumShadowSplits() const
+{
+    unsigned numSplits = 0;
+    for (const RenderPipelineView* view : renderPipelineViews_)
+    {
+        if (view)
+            numSplits += view->GetStats().numShadowSplits_;
+    }
+    return numSplits;
+}
+
+unsigned Renderer::GetNumReusedShadowSplits() const
+{
+    unsigned numSplits = 0;
+    for (const RenderPipelineView* view : renderPipelineViews_)
+    {
+        if (view)
+            numSplits += view->GetStats().numReusedShadowSplits_;
+    }
+    return numSplits;
+}
+
 void Renderer::Update(float timeStep)
 {
     URHO3D_PROFILE("UpdateViews");
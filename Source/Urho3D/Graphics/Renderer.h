@@ -468,6 +468,14 @@ public:
     /// Return number of occluders rendered.
     /// @property
     unsigned GetNumOccluders(bool allViews = false) const;
+    /// Return number of batch groups eligible for draw command queue caching in all render pipeline views.
+    unsigned GetNumCacheableDrawQueues() const;
+    /// Return number of batch groups rendered from cached draw command queues in all render pipeline views.
+    unsigned GetNumReusedDrawQueues() const;
+    /// Return number of shadow splits processed in all render pipeline views.
+    unsigned GetNumShadowSplits() const;
+    /// Return number of shadow splits reused from previous frame in all render pipeline views.
+    unsigned GetNumReusedShadowSplits() const;
 
     /// Return the default zone.
     /// @property
@@ -141,6 +141,7 @@ void Skeleton::UpdateBoneOrder()
     const unsigned numBones = bones_.size();
     bonesOrder_.reserve(numBones);
     bonesOrder_.clear();
+    boneDepths_.assign(numBones, 0);
 
     // Collect roots first
     for (unsigned boneIndex = 0; boneIndex < numBones; ++boneIndex)
@@ -152,6 +153,7 @@ void Skeleton::UpdateBoneOrder()
     // Collect layer by layer
     unsigned rangeBegin = 0;
     unsigned rangeEnd = bonesOrder_.size();
+    unsigned depth = 0;
 
     while (bonesOrder_.size() < numBones && rangeBegin != rangeEnd)
     {
@@ -164,9 +166,13 @@ void Skeleton::UpdateBoneOrder()
 
             const bool isDirectChild = ea::find(currentParents.begin(), currentParents.end(), parentBoneIndex) != currentParents.end();
             if (isDirectChild)
+            {
                 bonesOrder_.push_back(boneIndex);
+                boneDepths_[boneIndex] = depth + 1;
+            }
         }
 
+        ++depth;
         rangeBegin = rangeEnd;
         rangeEnd = bonesOrder_.size();
     }
@@ -123,6 +123,8 @@ public:
 
     /// Return order of bones from parents to children.
     const ea::vector<unsigned>& GetBonesOrder() const { return bonesOrder_; }
+    /// Return depth of the bone in hierarchy. Root bones have zero depth.
+    unsigned GetBoneDepth(unsigned index) const { return index < boneDepths_.size() ? boneDepths_[index] : 0; }
 
     /// Return modifiable bones.
     ea::vector<Bone>& GetModifiableBones() { return bones_; }
@@ -160,6 +162,8 @@ private:
     ea::vector<Bone> bones_;
     /// Indices of bones ordered from root to children.
     ea::vector<unsigned> bonesOrder_;
+    /// Depths of bones in hierarchy.
+    ea::vector<unsigned> boneDepths_;
     /// Root bone index.
     unsigned rootBoneIndex_;
 };
@@ -23,6 +23,7 @@
 #include "../Precompiled.h"
 
 #include "../Core/Context.h"
+#include "../Core/WorkQueue.h"
 #include "../IO/Log.h"
 #include "../Graphics/Geometry.h"
 #include "../Graphics/IndexBuffer.h"
@@ -39,6 +40,38 @@ namespace Urho3D
 namespace
 {
 
+/// Skinning kernel for range of vertices.
+using SkinningKernel = void(*)(float* vertexData, const unsigned char* indices, const float* weights,
+    const Matrix3x4* transforms, unsigned numVertices);
+
+#ifdef URHO3D_SSE
+/// Load 3-vector and set W component without reading past the end of the vector.
+inline __m128 LoadVector3(const float* data, __m128 w)
+{
+    const __m128 xy = _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(data));
+    const __m128 zw = _mm_unpacklo_ps(_mm_load_ss(data + 2), w);
+    return _mm_movelh_ps(xy, zw);
+}
+
+/// Store XYZ components of vector.
+inline void StoreVector3(float* data, __m128 value)
+{
+    _mm_storel_pi(reinterpret_cast<__m64*>(data), value);
+    _mm_store_ss(data + 2, _mm_movehl_ps(value, value));
+}
+
+/// Transform vector by rows of 3x4 matrix. Translation is applied only if W component is 1.
+inline __m128 TransformVector(__m128 row0, __m128 row1, __m128 row2, __m128 vec)
+{
+    const __m128 r0 = _mm_mul_ps(row0, vec);
+    const __m128 r1 = _mm_mul_ps(row1, vec);
+    const __m128 r2 = _mm_mul_ps(row2, vec);
+    const __m128 r3 = _mm_setzero_ps();
+    const __m128 t0 = _mm_add_ps(_mm_unpacklo_ps(r0, r1), _mm_unpackhi_ps(r0, r1));
+    const __m128 t2 = _mm_add_ps(_mm_unpacklo_ps(r2, r3), _mm_unpackhi_ps(r2, r3));
+    return _mm_add_ps(_mm_movelh_ps(t0, t2), _mm_movehl_ps(t2, t0));
+}
+#else
 Vector3 TransformNormal(const Matrix3x4& m, const Vector3& v)
 {
     return {
@@ -47,6 +80,175 @@ Vector3 TransformNormal(const Matrix3x4& m, const Vector3& v)
         m.m20_ * v.x_ + m.m21_ * v.y_ + m.m22_ * v.z_
     };
 }
+#endif
+
+/// Add scaled 3-vector to destination.
+inline void AddScaledVector3(float* dest, const float* src, float weight)
+{
+#ifdef URHO3D_SSE
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 delta = _mm_mul_ps(LoadVector3(src, zero), _mm_set1_ps(weight));
+    StoreVector3(dest, _mm_add_ps(LoadVector3(dest, zero), delta));
+#else
+    dest[0] += src[0] * weight;
+    dest[1] += src[1] * weight;
+    dest[2] += src[2] * weight;
+#endif
+}
+
+/// Return size of vertex in animated vertex buffer, in floats. Elements are always ordered as position, normal, tangent.
+constexpr unsigned GetAnimatedVertexSize(bool hasNormals, bool hasTangents)
+{
+    return 3 + (hasNormals ? 3 : 0) + (hasTangents ? 4 : 0);
+}
+
+/// Skin vertices with layout and number of bones known at compile time.
+template <unsigned NumBones, bool SkinNormals, bool SkinTangents>
+void SkinVertices(float* vertexData, const unsigned char* indices, const float* weights,
+    const Matrix3x4* transforms, unsigned numVertices)
+{
+    static constexpr unsigned NormalOffset = 3;
+    static constexpr unsigned TangentOffset = SkinNormals ? 6 : 3;
+    static constexpr unsigned VertexSize = GetAnimatedVertexSize(SkinNormals, SkinTangents);
+
+#ifdef URHO3D_SSE
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 zero = _mm_setzero_ps();
+#endif
+
+    for (unsigned vertexIndex = 0; vertexIndex < numVertices; ++vertexIndex)
+    {
+#ifdef URHO3D_SSE
+        // Blend matrix rows
+        const float* matrix = &transforms[indices[0]].m00_;
+        __m128 weight = _mm_set1_ps(weights[0]);
+        __m128 row0 = _mm_mul_ps(_mm_loadu_ps(matrix), weight);
+        __m128 row1 = _mm_mul_ps(_mm_loadu_ps(matrix + 4), weight);
+        __m128 row2 = _mm_mul_ps(_mm_loadu_ps(matrix + 8), weight);
+        for (unsigned boneIndex = 1; boneIndex < NumBones; ++boneIndex)
+        {
+            matrix = &transforms[indices[boneIndex]].m00_;
+            weight = _mm_set1_ps(weights[boneIndex]);
+            row0 = _mm_add_ps(row0, _mm_mul_ps(_mm_loadu_ps(matrix), weight));
+            row1 = _mm_add_ps(row1, _mm_mul_ps(_mm_loadu_ps(matrix + 4), weight));
+            row2 = _mm_add_ps(row2, _mm_mul_ps(_mm_loadu_ps(matrix + 8), weight));
+        }
+
+        StoreVector3(vertexData, TransformVector(row0, row1, row2, LoadVector3(vertexData, one)));
+
+        if constexpr (SkinNormals)
+        {
+            float* normal = vertexData + NormalOffset;
+            StoreVector3(normal, TransformVector(row0, row1, row2, LoadVector3(normal, zero)));
+        }
+
+        if constexpr (SkinTangents)
+        {
+            float* tangent = vertexData + TangentOffset;
+            StoreVector3(tangent, TransformVector(row0, row1, row2, LoadVector3(tangent, zero)));
+        }
+#else
+        Matrix3x4 matrix = transforms[indices[0]] * weights[0];
+        for (unsigned boneIndex = 1; boneIndex < NumBones; ++boneIndex)
+            matrix = matrix + transforms[indices[boneIndex]] * weights[boneIndex];
+
+        Vector3& position = *reinterpret_cast<Vector3*>(vertexData);
+        position = matrix * position;
+
+        if constexpr (SkinNormals)
+        {
+            Vector3& normal = *reinterpret_cast<Vector3*>(vertexData + NormalOffset);
+            normal = TransformNormal(matrix, normal);
+        }
+
+        if constexpr (SkinTangents)
+        {
+            Vector3& tangent = *reinterpret_cast<Vector3*>(vertexData + TangentOffset);
+            tangent = TransformNormal(matrix, tangent);
+        }
+#endif
+
+        // Advance
+        vertexData += VertexSize;
+        indices += NumBones;
+        weights += NumBones;
+    }
+}
+
+template <unsigned NumBones>
+SkinningKernel GetSkinningKernel(bool skinNormals, bool skinTangents)
+{
+    if (skinNormals && skinTangents)
+        return &SkinVertices<NumBones, true, true>;
+    else if (skinNormals)
+        return &SkinVertices<NumBones, true, false>;
+    else if (skinTangents)
+        return &SkinVertices<NumBones, false, true>; // this is really weird case
+    else
+        return &SkinVertices<NumBones, false, false>;
+}
+
+SkinningKernel GetSkinningKernel(unsigned numBones, bool skinNormals, bool skinTangents)
+{
+    switch (numBones)
+    {
+    case 1: return GetSkinningKernel<1>(skinNormals, skinTangents);
+    case 2: return GetSkinningKernel<2>(skinNormals, skinTangents);
+    case 3: return GetSkinningKernel<3>(skinNormals, skinTangents);
+    default: return GetSkinningKernel<4>(skinNormals, skinTangents);
+    }
+}
+
+/// Morph kernel for range of vertices.
+using MorphKernel = void(*)(unsigned char* destData, const unsigned char* srcData, unsigned numVertices,
+    unsigned vertexSize, unsigned normalOffset, unsigned tangentOffset, float weight);
+
+/// Apply morph to vertices with set of morphed elements known at compile time.
+template <bool MorphPositions, bool MorphNormals, bool MorphTangents>
+void MorphVertices(unsigned char* destData, const unsigned char* srcData, unsigned numVertices,
+    unsigned vertexSize, unsigned normalOffset, unsigned tangentOffset, float weight)
+{
+    static constexpr unsigned NumElements = MorphPositions + MorphNormals + MorphTangents;
+    static constexpr unsigned SourceVertexSize = sizeof(unsigned) + NumElements * 3 * sizeof(float);
+
+    for (unsigned i = 0; i < numVertices; ++i)
+    {
+        unsigned vertexIndex;
+        memcpy(&vertexIndex, srcData, sizeof(unsigned));
+        auto src = reinterpret_cast<const float*>(srcData + sizeof(unsigned));
+        unsigned char* dest = destData + vertexIndex * vertexSize;
+
+        if constexpr (MorphPositions)
+        {
+            AddScaledVector3(reinterpret_cast<float*>(dest), src, weight);
+            src += 3;
+        }
+        if constexpr (MorphNormals)
+        {
+            AddScaledVector3(reinterpret_cast<float*>(dest + normalOffset), src, weight);
+            src += 3;
+        }
+        if constexpr (MorphTangents)
+            AddScaledVector3(reinterpret_cast<float*>(dest + tangentOffset), src, weight);
+
+        srcData += SourceVertexSize;
+    }
+}
+
+MorphKernel GetMorphKernel(bool morphPositions, bool morphNormals, bool morphTangents)
+{
+    static const MorphKernel kernels[] = {
+        nullptr,
+        &MorphVertices<true, false, false>,
+        &MorphVertices<false, true, false>,
+        &MorphVertices<true, true, false>,
+        &MorphVertices<false, false, true>,
+        &MorphVertices<true, false, true>,
+        &MorphVertices<false, true, true>,
+        &MorphVertices<true, true, true>,
+    };
+    return kernels[(morphPositions ? 1 : 0) | (morphNormals ? 2 : 0) | (morphTangents ? 4 : 0)];
+}
 
 }
 
@@ -63,7 +265,7 @@ void SoftwareModelAnimator::Initialize(Model* model, bool skinned, unsigned numB
 {
     originalModel_ = model;
     skinned_ = skinned;
-    numBones_ = numBones;
+    numBones_ = Clamp(numBones, 1u, MaxBones);
     CloneModelGeometries();
     InitializeAnimationData();
 }
@@ -117,68 +319,29 @@ void SoftwareModelAnimator::ApplySkinning(ea::span<const Matrix3x4> worldTransfo
         if (!clonedBuffer || !animationData.hasSkeletalAnimation_)
             continue;
 
-        if (!animationData.skinNormals_ && !animationData.skinTangents_)
-            ApplyVertexBufferSkinning<false, false>(clonedBuffer, animationData, worldTransforms);
-        else if (animationData.skinNormals_ && !animationData.skinTangents_)
-            ApplyVertexBufferSkinning<true, false>(clonedBuffer, animationData, worldTransforms);
-        else if (animationData.skinNormals_ && animationData.skinTangents_)
-            ApplyVertexBufferSkinning<true, true>(clonedBuffer, animationData, worldTransforms);
-        else
-            ApplyVertexBufferSkinning<false, true>(clonedBuffer, animationData, worldTransforms); // this is really weird case
+        ApplyVertexBufferSkinning(clonedBuffer, animationData, worldTransforms);
     }
 }
 
-template <bool SkinNormals, bool SkinTangents>
 void SoftwareModelAnimator::ApplyVertexBufferSkinning(VertexBuffer* clonedBuffer, const VertexBufferAnimationData& animationData,
     ea::span<const Matrix3x4> worldTransforms) const
 {
-    const unsigned clonedVertexSize = clonedBuffer->GetVertexSize();
-    const unsigned normalOffset = clonedBuffer->GetElementOffset(TYPE_VECTOR3, SEM_NORMAL);
-    const unsigned tangentOffset = clonedBuffer->GetElementOffset(TYPE_VECTOR4, SEM_TANGENT);
-
-    unsigned char* clonedBufferData = clonedBuffer->GetShadowData();
-
-    unsigned char* positionsData = clonedBufferData;
-    unsigned char* normalsData = SkinNormals ? clonedBufferData + normalOffset : nullptr;
-    unsigned char* tangentsData = SkinTangents ? clonedBufferData + tangentOffset : nullptr;
+    const SkinningKernel kernel = GetSkinningKernel(numBones_, animationData.skinNormals_, animationData.skinTangents_);
+    const unsigned vertexSize = GetAnimatedVertexSize(animationData.skinNormals_, animationData.skinTangents_);
+    const unsigned numBones = numBones_;
 
+    auto vertexData = reinterpret_cast<float*>(clonedBuffer->GetShadowData());
     const unsigned char* indicesData = animationData.blendIndices_.data();
     const float* weightsData = animationData.blendWeights_.data();
+    const Matrix3x4* transforms = worldTransforms.data();
 
-    const unsigned numVertices = clonedBuffer->GetVertexCount();
-    Matrix3x4 matrix;
-    for (unsigned vertexIndex = 0; vertexIndex < numVertices; ++vertexIndex)
+    // Vertices are independent, process them in chunks
+    ForEachParallel(GetSubsystem<WorkQueue>(), VerticesPerTask, clonedBuffer->GetVertexCount(),
+        [=](unsigned beginIndex, unsigned endIndex)
     {
-        matrix = worldTransforms[indicesData[0]] * weightsData[0];
-        for (unsigned boneIndex = 1; boneIndex < numBones_; ++boneIndex)
-            matrix = matrix + worldTransforms[indicesData[boneIndex]] * weightsData[boneIndex];
-
-        Vector3& position = *reinterpret_cast<Vector3*>(positionsData);
-        position = matrix * position;
-
-        if constexpr (SkinNormals)
-        {
-            Vector3& normal = *reinterpret_cast<Vector3*>(normalsData);
-            normal = TransformNormal(matrix, normal);
-        }
-
-        if constexpr (SkinTangents)
-        {
-            Vector3& tangent = *reinterpret_cast<Vector3*>(tangentsData);
-            tangent = TransformNormal(matrix, tangent);
-        }
-
-        // Advance
-        indicesData += numBones_;
-        weightsData += numBones_;
-
-        positionsData += clonedVertexSize;
-        if constexpr (SkinNormals)
-            normalsData += clonedVertexSize;
-        if constexpr (SkinTangents)
-            tangentsData += clonedVertexSize;
-    }
-
+        kernel(vertexData + beginIndex * vertexSize, indicesData + beginIndex * numBones,
+            weightsData + beginIndex * numBones, transforms, endIndex - beginIndex);
+    });
 }
 
 void SoftwareModelAnimator::Commit()
@@ -335,6 +498,8 @@ void SoftwareModelAnimator::InitializeAnimationData()
     {
         VertexBuffer* originalBuffer = originalModel_->GetVertexBuffers()[bufferIndex];
         VertexBuffer* clonedBuffer = vertexBuffers_[bufferIndex];
+        if (!clonedBuffer || !clonedBuffer->HasElement(SEM_POSITION))
+            continue;
 
         const unsigned originalVertexSize = originalBuffer->GetVertexSize();
         const unsigned indicesOffset = originalBuffer->GetElementOffset(TYPE_UBYTE4, SEM_BLENDINDICES);
@@ -347,9 +512,17 @@ void SoftwareModelAnimator::InitializeAnimationData()
 
         const unsigned numVertices = originalBuffer->GetVertexCount();
         VertexBufferAnimationData& animationData = vertexBuffersData_[bufferIndex];
-        animationData.hasSkeletalAnimation_ = true;
         animationData.skinNormals_ = clonedBuffer->HasElement(SEM_NORMAL);
         animationData.skinTangents_ = clonedBuffer->HasElement(SEM_TANGENT);
+
+        // Skinning kernels expect tightly packed position, normal and tangent
+        if (clonedBuffer->GetVertexSize() != GetAnimatedVertexSize(animationData.skinNormals_, animationData.skinTangents_) * sizeof(float))
+        {
+            URHO3D_LOGERROR("Unexpected vertex layout for software skinning");
+            continue;
+        }
+
+        animationData.hasSkeletalAnimation_ = true;
         animationData.blendIndices_.resize(numVertices * numBones_);
         animationData.blendWeights_.resize(numVertices * numBones_);
 
@@ -442,47 +615,28 @@ void SoftwareModelAnimator::CopyMorphVertices(void* destVertexData, const void*
 void SoftwareModelAnimator::ApplyMorph(VertexBuffer* buffer, const VertexBufferMorph& morph, float weight)
 {
     const VertexMaskFlags elementMask = morph.elementMask_ & buffer->GetElementMask();
-    unsigned vertexCount = morph.vertexCount_;
-    unsigned normalOffset = buffer->GetElementOffset(SEM_NORMAL);
-    unsigned tangentOffset = buffer->GetElementOffset(SEM_TANGENT);
-    unsigned vertexSize = buffer->GetVertexSize();
+    const bool hasPositions = elementMask.Test(MASK_POSITION);
+    const bool hasNormals = elementMask.Test(MASK_NORMAL);
+    const bool hasTangents = elementMask.Test(MASK_TANGENT);
+    const MorphKernel kernel = GetMorphKernel(hasPositions, hasNormals, hasTangents);
+    if (!kernel)
+        return;
 
-    unsigned char* srcData = morph.morphData_.get();
+    const unsigned normalOffset = buffer->GetElementOffset(SEM_NORMAL);
+    const unsigned tangentOffset = buffer->GetElementOffset(SEM_TANGENT);
+    const unsigned vertexSize = buffer->GetVertexSize();
+    const unsigned sourceVertexSize = sizeof(unsigned) + (hasPositions + hasNormals + hasTangents) * 3 * sizeof(float);
+
+    const unsigned char* srcData = morph.morphData_.get();
     unsigned char* destData = buffer->GetShadowData();
 
-    while (vertexCount--)
+    // Each vertex is referenced at most once within morph, process them in chunks
+    ForEachParallel(GetSubsystem<WorkQueue>(), VerticesPerTask, morph.vertexCount_,
+        [=](unsigned beginIndex, unsigned endIndex)
     {
-        const unsigned vertexIndex = *reinterpret_cast<const unsigned*>(srcData);
-        srcData += sizeof(unsigned);
-
-        if (elementMask & MASK_POSITION)
-        {
-            auto dest = reinterpret_cast<float*>(destData + vertexIndex * vertexSize);
-            auto src = reinterpret_cast<const float*>(srcData);
-            dest[0] += src[0] * weight;
-            dest[1] += src[1] * weight;
-            dest[2] += src[2] * weight;
-            srcData += 3 * sizeof(float);
-        }
-        if (elementMask & MASK_NORMAL)
-        {
-            auto dest = reinterpret_cast<float*>(destData + vertexIndex * vertexSize + normalOffset);
-            auto src = reinterpret_cast<const float*>(srcData);
-            dest[0] += src[0] * weight;
-            dest[1] += src[1] * weight;
-            dest[2] += src[2] * weight;
-            srcData += 3 * sizeof(float);
-        }
-        if (elementMask & MASK_TANGENT)
-        {
-            auto dest = reinterpret_cast<float*>(destData + vertexIndex * vertexSize + tangentOffset);
-            auto src = reinterpret_cast<const float*>(srcData);
-            dest[0] += src[0] * weight;
-            dest[1] += src[1] * weight;
-            dest[2] += src[2] * weight;
-            srcData += 3 * sizeof(float);
-        }
-    }
+        kernel(destData, srcData + beginIndex * sourceVertexSize, endIndex - beginIndex,
+            vertexSize, normalOffset, tangentOffset, weight);
+    });
 }
 
 }
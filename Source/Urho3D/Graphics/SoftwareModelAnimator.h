@@ -53,6 +53,8 @@ class URHO3D_API SoftwareModelAnimator : public Object
 public:
     /// Max number of bones.
     static const unsigned MaxBones = 4;
+    /// Number of vertices processed by one task in parallel skinning and morphing.
+    static const unsigned VerticesPerTask = 2048;
 
     /// Construct.
     explicit SoftwareModelAnimator(Context* context);
@@ -92,7 +94,6 @@ private:
     /// Apply a vertex buffer morph.
     void ApplyMorph(VertexBuffer* buffer, const VertexBufferMorph& morph, float weight);
     /// Apply skinning for given vertex buffer.
-    template <bool SkinNormals, bool SkinTangents>
     void ApplyVertexBufferSkinning(VertexBuffer* clonedBuffer, const VertexBufferAnimationData& animationData,
         ea::span<const Matrix3x4> worldTransforms) const;
 
@@ -0,0 +1,71 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+/// \file
+
+#pragma once
+
+#include "../Core/NonCopyable.h"
+
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+class DebugRenderer;
+class Drawable;
+class OctreeQuery;
+class RayOctreeQuery;
+
+/// Type of spatial index used by Octree.
+enum class SpatialIndexType
+{
+    /// Loose octree. Best for mostly static scenes.
+    Octree,
+    /// Bounding volume hierarchy with fattened leaves. Best for scenes with many moving drawables.
+    BVH,
+};
+
+/// Alternative spatial index of drawables that can be used by Octree instead of octants.
+/// All methods are called from the main thread except queries, which may be called from any thread concurrently.
+class URHO3D_API SpatialIndex : private NonCopyable
+{
+public:
+    /// Destruct.
+    virtual ~SpatialIndex() = default;
+
+    /// Add drawable. Bounding box of drawable should be up to date.
+    virtual void AddDrawable(Drawable* drawable) = 0;
+    /// Remove drawable.
+    virtual void RemoveDrawable(Drawable* drawable) = 0;
+    /// Update drawable after its bounding box is changed.
+    virtual void UpdateDrawable(Drawable* drawable) = 0;
+
+    /// Return drawable objects by a query.
+    virtual void GetDrawables(OctreeQuery& query) const = 0;
+    /// Return drawable objects that may be hit by a ray query. Drawable flags and view mask are checked.
+    virtual void GetDrawables(RayOctreeQuery& query, ea::vector<Drawable*>& drawables) const = 0;
+    /// Draw internal structure to the debug graphics.
+    virtual void DrawDebugGeometry(DebugRenderer* debug, bool depthTest) const {}
+};
+
+}
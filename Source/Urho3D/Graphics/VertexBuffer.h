@@ -241,8 +241,12 @@ public:
         return indexAndData.first;
     }
 
+    /// Return writeable data of already allocated vertices. Pointer is invalidated by next allocation.
+    unsigned char* GetVertexData(unsigned startVertex) { return shadowData_.data() + startVertex * vertexSize_; }
+
     VertexBuffer* GetVertexBuffer() const { return vertexBuffer_; }
     unsigned GetVertexCount() const { return numVertices_; }
+    unsigned GetVertexSize() const { return vertexSize_; }
 
 private:
     void GrowBuffer(unsigned newMaxNumVertices);
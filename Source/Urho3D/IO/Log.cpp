@@ -22,8 +22,10 @@
 
 #include "../Precompiled.h"
 
+#include "../Container/MPSCRingBuffer.h"
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
+#include "../Core/Profiler.h"
 #include "../Core/Thread.h"
 #include "../Core/Timer.h"
 #include "../IO/IOEvents.h"
@@ -41,6 +43,8 @@
 #endif
 #include <spdlog/details/null_mutex.h>
 
+#include <atomic>
+#include <condition_variable>
 #include <mutex>
 #include <cstdio>
 
@@ -244,10 +248,18 @@ static LogLevel ConvertLogLevel(spdlog::level::level_enum level)
 template<typename Mutex>
 class MessageForwarderSink : public spdlog::sinks::base_sink<Mutex>
 {
+public:
+    /// Set Log that receives messages. Sink is locked, so it's safe to reset owner while other threads are writing.
+    void SetOwner(Log* owner)
+    {
+        std::lock_guard<Mutex> lock(this->mutex_);
+        owner_ = owner;
+    }
+
 protected:
     void sink_it_(const spdlog::details::log_msg& msg) override
     {
-        auto* logInstance = GetLog();
+        Log* logInstance = owner_;
         if (logInstance == nullptr)
             return;
         time_t time = std::chrono::system_clock::to_time_t(msg.time);
@@ -256,47 +268,54 @@ protected:
     }
 
     void flush_() override { }
+
+private:
+    /// Log that owns this sink.
+    Log* owner_{};
 };
 
 using MessageForwarderSink_mt = MessageForwarderSink<std::mutex>;
 using MessageForwarderSink_st = MessageForwarderSink<spdlog::details::null_mutex>;
 
-Logger::Logger(void* logger)
-    : logger_(logger)
+/// Return level used to write the message.
+static spdlog::level::level_enum GetWriteLevel(LogLevel level)
 {
+    // Messages with invalid level are written as warnings
+    return level >= LOG_TRACE && level < LOG_NONE ? ConvertLogLevel(level) : spdlog::level::warn;
 }
 
-void Logger::Write(LogLevel level, ea::string_view message) const
+/// Whether the current thread is the log thread.
+static thread_local bool isLogThread = false;
+
+/// Message stored in asynchronous log queue.
+struct AsyncLogRecord
 {
-    if (logger_ == nullptr)
-        return;
+    /// Logger to write message to.
+    spdlog::logger* logger_{};
+    /// Message level.
+    spdlog::level::level_enum level_{};
+    /// Time when message was logged.
+    spdlog::log_clock::time_point time_;
+    /// Pre-formatted message.
+    ea::string message_;
+    /// Callback that formats the message on the log thread, optional.
+    ea::function<ea::string()> callback_;
+};
 
-    auto* logger = reinterpret_cast<spdlog::logger*>(logger_);
+/// Thread that writes messages from asynchronous log queue.
+class LogThread : public Thread
+{
+public:
+    /// Construct.
+    explicit LogThread(LogImpl* owner) : Thread("LogThread"), owner_(owner) {}
 
-    switch (level)
-    {
-    case LOG_TRACE:
-        logger->trace(ToFmtStringView(message));
-        break;
-    case LOG_DEBUG:
-        logger->debug(ToFmtStringView(message));
-        break;
-    case LOG_INFO:
-        logger->info(ToFmtStringView(message));
-        break;
-    case LOG_WARNING:
-        logger->warn(ToFmtStringView(message));
-        break;
-    case LOG_ERROR:
-        logger->error(ToFmtStringView(message));
-        break;
-    case LOG_NONE:
-    case MAX_LOGLEVELS:
-    default:
-        logger->warn(ToFmtStringView(message));
-        break;
-    }
-}
+    /// Process queued messages until stopped.
+    void ThreadFunction() override;
+
+private:
+    /// Log implementation.
+    LogImpl* owner_{};
+};
 
 class LogImpl : public Object
 {
@@ -319,7 +338,8 @@ public:
         platformSink_ = std::make_shared<spdlog::sinks::stdout_sink_mt>();
 #endif
         distributorSink_->add_sink(platformSink_);
-        distributorSink_->add_sink(std::make_shared<MessageForwarderSink_mt>());
+        forwarderSink_ = std::make_shared<MessageForwarderSink_mt>();
+        distributorSink_->add_sink(forwarderSink_);
 
         dupFilterSink_ = std::make_shared<DuplicateFilterSink>(
             std::chrono::seconds(5), spdlog::level::err, 10);
@@ -328,6 +348,183 @@ public:
         mainSink_ = dupFilterSink_;
     }
 
+    ~LogImpl() override
+    {
+        StopAsync();
+    }
+
+    /// Start log thread.
+    void StartAsync(unsigned capacity)
+    {
+        if (async_.load(std::memory_order_relaxed))
+            return;
+
+        // Queue is empty when asynchronous mode is disabled, so it's safe to recreate it
+        if (!queue_ || queue_->GetCapacity() != NextPowerOfTwo(capacity))
+            queue_ = ea::make_unique<MPSCRingBuffer<AsyncLogRecord>>(capacity);
+
+        stopRequested_.store(false, std::memory_order_relaxed);
+        thread_ = ea::make_unique<LogThread>(this);
+        thread_->Run();
+        async_.store(true, std::memory_order_release);
+    }
+
+    /// Stop log thread and write all queued messages.
+    void StopAsync()
+    {
+        if (!async_.load(std::memory_order_relaxed))
+            return;
+
+        async_.store(false, std::memory_order_release);
+        stopRequested_.store(true, std::memory_order_release);
+        WakeThread(true);
+        thread_->Stop();
+        thread_ = nullptr;
+
+        // Write messages pushed by writers that have not noticed the mode change yet
+        ProcessQueue();
+    }
+
+    /// Return whether messages are written from log thread.
+    bool IsAsync() const { return async_.load(std::memory_order_acquire); }
+
+    /// Push message to the queue or write it immediately.
+    void Enqueue(AsyncLogRecord&& record)
+    {
+        // Sinks may log too, don't let the log thread wait for itself
+        if (isLogThread)
+        {
+            WriteRecord(record);
+            return;
+        }
+
+        const LogOverflowPolicy policy = policy_.load(std::memory_order_relaxed);
+        const bool isError = record.level_ >= spdlog::level::err;
+        if (policy == LogOverflowPolicy::Sample && !isError && queue_->GetSize() > queue_->GetCapacity() / 2)
+        {
+            const unsigned rate = ea::max(1u, sampleRate_.load(std::memory_order_relaxed));
+            if (sampleCounter_.fetch_add(1, std::memory_order_relaxed) % rate != 0)
+            {
+                numDropped_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+
+        const bool canBlock = policy == LogOverflowPolicy::Block || (policy == LogOverflowPolicy::Sample && isError);
+        while (!queue_->TryPush(ea::move(record)))
+        {
+            if (!canBlock)
+            {
+                numDropped_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            // Log thread may be already stopped, nobody would free the space
+            if (!IsAsync())
+            {
+                WriteRecord(record);
+                return;
+            }
+
+            WakeThread(true);
+            Time::Sleep(0);
+        }
+
+        numPushed_.fetch_add(1, std::memory_order_relaxed);
+        WakeThread(false);
+    }
+
+    /// Wait until log thread writes all messages pushed so far.
+    void WaitForQueue()
+    {
+        const unsigned long long numPushed = numPushed_.load(std::memory_order_relaxed);
+        while (IsAsync() && numProcessed_.load(std::memory_order_acquire) < numPushed)
+        {
+            WakeThread(true);
+            Time::Sleep(0);
+        }
+    }
+
+    /// Process queue until stop is requested. Called from log thread.
+    void RunThread()
+    {
+        while (!stopRequested_.load(std::memory_order_acquire))
+        {
+            if (ProcessQueue())
+                continue;
+
+            std::unique_lock<std::mutex> lock(wakeMutex_);
+            threadSleeping_.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            // Timeout is just a safety net, writers wake the thread up
+            if (queue_->IsEmpty() && !stopRequested_.load(std::memory_order_relaxed))
+                wakeCondition_.wait_for(lock, std::chrono::milliseconds(10));
+            threadSleeping_.store(false, std::memory_order_relaxed);
+        }
+        ProcessQueue();
+    }
+
+    /// Write all queued messages. Should be called only from one thread at a time.
+    bool ProcessQueue()
+    {
+        bool processed = false;
+        AsyncLogRecord record;
+        while (queue_->TryPop(record))
+        {
+            WriteRecord(record);
+            numProcessed_.fetch_add(1, std::memory_order_release);
+            processed = true;
+        }
+        return processed;
+    }
+
+    /// Write message to the logger.
+    void WriteRecord(AsyncLogRecord& record)
+    {
+        if (record.callback_)
+            record.message_ = record.callback_();
+        record.logger_->log(record.time_, spdlog::source_loc{}, record.level_, ToFmtStringView(record.message_));
+    }
+
+    /// Wake up log thread if it's sleeping.
+    void WakeThread(bool force)
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (force || threadSleeping_.load(std::memory_order_relaxed))
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex_);
+            wakeCondition_.notify_one();
+        }
+    }
+
+    /// Queue of messages written from log thread.
+    ea::unique_ptr<MPSCRingBuffer<AsyncLogRecord>> queue_;
+    /// Log thread.
+    ea::unique_ptr<LogThread> thread_;
+    /// Whether the asynchronous mode is enabled.
+    std::atomic<bool> async_{};
+    /// Whether the log thread should stop.
+    std::atomic<bool> stopRequested_{};
+    /// Whether the log thread is waiting for messages.
+    std::atomic<bool> threadSleeping_{};
+    /// Mutex used to wake up log thread.
+    std::mutex wakeMutex_;
+    /// Condition used to wake up log thread.
+    std::condition_variable wakeCondition_;
+
+    /// Policy applied when queue is full.
+    std::atomic<LogOverflowPolicy> policy_{LogOverflowPolicy::Drop};
+    /// Sample rate for LogOverflowPolicy::Sample.
+    std::atomic<unsigned> sampleRate_{16};
+    /// Counter of sampled messages.
+    std::atomic<unsigned> sampleCounter_{};
+    /// Number of messages dropped.
+    std::atomic<unsigned long long> numDropped_{};
+    /// Number of messages pushed to the queue.
+    std::atomic<unsigned long long> numPushed_{};
+    /// Number of messages written from the queue.
+    std::atomic<unsigned long long> numProcessed_{};
+
 #ifdef __ANDROID__
     /// Android adb logcat sink
     std::shared_ptr<spdlog::sinks::android_sink_mt> platformSink_;
@@ -349,19 +546,84 @@ public:
 
     /// Sink that forwards messages to all other sinks.
     std::shared_ptr<spdlog::sinks::dist_sink_mt> distributorSink_;
+    /// Sink that forwards messages to owner Log as events.
+    std::shared_ptr<MessageForwarderSink_mt> forwarderSink_;
     /// Sink that filters out duplicate messages.
     std::shared_ptr<DuplicateFilterSink> dupFilterSink_;
 
     /// Sink that should be used for logging.
     std::shared_ptr<spdlog::sinks::sink> mainSink_;
+    /// Loggers created for this Log. Owned here so Logger copies stay valid while they reference this object.
+    ea::unordered_map<ea::string, std::shared_ptr<spdlog::logger>> loggers_;
 };
 
+void LogThread::ThreadFunction()
+{
+    URHO3D_PROFILE_THREAD("LogThread");
+    isLogThread = true;
+    owner_->RunThread();
+}
+
+Logger::Logger(void* logger, LogImpl* impl)
+    : logger_(logger)
+    , impl_(impl)
+{
+}
+
+Logger::Logger() = default;
+
+Logger::Logger(const Logger& other) = default;
+
+Logger::~Logger() = default;
+
+Logger& Logger::operator=(const Logger& other) = default;
+
+void Logger::Write(LogLevel level, ea::string_view message) const
+{
+    if (logger_ == nullptr)
+        return;
+
+    auto* logger = reinterpret_cast<spdlog::logger*>(logger_);
+    const spdlog::level::level_enum writeLevel = GetWriteLevel(level);
+
+    if (impl_ && impl_->IsAsync())
+    {
+        if (logger->should_log(writeLevel))
+            impl_->Enqueue({logger, writeLevel, spdlog::log_clock::now(), ea::string(message), nullptr});
+        return;
+    }
+
+    logger->log(writeLevel, ToFmtStringView(message));
+}
+
+void Logger::WriteDeferredImpl(LogLevel level, ea::function<ea::string()> callback) const
+{
+    if (impl_ && impl_->IsAsync())
+    {
+        auto* logger = reinterpret_cast<spdlog::logger*>(logger_);
+        impl_->Enqueue({logger, GetWriteLevel(level), spdlog::log_clock::now(), EMPTY_STRING, ea::move(callback)});
+        return;
+    }
+
+    Write(level, callback());
+}
+
+bool Logger::IsEnabled(LogLevel level) const
+{
+    if (logger_ == nullptr)
+        return false;
+
+    auto* logger = reinterpret_cast<spdlog::logger*>(logger_);
+    return logger->should_log(GetWriteLevel(level));
+}
+
 Log::Log(Context* context) :
     Object(context),
     impl_(new LogImpl(context)),
     formatPattern_("[%H:%M:%S] [%l] [%n] : %v"),
     defaultLogger_(GetOrCreateLogger("main"))
 {
+    impl_->forwarderSink_->SetOwner(this);
 #if !__EMSCRIPTEN__
     spdlog::flush_every(std::chrono::seconds(5));
 #endif
@@ -370,6 +632,9 @@ Log::Log(Context* context) :
 
 Log::~Log()
 {
+    impl_->StopAsync();
+    // Logger copies may outlive the Log and keep writing to console and file
+    impl_->forwarderSink_->SetOwner(nullptr);
     spdlog::shutdown();
 }
 
@@ -410,7 +675,10 @@ void Log::SetLevel(LogLevel level)
     }
 
     level_ = level;
-    spdlog::set_level(ConvertLogLevel(level));
+
+    MutexLock lock(logMutex_);
+    for (const auto& [name, logger] : impl_->loggers_)
+        logger->set_level(ConvertLogLevel(level));
 }
 
 void Log::SetQuiet(bool quiet)
@@ -433,6 +701,68 @@ void Log::SetLogFormat(const ea::string& format)
 #endif
 }
 
+void Log::SetAsync(bool enable)
+{
+    if (enable)
+        impl_->StartAsync(asyncQueueCapacity_);
+    else
+        impl_->StopAsync();
+}
+
+void Log::SetAsyncQueueCapacity(unsigned capacity)
+{
+    asyncQueueCapacity_ = ea::max(capacity, 2u);
+}
+
+void Log::SetOverflowPolicy(LogOverflowPolicy policy)
+{
+    impl_->policy_.store(policy, std::memory_order_relaxed);
+}
+
+void Log::SetSampleRate(unsigned rate)
+{
+    impl_->sampleRate_.store(ea::max(rate, 1u), std::memory_order_relaxed);
+}
+
+void Log::Flush()
+{
+    impl_->WaitForQueue();
+
+    MutexLock lock(logMutex_);
+    for (const auto& [name, logger] : impl_->loggers_)
+        logger->flush();
+}
+
+bool Log::IsAsync() const
+{
+    return impl_->IsAsync();
+}
+
+LogOverflowPolicy Log::GetOverflowPolicy() const
+{
+    return impl_->policy_.load(std::memory_order_relaxed);
+}
+
+unsigned Log::GetSampleRate() const
+{
+    return impl_->sampleRate_.load(std::memory_order_relaxed);
+}
+
+unsigned long long Log::GetNumDroppedMessages() const
+{
+    return impl_->numDropped_.load(std::memory_order_relaxed);
+}
+
+unsigned Log::GetNumQueuedMessages() const
+{
+    return impl_->queue_ ? impl_->queue_->GetSize() : 0;
+}
+
+unsigned long long Log::GetNumProcessedMessages() const
+{
+    return impl_->numProcessed_.load(std::memory_order_relaxed);
+}
+
 Logger Log::GetLogger(const ea::string& name)
 {
     // Loggers may be used only after initializing Log subsystem, therefore do not use logging from static initializers.
@@ -445,19 +775,23 @@ Logger Log::GetLogger(const ea::string& name)
 
 Logger Log::GetOrCreateLogger(const ea::string& name)
 {
-    std::shared_ptr<spdlog::logger> logger;
     MutexLock lock(logMutex_);
 
-    logger = spdlog::get(name.c_str());
-
+    // Loggers in spdlog registry may belong to another Log instance, only own loggers are reused
+    std::shared_ptr<spdlog::logger>& logger = impl_->loggers_[name];
     if (!logger)
     {
         logger = std::make_shared<spdlog::logger>(name.c_str(), impl_->mainSink_);
         logger->set_level(ConvertLogLevel(level_));
-        spdlog::register_logger(logger);
+
+        // Register for periodic flush, first Log instance wins the name
+        static std::mutex registryMutex;
+        std::lock_guard<std::mutex> registryLock(registryMutex);
+        if (!spdlog::get(name.c_str()))
+            spdlog::register_logger(logger);
     }
 
-    return Logger(reinterpret_cast<void*>(logger.get()));
+    return Logger(reinterpret_cast<void*>(logger.get()), impl_);
 }
 
 Logger Log::GetLogger()
@@ -488,10 +822,6 @@ void Log::SendMessageEvent(LogLevel level, time_t timestamp, const ea::string& l
     }
 #endif
 
-    auto* logInstance = GetLog();
-    if (logInstance == nullptr)
-        return;
-
     // If not in the main thread, store message for later processing
     if (!Thread::IsMainThread())
     {
@@ -507,7 +837,7 @@ void Log::SendMessageEvent(LogLevel level, time_t timestamp, const ea::string& l
 
     using namespace LogMessage;
 
-    VariantMap& eventData = logInstance->GetEventDataMap();
+    VariantMap& eventData = GetEventDataMap();
     eventData[P_LEVEL] = level;
     eventData[P_TIME] = (unsigned)timestamp;
     eventData[P_LOGGER] = logger;
@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include <EASTL/functional.h>
 #include <EASTL/list.h>
 
 #include "../Core/Assert.h"
@@ -77,6 +78,17 @@ static const char* logLevelNames[] =
     nullptr
 };
 
+/// Policy applied when asynchronous log queue is full.
+enum class LogOverflowPolicy
+{
+    /// Drop new messages.
+    Drop,
+    /// Block writer until there's space in the queue.
+    Block,
+    /// Keep only every N-th message when the queue is more than half full. Errors are never sampled out.
+    Sample,
+};
+
 class File;
 
 /// Stored log message from another thread.
@@ -111,19 +123,35 @@ class Log;
 class URHO3D_API Logger
 {
 protected:
-    explicit Logger(void* logger);
+    Logger(void* logger, LogImpl* impl);
 
     friend class Log;
 
 public:
-    Logger() = default;
-    Logger(const Logger& other) = default;
+    Logger();
+    Logger(const Logger& other);
+    ~Logger();
+    Logger& operator=(const Logger& other);
 
     /// Write formatted message to log if there are extra arguments.
     template <class Arg, class... Args>
-    void Write(LogLevel level, ea::string_view format, const Arg& arg, const Args&... args) const { Write(level, Format(format, arg, args...)); }
+    void Write(LogLevel level, ea::string_view format, const Arg& arg, const Args&... args) const
+    {
+        if (IsEnabled(level))
+            Write(level, Format(format, arg, args...));
+    }
     /// Write message to log as is if there's no extra arguments.
     void Write(LogLevel level, ea::string_view message) const;
+    /// Write message produced by the callback. In asynchronous mode the callback is invoked from the log thread,
+    /// so it should capture everything by value.
+    template <class T>
+    void WriteDeferred(LogLevel level, T callback) const
+    {
+        if (IsEnabled(level))
+            WriteDeferredImpl(level, ea::move(callback));
+    }
+    /// Return whether the messages of given level are written.
+    bool IsEnabled(LogLevel level) const;
 
     template<typename... Args> void Trace(ea::string_view format, Args... args) const   { Write(LOG_TRACE, format, args...); }
     template<typename... Args> void Debug(ea::string_view format, Args... args) const   { Write(LOG_DEBUG, format, args...); }
@@ -132,8 +160,13 @@ public:
     template<typename... Args> void Error(ea::string_view format, Args... args) const   { Write(LOG_ERROR, format, args...); }
 
 protected:
+    /// Write deferred message if level check is passed.
+    void WriteDeferredImpl(LogLevel level, ea::function<ea::string()> callback) const;
+
     /// Instance of spdlog logger.
     void* logger_ = nullptr;
+    /// Log implementation that owns spdlog logger and asynchronous queue. Kept alive even if Log is destroyed.
+    SharedPtr<LogImpl> impl_;
 };
 
 /// Logging subsystem.
@@ -171,24 +204,62 @@ public:
     /// @property
     bool IsQuiet() const { return quiet_; }
 
+    /// Set whether to write messages from dedicated log thread. Writers only push messages to the lock-free queue.
+    /// Should not be called while other threads are writing to the log.
+    /// @property
+    void SetAsync(bool enable);
+    /// Set capacity of asynchronous log queue. Applied when asynchronous mode is enabled next time.
+    /// @property
+    void SetAsyncQueueCapacity(unsigned capacity);
+    /// Set policy applied when asynchronous log queue is full.
+    /// @property
+    void SetOverflowPolicy(LogOverflowPolicy policy);
+    /// Set how many messages are sampled out per kept message if overflow policy is LogOverflowPolicy::Sample.
+    /// @property
+    void SetSampleRate(unsigned rate);
+    /// Wait until all queued messages are written and flush sinks.
+    void Flush();
+
+    /// Return whether messages are written from dedicated log thread.
+    /// @property
+    bool IsAsync() const;
+    /// Return capacity of asynchronous log queue.
+    /// @property
+    unsigned GetAsyncQueueCapacity() const { return asyncQueueCapacity_; }
+    /// Return policy applied when asynchronous log queue is full.
+    /// @property
+    LogOverflowPolicy GetOverflowPolicy() const;
+    /// Return sample rate for LogOverflowPolicy::Sample.
+    /// @property
+    unsigned GetSampleRate() const;
+    /// Return total number of messages dropped because asynchronous log queue was full.
+    unsigned long long GetNumDroppedMessages() const;
+    /// Return number of messages currently waiting in asynchronous log queue.
+    unsigned GetNumQueuedMessages() const;
+    /// Return total number of messages written from asynchronous log queue.
+    unsigned long long GetNumProcessedMessages() const;
+
     /// Returns a logger with specified name.
     static Logger GetLogger(const ea::string& name);
     /// Returns default logger.
     static Logger GetLogger();
 
+    /// Return new or existing logger for this Log instance.
+    Logger GetOrCreateLogger(const ea::string& name);
+
     ///
     void PumpThreadMessages();
 
 private:
     /// Handle end of frame. Process the threaded log messages.
     void HandleEndFrame(StringHash eventType, VariantMap& eventData) { PumpThreadMessages(); }
-    /// Return new or existing logger for this Log instance.
-    Logger GetOrCreateLogger(const ea::string& name);
 
     /// Implementation hiding spdlog class types from public headers.
     SharedPtr<LogImpl> impl_;
     /// Log format pattern.
     ea::string formatPattern_{};
+    /// Capacity of asynchronous log queue.
+    unsigned asyncQueueCapacity_{8 * 1024};
     /// Mutex for threaded operation.
     Mutex logMutex_{};
     /// Log messages from other threads.
@@ -0,0 +1,188 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/Assert.h"
+#include "../Math/BoundingBoxArray.h"
+#include "../Math/Frustum.h"
+
+#include <limits>
+
+#ifdef URHO3D_SSE
+#include <xmmintrin.h>
+#endif
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+BoundingBoxArray::BoundingBoxArray()
+{
+    Clear();
+}
+
+void BoundingBoxArray::PushBack(const BoundingBox& box)
+{
+    // Insert before padding
+    const Vector3 center = box.Center();
+    const Vector3 halfSize = center - box.min_;
+    centerX_.insert(centerX_.begin() + size_, center.x_);
+    centerY_.insert(centerY_.begin() + size_, center.y_);
+    centerZ_.insert(centerZ_.begin() + size_, center.z_);
+    halfSizeX_.insert(halfSizeX_.begin() + size_, halfSize.x_);
+    halfSizeY_.insert(halfSizeY_.begin() + size_, halfSize.y_);
+    halfSizeZ_.insert(halfSizeZ_.begin() + size_, halfSize.z_);
+    ++size_;
+}
+
+void BoundingBoxArray::EraseAt(unsigned index)
+{
+    URHO3D_ASSERT(index < size_);
+
+    centerX_.erase_at(index);
+    centerY_.erase_at(index);
+    centerZ_.erase_at(index);
+    halfSizeX_.erase_at(index);
+    halfSizeY_.erase_at(index);
+    halfSizeZ_.erase_at(index);
+    --size_;
+}
+
+void BoundingBoxArray::Clear()
+{
+    size_ = 0;
+    centerX_.assign(Padding, 0.0f);
+    centerY_.assign(Padding, 0.0f);
+    centerZ_.assign(Padding, 0.0f);
+    halfSizeX_.assign(Padding, 0.0f);
+    halfSizeY_.assign(Padding, 0.0f);
+    halfSizeZ_.assign(Padding, 0.0f);
+}
+
+void BoundingBoxArray::Set(unsigned index, const BoundingBox& box)
+{
+    URHO3D_ASSERT(index < size_);
+
+    // Same math as in Frustum::IsInsideFast so results are consistent
+    const Vector3 center = box.Center();
+    const Vector3 halfSize = center - box.min_;
+    centerX_[index] = center.x_;
+    centerY_[index] = center.y_;
+    centerZ_[index] = center.z_;
+    halfSizeX_[index] = halfSize.x_;
+    halfSizeY_[index] = halfSize.y_;
+    halfSizeZ_[index] = halfSize.z_;
+}
+
+void BoundingBoxArray::Invalidate(unsigned index)
+{
+    URHO3D_ASSERT(index < size_);
+
+    // NaN center fails all plane tests, so invalid box is never culled
+    centerX_[index] = std::numeric_limits<float>::quiet_NaN();
+}
+
+unsigned BoundingBoxArray::CullFrustum(
+    const Frustum& frustum, unsigned beginIndex, unsigned endIndex, unsigned* outputIndices) const
+{
+    URHO3D_ASSERT(beginIndex <= endIndex && endIndex <= size_);
+
+    unsigned numVisible = 0;
+
+#ifdef URHO3D_SSE
+    __m128 normalX[NUM_FRUSTUM_PLANES];
+    __m128 normalY[NUM_FRUSTUM_PLANES];
+    __m128 normalZ[NUM_FRUSTUM_PLANES];
+    __m128 absNormalX[NUM_FRUSTUM_PLANES];
+    __m128 absNormalY[NUM_FRUSTUM_PLANES];
+    __m128 absNormalZ[NUM_FRUSTUM_PLANES];
+    __m128 distance[NUM_FRUSTUM_PLANES];
+    for (unsigned i = 0; i < NUM_FRUSTUM_PLANES; ++i)
+    {
+        const Plane& plane = frustum.planes_[i];
+        normalX[i] = _mm_set1_ps(plane.normal_.x_);
+        normalY[i] = _mm_set1_ps(plane.normal_.y_);
+        normalZ[i] = _mm_set1_ps(plane.normal_.z_);
+        absNormalX[i] = _mm_set1_ps(plane.absNormal_.x_);
+        absNormalY[i] = _mm_set1_ps(plane.absNormal_.y_);
+        absNormalZ[i] = _mm_set1_ps(plane.absNormal_.z_);
+        distance[i] = _mm_set1_ps(plane.d_);
+    }
+
+    const __m128 zero = _mm_setzero_ps();
+    for (unsigned batchIndex = beginIndex; batchIndex < endIndex; batchIndex += BatchSize)
+    {
+        const __m128 centerX = _mm_loadu_ps(&centerX_[batchIndex]);
+        const __m128 centerY = _mm_loadu_ps(&centerY_[batchIndex]);
+        const __m128 centerZ = _mm_loadu_ps(&centerZ_[batchIndex]);
+        const __m128 halfSizeX = _mm_loadu_ps(&halfSizeX_[batchIndex]);
+        const __m128 halfSizeY = _mm_loadu_ps(&halfSizeY_[batchIndex]);
+        const __m128 halfSizeZ = _mm_loadu_ps(&halfSizeZ_[batchIndex]);
+
+        __m128 outside = zero;
+        for (unsigned i = 0; i < NUM_FRUSTUM_PLANES; ++i)
+        {
+            __m128 dist = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+                _mm_mul_ps(normalX[i], centerX),
+                _mm_mul_ps(normalY[i], centerY)),
+                _mm_mul_ps(normalZ[i], centerZ)),
+                distance[i]);
+            __m128 absDist = _mm_add_ps(_mm_add_ps(
+                _mm_mul_ps(absNormalX[i], halfSizeX),
+                _mm_mul_ps(absNormalY[i], halfSizeY)),
+                _mm_mul_ps(absNormalZ[i], halfSizeZ));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(dist, _mm_sub_ps(zero, absDist)));
+        }
+
+        // Ignore padding or boxes after the end of the range
+        const unsigned numBoxes = ea::min(BatchSize, endIndex - batchIndex);
+        const unsigned visibleMask = ~static_cast<unsigned>(_mm_movemask_ps(outside)) & ((1u << numBoxes) - 1);
+        for (unsigned i = 0; i < numBoxes; ++i)
+        {
+            if (visibleMask & (1u << i))
+                outputIndices[numVisible++] = batchIndex + i;
+        }
+    }
+#else
+    for (unsigned index = beginIndex; index < endIndex; ++index)
+    {
+        bool outside = false;
+        for (const Plane& plane : frustum.planes_)
+        {
+            const float dist = plane.normal_.x_ * centerX_[index] + plane.normal_.y_ * centerY_[index]
+                + plane.normal_.z_ * centerZ_[index] + plane.d_;
+            const float absDist = plane.absNormal_.x_ * halfSizeX_[index] + plane.absNormal_.y_ * halfSizeY_[index]
+                + plane.absNormal_.z_ * halfSizeZ_[index];
+            outside |= dist < -absDist;
+        }
+
+        if (!outside)
+            outputIndices[numVisible++] = index;
+    }
+#endif
+
+    return numVisible;
+}
+
+}
@@ -0,0 +1,86 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+/// \file
+
+#pragma once
+
+#include "../Math/BoundingBox.h"
+
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+class Frustum;
+
+/// Array of bounding boxes stored as structure of arrays of centers and half sizes.
+/// Used to test many boxes at once in vectorized intersection tests.
+/// Box may be invalidated, invalid boxes are never culled.
+class URHO3D_API BoundingBoxArray
+{
+public:
+    /// Number of boxes tested in one iteration.
+    static const unsigned BatchSize = 4;
+
+    /// Construct empty.
+    BoundingBoxArray();
+
+    /// Add box to the end.
+    void PushBack(const BoundingBox& box);
+    /// Remove box at index. Order of other boxes is preserved.
+    void EraseAt(unsigned index);
+    /// Remove all boxes.
+    void Clear();
+    /// Replace box at index.
+    void Set(unsigned index, const BoundingBox& box);
+    /// Invalidate box at index.
+    void Invalidate(unsigned index);
+
+    /// Return number of boxes.
+    unsigned Size() const { return size_; }
+    /// Return whether the array is empty.
+    bool Empty() const { return size_ == 0; }
+    /// Return whether the box at index is valid.
+    bool IsValid(unsigned index) const { return !IsNaN(centerX_[index]); }
+
+    /// Test boxes in range against frustum. Write indices of boxes that are not fully outside to the output.
+    /// Output should have space for all boxes in range. Return number of written indices.
+    unsigned CullFrustum(const Frustum& frustum, unsigned beginIndex, unsigned endIndex, unsigned* outputIndices) const;
+
+private:
+    /// Number of padding elements after the last box, so the last batch can be loaded at once.
+    static const unsigned Padding = BatchSize - 1;
+
+    /// Number of boxes.
+    unsigned size_{};
+    /// Box centers.
+    ea::vector<float> centerX_;
+    ea::vector<float> centerY_;
+    ea::vector<float> centerZ_;
+    /// Box half sizes.
+    ea::vector<float> halfSizeX_;
+    ea::vector<float> halfSizeY_;
+    ea::vector<float> halfSizeZ_;
+};
+
+}
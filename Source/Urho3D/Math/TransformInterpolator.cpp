@@ -0,0 +1,242 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Core/Assert.h"
+#include "../Math/TransformInterpolator.h"
+
+#ifdef URHO3D_SSE
+#include <emmintrin.h>
+#endif
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+namespace
+{
+
+#ifdef URHO3D_SSE
+inline __m128 MultiplyAdd(__m128 a, __m128 b, float c)
+{
+    return _mm_add_ps(_mm_mul_ps(a, b), _mm_set1_ps(c));
+}
+
+/// Return arc cosine of values in range [0, 1]. Absolute error is below 1e-7.
+inline __m128 AcosUnit(__m128 x)
+{
+    // Abramowitz and Stegun, formula 4.4.46
+    __m128 result = _mm_set1_ps(-0.0012624911f);
+    result = MultiplyAdd(result, x, 0.0066700901f);
+    result = MultiplyAdd(result, x, -0.0170881256f);
+    result = MultiplyAdd(result, x, 0.0308918810f);
+    result = MultiplyAdd(result, x, -0.0501743046f);
+    result = MultiplyAdd(result, x, 0.0889789874f);
+    result = MultiplyAdd(result, x, -0.2145988016f);
+    result = MultiplyAdd(result, x, 1.5707963050f);
+    return _mm_mul_ps(result, _mm_sqrt_ps(_mm_sub_ps(_mm_set1_ps(1.0f), x)));
+}
+
+/// Return sine of values in range [0, pi/2]. Absolute error is below 1e-7.
+inline __m128 SinHalfPi(__m128 x)
+{
+    const __m128 x2 = _mm_mul_ps(x, x);
+    __m128 result = _mm_set1_ps(-2.5052108e-8f);
+    result = MultiplyAdd(result, x2, 2.7557319e-6f);
+    result = MultiplyAdd(result, x2, -1.9841270e-4f);
+    result = MultiplyAdd(result, x2, 8.3333333e-3f);
+    result = MultiplyAdd(result, x2, -1.6666667e-1f);
+    result = MultiplyAdd(result, x2, 1.0f);
+    return _mm_mul_ps(result, x);
+}
+
+/// Return mask ? a : b.
+inline __m128 Select(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+/// Interpolate linearly, same as Vector3::Lerp.
+inline __m128 Lerp(__m128 from, __m128 to, __m128 factor, __m128 inverseFactor)
+{
+    return _mm_add_ps(_mm_mul_ps(from, inverseFactor), _mm_mul_ps(to, factor));
+}
+#endif
+
+}
+
+TransformInterpolator::TransformInterpolator()
+{
+    Clear();
+}
+
+void TransformInterpolator::Clear()
+{
+    size_ = 0;
+    for (ea::vector<float>& component : components_)
+        component.clear();
+}
+
+unsigned TransformInterpolator::Add(const Transform& from, const Transform& to, const Vector3& factors)
+{
+    // Allocate whole batch at once, so padding is always initialized
+    if (size_ % BatchSize == 0)
+    {
+        for (ea::vector<float>& component : components_)
+            component.resize(size_ + BatchSize, 0.0f);
+    }
+
+    const unsigned index = size_++;
+    Set(index, from, to, factors);
+    return index;
+}
+
+void TransformInterpolator::Set(unsigned index, const Transform& from, const Transform& to, const Vector3& factors)
+{
+    URHO3D_ASSERT(index < size_);
+
+    const float values[NumComponents] = {
+        from.position_.x_, from.position_.y_, from.position_.z_,
+        from.rotation_.w_, from.rotation_.x_, from.rotation_.y_, from.rotation_.z_,
+        from.scale_.x_, from.scale_.y_, from.scale_.z_,
+        to.position_.x_, to.position_.y_, to.position_.z_,
+        to.rotation_.w_, to.rotation_.x_, to.rotation_.y_, to.rotation_.z_,
+        to.scale_.x_, to.scale_.y_, to.scale_.z_,
+        factors.x_, factors.y_, factors.z_};
+
+    for (unsigned i = 0; i < NumComponents; ++i)
+        components_[i][index] = values[i];
+}
+
+void TransformInterpolator::Evaluate()
+{
+#ifdef URHO3D_SSE
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128 minSinAngle = _mm_set1_ps(0.001f);
+
+    float* data[NumComponents];
+    for (unsigned i = 0; i < NumComponents; ++i)
+        data[i] = components_[i].data();
+
+    const auto load = [&](Component component, unsigned index) { return _mm_loadu_ps(&data[component][index]); };
+    const auto store = [&](Component component, unsigned index, __m128 value) { _mm_storeu_ps(&data[component][index], value); };
+
+    for (unsigned index = 0; index < size_; index += BatchSize)
+    {
+        // Positions and scales
+        const __m128 positionFactor = load(PositionFactor, index);
+        const __m128 inversePositionFactor = _mm_sub_ps(one, positionFactor);
+        for (unsigned i = 0; i < 3; ++i)
+        {
+            const auto from = static_cast<Component>(FromPositionX + i);
+            const auto to = static_cast<Component>(ToPositionX + i);
+            store(from, index, Lerp(load(from, index), load(to, index), positionFactor, inversePositionFactor));
+        }
+
+        const __m128 scaleFactor = load(ScaleFactor, index);
+        const __m128 inverseScaleFactor = _mm_sub_ps(one, scaleFactor);
+        for (unsigned i = 0; i < 3; ++i)
+        {
+            const auto from = static_cast<Component>(FromScaleX + i);
+            const auto to = static_cast<Component>(ToScaleX + i);
+            store(from, index, Lerp(load(from, index), load(to, index), scaleFactor, inverseScaleFactor));
+        }
+
+        // Rotations
+        const __m128 fromW = load(FromRotationW, index);
+        const __m128 fromX = load(FromRotationX, index);
+        const __m128 fromY = load(FromRotationY, index);
+        const __m128 fromZ = load(FromRotationZ, index);
+        __m128 toW = load(ToRotationW, index);
+        __m128 toX = load(ToRotationX, index);
+        __m128 toY = load(ToRotationY, index);
+        __m128 toZ = load(ToRotationZ, index);
+
+        // Enable shortest path rotation
+        const __m128 cosAngleSigned = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(fromW, toW), _mm_mul_ps(fromX, toX)),
+            _mm_add_ps(_mm_mul_ps(fromY, toY), _mm_mul_ps(fromZ, toZ)));
+        const __m128 sign = _mm_and_ps(cosAngleSigned, signMask);
+        toW = _mm_xor_ps(toW, sign);
+        toX = _mm_xor_ps(toX, sign);
+        toY = _mm_xor_ps(toY, sign);
+        toZ = _mm_xor_ps(toZ, sign);
+        const __m128 cosAngle = _mm_min_ps(_mm_andnot_ps(signMask, cosAngleSigned), one);
+
+        const __m128 rotationFactor = load(RotationFactor, index);
+        const __m128 inverseRotationFactor = _mm_sub_ps(one, rotationFactor);
+
+        const __m128 angle = AcosUnit(cosAngle);
+        const __m128 sinAngle = SinHalfPi(angle);
+        const __m128 useSlerp = _mm_cmpgt_ps(sinAngle, minSinAngle);
+        const __m128 invSinAngle = _mm_div_ps(one, Select(useSlerp, sinAngle, one));
+
+        // Keep source rotation exact for zero factor, polynomial approximation doesn't guarantee that
+        const __m128 keepFrom = _mm_cmpeq_ps(rotationFactor, _mm_setzero_ps());
+        const __m128 fromWeight = Select(keepFrom, one, Select(useSlerp,
+            _mm_mul_ps(SinHalfPi(_mm_mul_ps(inverseRotationFactor, angle)), invSinAngle), inverseRotationFactor));
+        const __m128 toWeight = Select(useSlerp,
+            _mm_mul_ps(SinHalfPi(_mm_mul_ps(rotationFactor, angle)), invSinAngle), rotationFactor);
+
+        store(FromRotationW, index, Lerp(fromW, toW, toWeight, fromWeight));
+        store(FromRotationX, index, Lerp(fromX, toX, toWeight, fromWeight));
+        store(FromRotationY, index, Lerp(fromY, toY, toWeight, fromWeight));
+        store(FromRotationZ, index, Lerp(fromZ, toZ, toWeight, fromWeight));
+    }
+#else
+    for (unsigned index = 0; index < size_; ++index)
+    {
+        const Transform result = GetResult(index);
+        const Vector3 toPosition{components_[ToPositionX][index], components_[ToPositionY][index], components_[ToPositionZ][index]};
+        const Quaternion toRotation{components_[ToRotationW][index], components_[ToRotationX][index],
+            components_[ToRotationY][index], components_[ToRotationZ][index]};
+        const Vector3 toScale{components_[ToScaleX][index], components_[ToScaleY][index], components_[ToScaleZ][index]};
+
+        const Vector3 position = result.position_.Lerp(toPosition, components_[PositionFactor][index]);
+        const Quaternion rotation = result.rotation_.Slerp(toRotation, components_[RotationFactor][index]);
+        const Vector3 scale = result.scale_.Lerp(toScale, components_[ScaleFactor][index]);
+
+        const float values[] = {position.x_, position.y_, position.z_,
+            rotation.w_, rotation.x_, rotation.y_, rotation.z_, scale.x_, scale.y_, scale.z_};
+        for (unsigned i = 0; i < ToPositionX; ++i)
+            components_[i][index] = values[i];
+    }
+#endif
+}
+
+Transform TransformInterpolator::GetResult(unsigned index) const
+{
+    URHO3D_ASSERT(index < size_);
+
+    Transform result;
+    result.position_ = {components_[FromPositionX][index], components_[FromPositionY][index], components_[FromPositionZ][index]};
+    result.rotation_ = {components_[FromRotationW][index], components_[FromRotationX][index],
+        components_[FromRotationY][index], components_[FromRotationZ][index]};
+    result.scale_ = {components_[FromScaleX][index], components_[FromScaleY][index], components_[FromScaleZ][index]};
+    return result;
+}
+
+}
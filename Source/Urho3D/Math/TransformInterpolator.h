@@ -0,0 +1,99 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+/// \file
+
+#pragma once
+
+#include "../Math/Transform.h"
+
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+/// Interpolates many pairs of transforms at once.
+/// Pairs are stored as structure of arrays and evaluated in batches of several pairs per instruction.
+/// Positions and scales are interpolated like Vector3::Lerp, rotations are interpolated like Quaternion::Slerp.
+class URHO3D_API TransformInterpolator
+{
+public:
+    /// Number of pairs interpolated in one iteration.
+    static const unsigned BatchSize = 4;
+
+    /// Construct empty.
+    TransformInterpolator();
+
+    /// Remove all pairs. Allocated memory is kept.
+    void Clear();
+    /// Add pair of transforms with separate interpolation factors for position, rotation and scale.
+    /// Return index of the pair.
+    unsigned Add(const Transform& from, const Transform& to, const Vector3& factors);
+    /// Replace pair at index. May be used to interpolate results of previous evaluation once again.
+    void Set(unsigned index, const Transform& from, const Transform& to, const Vector3& factors);
+    /// Interpolate all pairs.
+    void Evaluate();
+
+    /// Return result of interpolation. Valid after Evaluate.
+    Transform GetResult(unsigned index) const;
+    /// Return number of pairs.
+    unsigned Size() const { return size_; }
+
+private:
+    /// Component arrays.
+    enum Component
+    {
+        FromPositionX,
+        FromPositionY,
+        FromPositionZ,
+        FromRotationW,
+        FromRotationX,
+        FromRotationY,
+        FromRotationZ,
+        FromScaleX,
+        FromScaleY,
+        FromScaleZ,
+        ToPositionX,
+        ToPositionY,
+        ToPositionZ,
+        ToRotationW,
+        ToRotationX,
+        ToRotationY,
+        ToRotationZ,
+        ToScaleX,
+        ToScaleY,
+        ToScaleZ,
+        PositionFactor,
+        RotationFactor,
+        ScaleFactor,
+
+        NumComponents
+    };
+
+    /// Number of pairs.
+    unsigned size_{};
+    /// Components of pairs, padded to the batch size. Results are written into "from" components.
+    ea::vector<float> components_[NumComponents];
+};
+
+}
@@ -25,6 +25,7 @@
 #include <EASTL/sort.h>
 
 #include "../Core/Context.h"
+#include "../Core/Metrics.h"
 #include "../Core/Mutex.h"
 #include "../Core/Profiler.h"
 #include "../Graphics/DebugRenderer.h"
@@ -313,6 +314,7 @@ void PhysicsWorld::draw3dText(const btVector3& location, const char* textString)
 void PhysicsWorld::Update(float timeStep)
 {
     URHO3D_PROFILE("UpdatePhysics");
+    URHO3D_METRIC_TIMER("PhysicsWorld::Update");
 
     float internalTimeStep = 1.0f / fps_;
     int maxSubSteps = (int)(timeStep * fps_) + 1;
@@ -24,6 +24,7 @@
 
 #include <EASTL/unique_ptr.h>
 
+#include "../Container/PoolAllocator.h"
 #include "../IO/VectorBuffer.h"
 #include "../Math/BoundingBox.h"
 #include "../Math/Sphere.h"
@@ -136,6 +137,11 @@ static const float DEFAULT_MAX_NETWORK_ANGULAR_VELOCITY = 100.0f;
 /// Cache of collision geometry data.
 using CollisionGeometryDataCache = ea::unordered_map<ea::pair<Model*, unsigned>, SharedPtr<CollisionGeometryData> >;
 
+/// Collision pairs with manifolds. The map is rebuilt on every physics step, so nodes are pooled.
+using CollisionPairMap = ea::unordered_map<ea::pair<WeakPtr<RigidBody>, WeakPtr<RigidBody>>, ManifoldPair,
+    ea::hash<ea::pair<WeakPtr<RigidBody>, WeakPtr<RigidBody>>>, ea::equal_to<ea::pair<WeakPtr<RigidBody>, WeakPtr<RigidBody>>>,
+    PoolEASTLAllocator>;
+
 /// Physics simulation world component. Should be added only to the root scene node.
 class URHO3D_API PhysicsWorld : public Component, public btIDebugDraw
 {
@@ -355,9 +361,9 @@ private:
     /// Constraints in the world.
     ea::vector<Constraint*> constraints_;
     /// Collision pairs on this frame.
-    ea::unordered_map<ea::pair<WeakPtr<RigidBody>, WeakPtr<RigidBody> >, ManifoldPair> currentCollisions_;
+    CollisionPairMap currentCollisions_;
     /// Collision pairs on the previous frame. Used to check if a collision is "new." Manifolds are not guaranteed to exist anymore.
-    ea::unordered_map<ea::pair<WeakPtr<RigidBody>, WeakPtr<RigidBody> >, ManifoldPair> previousCollisions_;
+    CollisionPairMap previousCollisions_;
     /// Delayed (parented) world transform assignments.
     ea::unordered_map<RigidBody*, DelayedWorldTransform> delayedWorldTransforms_;
     /// Cache for trimesh geometry data by model and LOD level.
@@ -22,6 +22,7 @@
 
 #include "../Precompiled.h"
 
+#include "../Core/FrameAllocator.h"
 #include "../IO/Log.h"
 #include "../Graphics/Renderer.h"
 #include "../RenderPipeline/BatchCompositor.h"
@@ -233,23 +234,49 @@ void BatchCompositor::ComposeShadowBatches()
 {
     URHO3D_PROFILE("PrepareShadowBatches");
 
-    // Collect shadow caster batches in worker threads
+    // Collect shadow caster batches in worker threads.
+    // Split is finalized right after composition unless it has to wait for pipeline states from main thread.
     const auto& lightProcessors = drawableProcessor_->GetLightProcessors();
+    FrameVector<unsigned char> hasDelayedBatches(workQueue_->GetFrameAllocator());
+    for (const LightProcessor* lightProcessor : lightProcessors)
+        hasDelayedBatches.resize(hasDelayedBatches.size() + lightProcessor->GetNumSplits());
+
+    shadowBatchTasks_.clear();
+    unsigned globalSplitIndex = 0;
     for (unsigned lightIndex = 0; lightIndex < lightProcessors.size(); ++lightIndex)
     {
         LightProcessor* lightProcessor = lightProcessors[lightIndex];
         const unsigned numSplits = lightProcessor->GetNumSplits();
-        for (unsigned splitIndex = 0; splitIndex < numSplits; ++splitIndex)
+        for (unsigned splitIndex = 0; splitIndex < numSplits; ++splitIndex, ++globalSplitIndex)
         {
-            workQueue_->AddWorkItem([=](unsigned threadIndex)
+            ShadowSplitProcessor* split = lightProcessor->GetMutableSplit(splitIndex);
+            unsigned char& hasDelayedBatchesInSplit = hasDelayedBatches[globalSplitIndex];
+
+            const SharedPtr<WorkTask> beginTask = workQueue_->ScheduleTask([=, &hasDelayedBatchesInSplit](unsigned)
+            {
+                hasDelayedBatchesInSplit = BeginShadowBatchesComposition(lightIndex, split);
+            });
+            shadowBatchTasks_.push_back(workQueue_->ScheduleTask([=, &hasDelayedBatchesInSplit](unsigned)
             {
-                BeginShadowBatchesComposition(lightIndex, lightProcessor->GetMutableSplit(splitIndex));
-            }, M_MAX_UNSIGNED);
+                if (!hasDelayedBatchesInSplit)
+                    split->FinalizeShadowBatches(workQueue_);
+            }, {&beginTask, 1}));
         }
     }
-    workQueue_->Complete(M_MAX_UNSIGNED);
+    workQueue_->WaitForTasks(shadowBatchTasks_);
 
-    // Finalize shadow batches
+    // Finalize remaining shadow batches
+    splitsWithDelayedShadowBatches_.clear();
+    globalSplitIndex = 0;
+    for (LightProcessor* lightProcessor : lightProcessors)
+    {
+        const unsigned numSplits = lightProcessor->GetNumSplits();
+        for (unsigned splitIndex = 0; splitIndex < numSplits; ++splitIndex, ++globalSplitIndex)
+        {
+            if (hasDelayedBatches[globalSplitIndex])
+                splitsWithDelayedShadowBatches_.push_back(lightProcessor->GetMutableSplit(splitIndex));
+        }
+    }
     FinalizeShadowBatchesComposition();
 }
 
@@ -298,7 +325,7 @@ void BatchCompositor::ComposeLightVolumeBatches()
     }
 
     FillSortKeys(sortedLightVolumeBatches_, lightVolumeBatches_);
-    ea::sort(sortedLightVolumeBatches_.begin(), sortedLightVolumeBatches_.end());
+    SortPipelineBatches(workQueue_, lightVolumeBatchSorter_, sortedLightVolumeBatches_);
 }
 
 void BatchCompositor::OnUpdateBegin(const CommonFrameInfo& frameInfo)
@@ -318,7 +345,7 @@ void BatchCompositor::OnPipelineStatesInvalidated()
     lightVolumeCache_.Invalidate();
 }
 
-void BatchCompositor::BeginShadowBatchesComposition(unsigned lightIndex, ShadowSplitProcessor* splitProcessor)
+bool BatchCompositor::BeginShadowBatchesComposition(unsigned lightIndex, ShadowSplitProcessor* splitProcessor)
 {
     LightProcessor* lightProcessor = splitProcessor->GetLightProcessor();
     const unsigned lightHash = lightProcessor->GetShadowHash(splitProcessor->GetSplitIndex());
@@ -328,6 +355,7 @@ void BatchCompositor::BeginShadowBatchesComposition(unsigned lightIndex, ShadowS
     auto& shadowBatches = splitProcessor->GetMutableUnsortedShadowBatches();
     const unsigned lightMask = splitProcessor->GetLight()->GetLightMask();
 
+    bool hasDelayedBatches = false;
     for (Drawable* drawable : shadowCasters)
     {
         // Check shadow mask now when zone is ready
@@ -371,9 +399,13 @@ void BatchCompositor::BeginShadowBatchesComposition(unsigned lightIndex, ShadowS
                 }
             }
             else
+            {
                 delayedShadowBatches_.PushBack(threadIndex, { splitProcessor, desc });
+                hasDelayedBatches = true;
+            }
         }
     }
+    return hasDelayedBatches;
 }
 
 void BatchCompositor::FinalizeShadowBatchesComposition()
@@ -396,20 +428,11 @@ void BatchCompositor::FinalizeShadowBatchesComposition()
     }
 
     // Finalize shadow batches
-    const auto& lightProcessors = drawableProcessor_->GetLightProcessors();
-    for (unsigned lightIndex = 0; lightIndex < lightProcessors.size(); ++lightIndex)
+    ForEachParallel(workQueue_, splitsWithDelayedShadowBatches_,
+        [&](unsigned /*index*/, ShadowSplitProcessor* split)
     {
-        LightProcessor* lightProcessor = lightProcessors[lightIndex];
-        const unsigned numSplits = lightProcessor->GetNumSplits();
-        for (unsigned splitIndex = 0; splitIndex < numSplits; ++splitIndex)
-        {
-            workQueue_->AddWorkItem([=](unsigned threadIndex)
-            {
-                lightProcessor->GetMutableSplit(splitIndex)->FinalizeShadowBatches();
-            }, M_MAX_UNSIGNED);
-        }
-    }
-    workQueue_->Complete(M_MAX_UNSIGNED);
+        split->FinalizeShadowBatches(workQueue_);
+    });
 }
 
 }
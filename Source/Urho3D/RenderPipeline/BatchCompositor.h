@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include "../Core/RadixSort.h"
 #include "../Graphics/GraphicsDefs.h"
 #include "../RenderPipeline/BatchStateCache.h"
 #include "../RenderPipeline/DrawableProcessor.h"
@@ -264,8 +265,8 @@ protected:
     virtual void OnPipelineStatesInvalidated();
     /// @}
 
-    /// Safe to call from worker thread.
-    void BeginShadowBatchesComposition(unsigned lightIndex, ShadowSplitProcessor* splitProcessor);
+    /// Safe to call from worker thread. Return whether some batches are delayed till finalization.
+    bool BeginShadowBatchesComposition(unsigned lightIndex, ShadowSplitProcessor* splitProcessor);
     /// Should be called from main thread.
     void FinalizeShadowBatchesComposition();
 
@@ -295,8 +296,11 @@ private:
     /// @}
 
     WorkQueueVector<ea::pair<ShadowSplitProcessor*, PipelineBatchDesc>> delayedShadowBatches_;
+    ea::vector<ShadowSplitProcessor*> splitsWithDelayedShadowBatches_;
     ea::vector<PipelineBatch> lightVolumeBatches_;
+    ea::vector<SharedPtr<WorkTask>> shadowBatchTasks_;
     ea::vector<PipelineBatchByState> sortedLightVolumeBatches_;
+    RadixSorter<PipelineBatchByState> lightVolumeBatchSorter_;
 };
 
 }
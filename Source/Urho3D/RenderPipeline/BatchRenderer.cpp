@@ -23,6 +23,8 @@
 #include "../Precompiled.h"
 
 #include "../Core/Context.h"
+#include "../Core/Metrics.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/Camera.h"
 #include "../Graphics/DrawCommandQueue.h"
 #include "../Graphics/Graphics.h"
@@ -155,18 +157,30 @@ public:
         }
     }
 
-    /// Add uniforms to instancing buffer for instanced batches.
-    void AddBatchesToInstancingBuffer(InstancingBuffer& instancingBuffer,
-        const SourceBatch& sourceBatch, unsigned instanceIndex)
+    /// Write instancing data for all instances of the batch.
+    void WriteInstancingData(unsigned char* dest, unsigned stride, const SourceBatch& sourceBatch) const
     {
-        instancingBuffer.AddInstance();
-        instancingBuffer.SetElements(&sourceBatch.worldTransform_[instanceIndex], 0, 3);
-        if (ambientEnabled_)
+        static const unsigned TransformSize = sizeof(Matrix3x4);
+        static const unsigned ElementStride = InstancingBuffer::ElementStride;
+        const unsigned numInstances = sourceBatch.numWorldTransforms_;
+
+        // Copy all transforms at once if they are tightly packed in instancing buffer
+        if (!ambientEnabled_ && stride == TransformSize)
         {
-            if (ambientMode_ == DrawableAmbientMode::Flat)
-                instancingBuffer.SetElements(&ambientValueFlat_, 3, 1);
-            else if (ambientMode_ == DrawableAmbientMode::Directional)
-                instancingBuffer.SetElements(ambientValueSH_, 3, 7);
+            memcpy(dest, sourceBatch.worldTransform_, numInstances * TransformSize);
+            return;
+        }
+
+        for (unsigned i = 0; i < numInstances; ++i, dest += stride)
+        {
+            memcpy(dest, &sourceBatch.worldTransform_[i], TransformSize);
+            if (ambientEnabled_)
+            {
+                if (ambientMode_ == DrawableAmbientMode::Flat)
+                    memcpy(dest + 3 * ElementStride, &ambientValueFlat_, ElementStride);
+                else if (ambientMode_ == DrawableAmbientMode::Directional)
+                    memcpy(dest + 3 * ElementStride, ambientValueSH_, 7 * ElementStride);
+            }
         }
     }
 
@@ -278,6 +292,35 @@ public:
         ProcessBatch(pipelineBatch, lightVolumeHelpers_.sourceBatch_);
     }
 
+    /// Rewrite frame, camera and shadow light constants of already recorded queue.
+    void PatchConstants()
+    {
+        for (const PatchableShaderParameterGroup& patchableGroup : drawQueue_.GetPatchableShaderParameterGroups())
+        {
+            drawQueue_.BeginShaderParameterGroupPatch(patchableGroup);
+            switch (patchableGroup.group_)
+            {
+            case SP_FRAME:
+                AddFrameConstants();
+                break;
+
+            case SP_CAMERA:
+                AddCameraConstants(patchableGroup.userValue_);
+                break;
+
+            case SP_LIGHT:
+                assert(outputShadowSplit_);
+                AddPixelLightConstants(outputShadowSplit_->GetLightProcessor()->GetParams());
+                break;
+
+            default:
+                assert(0);
+                break;
+            }
+            drawQueue_.CommitShaderParameterGroup(patchableGroup.group_);
+        }
+    }
+
     void FlushDrawCommands(unsigned nextInstanceIndex)
     {
         if (instancingGroup_.count_ > 0)
@@ -389,12 +432,14 @@ private:
     {
         if (drawQueue_.BeginShaderParameterGroup(SP_FRAME, false))
         {
+            drawQueue_.MarkShaderParameterGroupPatchable();
             AddFrameConstants();
             drawQueue_.CommitShaderParameterGroup(SP_FRAME);
         }
 
         if (drawQueue_.BeginShaderParameterGroup(SP_CAMERA, dirty_.cameraConstants_))
         {
+            drawQueue_.MarkShaderParameterGroupPatchable(current_.constantDepthBias_);
             AddCameraConstants(current_.constantDepthBias_);
             drawQueue_.CommitShaderParameterGroup(SP_CAMERA);
         }
@@ -413,6 +458,7 @@ private:
         {
             if (drawQueue_.BeginShaderParameterGroup(SP_LIGHT, false))
             {
+                drawQueue_.MarkShaderParameterGroupPatchable();
                 const CookedLightParams& params = outputShadowSplit_->GetLightProcessor()->GetParams();
                 AddPixelLightConstants(params);
                 drawQueue_.CommitShaderParameterGroup(SP_LIGHT);
@@ -746,7 +792,7 @@ private:
     const InstancingBuffer& instancingBuffer_;
     const FrameInfo& frameInfo_;
     const Scene& scene_;
-    const ea::vector<LightProcessor*>& lights_;
+    const ea::span<LightProcessor* const> lights_;
     const Node& cameraNode_;
     const float depthRange_{};
     const Vector4 clipPlane_{};
@@ -880,6 +926,7 @@ BatchRenderer::BatchRenderer(RenderPipelineInterface* renderPipeline, const Draw
     : Object(renderPipeline->GetContext())
     , renderer_(context_->GetSubsystem<Renderer>())
     , debugger_(renderPipeline->GetDebugger())
+    , workQueue_(context_->GetSubsystem<WorkQueue>())
     , drawableProcessor_(drawableProcessor)
     , instancingBuffer_(instancingBuffer)
 {
@@ -892,6 +939,9 @@ void BatchRenderer::SetSettings(const BatchRendererSettings& settings)
 
 void BatchRenderer::RenderBatches(const BatchRenderingContext& ctx, PipelineBatchGroup<PipelineBatchByState> batchGroup)
 {
+    URHO3D_METRIC_TIMER("BatchRenderer::RenderBatches");
+    URHO3D_METRIC_COUNTER("BatchRenderer::NumBatches", batchGroup.batches_.size());
+
     batchGroup.flags_ = AdjustRenderFlags(batchGroup.flags_);
 
     if (RenderPipelineDebugger::IsSnapshotInProgress(debugger_))
@@ -914,6 +964,9 @@ void BatchRenderer::RenderBatches(const BatchRenderingContext& ctx, PipelineBatc
 
 void BatchRenderer::RenderBatches(const BatchRenderingContext& ctx, PipelineBatchGroup<PipelineBatchBackToFront> batchGroup)
 {
+    URHO3D_METRIC_TIMER("BatchRenderer::RenderBatches");
+    URHO3D_METRIC_COUNTER("BatchRenderer::NumBatches", batchGroup.batches_.size());
+
     batchGroup.flags_ = AdjustRenderFlags(batchGroup.flags_);
 
     if (RenderPipelineDebugger::IsSnapshotInProgress(debugger_))
@@ -955,6 +1008,15 @@ void BatchRenderer::RenderLightVolumeBatches(const BatchRenderingContext& ctx,
     }
 }
 
+void BatchRenderer::PatchRecordedBatches(const BatchRenderingContext& ctx, BatchRenderFlags flags)
+{
+    URHO3D_METRIC_TIMER("BatchRenderer::PatchRecordedBatches");
+
+    DrawCommandCompositor<false> compositor(ctx, settings_, nullptr,
+        *drawableProcessor_, *instancingBuffer_, AdjustRenderFlags(flags), 0);
+    compositor.PatchConstants();
+}
+
 void BatchRenderer::PrepareInstancingBuffer(PipelineBatchGroup<PipelineBatchByState>& batches)
 {
     PrepareInstancingBufferImpl(batches);
@@ -976,24 +1038,45 @@ void BatchRenderer::PrepareInstancingBufferImpl(PipelineBatchGroup<T>& batches)
     if (!objectParameterBuilder.IsInstancingSupported())
         return;
 
-    batches.startInstance_ = instancingBuffer_->GetNextInstanceIndex();
+    // Allocate instances for the whole group at once
+    instancedBatches_.clear();
     for (const T& sortedBatch : batches.batches_)
     {
         const PipelineBatch& pipelineBatch = *sortedBatch.pipelineBatch_;
         if (!objectParameterBuilder.IsBatchInstanced(pipelineBatch))
             continue;
 
-        const SourceBatch& sourceBatch = pipelineBatch.GetSourceBatch();
-        if (objectParameterBuilder.IsAmbientEnabled())
+        instancedBatches_.emplace_back(&pipelineBatch, batches.numInstances_);
+        batches.numInstances_ += pipelineBatch.GetSourceBatch().numWorldTransforms_;
+    }
+
+    batches.startInstance_ = instancingBuffer_->AddInstances(batches.numInstances_);
+    if (batches.numInstances_ == 0)
+        return;
+
+    URHO3D_METRIC_COUNTER("BatchRenderer::NumInstances", batches.numInstances_);
+
+    // Fill instances in parallel, each batch owns its own range of the buffer
+    unsigned char* groupData = instancingBuffer_->GetInstanceData(batches.startInstance_);
+    const unsigned stride = instancingBuffer_->GetInstanceStride();
+    const BatchRenderFlags flags = batches.flags_;
+    ForEachParallel(workQueue_, InstancedBatchesPerTask, instancedBatches_.size(),
+        [&](unsigned fromIndex, unsigned toIndex)
+    {
+        ObjectParameterBuilder taskObjectParameterBuilder(settings_, flags);
+        for (unsigned i = fromIndex; i < toIndex; ++i)
         {
-            const LightAccumulator& lightAccumulator = drawableProcessor_->GetGeometryLighting(pipelineBatch.drawableIndex_);
-            objectParameterBuilder.SetBatchAmbient(lightAccumulator);
-        }
+            const auto& [pipelineBatch, instanceOffset] = instancedBatches_[i];
+            if (taskObjectParameterBuilder.IsAmbientEnabled())
+            {
+                const LightAccumulator& lightAccumulator = drawableProcessor_->GetGeometryLighting(pipelineBatch->drawableIndex_);
+                taskObjectParameterBuilder.SetBatchAmbient(lightAccumulator);
+            }
 
-        for (unsigned i = 0; i < sourceBatch.numWorldTransforms_; ++i)
-            objectParameterBuilder.AddBatchesToInstancingBuffer(*instancingBuffer_, sourceBatch, i);
-        batches.numInstances_ += sourceBatch.numWorldTransforms_;
-    }
+            taskObjectParameterBuilder.WriteInstancingData(
+                groupData + instanceOffset * stride, stride, pipelineBatch->GetSourceBatch());
+        }
+    });
 }
 
 BatchRenderFlags BatchRenderer::AdjustRenderFlags(BatchRenderFlags flags) const
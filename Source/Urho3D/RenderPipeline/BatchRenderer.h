@@ -29,6 +29,7 @@
 #include "../RenderPipeline/PipelineBatchSortKey.h"
 
 #include <EASTL/span.h>
+#include <EASTL/vector.h>
 
 namespace Urho3D
 {
@@ -37,6 +38,8 @@ class Camera;
 class DrawableProcessor;
 class InstancingBuffer;
 class ShadowSplitProcessor;
+class WorkQueue;
+struct PipelineBatch;
 
 /// Common parameters of batch rendering
 struct BatchRenderingContext
@@ -71,6 +74,10 @@ public:
         ea::span<const PipelineBatchByState> batches);
     /// @}
 
+    /// Update frame, camera and shadow light constants in the queue recorded by RenderBatches on previous frames.
+    /// Flags should be the same as the ones used for recording.
+    void PatchRecordedBatches(const BatchRenderingContext& ctx, BatchRenderFlags flags);
+
     /// Store instancing data for batches.
     /// @{
     void PrepareInstancingBuffer(PipelineBatchGroup<PipelineBatchByState>& batches);
@@ -82,15 +89,22 @@ private:
     void PrepareInstancingBufferImpl(PipelineBatchGroup<T>& batches);
     BatchRenderFlags AdjustRenderFlags(BatchRenderFlags flags) const;
 
+    /// Number of instanced batches processed by one task.
+    static const unsigned InstancedBatchesPerTask = 64;
+
     /// External dependencies
     /// @{
     Renderer* renderer_{};
+    WorkQueue* workQueue_{};
     RenderPipelineDebugger* debugger_{};
     const DrawableProcessor* drawableProcessor_{};
     InstancingBuffer* instancingBuffer_{};
     /// @}
 
     BatchRendererSettings settings_;
+
+    /// Instanced batches of current group and offsets of their instances within the group.
+    ea::vector<ea::pair<const PipelineBatch*, unsigned>> instancedBatches_;
 };
 
 }
@@ -0,0 +1,146 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Graphics/Drawable.h"
+#include "../Graphics/Geometry.h"
+#include "../Graphics/Graphics.h"
+#include "../Graphics/Material.h"
+#include "../RenderPipeline/DrawCommandQueueCache.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+DrawCommandQueueBatchKey::DrawCommandQueueBatchKey(const PipelineBatch& pipelineBatch)
+    : drawable_(pipelineBatch.drawable_)
+    , drawableRevision_(pipelineBatch.drawable_->GetRevision())
+    , material_(pipelineBatch.material_)
+    , materialRevision_(pipelineBatch.material_->GetRevision())
+    , pipelineState_(pipelineBatch.pipelineState_)
+    , geometry_(pipelineBatch.geometry_)
+    , indexBuffer_(pipelineBatch.geometry_->GetIndexBuffer())
+    , indexStart_(pipelineBatch.geometry_->GetIndexStart())
+    , indexCount_(pipelineBatch.geometry_->GetIndexCount())
+    , vertexStart_(pipelineBatch.geometry_->GetVertexStart())
+    , vertexCount_(pipelineBatch.geometry_->GetVertexCount())
+    , sourceBatchIndex_(pipelineBatch.sourceBatchIndex_)
+    , geometryType_(pipelineBatch.geometryType_)
+{
+    const auto& vertexBuffers = pipelineBatch.geometry_->GetVertexBuffers();
+    if (!vertexBuffers.empty())
+        vertexBuffer_ = vertexBuffers[0];
+
+    const SourceBatch& sourceBatch = pipelineBatch.GetSourceBatch();
+    worldTransform_ = sourceBatch.worldTransform_;
+    numWorldTransforms_ = sourceBatch.numWorldTransforms_;
+}
+
+bool DrawCommandQueueBatchKey::operator==(const DrawCommandQueueBatchKey& rhs) const
+{
+    return drawable_ == rhs.drawable_
+        && drawableRevision_ == rhs.drawableRevision_
+        && material_ == rhs.material_
+        && materialRevision_ == rhs.materialRevision_
+        && pipelineState_ == rhs.pipelineState_
+        && geometry_ == rhs.geometry_
+        && indexBuffer_ == rhs.indexBuffer_
+        && vertexBuffer_ == rhs.vertexBuffer_
+        && indexStart_ == rhs.indexStart_
+        && indexCount_ == rhs.indexCount_
+        && vertexStart_ == rhs.vertexStart_
+        && vertexCount_ == rhs.vertexCount_
+        && worldTransform_ == rhs.worldTransform_
+        && numWorldTransforms_ == rhs.numWorldTransforms_
+        && sourceBatchIndex_ == rhs.sourceBatchIndex_
+        && geometryType_ == rhs.geometryType_;
+}
+
+bool DrawCommandQueueKey::operator==(const DrawCommandQueueKey& rhs) const
+{
+    return flags_ == rhs.flags_
+        && startInstance_ == rhs.startInstance_
+        && numInstances_ == rhs.numInstances_
+        && scissorRect_ == rhs.scissorRect_
+        && farClip_ == rhs.farClip_
+        && instancingBuffer_ == rhs.instancingBuffer_
+        && globalResources_ == rhs.globalResources_
+        && batches_ == rhs.batches_;
+}
+
+DrawCommandQueueCache::DrawCommandQueueCache(Graphics* graphics)
+    : graphics_(graphics)
+    , constantBuffersSupported_(graphics_ && graphics_->GetCaps().constantBuffersSupported_)
+    , enabled_(constantBuffersSupported_)
+{
+}
+
+void DrawCommandQueueCache::BeginFrame()
+{
+    numCacheableQueues_ = 0;
+    numReusedQueues_ = 0;
+
+    for (auto iter = queues_.begin(); iter != queues_.end();)
+    {
+        if (!iter->second.used_)
+            iter = queues_.erase(iter);
+        else
+        {
+            iter->second.used_ = false;
+            ++iter;
+        }
+    }
+}
+
+void DrawCommandQueueCache::Invalidate()
+{
+    queues_.clear();
+}
+
+void DrawCommandQueueCache::SetEnabled(bool enabled)
+{
+    enabled_ = enabled && constantBuffersSupported_;
+    if (!enabled_)
+        Invalidate();
+}
+
+ea::pair<DrawCommandQueue*, bool> DrawCommandQueueCache::GetQueueForKey(const void* owner)
+{
+    ++numCacheableQueues_;
+
+    CachedQueue& cachedQueue = queues_[owner];
+    cachedQueue.used_ = true;
+    if (!cachedQueue.queue_)
+        cachedQueue.queue_ = MakeShared<DrawCommandQueue>(graphics_);
+    else if (cachedQueue.key_ == tempKey_)
+    {
+        ++numReusedQueues_;
+        return {cachedQueue.queue_, true};
+    }
+
+    ea::swap(cachedQueue.key_, tempKey_);
+    return {cachedQueue.queue_, false};
+}
+
+}
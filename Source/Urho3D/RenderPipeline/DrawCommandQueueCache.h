@@ -0,0 +1,185 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Container/Ptr.h"
+#include "../Graphics/DrawCommandQueue.h"
+#include "../Math/Rect.h"
+#include "../RenderPipeline/BatchCompositor.h"
+#include "../RenderPipeline/PipelineBatchSortKey.h"
+
+#include <EASTL/span.h>
+#include <EASTL/unordered_map.h>
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+class Geometry;
+class Graphics;
+class Material;
+class PipelineState;
+class VertexBuffer;
+
+/// Everything that affects how the batch is recorded into draw command queue.
+struct DrawCommandQueueBatchKey
+{
+    const Drawable* drawable_{};
+    unsigned drawableRevision_{};
+    const Material* material_{};
+    unsigned materialRevision_{};
+    const PipelineState* pipelineState_{};
+    const Geometry* geometry_{};
+    const void* indexBuffer_{};
+    const void* vertexBuffer_{};
+    unsigned indexStart_{};
+    unsigned indexCount_{};
+    unsigned vertexStart_{};
+    unsigned vertexCount_{};
+    const Matrix3x4* worldTransform_{};
+    unsigned numWorldTransforms_{};
+    unsigned sourceBatchIndex_{};
+    GeometryType geometryType_{};
+
+    explicit DrawCommandQueueBatchKey(const PipelineBatch& pipelineBatch);
+
+    bool operator==(const DrawCommandQueueBatchKey& rhs) const;
+    bool operator!=(const DrawCommandQueueBatchKey& rhs) const { return !(*this == rhs); }
+};
+
+/// Everything that affects how the batch group is recorded into draw command queue.
+/// Frame, camera and shadow light constants are not included because they are patched on reuse.
+struct DrawCommandQueueKey
+{
+    BatchRenderFlags flags_;
+    unsigned startInstance_{};
+    unsigned numInstances_{};
+    IntRect scissorRect_;
+    float farClip_{};
+    const VertexBuffer* instancingBuffer_{};
+    ea::vector<ea::pair<TextureUnit, const Texture*>> globalResources_;
+    ea::vector<DrawCommandQueueBatchKey> batches_;
+
+    /// Return whether the batch group may be cached at all.
+    /// Only groups of static geometry without any lighting are cached,
+    /// because lighting may change without any notification.
+    template <class T>
+    static bool IsCacheable(const PipelineBatchGroup<T>& batchGroup)
+    {
+        const BatchRenderFlags flags = batchGroup.flags_;
+        if (batchGroup.batches_.empty() || flags.Test(BatchRenderFlag::EnableAmbientLighting)
+            || flags.Test(BatchRenderFlag::EnableVertexLights) || flags.Test(BatchRenderFlag::EnablePixelLights))
+            return false;
+
+        for (const auto& sortedBatch : batchGroup.batches_)
+        {
+            const GeometryType geometryType = sortedBatch.pipelineBatch_->geometryType_;
+            if (geometryType != GEOM_STATIC && geometryType != GEOM_STATIC_NOINSTANCING)
+                return false;
+        }
+        return true;
+    }
+
+    /// Initialize key from batch group and rendering parameters.
+    template <class T>
+    void Define(const PipelineBatchGroup<T>& batchGroup, ea::span<const ShaderResourceDesc> globalResources,
+        float farClip, const VertexBuffer* instancingBuffer)
+    {
+        flags_ = batchGroup.flags_;
+        startInstance_ = batchGroup.startInstance_;
+        numInstances_ = batchGroup.numInstances_;
+        scissorRect_ = batchGroup.scissorRect_;
+        farClip_ = farClip;
+        instancingBuffer_ = instancingBuffer;
+
+        globalResources_.clear();
+        for (const ShaderResourceDesc& desc : globalResources)
+            globalResources_.emplace_back(desc.unit_, desc.texture_);
+
+        batches_.clear();
+        for (const auto& sortedBatch : batchGroup.batches_)
+            batches_.emplace_back(*sortedBatch.pipelineBatch_);
+    }
+
+    bool operator==(const DrawCommandQueueKey& rhs) const;
+    bool operator!=(const DrawCommandQueueKey& rhs) const { return !(*this == rhs); }
+};
+
+/// Cache of recorded draw command queues for static batch groups.
+/// Cached queue is reused if the batch group didn't change since previous frame.
+class URHO3D_API DrawCommandQueueCache : public NonCopyable
+{
+public:
+    explicit DrawCommandQueueCache(Graphics* graphics);
+
+    /// Return cached queue for the batch group identified by arbitrary persistent owner.
+    /// Returns null queue if batch group cannot be cached.
+    /// Returns true in second value if the queue is already recorded and only needs patching.
+    /// Otherwise the queue should be reset and recorded.
+    template <class T>
+    ea::pair<DrawCommandQueue*, bool> GetQueue(const void* owner, const PipelineBatchGroup<T>& batchGroup,
+        ea::span<const ShaderResourceDesc> globalResources, float farClip, const VertexBuffer* instancingBuffer)
+    {
+        if (!enabled_ || !DrawCommandQueueKey::IsCacheable(batchGroup))
+            return {};
+
+        tempKey_.Define(batchGroup, globalResources, farClip, instancingBuffer);
+        return GetQueueForKey(owner);
+    }
+
+    /// Begin new frame: remove queues that were not used on previous frame and reset statistics.
+    void BeginFrame();
+    /// Remove all cached queues.
+    void Invalidate();
+    /// Enable or disable the cache. Cache is always disabled if constant buffers are not supported.
+    void SetEnabled(bool enabled);
+
+    /// Return number of batch groups that are eligible for caching on current frame.
+    unsigned GetNumCacheableQueues() const { return numCacheableQueues_; }
+    /// Return number of batch groups rendered from cache on current frame.
+    unsigned GetNumReusedQueues() const { return numReusedQueues_; }
+    /// Return number of queues in the cache.
+    unsigned GetNumQueues() const { return queues_.size(); }
+
+private:
+    struct CachedQueue
+    {
+        SharedPtr<DrawCommandQueue> queue_;
+        DrawCommandQueueKey key_;
+        bool used_{};
+    };
+
+    ea::pair<DrawCommandQueue*, bool> GetQueueForKey(const void* owner);
+
+    Graphics* graphics_{};
+    bool constantBuffersSupported_{};
+    bool enabled_{};
+
+    ea::unordered_map<const void*, CachedQueue> queues_;
+    DrawCommandQueueKey tempKey_;
+
+    unsigned numCacheableQueues_{};
+    unsigned numReusedQueues_{};
+};
+
+}
@@ -22,9 +22,11 @@
 
 #include "../Precompiled.h"
 
+#include "../Core/Metrics.h"
 #include "../Core/WorkQueue.h"
 #include "../Graphics/Drawable.h"
 #include "../Graphics/GlobalIllumination.h"
+#include "../Graphics/HierarchicalLodProxy.h"
 #include "../Graphics/OcclusionBuffer.h"
 #include "../Graphics/Octree.h"
 #include "../Graphics/ReflectionProbe.h"
@@ -38,6 +40,7 @@
 #include "../RenderPipeline/RenderPipelineDefs.h"
 #include "../Scene/Scene.h"
 
+#include <EASTL/algorithm.h>
 #include <EASTL/sort.h>
 
 #include "../DebugNew.h"
@@ -48,6 +51,13 @@ namespace Urho3D
 namespace
 {
 
+/// Number of shadow caster candidates tested by one task.
+const unsigned ShadowCasterCandidatesPerTask = 256;
+/// Number of visible drawables tested against occlusion buffer at once.
+const unsigned DrawablesPerOcclusionTest = 16;
+/// Number of geometries processed by one task during forward lighting accumulation.
+const unsigned ForwardLitGeometriesPerTask = 64;
+
 /// Calculate light penalty for drawable for given absolute light penalty and light settings
 /// Order of penalties, from lower to higher:
 /// -2:      Important directional lights;
@@ -208,6 +218,10 @@ void DrawableProcessor::OnUpdateBegin(const FrameInfo& frameInfo)
     for (UpdateFlag& isUpdated : isDrawableUpdated_)
         isUpdated.clear(std::memory_order_relaxed);
 
+    lodProxyStates_.resize(numDrawables_);
+    for (LodProxyState& state : lodProxyStates_)
+        state.store(0, std::memory_order_relaxed);
+
     geometryFlags_.resize(numDrawables_);
     ea::fill(geometryFlags_.begin(), geometryFlags_.end(), 0);
 
@@ -282,15 +296,47 @@ void DrawableProcessor::ProcessOccluders(const ea::vector<Drawable*>& occluders,
 void DrawableProcessor::ProcessVisibleDrawables(const ea::vector<Drawable*>& drawables, OcclusionBuffer* occlusionBuffer)
 {
     URHO3D_PROFILE("ProcessVisibleDrawables");
+    URHO3D_METRIC_TIMER("DrawableProcessor::ProcessVisibleDrawables");
+    URHO3D_METRIC_HISTOGRAM("DrawableProcessor::NumVisibleDrawables", drawables.size());
 
-    ForEachParallel(workQueue_, drawables,
-        [&](unsigned /*index*/, Drawable* drawable)
+    if (!occlusionBuffer)
     {
-        if (occlusionBuffer && drawable->IsOccludee() && !occlusionBuffer->IsVisible(drawable->GetWorldBoundingBox()))
-            return;
+        ForEachParallel(workQueue_, drawables,
+            [&](unsigned /*index*/, Drawable* drawable) { ProcessVisibleDrawable(drawable); });
+    }
+    else
+    {
+        // Test occludees in groups so their bounding boxes are projected together
+        ForEachParallel(workQueue_, DrawablesPerOcclusionTest, drawables.size(),
+            [&](unsigned beginIndex, unsigned endIndex)
+        {
+            Drawable* occludees[DrawablesPerOcclusionTest];
+            BoundingBox occludeeBoxes[DrawablesPerOcclusionTest];
+            bool isOccludeeVisible[DrawablesPerOcclusionTest];
 
-        ProcessVisibleDrawable(drawable);
-    });
+            unsigned numOccludees = 0;
+            for (unsigned i = beginIndex; i < endIndex; ++i)
+            {
+                Drawable* drawable = drawables[i];
+                if (!drawable->IsOccludee())
+                {
+                    ProcessVisibleDrawable(drawable);
+                    continue;
+                }
+
+                occludees[numOccludees] = drawable;
+                occludeeBoxes[numOccludees] = drawable->GetWorldBoundingBox();
+                ++numOccludees;
+            }
+
+            occlusionBuffer->IsVisible({occludeeBoxes, numOccludees}, {isOccludeeVisible, numOccludees});
+            for (unsigned i = 0; i < numOccludees; ++i)
+            {
+                if (isOccludeeVisible[i])
+                    ProcessVisibleDrawable(occludees[i]);
+            }
+        });
+    }
 
     // Sort lights by component ID for stability
     lights_.resize(lightsTemp_.Size());
@@ -433,6 +479,33 @@ void DrawableProcessor::CheckMaterialForAuxiliaryRenderSurfaces(Material* materi
     material->MarkForAuxView(frameInfo_.frameNumber_);
 }
 
+bool DrawableProcessor::IsHiddenByLodProxy(const Drawable* drawable)
+{
+    const HierarchicalLodProxy* proxy = drawable->GetLodProxy();
+    if (!proxy)
+        return false;
+
+    // Proxy is rendered instead of cluster drawables when it is used and hidden otherwise.
+    // Evaluate proxy once per frame, concurrent evaluations store the same result.
+    bool isProxyUsed{};
+    const unsigned proxyIndex = proxy->GetDrawableIndex();
+    if (proxyIndex < numDrawables_)
+    {
+        LodProxyState& state = lodProxyStates_[proxyIndex];
+        unsigned char value = state.load(std::memory_order_relaxed);
+        if (value == 0)
+        {
+            value = proxy->IsProxyUsed(frameInfo_.camera_) ? 2 : 1;
+            state.store(value, std::memory_order_relaxed);
+        }
+        isProxyUsed = value == 2;
+    }
+    else
+        isProxyUsed = proxy->IsProxyUsed(frameInfo_.camera_);
+
+    return proxy == drawable ? !isProxyUsed : isProxyUsed;
+}
+
 void DrawableProcessor::ProcessVisibleDrawable(Drawable* drawable)
 {
     const unsigned drawableIndex = drawable->GetDrawableIndex();
@@ -447,6 +520,10 @@ void DrawableProcessor::ProcessVisibleDrawable(Drawable* drawable)
     if (maxDistance > 0.0f && drawable->GetDistance() > maxDistance)
         return;
 
+    // Skip if replaced by hierarchical LOD
+    if (IsHiddenByLodProxy(drawable))
+        return;
+
     drawable->MarkInView(frameInfo_);
 
     // For geometries, find zone, clear lights and calculate view space Z range
@@ -589,6 +666,7 @@ void DrawableProcessor::ProcessVisibleDrawable(Drawable* drawable)
 void DrawableProcessor::ProcessLights(LightProcessorCallback* callback)
 {
     URHO3D_PROFILE("ProcessVisibleLights");
+    URHO3D_METRIC_TIMER("DrawableProcessor::ProcessLights");
 
     for (LightProcessor* lightProcessor : lightProcessors_)
         lightProcessor->BeginUpdate(this, callback);
@@ -616,11 +694,18 @@ void DrawableProcessor::ProcessLights(LightProcessorCallback* callback)
 
 void DrawableProcessor::ProcessForwardLightingForLight(
     unsigned lightIndex, const ea::vector<Drawable*>& litGeometries)
+{
+    if (const SharedPtr<WorkTask> task = ScheduleForwardLightingForLight(lightIndex, litGeometries, {}))
+        workQueue_->WaitForTask(task);
+}
+
+SharedPtr<WorkTask> DrawableProcessor::ScheduleForwardLightingForLight(unsigned lightIndex,
+    const ea::vector<Drawable*>& litGeometries, ea::span<const SharedPtr<WorkTask>> dependencies)
 {
     if (lightIndex >= lights_.size())
     {
         URHO3D_LOGERROR("Invalid light index {}", lightIndex);
-        return;
+        return nullptr;
     }
 
     Light* light = lights_[lightIndex];
@@ -633,59 +718,79 @@ void DrawableProcessor::ProcessForwardLightingForLight(
     LightAccumulatorContext ctx;
     ctx.maxVertexLights_ = settings_.maxVertexLights_;
     ctx.maxPixelLights_ = settings_.maxPixelLights_;
-    ctx.lights_ = &lightDataForAccumulator_;
+    ctx.lights_ = lightDataForAccumulator_;
 
-    ForEachParallel(workQueue_, litGeometries,
-        [&](unsigned /*index*/, Drawable* geometry)
+    Drawable* const* geometries = litGeometries.data();
+    return ScheduleForEachParallel(workQueue_, ForwardLitGeometriesPerTask, litGeometries.size(),
+        [=](unsigned beginIndex, unsigned endIndex)
     {
-        const unsigned drawableIndex = geometry->GetDrawableIndex();
-
-        // Directional light doesn't filter out e.g. deferred lit geometries for shadow focusing
-        if (lightType == LIGHT_DIRECTIONAL)
+        for (unsigned i = beginIndex; i < endIndex; ++i)
         {
-            const bool isForwardLit = !!(geometryFlags_[drawableIndex] & GeometryRenderFlag::ForwardLit);
-            if (!isForwardLit)
-                return;
-        }
+            Drawable* geometry = geometries[i];
+            const unsigned drawableIndex = geometry->GetDrawableIndex();
 
-        const float distance = ea::max(light->GetDistanceTo(geometry), M_LARGE_EPSILON);
-        const float penalty = GetDrawableLightPenalty(distance * lightIntensityPenalty,
-            isNegative, lightImportance, lightType);
-        geometryLighting_[drawableIndex].AccumulateLight(ctx, geometry, lightImportance, lightIndex, penalty);
-    });
+            // Directional light doesn't filter out e.g. deferred lit geometries for shadow focusing
+            if (lightType == LIGHT_DIRECTIONAL)
+            {
+                const bool isForwardLit = !!(geometryFlags_[drawableIndex] & GeometryRenderFlag::ForwardLit);
+                if (!isForwardLit)
+                    continue;
+            }
+
+            const float distance = ea::max(light->GetDistanceTo(geometry), M_LARGE_EPSILON);
+            const float penalty = GetDrawableLightPenalty(distance * lightIntensityPenalty,
+                isNegative, lightImportance, lightType);
+            geometryLighting_[drawableIndex].AccumulateLight(ctx, geometry, lightImportance, lightIndex, penalty);
+        }
+    }, dependencies);
 }
 
 void DrawableProcessor::FinalizeForwardLighting()
 {
-    ForEachParallel(workQueue_, geometries_,
-        [&](unsigned /*index*/, Drawable* drawable)
+    workQueue_->WaitForTask(ScheduleFinalizeForwardLighting({}));
+}
+
+SharedPtr<WorkTask> DrawableProcessor::ScheduleFinalizeForwardLighting(ea::span<const SharedPtr<WorkTask>> dependencies)
+{
+    return ScheduleForEachParallel(workQueue_, ForwardLitGeometriesPerTask, geometries_.Size(),
+        [this, iter = geometries_.Begin(), iterIndex = 0u](unsigned beginIndex, unsigned endIndex) mutable
     {
-        const unsigned drawableIndex = drawable->GetDrawableIndex();
-        const unsigned char flags = geometryFlags_[drawableIndex];
-        if (flags & GeometryRenderFlag::ForwardLit)
+        iter += beginIndex - iterIndex;
+        for (iterIndex = beginIndex; iterIndex < endIndex; ++iterIndex, ++iter)
         {
-            LightAccumulator& lightAccumulator = geometryLighting_[drawableIndex];
-            lightAccumulator.Cook();
+            const unsigned drawableIndex = (*iter)->GetDrawableIndex();
+            const unsigned char flags = geometryFlags_[drawableIndex];
+            if (flags & GeometryRenderFlag::ForwardLit)
+            {
+                LightAccumulator& lightAccumulator = geometryLighting_[drawableIndex];
+                lightAccumulator.Cook();
+            }
         }
-    });
+    }, dependencies);
 }
 
 void DrawableProcessor::ProcessForwardLighting()
 {
     URHO3D_PROFILE("ProcessForwardLighting");
+    URHO3D_METRIC_TIMER("DrawableProcessor::ProcessForwardLighting");
 
-    bool hasForwardLights = false;
+    // Light accumulators are not thread-safe, so lights are chained one after another.
+    // Main thread doesn't need to wait for each light and helps with the whole chain instead.
+    SharedPtr<WorkTask> lastTask;
     for (unsigned i = 0; i < lightProcessors_.size(); ++i)
     {
         const LightProcessor* lightProcessor = lightProcessors_[i];
         if (lightProcessor->HasForwardLitGeometries())
         {
-            ProcessForwardLightingForLight(i, lightProcessor->GetLitGeometries());
-            hasForwardLights = true;
+            const auto dependencies = lastTask ? ea::span<const SharedPtr<WorkTask>>(&lastTask, 1)
+                : ea::span<const SharedPtr<WorkTask>>();
+            if (SharedPtr<WorkTask> task = ScheduleForwardLightingForLight(i, lightProcessor->GetLitGeometries(), dependencies))
+                lastTask = ea::move(task);
         }
     }
-    if (hasForwardLights)
-        FinalizeForwardLighting();
+
+    if (lastTask)
+        workQueue_->WaitForTask(ScheduleFinalizeForwardLighting({&lastTask, 1}));
 }
 
 void DrawableProcessor::PreprocessShadowCasters(ea::vector<Drawable*>& shadowCasters,
@@ -707,22 +812,37 @@ void DrawableProcessor::PreprocessShadowCasters(ea::vector<Drawable*>& shadowCas
     if (lightSpaceFrustum.vertices_[0] == lightSpaceFrustum.vertices_[4])
         return;
 
-    for (Drawable* drawable : candidates)
+    // Test candidates in parallel, invisible casters are replaced with nulls.
+    // Remove nulls afterwards so the order of shadow casters doesn't depend on threading.
+    shadowCasters.resize(candidates.size());
+    ForEachParallel(workQueue_, ShadowCasterCandidatesPerTask, candidates.size(),
+        [&](unsigned fromIndex, unsigned toIndex)
     {
-        // For point light, check that this drawable is inside the split shadow camera frustum
-        if (lightType == LIGHT_POINT && shadowCameraFrustum.IsInsideFast(drawable->GetWorldBoundingBox()) == OUTSIDE)
-            continue;
-
-        // Queue shadow caster if it's visible
-        const BoundingBox lightSpaceBoundingBox = drawable->GetWorldBoundingBox().Transformed(worldToLightSpace);
-        const bool isDrawableVisible = !!(geometryFlags_[drawable->GetDrawableIndex()] & GeometryRenderFlag::VisibleInCullCamera);
-        if (isDrawableVisible
-            || IsShadowCasterVisible(lightSpaceBoundingBox, shadowCamera, lightSpaceFrustum, lightSpaceFrustumBoundingBox))
+        for (unsigned i = fromIndex; i < toIndex; ++i)
         {
-            QueueDrawableUpdate(drawable);
-            shadowCasters.push_back(drawable);
+            Drawable* drawable = candidates[i];
+            shadowCasters[i] = nullptr;
+
+            // Cast shadows from the same side of hierarchical LOD cluster that is rendered
+            if (IsHiddenByLodProxy(drawable))
+                continue;
+
+            // For point light, check that this drawable is inside the split shadow camera frustum
+            if (lightType == LIGHT_POINT && shadowCameraFrustum.IsInsideFast(drawable->GetWorldBoundingBox()) == OUTSIDE)
+                continue;
+
+            // Queue shadow caster if it's visible
+            const BoundingBox lightSpaceBoundingBox = drawable->GetWorldBoundingBox().Transformed(worldToLightSpace);
+            const bool isDrawableVisible = !!(geometryFlags_[drawable->GetDrawableIndex()] & GeometryRenderFlag::VisibleInCullCamera);
+            if (isDrawableVisible
+                || IsShadowCasterVisible(lightSpaceBoundingBox, shadowCamera, lightSpaceFrustum, lightSpaceFrustumBoundingBox))
+            {
+                QueueDrawableUpdate(drawable);
+                shadowCasters[i] = drawable;
+            }
         }
-    }
+    });
+    shadowCasters.erase(ea::remove(shadowCasters.begin(), shadowCasters.end(), nullptr), shadowCasters.end());
 }
 
 void DrawableProcessor::QueueDrawableUpdate(Drawable* drawable)
@@ -781,6 +901,7 @@ void DrawableProcessor::SortLightProcessorsByShadowMapTexture()
 void DrawableProcessor::UpdateGeometries()
 {
     URHO3D_PROFILE("UpdateGeometries");
+    URHO3D_METRIC_TIMER("DrawableProcessor::UpdateGeometries");
 
     // Update in worker threads
     ForEachParallel(workQueue_, threadedGeometryUpdates_,
@@ -181,6 +181,7 @@ public:
 
     const FrameInfo& GetFrameInfo() const { return frameInfo_; }
     const DrawableProcessorSettings& GetSettings() const { return settings_; }
+    WorkQueue* GetWorkQueue() const { return workQueue_; }
 
     /// Process occluders. UpdateBatches for occluders may be called twice, but never reentrantly.
     void ProcessOccluders(const ea::vector<Drawable*>& occluders, float sizeThreshold);
@@ -224,8 +225,13 @@ public:
     void ProcessLights(LightProcessorCallback* callback);
     /// Accumulate forward lighting for specified light source and geometries.
     void ProcessForwardLightingForLight(unsigned lightIndex, const ea::vector<Drawable*>& litGeometries);
+    /// Schedule forward lighting accumulation for specified light source and geometries.
+    SharedPtr<WorkTask> ScheduleForwardLightingForLight(unsigned lightIndex,
+        const ea::vector<Drawable*>& litGeometries, ea::span<const SharedPtr<WorkTask>> dependencies);
     /// Should be called after all forward lighting is processed.
     void FinalizeForwardLighting();
+    /// Schedule finalization of forward lighting after specified tasks.
+    SharedPtr<WorkTask> ScheduleFinalizeForwardLighting(ea::span<const SharedPtr<WorkTask>> dependencies);
     /// Process forward lighting for all lights.
     void ProcessForwardLighting();
 
@@ -256,6 +262,18 @@ private:
         UpdateFlag(UpdateFlag&& other) {}
     };
 
+    /// State of hierarchical LOD proxy for this pipeline and frame: 0 if not evaluated, 1 if not used, 2 if used.
+    /// Technically copyable to allow storage in vector, but is invalidated on copying.
+    struct LodProxyState : public std::atomic<unsigned char>
+    {
+        LodProxyState() = default;
+        LodProxyState(const LodProxyState& other) {}
+        LodProxyState(LodProxyState&& other) {}
+    };
+
+    /// Return whether the drawable is replaced by the other side of its hierarchical LOD cluster.
+    bool IsHiddenByLodProxy(const Drawable* drawable);
+
     /// External dependencies
     /// @{
     WorkQueue* workQueue_{};
@@ -286,6 +304,7 @@ private:
     /// Arrays indexed with drawable index
     /// @{
     ea::vector<UpdateFlag> isDrawableUpdated_;
+    ea::vector<LodProxyState> lodProxyStates_;
     ea::vector<unsigned char> geometryFlags_;
     ea::vector<FloatRange> geometryZRanges_;
     ea::vector<LightAccumulator> geometryLighting_;
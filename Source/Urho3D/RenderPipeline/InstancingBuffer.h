@@ -64,10 +64,19 @@ public:
         memcpy(currentInstanceData_ + index * ElementStride, data, count * ElementStride);
     }
 
+    /// Add multiple instances to buffer at once. Returns index of the first added instance.
+    /// Use GetInstanceData to fill them after all instances are added.
+    unsigned AddInstances(unsigned count) { return vertexBuffer_->AddVertices(count).first; }
+
+    /// Return writeable data of already added instance. Pointer is invalidated by next added instance.
+    /// Different instances may be filled from different threads.
+    unsigned char* GetInstanceData(unsigned index) { return vertexBuffer_->GetVertexData(index); }
+
     /// Getters
     /// @{
     const InstancingBufferSettings& GetSettings() const { return settings_; }
     VertexBuffer* GetVertexBuffer() const { return vertexBuffer_ ? vertexBuffer_->GetVertexBuffer() : nullptr; }
+    unsigned GetInstanceStride() const { return vertexBuffer_ ? vertexBuffer_->GetVertexSize() : 0; }
     bool IsEnabled() const { return settings_.enableInstancing_; }
     /// @}
 
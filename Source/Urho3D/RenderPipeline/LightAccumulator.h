@@ -28,6 +28,7 @@
 
 #include <EASTL/fixed_vector.h>
 #include <EASTL/sort.h>
+#include <EASTL/span.h>
 
 namespace Urho3D
 {
@@ -101,7 +102,7 @@ struct LightAccumulatorContext
     unsigned maxVertexLights_{ 4 };
     unsigned maxPixelLights_{ 1 };
     /// Array of lights to be indexed.
-    const ea::vector<LightDataForAccumulator>* lights_;
+    ea::span<const LightDataForAccumulator> lights_;
 };
 
 /// Accumulated light for forward rendering.
@@ -151,7 +152,7 @@ struct LightAccumulator
         const unsigned maxLights = ctx.maxVertexLights_ + firstVertexLight_;
         if (lights_.size() > maxLights)
         {
-            const LightDataForAccumulator& lightData = (*ctx.lights_)[lights_.back().second];
+            const LightDataForAccumulator& lightData = ctx.lights_[lights_.back().second];
             const Vector3 samplePosition = geometry->GetWorldBoundingBox().Center();
             sphericalHarmonics_ += lightData.GetLightingAtPoint(samplePosition);
             lights_.pop_back();
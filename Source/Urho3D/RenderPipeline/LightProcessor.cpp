@@ -250,23 +250,28 @@ void LightProcessor::Update(DrawableProcessor* drawableProcessor, const LightPro
 
     InitializeShadowSplits(drawableProcessor);
 
-    for (unsigned i = 0; i < numActiveSplits_; ++i)
+    // Splits are independent, process each one in separate task
+    ForEachParallel(drawableProcessor->GetWorkQueue(), 1, numActiveSplits_,
+        [&](unsigned fromIndex, unsigned toIndex)
     {
-        switch (lightType)
+        for (unsigned i = fromIndex; i < toIndex; ++i)
         {
-        case LIGHT_SPOT:
-            splits_[i].ProcessSpotShadowCasters(drawableProcessor, shadowCasterCandidates_);
-            break;
-        case LIGHT_POINT:
-            splits_[i].ProcessPointShadowCasters(drawableProcessor, shadowCasterCandidates_);
-            break;
-        case LIGHT_DIRECTIONAL:
-            splits_[i].ProcessDirectionalShadowCasters(drawableProcessor, shadowCasterCandidates_);
-            break;
-        default:
-            break;
+            switch (lightType)
+            {
+            case LIGHT_SPOT:
+                splits_[i].ProcessSpotShadowCasters(drawableProcessor, shadowCasterCandidates_);
+                break;
+            case LIGHT_POINT:
+                splits_[i].ProcessPointShadowCasters(drawableProcessor, shadowCasterCandidates_);
+                break;
+            case LIGHT_DIRECTIONAL:
+                splits_[i].ProcessDirectionalShadowCasters(drawableProcessor);
+                break;
+            default:
+                break;
+            }
         }
-    }
+    });
 
     const auto hasShadowCaster = [](const ShadowSplitProcessor& split) { return split.HasShadowCasters(); };
     if (!ea::any_of(splits_.begin(), splits_.begin() + numActiveSplits_, hasShadowCaster))
@@ -313,8 +318,12 @@ void LightProcessor::InitializeShadowSplits(DrawableProcessor* drawableProcessor
         const auto activeSplits = GetActiveSplits(light_, cullCamera->GetNearClip(), cullCamera->GetFarClip());
 
         numActiveSplits_ = activeSplits.size();
-        for (unsigned i = 0; i < numActiveSplits_; ++i)
-            splits_[i].InitializeDirectional(drawableProcessor, activeSplits[i], litGeometries_);
+        ForEachParallel(drawableProcessor->GetWorkQueue(), 1, numActiveSplits_,
+            [&](unsigned fromIndex, unsigned toIndex)
+        {
+            for (unsigned i = fromIndex; i < toIndex; ++i)
+                splits_[i].InitializeDirectional(drawableProcessor, activeSplits[i], litGeometries_);
+        });
         break;
     }
     case LIGHT_SPOT:
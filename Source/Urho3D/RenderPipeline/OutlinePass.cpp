@@ -135,7 +135,7 @@ void OutlineScenePass::OnBatchesReady()
     }
 
     BatchCompositor::FillSortKeys(sortedBatches_, deferredBatches_);
-    ea::sort(sortedBatches_.begin(), sortedBatches_.end());
+    SortPipelineBatches(workQueue_, batchSorter_, sortedBatches_);
 
     batchGroup_ = {sortedBatches_};
     batchGroup_.flags_ = BatchRenderFlag::EnableInstancingForStaticGeometry;
@@ -71,6 +71,7 @@ private:
     /// @{
     ShaderProgramDesc shaderProgramDesc_;
     ea::vector<PipelineBatchByState> sortedBatches_;
+    RadixSorter<PipelineBatchByState> batchSorter_;
     PipelineBatchGroup<PipelineBatchByState> batchGroup_;
     /// @}
 };
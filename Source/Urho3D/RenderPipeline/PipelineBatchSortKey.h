@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include "../Core/RadixSort.h"
 #include "../Graphics/Geometry.h"
 #include "../Graphics/Graphics.h"
 #include "../Graphics/Material.h"
@@ -29,6 +30,7 @@
 #include "../RenderPipeline/DrawableProcessor.h"
 #include "../RenderPipeline/BatchCompositor.h"
 
+#include <EASTL/sort.h>
 #include <EASTL/span.h>
 
 namespace Urho3D
@@ -150,15 +152,46 @@ struct PipelineBatchBackToFront
         distance_ = batch->distance_;
     }
 
+    /// Return sorting key: render order in high bits, inverted distance in low bits.
+    unsigned long long GetSortKey() const
+    {
+        // Flip float bits so unsigned comparison matches float comparison, then invert to sort back to front
+        unsigned distanceBits = FloatToRawIntBits(distance_);
+        distanceBits = (distanceBits & 0x80000000u) ? ~distanceBits : (distanceBits | 0x80000000u);
+        return (static_cast<unsigned long long>(renderOrder_) << 32ull) | ~distanceBits;
+    }
+
     /// Compare sorted batches.
     bool operator < (const PipelineBatchBackToFront& rhs) const
     {
-        if (renderOrder_ != rhs.renderOrder_)
-            return renderOrder_ < rhs.renderOrder_;
-        return distance_ > rhs.distance_;
+        return GetSortKey() < rhs.GetSortKey();
     }
 };
 
+/// Sort batches by state.
+inline void SortPipelineBatches(WorkQueue* workQueue, RadixSorter<PipelineBatchByState>& sorter,
+    ea::span<PipelineBatchByState> batches)
+{
+    // Two radix sorts are slower than comparison sort for small arrays
+    static constexpr unsigned MaxComparisonSortSize = 2048;
+    if (batches.size() <= MaxComparisonSortSize)
+    {
+        ea::sort(batches.begin(), batches.end());
+        return;
+    }
+
+    // LSD sort: less important key goes first
+    sorter.Sort(workQueue, batches, [](const PipelineBatchByState& batch) { return batch.secondaryKey_; });
+    sorter.Sort(workQueue, batches, [](const PipelineBatchByState& batch) { return batch.primaryKey_; });
+}
+
+/// Sort batches by render order and back to front. Order of equal batches is preserved.
+inline void SortPipelineBatches(WorkQueue* workQueue, RadixSorter<PipelineBatchBackToFront>& sorter,
+    ea::span<PipelineBatchBackToFront> batches)
+{
+    sorter.Sort(workQueue, batches, [](const PipelineBatchBackToFront& batch) { return batch.GetSortKey(); });
+}
+
 /// Group of batches to be rendered.
 template <class PipelineBatchSorted>
 struct PipelineBatchGroup
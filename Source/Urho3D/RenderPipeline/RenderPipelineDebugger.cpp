@@ -83,7 +83,7 @@ DebugFrameSnapshotBatch::DebugFrameSnapshotBatch(const DrawableProcessor& drawab
     , numPrimitives_(geometry_->GetPrimitiveCount())
     , newInstancingGroup_(newInstancingGroup)
 {
-    const ea::vector<Light*>& lights = drawableProcessor.GetLights();
+    const auto& lights = drawableProcessor.GetLights();
     light_ = pipelineBatch.pixelLightIndex_ < lights.size() ? lights[pipelineBatch.pixelLightIndex_] : nullptr;
 }
 
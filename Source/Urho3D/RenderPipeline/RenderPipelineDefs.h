@@ -243,6 +243,14 @@ struct RenderPipelineStats
     unsigned numShadowedLights_{};
     /// Number of occluders rendered.
     unsigned numOccluders_{};
+    /// Number of batch groups eligible for draw command queue caching.
+    unsigned numCacheableDrawQueues_{};
+    /// Number of batch groups rendered from cached draw command queues.
+    unsigned numReusedDrawQueues_{};
+    /// Number of shadow splits processed.
+    unsigned numShadowSplits_{};
+    /// Number of shadow splits reused from previous frame without rendering.
+    unsigned numReusedShadowSplits_{};
 };
 
 /// Base interface of render pipeline required by Render Pipeline classes.
@@ -521,6 +529,8 @@ struct SceneProcessorSettings
     ReflectionQuality reflectionQuality_{ ReflectionQuality::Pixel };
     bool depthPrePass_{ false };
     bool enableShadows_{ true };
+    /// Whether to reuse shadow maps of splits with unchanged static shadow casters from previous frame.
+    bool reuseStaticShadowMaps_{ true };
     DirectLightingMode lightingMode_{};
     unsigned directionalShadowSize_{ 1024 };
     unsigned spotShadowSize_{ 1024 };
@@ -572,6 +582,7 @@ struct SceneProcessorSettings
             && reflectionQuality_ == rhs.reflectionQuality_
             && depthPrePass_ == rhs.depthPrePass_
             && enableShadows_ == rhs.enableShadows_
+            && reuseStaticShadowMaps_ == rhs.reuseStaticShadowMaps_
             && lightingMode_ == rhs.lightingMode_
             && directionalShadowSize_ == rhs.directionalShadowSize_
             && spotShadowSize_ == rhs.spotShadowSize_
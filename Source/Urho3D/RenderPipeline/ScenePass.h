@@ -75,6 +75,7 @@ protected:
     ea::vector<PipelineBatchByState> sortedDeferredBatches_;
     ea::vector<PipelineBatchByState> sortedBaseBatches_;
     ea::vector<PipelineBatchByState> sortedLightBatches_;
+    RadixSorter<PipelineBatchByState> batchSorter_;
 
     PipelineBatchGroup<PipelineBatchByState> deferredBatchGroup_;
     PipelineBatchGroup<PipelineBatchByState> baseBatchGroup_;
@@ -99,6 +100,7 @@ protected:
     void OnBatchesReady() override;
 
     ea::vector<PipelineBatchBackToFront> sortedBatches_;
+    RadixSorter<PipelineBatchBackToFront> batchSorter_;
     bool hasRefractionBatches_{};
 
     PipelineBatchGroup<PipelineBatchBackToFront> batchGroup_;
@@ -38,6 +38,7 @@
 #include "../RenderPipeline/BatchRenderer.h"
 #include "../RenderPipeline/CameraProcessor.h"
 #include "../RenderPipeline/DrawableProcessor.h"
+#include "../RenderPipeline/DrawCommandQueueCache.h"
 #include "../RenderPipeline/InstancingBuffer.h"
 #include "../RenderPipeline/LightProcessor.h"
 #include "../RenderPipeline/PipelineBatchSortKey.h"
@@ -58,6 +59,9 @@ namespace Urho3D
 namespace
 {
 
+/// Number of occluders tested against occlusion buffer at once.
+const unsigned OccludersPerOcclusionTest = 4;
+
 class OccluderOctreeQuery : public FrustumOctreeQuery
 {
 public:
@@ -199,11 +203,14 @@ SceneProcessor::SceneProcessor(RenderPipelineInterface* renderPipeline, const ea
     , batchCompositor_(MakeShared<BatchCompositor>(
         renderPipeline_, drawableProcessor_, pipelineStateBuilder_, Technique::GetPassIndex("shadow")))
     , batchRenderer_(MakeShared<BatchRenderer>(renderPipeline_, drawableProcessor_, instancingBuffer_))
+    , drawQueueCache_(ea::make_unique<DrawCommandQueueCache>(graphics_))
     , batchStateCacheCallback_(pipelineStateBuilder_)
 {
     renderPipeline_->OnUpdateBegin.Subscribe(this, &SceneProcessor::OnUpdateBegin);
     renderPipeline_->OnRenderBegin.Subscribe(this, &SceneProcessor::OnRenderBegin);
     renderPipeline_->OnRenderEnd.Subscribe(this, &SceneProcessor::OnRenderEnd);
+    renderPipeline_->OnPipelineStatesInvalidated.Subscribe(this, &SceneProcessor::OnPipelineStatesInvalidated);
+    renderPipeline_->OnCollectStatistics.Subscribe(this, &SceneProcessor::OnCollectStatistics);
 }
 
 SceneProcessor::~SceneProcessor()
@@ -266,6 +273,8 @@ void SceneProcessor::SetSettings(const ShaderProgramCompositorSettings& settings
         drawableProcessor_->SetSettings(settings.sceneProcessor_);
         batchRenderer_->SetSettings(settings.sceneProcessor_);
         batchCompositor_->SetShadowMaterialQuality(settings.sceneProcessor_.materialQuality_);
+        drawQueueCache_->Invalidate();
+        shadowMapsInvalidated_ = true;
     }
 }
 
@@ -338,7 +347,10 @@ void SceneProcessor::PrepareInstancingBuffer()
     for (LightProcessor* sceneLight : visibleLights)
     {
         for (ShadowSplitProcessor& split : sceneLight->GetMutableSplits())
-            batchRenderer_->PrepareInstancingBuffer(split.GetMutableShadowBatches());
+        {
+            batchRenderer_->PrepareInstancingBuffer(split.GetMutableStaticShadowBatches());
+            batchRenderer_->PrepareInstancingBuffer(split.GetMutableDynamicShadowBatches());
+        }
     }
 
     for (ScenePass* pass : passes_)
@@ -357,16 +369,44 @@ void SceneProcessor::PrepareDrawablesBeforeRendering()
 
 void SceneProcessor::RenderShadowMaps()
 {
+    numShadowSplits_ = 0;
+    numReusedShadowSplits_ = 0;
+
     if (!settings_.enableShadows_)
         return;
 
     URHO3D_PROFILE("RenderShadowMaps");
 
     const auto& lightsByShadowMap = drawableProcessor_->GetLightProcessorsByShadowMap();
+
+    // Preserve unchanged shadow maps from previous frame before any shadow map page is cleared
+    const bool enableReuse = settings_.reuseStaticShadowMaps_ && !shadowMapsInvalidated_
+        && !RenderPipelineDebugger::IsSnapshotInProgress(debugger_);
+    const bool enableStaticShadowMaps = enableReuse && shadowMapAllocator_->IsStaticShadowMapSupported();
+    const unsigned shadowMapGeneration = shadowMapAllocator_->GetGeneration();
+    shadowMapsInvalidated_ = false;
+    for (LightProcessor* sceneLight : lightsByShadowMap)
+    {
+        for (ShadowSplitProcessor& split : sceneLight->GetMutableSplits())
+        {
+            ++numShadowSplits_;
+            const ShadowMapRenderMode renderMode = split.UpdateShadowMapReuse(
+                shadowMapGeneration, enableReuse, enableStaticShadowMaps);
+            if (renderMode == ShadowMapRenderMode::Reuse)
+            {
+                shadowMapAllocator_->PreserveShadowMap(split.GetShadowMap());
+                ++numReusedShadowSplits_;
+            }
+        }
+    }
+
     for (LightProcessor* sceneLight : lightsByShadowMap)
     {
         for (const ShadowSplitProcessor& split : sceneLight->GetSplits())
         {
+            if (split.IsShadowMapReused())
+                continue;
+
             if (RenderPipelineDebugger::IsSnapshotInProgress(debugger_))
             {
                 const ea::string passName = Format("ShadowMap.[{}].{}",
@@ -374,10 +414,35 @@ void SceneProcessor::RenderShadowMaps()
                 debugger_->BeginPass(passName);
             }
 
-            drawQueue_->Reset();
-            batchRenderer_->RenderBatches({ *drawQueue_, split }, split.GetShadowBatches());
-            shadowMapAllocator_->BeginShadowMapRendering(split.GetShadowMap());
-            drawQueue_->Execute();
+            const ShadowMapRegion& shadowMap = split.GetShadowMap();
+            if (split.IsStaticShadowMapUsed())
+            {
+                // Render static shadow casters into static shadow map only if they changed
+                const auto [staticShadowMap, isUndefined] = shadowMapAllocator_->GetStaticShadowMap(
+                    &split, shadowMap.rect_.Size());
+                if (isUndefined || split.GetShadowMapRenderMode() == ShadowMapRenderMode::UpdateStatic)
+                {
+                    DrawCommandQueue* staticDrawQueue = RecordShadowBatches(split, split.GetStaticShadowBatches());
+                    shadowMapAllocator_->BeginStaticShadowMapRendering(staticShadowMap);
+                    staticDrawQueue->Execute();
+                }
+
+                shadowMapAllocator_->BeginShadowMapRendering(shadowMap);
+                shadowMapAllocator_->CopyStaticShadowMap(staticShadowMap, shadowMap);
+            }
+            else
+            {
+                DrawCommandQueue* staticDrawQueue = RecordShadowBatches(split, split.GetStaticShadowBatches());
+                shadowMapAllocator_->BeginShadowMapRendering(shadowMap);
+                staticDrawQueue->Execute();
+            }
+
+            // Record dynamic shadow casters after the copy, it may use the same draw queue
+            if (!split.GetDynamicShadowBatches().batches_.empty())
+            {
+                DrawCommandQueue* dynamicDrawQueue = RecordShadowBatches(split, split.GetDynamicShadowBatches());
+                dynamicDrawQueue->Execute();
+            }
 
             if (RenderPipelineDebugger::IsSnapshotInProgress(debugger_))
             {
@@ -387,6 +452,20 @@ void SceneProcessor::RenderShadowMaps()
     }
 }
 
+DrawCommandQueue* SceneProcessor::RecordShadowBatches(
+    const ShadowSplitProcessor& split, const PipelineBatchGroup<PipelineBatchByState>& shadowBatches)
+{
+    const auto [drawQueue, isRecorded] = GetDrawQueue(&shadowBatches, split.GetShadowCamera(), shadowBatches, {});
+    if (isRecorded)
+        batchRenderer_->PatchRecordedBatches({ *drawQueue, split }, shadowBatches.flags_);
+    else
+    {
+        drawQueue->Reset();
+        batchRenderer_->RenderBatches({ *drawQueue, split }, shadowBatches);
+    }
+    return drawQueue;
+}
+
 void SceneProcessor::RenderSceneBatches(ea::string_view debugName, Camera* camera,
     const PipelineBatchGroup<PipelineBatchByState>& batchGroup,
     ea::span<const ShaderResourceDesc> globalResources, ea::span<const ShaderParameterDesc> cameraParameters)
@@ -422,6 +501,21 @@ void SceneProcessor::RenderLightVolumeBatches(ea::string_view debugName, Camera*
         debugger_->EndPass();
 }
 
+template <class T>
+ea::pair<DrawCommandQueue*, bool> SceneProcessor::GetDrawQueue(const void* owner, Camera* camera,
+    const PipelineBatchGroup<T>& batchGroup, ea::span<const ShaderResourceDesc> globalResources)
+{
+    // Debugger needs to see every batch
+    if (!RenderPipelineDebugger::IsSnapshotInProgress(debugger_))
+    {
+        const auto [drawQueue, isRecorded] = drawQueueCache_->GetQueue(
+            owner, batchGroup, globalResources, camera->GetFarClip(), instancingBuffer_->GetVertexBuffer());
+        if (drawQueue)
+            return {drawQueue, isRecorded};
+    }
+    return {drawQueue_, false};
+}
+
 template <class T>
 void SceneProcessor::RenderBatchesInternal(ea::string_view debugName, Camera* camera, const PipelineBatchGroup<T>& batchGroup,
     ea::span<const ShaderResourceDesc> globalResources, ea::span<const ShaderParameterDesc> cameraParameters)
@@ -429,19 +523,25 @@ void SceneProcessor::RenderBatchesInternal(ea::string_view debugName, Camera* ca
     if (RenderPipelineDebugger::IsSnapshotInProgress(debugger_))
         debugger_->BeginPass(debugName);
 
-    drawQueue_->Reset();
+    const auto [drawQueue, isRecorded] = GetDrawQueue(&batchGroup, camera, batchGroup, globalResources);
 
-    BatchRenderingContext ctx{ *drawQueue_, *camera };
+    BatchRenderingContext ctx{ *drawQueue, *camera };
     ctx.globalResources_ = globalResources;
     ctx.cameraParameters_ = cameraParameters;
 
-    if (batchGroup.scissorRect_ != IntRect::ZERO)
-        drawQueue_->SetScissorRect(batchGroup.scissorRect_);
-    batchRenderer_->RenderBatches(ctx, batchGroup);
+    if (isRecorded)
+        batchRenderer_->PatchRecordedBatches(ctx, batchGroup.flags_);
+    else
+    {
+        drawQueue->Reset();
+        if (batchGroup.scissorRect_ != IntRect::ZERO)
+            drawQueue->SetScissorRect(batchGroup.scissorRect_);
+        batchRenderer_->RenderBatches(ctx, batchGroup);
+    }
 
     graphics_->SetClipPlane(camera->GetUseClipping(),
         camera->GetClipPlane(), camera->GetView(), camera->GetGPUProjection());
-    drawQueue_->Execute();
+    drawQueue->Execute();
 
     if (RenderPipelineDebugger::IsSnapshotInProgress(debugger_))
         debugger_->EndPass();
@@ -471,6 +571,7 @@ void SceneProcessor::OnUpdateBegin(const CommonFrameInfo& frameInfo)
 void SceneProcessor::OnRenderBegin(const CommonFrameInfo& frameInfo)
 {
     cameraProcessor_->OnRenderBegin(frameInfo_);
+    drawQueueCache_->BeginFrame();
 }
 
 void SceneProcessor::OnRenderEnd(const CommonFrameInfo& frameInfo)
@@ -478,6 +579,20 @@ void SceneProcessor::OnRenderEnd(const CommonFrameInfo& frameInfo)
     cameraProcessor_->OnRenderEnd(frameInfo_);
 }
 
+void SceneProcessor::OnPipelineStatesInvalidated()
+{
+    drawQueueCache_->Invalidate();
+    shadowMapsInvalidated_ = true;
+}
+
+void SceneProcessor::OnCollectStatistics(RenderPipelineStats& stats)
+{
+    stats.numCacheableDrawQueues_ += drawQueueCache_->GetNumCacheableQueues();
+    stats.numReusedDrawQueues_ += drawQueueCache_->GetNumReusedQueues();
+    stats.numShadowSplits_ += numShadowSplits_;
+    stats.numReusedShadowSplits_ += numReusedShadowSplits_;
+}
+
 bool SceneProcessor::IsLightShadowed(Light* light)
 {
     const bool shadowsEnabled = settings_.enableShadows_
@@ -524,23 +639,34 @@ void SceneProcessor::DrawOccluders()
 
     if (!occlusionBuffer_->IsThreaded())
     {
-        // If not threaded, draw occluders one by one and test the next occluder against already rasterized depth
-        for (unsigned i = 0; i < activeOccluders.size(); ++i)
+        // If not threaded, draw occluders in small groups and test each group against depth rasterized by previous groups
+        BoundingBox occluderBoxes[OccludersPerOcclusionTest];
+        bool isOccluderVisible[OccludersPerOcclusionTest];
+
+        const unsigned numOccluders = activeOccluders.size();
+        bool hasTriangles = true;
+        for (unsigned groupBegin = 0; groupBegin < numOccluders && hasTriangles; groupBegin += OccludersPerOcclusionTest)
         {
-            Drawable* occluder = activeOccluders[i].drawable_;
-            if (i > 0)
+            const unsigned groupSize = ea::min(OccludersPerOcclusionTest, numOccluders - groupBegin);
+            for (unsigned i = 0; i < groupSize; ++i)
+                occluderBoxes[i] = activeOccluders[groupBegin + i].drawable_->GetWorldBoundingBox();
+            occlusionBuffer_->IsVisible({occluderBoxes, groupSize}, {isOccluderVisible, groupSize});
+
+            for (unsigned i = 0; i < groupSize; ++i)
             {
-                // For subsequent occluders, do a test against the pixel-level occlusion buffer to see if rendering is necessary
-                if (!occlusionBuffer_->IsVisible(occluder->GetWorldBoundingBox()))
+                if (!isOccluderVisible[i])
                     continue;
-            }
 
-            // Check for running out of triangles
-            bool success = occluder->DrawOcclusion(occlusionBuffer_);
-            // Draw triangles submitted by this occluder
-            occlusionBuffer_->DrawTriangles();
-            if (!success)
-                break;
+                // Check for running out of triangles
+                const bool success = activeOccluders[groupBegin + i].drawable_->DrawOcclusion(occlusionBuffer_);
+                // Draw triangles submitted by this occluder
+                occlusionBuffer_->DrawTriangles();
+                if (!success)
+                {
+                    hasTriangles = false;
+                    break;
+                }
+            }
         }
     }
     else
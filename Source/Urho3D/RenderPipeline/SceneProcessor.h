@@ -25,6 +25,8 @@
 #include "../RenderPipeline/RenderPipelineDefs.h"
 #include "../RenderPipeline/PipelineBatchSortKey.h"
 
+#include <EASTL/unique_ptr.h>
+
 namespace Urho3D
 {
 
@@ -34,12 +36,14 @@ class CameraProcessor;
 class Drawable;
 class DrawableProcessor;
 class DrawCommandQueue;
+class DrawCommandQueueCache;
 class InstancingBuffer;
 class PipelineStateBuilder;
 class RenderPipelineInterface;
 class RenderSurface;
 class ScenePass;
 class ShadowMapAllocator;
+class ShadowSplitProcessor;
 class Viewport;
 struct ShaderParameterDesc;
 struct ShaderResourceDesc;
@@ -111,6 +115,8 @@ private:
     void OnUpdateBegin(const CommonFrameInfo& frameInfo);
     void OnRenderBegin(const CommonFrameInfo& frameInfo);
     void OnRenderEnd(const CommonFrameInfo& frameInfo);
+    void OnPipelineStatesInvalidated();
+    void OnCollectStatistics(RenderPipelineStats& stats);
     /// @}
 
     /// LightProcessorCallback implementation
@@ -121,6 +127,14 @@ private:
     /// @}
 
     void DrawOccluders();
+    /// Return queue to be recorded or reused for the batch group.
+    /// Returns true in second value if the queue is recorded already and should only be patched.
+    template <class T>
+    ea::pair<DrawCommandQueue*, bool> GetDrawQueue(const void* owner, Camera* camera,
+        const PipelineBatchGroup<T>& batchGroup, ea::span<const ShaderResourceDesc> globalResources);
+    /// Record or patch draw queue for shadow batches of the split.
+    DrawCommandQueue* RecordShadowBatches(
+        const ShadowSplitProcessor& split, const PipelineBatchGroup<PipelineBatchByState>& shadowBatches);
     template <class T>
     void RenderBatchesInternal(ea::string_view debugName, Camera* camera, const PipelineBatchGroup<T>& batchGroup,
         ea::span<const ShaderResourceDesc> globalResources, ea::span<const ShaderParameterDesc> cameraParameters);
@@ -144,6 +158,7 @@ private:
     SharedPtr<BatchCompositor> batchCompositor_;
     SharedPtr<BatchRenderer> batchRenderer_;
     SharedPtr<OcclusionBuffer> occlusionBuffer_;
+    ea::unique_ptr<DrawCommandQueueCache> drawQueueCache_;
     BatchStateCacheCallback* batchStateCacheCallback_{};
     /// @}
 
@@ -156,6 +171,14 @@ private:
     OcclusionBuffer* currentOcclusionBuffer_{};
     ea::vector<Drawable*> occluders_;
     ea::vector<Drawable*> drawables_;
+
+    /// Shadow map reuse
+    /// @{
+    /// Whether shadow maps from previous frame are invalidated by settings or pipeline state changes.
+    bool shadowMapsInvalidated_{};
+    unsigned numShadowSplits_{};
+    unsigned numReusedShadowSplits_{};
+    /// @}
 };
 
 }
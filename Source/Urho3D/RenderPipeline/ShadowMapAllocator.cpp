@@ -23,8 +23,12 @@
 #include "../Precompiled.h"
 
 #include "../Core/Context.h"
+#include "../Graphics/DrawCommandQueue.h"
+#include "../Graphics/Geometry.h"
 #include "../Graphics/Graphics.h"
+#include "../Graphics/PipelineState.h"
 #include "../Graphics/Renderer.h"
+#include "../RenderPipeline/ShaderConsts.h"
 #include "../RenderPipeline/ShadowMapAllocator.h"
 
 #include "../DebugNew.h"
@@ -63,6 +67,10 @@ void ShadowMapAllocator::SetSettings(const ShadowMapAllocatorSettings& settings)
 
         dummyColorTexture_ = nullptr;
         pages_.clear();
+        staticShadowMaps_.clear();
+
+        // Skip generation so shadow maps are not preserved from old pages
+        ++generation_;
     }
 }
 
@@ -82,10 +90,24 @@ void ShadowMapAllocator::CacheSettings()
 
 void ShadowMapAllocator::ResetAllShadowMaps()
 {
+    ++generation_;
     for (AtlasPage& element : pages_)
     {
         element.areaAllocator_.Reset(shadowAtlasPageSize_.x_, shadowAtlasPageSize_.y_, shadowAtlasPageSize_.x_, shadowAtlasPageSize_.y_);
         element.clearBeforeRendering_ = false;
+        element.hasPreservedShadowMaps_ = false;
+    }
+
+    // Release static shadow maps that were not used during previous generation
+    for (auto iter = staticShadowMaps_.begin(); iter != staticShadowMaps_.end();)
+    {
+        if (!iter->second.used_)
+            iter = staticShadowMaps_.erase(iter);
+        else
+        {
+            iter->second.used_ = false;
+            ++iter;
+        }
     }
 }
 
@@ -107,6 +129,12 @@ ShadowMapRegion ShadowMapAllocator::AllocateShadowMap(const IntVector2& size)
     return pages_.back().AllocateRegion(clampedSize);
 }
 
+void ShadowMapAllocator::PreserveShadowMap(const ShadowMapRegion& shadowMap)
+{
+    if (shadowMap && shadowMap.pageIndex_ < pages_.size())
+        pages_[shadowMap.pageIndex_].hasPreservedShadowMaps_ = true;
+}
+
 bool ShadowMapAllocator::BeginShadowMapRendering(const ShadowMapRegion& shadowMap)
 {
     if (!shadowMap || shadowMap.pageIndex_ >= pages_.size())
@@ -135,15 +163,21 @@ bool ShadowMapAllocator::BeginShadowMapRendering(const ShadowMapRegion& shadowMa
     for (unsigned i = 1; i < MAX_RENDERTARGETS; ++i)
         graphics_->SetRenderTarget(i, (RenderSurface*) nullptr);
 
-    // Clear whole texture if needed
-    if (poolElement.clearBeforeRendering_)
+    ClearTargetFlags clearFlags = CLEAR_DEPTH;
+    if (settings_.enableVarianceShadowMaps_ || dummyColorTexture_)
+        clearFlags |= CLEAR_COLOR;
+
+    // Clear whole texture if needed. If some shadow maps are preserved, clear only the rendered region.
+    if (poolElement.hasPreservedShadowMaps_)
+    {
+        graphics_->SetViewport(shadowMap.rect_);
+        graphics_->Clear(clearFlags, Color::WHITE);
+    }
+    else if (poolElement.clearBeforeRendering_)
     {
         poolElement.clearBeforeRendering_ = false;
 
         graphics_->SetViewport(shadowMapTexture->GetRect());
-        ClearTargetFlags clearFlags = CLEAR_DEPTH;
-        if (settings_.enableVarianceShadowMaps_ || dummyColorTexture_)
-            clearFlags |= CLEAR_COLOR;
         graphics_->Clear(clearFlags, Color::WHITE);
     }
 
@@ -152,6 +186,119 @@ bool ShadowMapAllocator::BeginShadowMapRendering(const ShadowMapRegion& shadowMa
     return true;
 }
 
+bool ShadowMapAllocator::IsStaticShadowMapSupported() const
+{
+#ifdef GL_ES_VERSION_2_0
+    // Depth output is not supported
+    return false;
+#else
+    // Variance shadow maps need color and depth to be copied, skip them for simplicity
+    return !settings_.enableVarianceShadowMaps_ && shadowMapFormat_ && !graphics_->GetDummyColorFormat();
+#endif
+}
+
+ea::pair<Texture2D*, bool> ShadowMapAllocator::GetStaticShadowMap(const void* owner, const IntVector2& size)
+{
+    StaticShadowMap& staticShadowMap = staticShadowMaps_[owner];
+    staticShadowMap.used_ = true;
+
+    Texture2D* texture = staticShadowMap.texture_;
+    if (texture && texture->GetSize() == size)
+        return {texture, false};
+
+    if (!texture)
+    {
+        staticShadowMap.texture_ = MakeShared<Texture2D>(context_);
+        texture = staticShadowMap.texture_;
+    }
+
+    // Static shadow map is only copied texel to texel, disable shadow compare and filtering
+    texture->SetNumLevels(1);
+    texture->SetSize(size.x_, size.y_, shadowMapFormat_, TEXTURE_DEPTHSTENCIL);
+    texture->SetFilterMode(FILTER_NEAREST);
+    return {texture, true};
+}
+
+void ShadowMapAllocator::BeginStaticShadowMapRendering(Texture2D* staticShadowMap)
+{
+    graphics_->SetTexture(TU_SHADOWMAP, nullptr);
+    graphics_->SetTexture(TU_DIFFUSE, nullptr);
+
+    graphics_->SetDepthStencil(staticShadowMap);
+    graphics_->SetRenderTarget(0, (RenderSurface*) nullptr);
+    for (unsigned i = 1; i < MAX_RENDERTARGETS; ++i)
+        graphics_->SetRenderTarget(i, (RenderSurface*) nullptr);
+
+    graphics_->SetViewport(staticShadowMap->GetRect());
+    graphics_->Clear(CLEAR_DEPTH, Color::WHITE);
+}
+
+void ShadowMapAllocator::CopyStaticShadowMap(Texture2D* staticShadowMap, const ShadowMapRegion& shadowMap)
+{
+    Geometry* quadGeometry = renderer_->GetQuadGeometry();
+    if (!copyStaticShadowMapPipelineState_)
+    {
+        static const char* shaderName = "v2/CopyFramebuffer";
+        ea::string defines = "URHO3D_COPY_DEPTH URHO3D_GEOMETRY_STATIC";
+        if (graphics_->GetCaps().constantBuffersSupported_)
+            defines += " URHO3D_USE_CBUFFERS";
+
+        PipelineStateDesc desc;
+        desc.InitializeInputLayoutAndPrimitiveType(quadGeometry);
+        desc.vertexShader_ = graphics_->GetShader(VS, shaderName, defines);
+        desc.pixelShader_ = graphics_->GetShader(PS, shaderName, defines);
+        desc.depthWriteEnabled_ = true;
+        desc.depthCompareFunction_ = CMP_ALWAYS;
+        desc.colorWriteEnabled_ = false;
+        copyStaticShadowMapPipelineState_ = renderer_->GetOrCreatePipelineState(desc);
+    }
+
+    if (!copyStaticShadowMapPipelineState_ || !copyStaticShadowMapPipelineState_->IsValid())
+        return;
+
+    // Static shadow map has the same size as the shadow map, so whole texture is mapped onto the viewport
+    const Vector4 clipToUVOffsetAndScale{0.5f, 0.5f, 0.5f, 0.5f};
+    Matrix3x4 modelMatrix = Matrix3x4::IDENTITY;
+#ifdef URHO3D_OPENGL
+    modelMatrix.m23_ = 0.0f;
+#else
+    modelMatrix.m23_ = 0.5f;
+#endif
+
+    DrawCommandQueue* drawQueue = renderer_->GetDefaultDrawQueue();
+    drawQueue->Reset();
+    drawQueue->SetPipelineState(copyStaticShadowMapPipelineState_);
+
+    if (drawQueue->BeginShaderParameterGroup(SP_FRAME))
+    {
+        drawQueue->AddShaderParameter(ShaderConsts::Frame_DeltaTime, 0.0f);
+        drawQueue->CommitShaderParameterGroup(SP_FRAME);
+    }
+
+    if (drawQueue->BeginShaderParameterGroup(SP_CAMERA))
+    {
+        drawQueue->AddShaderParameter(ShaderConsts::Camera_GBufferOffsets, clipToUVOffsetAndScale);
+        drawQueue->AddShaderParameter(ShaderConsts::Camera_GBufferInvSize, Vector2::ONE / static_cast<Vector2>(staticShadowMap->GetSize()));
+        drawQueue->AddShaderParameter(ShaderConsts::Camera_ViewProj, Matrix4::IDENTITY);
+        drawQueue->CommitShaderParameterGroup(SP_CAMERA);
+    }
+
+    if (drawQueue->BeginShaderParameterGroup(SP_OBJECT))
+    {
+        drawQueue->AddShaderParameter(ShaderConsts::Object_Model, modelMatrix);
+        drawQueue->CommitShaderParameterGroup(SP_OBJECT);
+    }
+
+    drawQueue->AddShaderResource(TU_DIFFUSE, staticShadowMap);
+    drawQueue->CommitShaderResources();
+
+    drawQueue->SetBuffers(GeometryBufferArray{ quadGeometry });
+    drawQueue->DrawIndexed(quadGeometry->GetIndexStart(), quadGeometry->GetIndexCount());
+
+    graphics_->SetViewport(shadowMap.rect_);
+    drawQueue->Execute();
+}
+
 ShadowMapRegion ShadowMapAllocator::AtlasPage::AllocateRegion(const IntVector2& size)
 {
     int x{}, y{};
@@ -29,11 +29,13 @@
 #include "../Graphics/Light.h"
 #include "../RenderPipeline/RenderPipelineDefs.h"
 
+#include <EASTL/unordered_map.h>
 #include <EASTL/vector.h>
 
 namespace Urho3D
 {
 
+class PipelineState;
 class Renderer;
 
 /// Utility to allocate shadow maps in texture atlas.
@@ -45,14 +47,35 @@ public:
     explicit ShadowMapAllocator(Context* context);
     void SetSettings(const ShadowMapAllocatorSettings& settings);
 
-    /// Reset allocated shadow maps.
+    /// Reset allocated shadow maps and begin new generation.
     void ResetAllShadowMaps();
     /// Allocate shadow map of given size. It is better to allocate from bigger to smaller sizes.
+    /// Allocation is deterministic: the same sequence of sizes yields the same regions in consecutive generations.
     ShadowMapRegion AllocateShadowMap(const IntVector2& size);
+    /// Keep contents of shadow map rendered in previous generation.
+    /// Should be called before any shadow map rendering in current generation.
+    void PreserveShadowMap(const ShadowMapRegion& shadowMap);
     /// Begin shadow map rendering. Clears shadow map if necessary.
     bool BeginShadowMapRendering(const ShadowMapRegion& shadowMap);
 
+    /// Static shadow maps keep static shadow casters of the shadow map outside of the atlas.
+    /// Static shadow map is copied into the shadow map before dynamic shadow casters are rendered.
+    /// @{
+    /// Return whether static shadow maps are supported for current settings.
+    bool IsStaticShadowMapSupported() const;
+    /// Return static shadow map of given size owned by given object.
+    /// Static shadow maps that are not requested during the generation are released.
+    /// Returns true in second value if the contents of the static shadow map are undefined.
+    ea::pair<Texture2D*, bool> GetStaticShadowMap(const void* owner, const IntVector2& size);
+    /// Begin static shadow map rendering. Clears static shadow map.
+    void BeginStaticShadowMapRendering(Texture2D* staticShadowMap);
+    /// Copy static shadow map into shadow map. Should be called after BeginShadowMapRendering.
+    void CopyStaticShadowMap(Texture2D* staticShadowMap, const ShadowMapRegion& shadowMap);
+    /// @}
+
     const ShadowMapAllocatorSettings& GetSettings() const { return settings_; }
+    /// Return current generation. Shadow map contents may be preserved only between consecutive generations.
+    unsigned GetGeneration() const { return generation_; }
 
 private:
     struct AtlasPage
@@ -61,11 +84,19 @@ private:
         SharedPtr<Texture2D> texture_;
         AreaAllocator areaAllocator_;
         bool clearBeforeRendering_{};
+        /// Whether the page contains preserved shadow maps and cannot be cleared as a whole.
+        bool hasPreservedShadowMaps_{};
 
         /// Allocate shadow map.
         ShadowMapRegion AllocateRegion(const IntVector2& size);
     };
 
+    struct StaticShadowMap
+    {
+        SharedPtr<Texture2D> texture_;
+        bool used_{};
+    };
+
     void CacheSettings();
     void AllocatePage();
 
@@ -85,6 +116,14 @@ private:
     /// Dummy color map for workaround, if needed.
     SharedPtr<Texture2D> dummyColorTexture_;
     ea::vector<AtlasPage> pages_;
+    /// Current generation.
+    unsigned generation_{};
+
+    /// Static shadow maps
+    /// @{
+    ea::unordered_map<const void*, StaticShadowMap> staticShadowMaps_;
+    SharedPtr<PipelineState> copyStaticShadowMapPipelineState_;
+    /// @}
 };
 
 }
@@ -70,6 +70,37 @@ Vector2 CalculateViewSize(const Vector2& minViewSize, const FocusParameters& par
 
 }
 
+bool ShadowSplitCacheKey::IsCacheable(const PipelineBatch& shadowBatch)
+{
+    return shadowBatch.geometryType_ == GEOM_STATIC || shadowBatch.geometryType_ == GEOM_STATIC_NOINSTANCING;
+}
+
+void ShadowSplitCacheKey::Define(const ShadowMapRegion& shadowMap, const Camera* shadowCamera,
+    const PipelineBatchGroup<PipelineBatchByState>& shadowBatches)
+{
+    texture_ = shadowMap.texture_;
+    rect_ = shadowMap.rect_;
+    viewProj_ = shadowCamera->GetViewProj();
+
+    batches_.clear();
+    for (const PipelineBatchByState& sortedBatch : shadowBatches.batches_)
+        batches_.emplace_back(*sortedBatch.pipelineBatch_);
+}
+
+void ShadowSplitCacheKey::Reset()
+{
+    texture_ = nullptr;
+    batches_.clear();
+}
+
+bool ShadowSplitCacheKey::operator==(const ShadowSplitCacheKey& rhs) const
+{
+    return texture_ == rhs.texture_
+        && rect_ == rhs.rect_
+        && viewProj_ == rhs.viewProj_
+        && batches_ == rhs.batches_;
+}
+
 ShadowSplitProcessor::ShadowSplitProcessor(LightProcessor* owner, unsigned splitIndex)
     : lightProcessor_(owner)
     , light_(lightProcessor_->GetLight())
@@ -138,8 +169,7 @@ void ShadowSplitProcessor::InitializePoint(CubeMapFace face)
     shadowCamera_->SetZoom(1.0f);
 }
 
-void ShadowSplitProcessor::ProcessDirectionalShadowCasters(
-    DrawableProcessor* drawableProcessor, ea::vector<Drawable*>& shadowCastersBuffer)
+void ShadowSplitProcessor::ProcessDirectionalShadowCasters(DrawableProcessor* drawableProcessor)
 {
     shadowCasters_.clear();
     unsortedShadowBatches_.clear();
@@ -155,11 +185,11 @@ void ShadowSplitProcessor::ProcessDirectionalShadowCasters(
     Octree* octree = frameInfo.octree_;
 
     DirectionalLightShadowCasterQuery query(
-        shadowCastersBuffer, shadowCamera_->GetFrustum(), DRAWABLE_GEOMETRY, light_, cullCamera->GetViewMask());
+        shadowCasterCandidates_, shadowCamera_->GetFrustum(), DRAWABLE_GEOMETRY, light_, cullCamera->GetViewMask());
     octree->GetDrawables(query);
 
     // Preprocess shadow casters
-    drawableProcessor->PreprocessShadowCasters(shadowCasters_, shadowCastersBuffer, cascadeZRange_, light_, shadowCamera_);
+    drawableProcessor->PreprocessShadowCasters(shadowCasters_, shadowCasterCandidates_, cascadeZRange_, light_, shadowCamera_);
 }
 
 void ShadowSplitProcessor::ProcessSpotShadowCasters(
@@ -359,12 +389,78 @@ Matrix4 ShadowSplitProcessor::GetWorldToShadowSpaceMatrix(float subPixelOffset)
     return texAdjust * shadowProj * shadowView;
 }
 
-void ShadowSplitProcessor::FinalizeShadowBatches()
+void ShadowSplitProcessor::FinalizeShadowBatches(WorkQueue* workQueue)
 {
     BatchCompositor::FillSortKeys(sortedShadowBatches_, unsortedShadowBatches_);
-    ea::sort(sortedShadowBatches_.begin(), sortedShadowBatches_.end());
-    shadowBatches_ = { sortedShadowBatches_,
-        BatchRenderFlag::EnableInstancingForStaticGeometry | BatchRenderFlag::DisableColorOutput };
+
+    // Static shadow batches go first so they can be cached and rendered separately from dynamic ones
+    const auto firstDynamicBatch = ea::partition(sortedShadowBatches_.begin(), sortedShadowBatches_.end(),
+        [](const PipelineBatchByState& sortedBatch) { return ShadowSplitCacheKey::IsCacheable(*sortedBatch.pipelineBatch_); });
+    const auto numStaticBatches = static_cast<unsigned>(firstDynamicBatch - sortedShadowBatches_.begin());
+    const ea::span<PipelineBatchByState> allBatches{sortedShadowBatches_};
+
+    // Splits are finalized in parallel already, but one split may contain most of the batches
+    SortPipelineBatches(workQueue, shadowBatchSorter_, allBatches.first(numStaticBatches));
+    SortPipelineBatches(workQueue, shadowBatchSorter_, allBatches.subspan(numStaticBatches));
+
+    const BatchRenderFlags flags = BatchRenderFlag::EnableInstancingForStaticGeometry | BatchRenderFlag::DisableColorOutput;
+    shadowBatches_ = { allBatches, flags };
+    staticShadowBatches_ = { allBatches.first(numStaticBatches), flags };
+    dynamicShadowBatches_ = { allBatches.subspan(numStaticBatches), flags };
+
+    // Compare static shadow casters with previous frame, reuse storage of the old key
+    ea::swap(cacheKey_, previousCacheKey_);
+    if (shadowMap_ && numStaticBatches > 0)
+    {
+        cacheKey_.Define(shadowMap_, shadowCamera_, staticShadowBatches_);
+        isStaticShadowMapUnchanged_ = cacheKey_ == previousCacheKey_;
+    }
+    else
+    {
+        cacheKey_.Reset();
+        isStaticShadowMapUnchanged_ = false;
+    }
+}
+
+ShadowMapRenderMode ShadowSplitProcessor::UpdateShadowMapReuse(
+    unsigned shadowMapGeneration, bool enableReuse, bool enableStaticShadowMap)
+{
+    const bool hasStaticCasters = shadowMap_ && !staticShadowBatches_.batches_.empty();
+    const bool hasDynamicCasters = !dynamicShadowBatches_.batches_.empty();
+    shadowMapRenderMode_ = cacheState_.Update(shadowMapGeneration, hasStaticCasters, isStaticShadowMapUnchanged_,
+        hasDynamicCasters, enableReuse, enableStaticShadowMap);
+    return shadowMapRenderMode_;
+}
+
+ShadowMapRenderMode ShadowSplitCacheState::Update(unsigned shadowMapGeneration, bool hasStaticCasters,
+    bool isStaticUnchanged, bool hasDynamicCasters, bool enableReuse, bool enableStaticShadowMap)
+{
+    // Shadow map is intact only if it was rendered or reused in previous generation
+    const bool isConsecutiveGeneration = lastShadowMapGeneration_ + 1 == shadowMapGeneration;
+    lastShadowMapGeneration_ = shadowMapGeneration;
+
+    if (!enableReuse || !hasStaticCasters)
+    {
+        isShadowMapStatic_ = false;
+        isStaticShadowMapValid_ = false;
+        return ShadowMapRenderMode::RenderAll;
+    }
+
+    const bool isShadowMapIntact = isShadowMapStatic_ && isStaticUnchanged && isConsecutiveGeneration;
+    isShadowMapStatic_ = !hasDynamicCasters;
+    isStaticShadowMapValid_ = isStaticShadowMapValid_ && isStaticUnchanged && enableStaticShadowMap;
+
+    if (!hasDynamicCasters && isShadowMapIntact)
+        return ShadowMapRenderMode::Reuse;
+
+    if (isStaticShadowMapValid_)
+        return ShadowMapRenderMode::RestoreStatic;
+
+    if (!hasDynamicCasters || !enableStaticShadowMap)
+        return ShadowMapRenderMode::RenderAll;
+
+    isStaticShadowMapValid_ = true;
+    return ShadowMapRenderMode::UpdateStatic;
 }
 
 }
@@ -24,6 +24,7 @@
 
 #include "../Graphics/Camera.h"
 #include "../Math/NumericRange.h"
+#include "../RenderPipeline/DrawCommandQueueCache.h"
 #include "../RenderPipeline/RenderPipelineDefs.h"
 #include "../RenderPipeline/PipelineBatchSortKey.h"
 #include "../Scene/Node.h"
@@ -38,6 +39,60 @@ class Drawable;
 class DrawableProcessor;
 class Light;
 class LightProcessor;
+class WorkQueue;
+
+/// Everything that affects the static contents of rendered shadow split.
+/// Static shadow casters rendered on previous frame may be reused if the key didn't change.
+struct ShadowSplitCacheKey
+{
+    const Texture2D* texture_{};
+    IntRect rect_;
+    Matrix4 viewProj_;
+    ea::vector<DrawCommandQueueBatchKey> batches_;
+
+    /// Return whether the shadow batch may be cached.
+    /// Only static geometry is cached, because skinned and dynamic geometry may change without any notification.
+    static bool IsCacheable(const PipelineBatch& shadowBatch);
+
+    /// Initialize key from shadow map region, shadow camera and static shadow batches.
+    void Define(const ShadowMapRegion& shadowMap, const Camera* shadowCamera,
+        const PipelineBatchGroup<PipelineBatchByState>& shadowBatches);
+    /// Reset key so it doesn't match any defined key.
+    void Reset();
+
+    bool operator==(const ShadowSplitCacheKey& rhs) const;
+    bool operator!=(const ShadowSplitCacheKey& rhs) const { return !(*this == rhs); }
+};
+
+/// How shadow map of the split is rendered in current frame.
+enum class ShadowMapRenderMode
+{
+    /// Render all shadow casters into shadow map.
+    RenderAll,
+    /// Keep shadow map rendered on previous frame as is.
+    Reuse,
+    /// Render static shadow casters into static shadow map, copy it into shadow map and render dynamic shadow casters.
+    UpdateStatic,
+    /// Copy static shadow map rendered on previous frames into shadow map and render dynamic shadow casters.
+    RestoreStatic,
+};
+
+/// Tracks which contents of shadow split are kept from previous frames.
+/// Static shadow casters are kept either in the shadow map itself, if there are no dynamic shadow casters,
+/// or in the separate static shadow map that is copied into the shadow map before dynamic shadow casters are rendered.
+struct ShadowSplitCacheState
+{
+    /// Whether the shadow map contains only static shadow casters described by the key of previous frame.
+    bool isShadowMapStatic_{};
+    /// Whether the static shadow map contains static shadow casters described by the key of previous frame.
+    bool isStaticShadowMapValid_{};
+    /// Generation of shadow maps when the split was rendered or reused last time.
+    unsigned lastShadowMapGeneration_{};
+
+    /// Return how shadow map should be rendered in current generation of shadow maps and update the state.
+    ShadowMapRenderMode Update(unsigned shadowMapGeneration, bool hasStaticCasters, bool isStaticUnchanged,
+        bool hasDynamicCasters, bool enableReuse, bool enableStaticShadowMap);
+};
 
 /// Manages single shadow split parameters and shadow casters.
 /// Spot lights always have one split.
@@ -59,13 +114,13 @@ public:
 
     /// Process shadow casters
     /// @{
-    void ProcessDirectionalShadowCasters(DrawableProcessor* drawableProcessor, ea::vector<Drawable*>& shadowCastersBuffer);
+    void ProcessDirectionalShadowCasters(DrawableProcessor* drawableProcessor);
     void ProcessSpotShadowCasters(DrawableProcessor* drawableProcessor, const ea::vector<Drawable*>& shadowCasterCandidates);
     void ProcessPointShadowCasters(DrawableProcessor* drawableProcessor, const ea::vector<Drawable*>& shadowCasterCandidates);
     /// @}
 
     void FinalizeShadow(const ShadowMapRegion& shadowMap, unsigned pcfKernelSize);
-    void FinalizeShadowBatches();
+    void FinalizeShadowBatches(WorkQueue* workQueue);
 
     /// Return immutable
     /// @{
@@ -92,6 +147,33 @@ public:
     auto& GetMutableUnsortedShadowBatches() { return unsortedShadowBatches_; }
     auto& GetMutableShadowBatches() { return shadowBatches_; }
     const auto& GetShadowBatches() const { return shadowBatches_; }
+    /// Static and dynamic subsets of shadow batches. Static shadow batches go first in all shadow batches.
+    /// @{
+    auto& GetMutableStaticShadowBatches() { return staticShadowBatches_; }
+    auto& GetMutableDynamicShadowBatches() { return dynamicShadowBatches_; }
+    const auto& GetStaticShadowBatches() const { return staticShadowBatches_; }
+    const auto& GetDynamicShadowBatches() const { return dynamicShadowBatches_; }
+    /// @}
+
+    /// Shadow map caching
+    /// @{
+    /// Return whether static shadow casters and shadow camera didn't change since previous frame.
+    /// Valid after shadow batches are finalized.
+    bool IsStaticShadowMapUnchanged() const { return isStaticShadowMapUnchanged_; }
+    /// Check how shadow map should be rendered in current generation of shadow maps.
+    /// Should be called once per frame for each rendered split before any shadow map rendering.
+    ShadowMapRenderMode UpdateShadowMapReuse(unsigned shadowMapGeneration, bool enableReuse, bool enableStaticShadowMap);
+    /// Return how shadow map is rendered in current frame.
+    ShadowMapRenderMode GetShadowMapRenderMode() const { return shadowMapRenderMode_; }
+    /// Return whether shadow map is reused from previous frame and doesn't need rendering.
+    bool IsShadowMapReused() const { return shadowMapRenderMode_ == ShadowMapRenderMode::Reuse; }
+    /// Return whether shadow map is rendered from static shadow map and dynamic shadow casters.
+    bool IsStaticShadowMapUsed() const
+    {
+        return shadowMapRenderMode_ == ShadowMapRenderMode::UpdateStatic
+            || shadowMapRenderMode_ == ShadowMapRenderMode::RestoreStatic;
+    }
+    /// @}
 
 private:
     void InitializeBaseDirectionalCamera(Camera* cullCamera);
@@ -118,6 +200,7 @@ private:
     /// @{
     FloatRange cascadeZRange_{};
     FloatRange focusedCascadeZRange_{};
+    ea::vector<Drawable*> shadowCasterCandidates_;
     ea::vector<Drawable*> shadowCasters_;
 
     ShadowMapRegion shadowMap_;
@@ -128,7 +211,19 @@ private:
     /// @{
     ea::vector<PipelineBatch> unsortedShadowBatches_;
     ea::vector<PipelineBatchByState> sortedShadowBatches_;
+    RadixSorter<PipelineBatchByState> shadowBatchSorter_;
     PipelineBatchGroup<PipelineBatchByState> shadowBatches_;
+    PipelineBatchGroup<PipelineBatchByState> staticShadowBatches_;
+    PipelineBatchGroup<PipelineBatchByState> dynamicShadowBatches_;
+    /// @}
+
+    /// Shadow map caching
+    /// @{
+    ShadowSplitCacheKey cacheKey_;
+    ShadowSplitCacheKey previousCacheKey_;
+    bool isStaticShadowMapUnchanged_{};
+    ShadowSplitCacheState cacheState_;
+    ShadowMapRenderMode shadowMapRenderMode_{};
     /// @}
 };
 
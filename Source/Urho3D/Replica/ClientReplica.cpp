@@ -25,6 +25,7 @@
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
 #include "../Core/Exception.h"
+#include "../Core/Metrics.h"
 #include "../IO/Log.h"
 #include "../Network/Connection.h"
 #include "../Network/Network.h"
@@ -204,6 +205,8 @@ bool ClientReplica::ProcessMessage(NetworkMessageId messageId, MemoryBuffer& mes
 
 void ClientReplica::ProcessSceneUpdate()
 {
+    URHO3D_METRIC_TIMER("ClientReplica::ProcessSceneUpdate");
+
     VariantMap& eventData = scene_->GetEventDataMap();
 
     using namespace SceneNetworkUpdate;
@@ -25,6 +25,7 @@
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
 #include "../Core/Exception.h"
+#include "../Core/Metrics.h"
 #include "../Core/Timer.h"
 #include "../IO/Log.h"
 #include "../Math/RandomEngine.h"
@@ -661,6 +662,8 @@ void ServerReplicator::OnInputReady(float timeStep, bool isUpdateNow, float over
 
 void ServerReplicator::OnNetworkUpdate()
 {
+    URHO3D_METRIC_TIMER("ServerReplicator::OnNetworkUpdate");
+
     using namespace EndServerNetworkFrame;
     auto& eventData = network_->GetEventDataMap();
     eventData[P_FRAME] = static_cast<long long>(currentFrame_);
@@ -28,6 +28,7 @@
 #include <EASTL/hash_set.h>
 
 #include "../Container/Ptr.h"
+#include "../Container/StringHashMap.h"
 #include "../Core/Mutex.h"
 #include "../IO/File.h"
 #include "../Resource/Resource.h"
@@ -167,7 +168,7 @@ public:
     Resource* GetExistingResource(StringHash type, const ea::string& name);
 
     /// Return all loaded resources.
-    const ea::unordered_map<StringHash, ResourceGroup>& GetAllResources() const { return resourceGroups_; }
+    const StringHashMap<ResourceGroup>& GetAllResources() const { return resourceGroups_; }
 
     /// Return added resource load directories.
     /// @property
@@ -275,7 +276,7 @@ private:
     /// Mutex for thread-safe access to the resource directories, resource packages and resource dependencies.
     mutable Mutex resourceMutex_;
     /// Resources by type.
-    ea::unordered_map<StringHash, ResourceGroup> resourceGroups_;
+    StringHashMap<ResourceGroup> resourceGroups_;
     /// Resource load directories.
     ea::vector<ea::string> resourceDirs_;
     /// File watchers for resource directories, if automatic reloading enabled.
@@ -23,10 +23,8 @@
 #include "../Precompiled.h"
 
 #include "../IO/Log.h"
-#if defined(URHO3D_PHYSICS) || defined(URHO3D_PHYSICS2D)
-#include "../Physics/PhysicsEvents.h"
-#endif
 #include "../Scene/LogicComponent.h"
+#include "../Scene/LogicComponentScheduler.h"
 #include "../Scene/Scene.h"
 #include "../Scene/SceneEvents.h"
 
@@ -39,15 +37,28 @@ LogicComponent::LogicComponent(Context* context) :
     currentEventMask_(0),
     delayedStartCalled_(false)
 {
+    schedulerIndices_.fill(M_MAX_UNSIGNED);
 }
 
-LogicComponent::~LogicComponent() = default;
+LogicComponent::~LogicComponent()
+{
+    RemoveFromScheduler();
+}
 
 void LogicComponent::OnSetEnabled()
 {
     UpdateEventSubscription();
 }
 
+void LogicComponent::UnsubscribeFromAllEvents()
+{
+    Component::UnsubscribeFromAllEvents();
+
+    // Scheduled updates replace update event subscriptions, so they are removed too
+    RemoveFromScheduler();
+    currentEventMask_ = USE_NO_EVENT;
+}
+
 void LogicComponent::Update(float timeStep)
 {
 }
@@ -98,12 +109,8 @@ void LogicComponent::OnSceneSet(Scene* scene)
         UpdateEventSubscription();
     else
     {
-        UnsubscribeFromEvent(E_SCENEUPDATE);
+        RemoveFromScheduler();
         UnsubscribeFromEvent(GetPostUpdateEvent());
-#if defined(URHO3D_PHYSICS) || defined(URHO3D_PHYSICS2D)
-        UnsubscribeFromEvent(E_PHYSICSPRESTEP);
-        UnsubscribeFromEvent(E_PHYSICSPOSTSTEP);
-#endif
         currentEventMask_ = USE_NO_EVENT;
     }
 }
@@ -114,119 +121,95 @@ void LogicComponent::UpdateEventSubscription()
     if (!scene)
         return;
 
-    bool enabled = IsEnabledEffective();
-
-    bool needUpdate = enabled && ((updateEventMask_ & USE_UPDATE) || !delayedStartCalled_);
-    if (needUpdate && !(currentEventMask_ & USE_UPDATE))
+    // Scene may change without OnSceneSet(nullptr) in between
+    LogicComponentScheduler* scheduler = scene->GetLogicComponentScheduler();
+    if (scheduler_ != scheduler)
     {
-        SubscribeToEvent(scene, E_SCENEUPDATE, URHO3D_HANDLER(LogicComponent, HandleSceneUpdate));
-        currentEventMask_ |= USE_UPDATE;
-    }
-    else if (!needUpdate && (currentEventMask_ & USE_UPDATE))
-    {
-        UnsubscribeFromEvent(scene, E_SCENEUPDATE);
-        currentEventMask_ &= ~USE_UPDATE;
+        RemoveFromScheduler();
+        scheduler_ = scheduler;
+        scheduler_->SetUpdateSource(scene);
     }
 
+    bool enabled = IsEnabledEffective();
+
+    UpdateSchedulerPhase(LogicComponentPhase::DelayedStart, enabled && !delayedStartCalled_);
+    UpdateSchedulerPhase(LogicComponentPhase::Update, enabled && (updateEventMask_ & USE_UPDATE));
+    SetCurrentEventFlag(USE_UPDATE, enabled && (updateEventMask_ & USE_UPDATE));
+
+    // Custom post-update events are not scheduled
+    const StringHash postUpdateEvent = GetPostUpdateEvent();
     bool needPostUpdate = enabled && (updateEventMask_ & USE_POSTUPDATE);
-    if (needPostUpdate && !(currentEventMask_ & USE_POSTUPDATE))
-    {
-        SubscribeToEvent(scene, GetPostUpdateEvent(), URHO3D_HANDLER(LogicComponent, HandleScenePostUpdate));
-        currentEventMask_ |= USE_POSTUPDATE;
-    }
+    if (postUpdateEvent == E_SCENEPOSTUPDATE)
+        UpdateSchedulerPhase(LogicComponentPhase::PostUpdate, needPostUpdate);
+    else if (needPostUpdate && !(currentEventMask_ & USE_POSTUPDATE))
+        SubscribeToEvent(scene, postUpdateEvent, URHO3D_HANDLER(LogicComponent, HandleCustomPostUpdate));
     else if (!needPostUpdate && (currentEventMask_ & USE_POSTUPDATE))
-    {
-        UnsubscribeFromEvent(scene, GetPostUpdateEvent());
-        currentEventMask_ &= ~USE_POSTUPDATE;
-    }
+        UnsubscribeFromEvent(scene, postUpdateEvent);
+    SetCurrentEventFlag(USE_POSTUPDATE, needPostUpdate);
 
 #if defined(URHO3D_PHYSICS) || defined(URHO3D_PHYSICS2D)
     Component* world = GetFixedUpdateSource();
     if (!world)
         return;
 
+    scheduler_->SetFixedUpdateSource(world);
+
     bool needFixedUpdate = enabled && (updateEventMask_ & USE_FIXEDUPDATE);
-    if (needFixedUpdate && !(currentEventMask_ & USE_FIXEDUPDATE))
-    {
-        SubscribeToEvent(world, E_PHYSICSPRESTEP, URHO3D_HANDLER(LogicComponent, HandlePhysicsPreStep));
-        currentEventMask_ |= USE_FIXEDUPDATE;
-    }
-    else if (!needFixedUpdate && (currentEventMask_ & USE_FIXEDUPDATE))
-    {
-        UnsubscribeFromEvent(world, E_PHYSICSPRESTEP);
-        currentEventMask_ &= ~USE_FIXEDUPDATE;
-    }
+    UpdateSchedulerPhase(LogicComponentPhase::FixedUpdate, needFixedUpdate);
+    SetCurrentEventFlag(USE_FIXEDUPDATE, needFixedUpdate);
 
     bool needFixedPostUpdate = enabled && (updateEventMask_ & USE_FIXEDPOSTUPDATE);
-    if (needFixedPostUpdate && !(currentEventMask_ & USE_FIXEDPOSTUPDATE))
-    {
-        SubscribeToEvent(world, E_PHYSICSPOSTSTEP, URHO3D_HANDLER(LogicComponent, HandlePhysicsPostStep));
-        currentEventMask_ |= USE_FIXEDPOSTUPDATE;
-    }
-    else if (!needFixedPostUpdate && (currentEventMask_ & USE_FIXEDPOSTUPDATE))
-    {
-        UnsubscribeFromEvent(world, E_PHYSICSPOSTSTEP);
-        currentEventMask_ &= ~USE_FIXEDPOSTUPDATE;
-    }
+    UpdateSchedulerPhase(LogicComponentPhase::FixedPostUpdate, needFixedPostUpdate);
+    SetCurrentEventFlag(USE_FIXEDPOSTUPDATE, needFixedPostUpdate);
 #endif
 }
 
-void LogicComponent::HandleSceneUpdate(StringHash eventType, VariantMap& eventData)
+void LogicComponent::UpdateSchedulerPhase(LogicComponentPhase phase, bool scheduled)
 {
-    using namespace SceneUpdate;
-
-    // Execute user-defined delayed start function before first update
-    if (!delayedStartCalled_)
-    {
-        DelayedStart();
-        delayedStartCalled_ = true;
-
-        // If did not need actual update events, unsubscribe now
-        if (!(updateEventMask_ & USE_UPDATE))
-        {
-            UnsubscribeFromEvent(GetScene(), E_SCENEUPDATE);
-            currentEventMask_ &= ~USE_UPDATE;
-            return;
-        }
-    }
-
-    // Then execute user-defined update function
-    Update(eventData[P_TIMESTEP].GetFloat());
+    const bool isScheduled = schedulerIndices_[static_cast<unsigned>(phase)] != M_MAX_UNSIGNED;
+    if (scheduled && !isScheduled)
+        scheduler_->AddComponent(this, phase);
+    else if (!scheduled && isScheduled)
+        scheduler_->RemoveComponent(this, phase);
 }
 
-void LogicComponent::HandleScenePostUpdate(StringHash eventType, VariantMap& eventData)
+void LogicComponent::SetCurrentEventFlag(UpdateEvent flag, bool enabled)
 {
-    using namespace ScenePostUpdate;
-
-    // Execute user-defined post-update function
-    PostUpdate(eventData[P_TIMESTEP].GetFloat());
+    if (enabled)
+        currentEventMask_ |= flag;
+    else
+        currentEventMask_ &= ~flag;
 }
 
-#if defined(URHO3D_PHYSICS) || defined(URHO3D_PHYSICS2D)
-
-void LogicComponent::HandlePhysicsPreStep(StringHash eventType, VariantMap& eventData)
+void LogicComponent::RemoveFromScheduler()
 {
-    using namespace PhysicsPreStep;
+    if (LogicComponentScheduler* scheduler = scheduler_)
+    {
+        for (unsigned i = 0; i < static_cast<unsigned>(LogicComponentPhase::Count); ++i)
+            scheduler->RemoveComponent(this, static_cast<LogicComponentPhase>(i));
+    }
+    scheduler_ = nullptr;
+    schedulerBatchIndex_ = M_MAX_UNSIGNED;
+}
 
-    // Execute user-defined delayed start function before first fixed update if not called yet
+void LogicComponent::ExecuteDelayedStart()
+{
+    // Execute user-defined delayed start function before first update
     if (!delayedStartCalled_)
     {
         DelayedStart();
         delayedStartCalled_ = true;
     }
 
-    // Execute user-defined fixed update function
-    FixedUpdate(eventData[P_TIMESTEP].GetFloat());
+    UpdateEventSubscription();
 }
 
-void LogicComponent::HandlePhysicsPostStep(StringHash eventType, VariantMap& eventData)
+void LogicComponent::HandleCustomPostUpdate(StringHash eventType, VariantMap& eventData)
 {
-    using namespace PhysicsPostStep;
+    using namespace ScenePostUpdate;
 
-    // Execute user-defined fixed post-update function
-    FixedPostUpdate(eventData[P_TIMESTEP].GetFloat());
+    // Execute user-defined post-update function
+    PostUpdate(eventData[P_TIMESTEP].GetFloat());
 }
 
-#endif
-
 }
@@ -26,6 +26,9 @@
 
 #include "../Container/FlagSet.h"
 #include "../Scene/Component.h"
+#include "../Scene/LogicComponentScheduler.h"
+
+#include <EASTL/array.h>
 
 namespace Urho3D
 {
@@ -49,6 +52,7 @@ URHO3D_FLAGSET(UpdateEvent, UpdateEventFlags);
 class URHO3D_API LogicComponent : public Component
 {
     URHO3D_OBJECT(LogicComponent, Component);
+    friend class LogicComponentScheduler;
 
     /// Construct.
     explicit LogicComponent(Context* context);
@@ -57,6 +61,8 @@ class URHO3D_API LogicComponent : public Component
 
     /// Handle enabled/disabled state change. Changes update event subscription.
     void OnSetEnabled() override;
+    /// Unsubscribe from all events. Also stops scheduled updates until update event subscription is changed.
+    void UnsubscribeFromAllEvents() override;
 
     /// Called when the component is added to a scene node. Other components may not yet exist.
     virtual void Start() { }
@@ -76,6 +82,10 @@ class URHO3D_API LogicComponent : public Component
     /// Called on physics post-update, fixed timestep.
     virtual void FixedPostUpdate(float timeStep);
 
+    /// Return whether Update, PostUpdate, FixedUpdate and FixedPostUpdate may be called in parallel for different instances.
+    /// Should be the same for all instances of the type.
+    virtual bool IsUpdateThreadSafe() const { return false; }
+
     /// Return post update event type. Should stay the same for any given instance of the component.
     virtual StringHash GetPostUpdateEvent() const;
 
@@ -97,16 +107,23 @@ protected:
 private:
     /// Subscribe/unsubscribe to update events based on current enabled state and update event mask.
     void UpdateEventSubscription();
-    /// Handle scene update event.
-    void HandleSceneUpdate(StringHash eventType, VariantMap& eventData);
-    /// Handle scene post-update event.
-    void HandleScenePostUpdate(StringHash eventType, VariantMap& eventData);
-#if defined(URHO3D_PHYSICS) || defined(URHO3D_PHYSICS2D)
-    /// Handle physics pre-step event.
-    void HandlePhysicsPreStep(StringHash eventType, VariantMap& eventData);
-    /// Handle physics post-step event.
-    void HandlePhysicsPostStep(StringHash eventType, VariantMap& eventData);
-#endif
+    /// Add to or remove from scheduler phase.
+    void UpdateSchedulerPhase(LogicComponentPhase phase, bool scheduled);
+    /// Set or reset flag of current event mask.
+    void SetCurrentEventFlag(UpdateEvent flag, bool enabled);
+    /// Remove from all phases of scheduler.
+    void RemoveFromScheduler();
+    /// Execute delayed start and update subscriptions. Called by scheduler.
+    void ExecuteDelayedStart();
+    /// Handle custom post-update event.
+    void HandleCustomPostUpdate(StringHash eventType, VariantMap& eventData);
+
+    /// Scheduler that updates this component.
+    WeakPtr<LogicComponentScheduler> scheduler_;
+    /// Index of type batch in scheduler.
+    unsigned schedulerBatchIndex_{M_MAX_UNSIGNED};
+    /// Indices in scheduler phases.
+    ea::array<unsigned, static_cast<unsigned>(LogicComponentPhase::Count)> schedulerIndices_;
     /// Requested event subscription mask.
     UpdateEventFlags updateEventMask_;
     /// Current event subscription mask.
@@ -0,0 +1,288 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
+#if defined(URHO3D_PHYSICS) || defined(URHO3D_PHYSICS2D)
+#include "../Physics/PhysicsEvents.h"
+#endif
+#include "../Scene/LogicComponent.h"
+#include "../Scene/LogicComponentScheduler.h"
+#include "../Scene/Scene.h"
+#include "../Scene/SceneEvents.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+LogicComponentScheduler::LogicComponentScheduler(Context* context)
+    : Object(context)
+{
+}
+
+LogicComponentScheduler::~LogicComponentScheduler()
+{
+    // Detach remaining components so they don't refer to stale indices
+    for (const auto& batch : typeBatches_)
+    {
+        for (unsigned phaseIndex = 0; phaseIndex < static_cast<unsigned>(LogicComponentPhase::Count); ++phaseIndex)
+        {
+            for (LogicComponent* component : batch->components_[phaseIndex])
+            {
+                if (component)
+                {
+                    component->schedulerIndices_[phaseIndex] = M_MAX_UNSIGNED;
+                    component->schedulerBatchIndex_ = M_MAX_UNSIGNED;
+                }
+            }
+        }
+    }
+}
+
+void LogicComponentScheduler::AddComponent(LogicComponent* component, LogicComponentPhase phase)
+{
+    const auto phaseIndex = static_cast<unsigned>(phase);
+    URHO3D_ASSERT(component->schedulerIndices_[phaseIndex] == M_MAX_UNSIGNED);
+
+    if (component->schedulerBatchIndex_ == M_MAX_UNSIGNED)
+        component->schedulerBatchIndex_ = GetOrCreateTypeBatch(component);
+
+    ea::vector<LogicComponent*>& components = typeBatches_[component->schedulerBatchIndex_]->components_[phaseIndex];
+    component->schedulerIndices_[phaseIndex] = components.size();
+    components.push_back(component);
+}
+
+void LogicComponentScheduler::RemoveComponent(LogicComponent* component, LogicComponentPhase phase)
+{
+    const auto phaseIndex = static_cast<unsigned>(phase);
+    const unsigned index = component->schedulerIndices_[phaseIndex];
+    if (index == M_MAX_UNSIGNED)
+        return;
+
+    // Leave hole, it's removed after the phase is executed next time
+    TypeBatch& batch = *typeBatches_[component->schedulerBatchIndex_];
+    URHO3D_ASSERT(batch.components_[phaseIndex][index] == component);
+    batch.components_[phaseIndex][index] = nullptr;
+    ++batch.numHoles_[phaseIndex];
+    component->schedulerIndices_[phaseIndex] = M_MAX_UNSIGNED;
+}
+
+void LogicComponentScheduler::SetUpdateSource(Scene* source)
+{
+    if (updateSource_ == source)
+        return;
+
+    if (updateSource_)
+    {
+        updateSource_->OnSceneUpdate.Unsubscribe(this);
+        updateSource_->OnScenePostUpdate.Unsubscribe(this);
+    }
+
+    if (source)
+    {
+        source->OnSceneUpdate.Subscribe(this, &LogicComponentScheduler::HandleSceneUpdate);
+        source->OnScenePostUpdate.Subscribe(this, &LogicComponentScheduler::HandleScenePostUpdate);
+    }
+
+    updateSource_ = source;
+}
+
+void LogicComponentScheduler::SetFixedUpdateSource(Component* source)
+{
+    if (fixedUpdateSource_ == source)
+        return;
+
+#if defined(URHO3D_PHYSICS) || defined(URHO3D_PHYSICS2D)
+    if (fixedUpdateSource_)
+    {
+        UnsubscribeFromEvent(fixedUpdateSource_, E_PHYSICSPRESTEP);
+        UnsubscribeFromEvent(fixedUpdateSource_, E_PHYSICSPOSTSTEP);
+    }
+
+    if (source)
+    {
+        SubscribeToEvent(source, E_PHYSICSPRESTEP, URHO3D_HANDLER(LogicComponentScheduler, HandlePhysicsPreStep));
+        SubscribeToEvent(source, E_PHYSICSPOSTSTEP, URHO3D_HANDLER(LogicComponentScheduler, HandlePhysicsPostStep));
+    }
+#endif
+
+    fixedUpdateSource_ = source;
+}
+
+template <class T>
+void LogicComponentScheduler::ExecutePhase(LogicComponentPhase phase, bool allowParallel, const T& callback)
+{
+    const auto phaseIndex = static_cast<unsigned>(phase);
+    auto workQueue = GetSubsystem<WorkQueue>();
+
+    // Batches and components may be added during iteration, they are ignored until the next time
+    const unsigned numBatches = typeBatches_.size();
+    for (unsigned batchIndex = 0; batchIndex < numBatches; ++batchIndex)
+    {
+        TypeBatch& batch = *typeBatches_[batchIndex];
+        ea::vector<LogicComponent*>& components = batch.components_[phaseIndex];
+        const unsigned numComponents = components.size();
+
+        if (allowParallel && batch.threadSafe_ && workQueue && numComponents > ComponentsPerTask)
+        {
+            ForEachParallel(workQueue, ComponentsPerTask, numComponents,
+                [&](unsigned beginIndex, unsigned endIndex)
+            {
+                for (unsigned i = beginIndex; i < endIndex; ++i)
+                {
+                    LogicComponent* component = components[i];
+                    if (component && !component->GetBlockEvents())
+                        callback(component);
+                }
+            });
+        }
+        else
+        {
+            for (unsigned i = 0; i < numComponents; ++i)
+            {
+                // Scheduled phases replace event subscriptions, so blocked events block them too
+                LogicComponent* component = components[i];
+                if (component && !component->GetBlockEvents())
+                    callback(component);
+            }
+        }
+
+        if (batch.numHoles_[phaseIndex] > 0)
+            CompactPhase(batch, phase);
+    }
+}
+
+void LogicComponentScheduler::Update(float timeStep)
+{
+    URHO3D_PROFILE("UpdateLogicComponents");
+
+    ExecuteDelayedStart();
+    ExecutePhase(LogicComponentPhase::Update, true,
+        [timeStep](LogicComponent* component) { component->Update(timeStep); });
+}
+
+void LogicComponentScheduler::PostUpdate(float timeStep)
+{
+    URHO3D_PROFILE("PostUpdateLogicComponents");
+
+    ExecutePhase(LogicComponentPhase::PostUpdate, true,
+        [timeStep](LogicComponent* component) { component->PostUpdate(timeStep); });
+}
+
+void LogicComponentScheduler::FixedUpdate(float timeStep)
+{
+    URHO3D_PROFILE("FixedUpdateLogicComponents");
+
+    ExecutePhase(LogicComponentPhase::FixedUpdate, true,
+        [timeStep](LogicComponent* component) { component->FixedUpdate(timeStep); });
+}
+
+void LogicComponentScheduler::FixedPostUpdate(float timeStep)
+{
+    URHO3D_PROFILE("FixedPostUpdateLogicComponents");
+
+    ExecutePhase(LogicComponentPhase::FixedPostUpdate, true,
+        [timeStep](LogicComponent* component) { component->FixedPostUpdate(timeStep); });
+}
+
+unsigned LogicComponentScheduler::GetNumComponents(LogicComponentPhase phase) const
+{
+    const auto phaseIndex = static_cast<unsigned>(phase);
+    unsigned result = 0;
+    for (const auto& batch : typeBatches_)
+        result += batch->components_[phaseIndex].size() - batch->numHoles_[phaseIndex];
+    return result;
+}
+
+unsigned LogicComponentScheduler::GetOrCreateTypeBatch(LogicComponent* component)
+{
+    const TypeInfo* typeInfo = component->GetTypeInfo();
+    const auto iter = typeBatchIndices_.find(typeInfo);
+    if (iter != typeBatchIndices_.end())
+        return iter->second;
+
+    const unsigned index = typeBatches_.size();
+    auto batch = ea::make_unique<TypeBatch>();
+    batch->threadSafe_ = component->IsUpdateThreadSafe();
+    typeBatches_.push_back(ea::move(batch));
+    typeBatchIndices_.emplace(typeInfo, index);
+    return index;
+}
+
+void LogicComponentScheduler::CompactPhase(TypeBatch& batch, LogicComponentPhase phase)
+{
+    const auto phaseIndex = static_cast<unsigned>(phase);
+    ea::vector<LogicComponent*>& components = batch.components_[phaseIndex];
+
+    // Keep the order of components
+    unsigned numComponents = 0;
+    for (LogicComponent* component : components)
+    {
+        if (!component)
+            continue;
+
+        component->schedulerIndices_[phaseIndex] = numComponents;
+        components[numComponents++] = component;
+    }
+
+    components.resize(numComponents);
+    batch.numHoles_[phaseIndex] = 0;
+}
+
+void LogicComponentScheduler::ExecuteDelayedStart()
+{
+    // Delayed start changes subscriptions, so it's never executed in parallel
+    ExecutePhase(LogicComponentPhase::DelayedStart, false,
+        [](LogicComponent* component) { component->ExecuteDelayedStart(); });
+}
+
+void LogicComponentScheduler::HandleSceneUpdate(const SceneUpdateEvent& event)
+{
+    Update(event.timeStep_);
+}
+
+void LogicComponentScheduler::HandleScenePostUpdate(const ScenePostUpdateEvent& event)
+{
+    PostUpdate(event.timeStep_);
+}
+
+void LogicComponentScheduler::HandlePhysicsPreStep(StringHash eventType, VariantMap& eventData)
+{
+#if defined(URHO3D_PHYSICS) || defined(URHO3D_PHYSICS2D)
+    using namespace PhysicsPreStep;
+    FixedUpdate(eventData[P_TIMESTEP].GetFloat());
+#endif
+}
+
+void LogicComponentScheduler::HandlePhysicsPostStep(StringHash eventType, VariantMap& eventData)
+{
+#if defined(URHO3D_PHYSICS) || defined(URHO3D_PHYSICS2D)
+    using namespace PhysicsPostStep;
+    FixedPostUpdate(eventData[P_TIMESTEP].GetFloat());
+#endif
+}
+
+}
@@ -0,0 +1,136 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Core/Object.h"
+
+#include <EASTL/unique_ptr.h>
+#include <EASTL/unordered_map.h>
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+class Component;
+class LogicComponent;
+class Scene;
+struct SceneUpdateEvent;
+struct ScenePostUpdateEvent;
+
+/// Update phase of logic components.
+enum class LogicComponentPhase
+{
+    DelayedStart,
+    Update,
+    PostUpdate,
+    FixedUpdate,
+    FixedPostUpdate,
+
+    Count
+};
+
+/// Scene-level scheduler that updates logic components in batches grouped by concrete type.
+/// Components of types that report thread-safe update are updated in parallel on WorkQueue.
+/// Components may be added and removed from the main thread at any time, including during the update.
+/// Components added during the update are not updated until the next time the phase is executed.
+/// Components that block events are skipped, same as if they were subscribed to update events.
+/// Update and post-update are dispatched as one receiver of scene update events, subscribed when the first
+/// component is added to the scene. Unlike individual subscriptions, all components of the scene are updated
+/// together at this position relative to other receivers.
+class URHO3D_API LogicComponentScheduler : public Object
+{
+    URHO3D_OBJECT(LogicComponentScheduler, Object);
+
+public:
+    /// Number of components processed by one task in parallel update.
+    static const unsigned ComponentsPerTask = 256;
+
+    /// Construct.
+    explicit LogicComponentScheduler(Context* context);
+    /// Destruct.
+    ~LogicComponentScheduler() override;
+
+    /// Add component to the phase. Component should not be added to the same phase twice.
+    void AddComponent(LogicComponent* component, LogicComponentPhase phase);
+    /// Remove component from the phase. Does nothing if the component is not added.
+    void RemoveComponent(LogicComponent* component, LogicComponentPhase phase);
+    /// Set source of scene update and post-update events.
+    void SetUpdateSource(Scene* source);
+    /// Set source of physics pre-step and post-step events used for fixed update.
+    void SetFixedUpdateSource(Component* source);
+
+    /// Execute delayed start and update of components.
+    void Update(float timeStep);
+    /// Execute post-update of components.
+    void PostUpdate(float timeStep);
+    /// Execute fixed update of components. Delayed start is executed only on update.
+    void FixedUpdate(float timeStep);
+    /// Execute fixed post-update of components.
+    void FixedPostUpdate(float timeStep);
+
+    /// Return number of components in the phase.
+    unsigned GetNumComponents(LogicComponentPhase phase) const;
+    /// Return number of distinct component types.
+    unsigned GetNumTypes() const { return typeBatches_.size(); }
+
+private:
+    /// Components of the same type.
+    struct TypeBatch
+    {
+        /// Whether the components can be updated in parallel.
+        bool threadSafe_{};
+        /// Components for each phase. Removed components leave null holes.
+        ea::vector<LogicComponent*> components_[static_cast<unsigned>(LogicComponentPhase::Count)];
+        /// Number of holes for each phase.
+        unsigned numHoles_[static_cast<unsigned>(LogicComponentPhase::Count)]{};
+    };
+
+    /// Return batch index for the type of the component. Create new batch if needed.
+    unsigned GetOrCreateTypeBatch(LogicComponent* component);
+    /// Execute phase for all batches.
+    template <class T> void ExecutePhase(LogicComponentPhase phase, bool allowParallel, const T& callback);
+    /// Remove holes from the phase.
+    void CompactPhase(TypeBatch& batch, LogicComponentPhase phase);
+    /// Execute all pending delayed starts.
+    void ExecuteDelayedStart();
+
+    /// Handle scene update event.
+    void HandleSceneUpdate(const SceneUpdateEvent& event);
+    /// Handle scene post-update event.
+    void HandleScenePostUpdate(const ScenePostUpdateEvent& event);
+    /// Handle physics pre-step event.
+    void HandlePhysicsPreStep(StringHash eventType, VariantMap& eventData);
+    /// Handle physics post-step event.
+    void HandlePhysicsPostStep(StringHash eventType, VariantMap& eventData);
+
+    /// Batches of components. Batches are never removed.
+    ea::vector<ea::unique_ptr<TypeBatch>> typeBatches_;
+    /// Index of batch for each type.
+    ea::unordered_map<const TypeInfo*, unsigned> typeBatchIndices_;
+    /// Source of update events.
+    WeakPtr<Scene> updateSource_;
+    /// Source of fixed update events.
+    WeakPtr<Component> fixedUpdateSource_;
+};
+
+}
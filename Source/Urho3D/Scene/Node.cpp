@@ -1893,6 +1893,13 @@ void Node::SetTransformSilent(const Matrix3x4& matrix)
     SetTransformSilent(matrix.Translation(), matrix.Rotation(), matrix.Scale());
 }
 
+void Node::SetCachedWorldTransform(const Matrix3x4& worldTransform) const
+{
+    worldTransform_ = worldTransform;
+    worldRotation_ = IsTransformHierarchyRoot() ? rotation_ : parent_->GetWorldRotation() * rotation_;
+    dirty_ = false;
+}
+
 void Node::OnAttributeAnimationAdded()
 {
     if (attributeAnimationInfos_.size() == 1)
@@ -703,6 +703,9 @@ public:
 
     /// Set local transform silently without marking the node & child nodes dirty. Used by animation code.
     void SetTransformSilent(const Matrix3x4& matrix);
+    /// Store world transform calculated externally and clear dirty flag. Parent world transform should be up to date.
+    /// Used by animation code to avoid evaluating bone nodes one by one.
+    void SetCachedWorldTransform(const Matrix3x4& worldTransform) const;
 
 protected:
     /// Handle attribute animation added.
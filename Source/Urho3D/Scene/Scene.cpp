@@ -49,6 +49,20 @@
 namespace Urho3D
 {
 
+void SceneUpdateEvent::ToVariantMap(VariantMap& eventData) const
+{
+    using namespace SceneUpdate;
+    eventData[P_SCENE] = scene_;
+    eventData[P_TIMESTEP] = timeStep_;
+}
+
+void ScenePostUpdateEvent::ToVariantMap(VariantMap& eventData) const
+{
+    using namespace ScenePostUpdate;
+    eventData[P_SCENE] = scene_;
+    eventData[P_TIMESTEP] = timeStep_;
+}
+
 Scene::Scene(Context* context) :
     Node(context),
     replicatedNodeID_(FIRST_REPLICATED_ID),
@@ -62,6 +76,7 @@ Scene::Scene(Context* context) :
     updateEnabled_(true),
     asyncLoading_(false),
     threadedUpdate_(false),
+    logicComponentScheduler_(MakeShared<LogicComponentScheduler>(context)),
     lightmaps_(Texture2D::GetTypeStatic())
 {
     // Assign an ID to self so that nodes can refer to this node as a parent
@@ -785,13 +800,13 @@ void Scene::Update(float timeStep)
 
     using namespace SceneUpdate;
 
+    // Update variable timestep logic
+    OnSceneUpdate.Send({this, timeStep});
+
     VariantMap& eventData = GetEventDataMap();
     eventData[P_SCENE] = this;
     eventData[P_TIMESTEP] = timeStep;
 
-    // Update variable timestep logic
-    SendEvent(E_SCENEUPDATE, eventData);
-
     // Update scene attribute animation.
     SendEvent(E_ATTRIBUTEANIMATIONUPDATE, eventData);
 
@@ -799,7 +814,7 @@ void Scene::Update(float timeStep)
     SendEvent(E_SCENESUBSYSTEMUPDATE, eventData);
 
     // Post-update variable timestep logic
-    SendEvent(E_SCENEPOSTUPDATE, eventData);
+    OnScenePostUpdate.Send({this, timeStep});
 
     // Note: using a float for elapsed time accumulation is inherently inaccurate. The purpose of this value is
     // primarily to update material animation effects, as it is available to shaders. It can be reset by calling
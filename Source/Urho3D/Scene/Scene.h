@@ -30,7 +30,9 @@
 #include "../Core/Mutex.h"
 #include "../Resource/XMLElement.h"
 #include "../Resource/JSONFile.h"
+#include "../Scene/LogicComponentScheduler.h"
 #include "../Scene/Node.h"
+#include "../Scene/SceneEvents.h"
 #include "../Scene/SceneResolver.h"
 
 namespace Urho3D
@@ -242,6 +244,9 @@ public:
     /// @property
     int GetAsyncLoadingMs() const { return asyncLoadingMs_; }
 
+    /// Return scheduler of logic component updates.
+    LogicComponentScheduler* GetLogicComponentScheduler() const { return logicComponentScheduler_; }
+
     /// Return required package files.
     /// @property
     const ea::vector<SharedPtr<PackageFile> >& GetRequiredPackageFiles() const { return requiredPackageFiles_; }
@@ -286,6 +291,11 @@ public:
     /// Return node user variable reverse mappings.
     ea::string GetVarNamesAttr() const;
 
+    /// Typed scene update event. VariantMap subscribers of E_SCENEUPDATE are notified after typed receivers.
+    TypedEvent<SceneUpdateEvent> OnSceneUpdate{this};
+    /// Typed scene post-update event. VariantMap subscribers of E_SCENEPOSTUPDATE are notified after typed receivers.
+    TypedEvent<ScenePostUpdateEvent> OnScenePostUpdate{this};
+
 private:
     /// Handle the logic update event to update the scene, if active.
     void HandleUpdate(StringHash eventType, VariantMap& eventData);
@@ -362,6 +372,9 @@ private:
     /// Threaded update flag.
     bool threadedUpdate_;
 
+    /// Scheduler of logic component updates.
+    SharedPtr<LogicComponentScheduler> logicComponentScheduler_;
+
     /// Lightmap textures names.
     ResourceRefList lightmaps_;
     /// Loaded lightmap textures.
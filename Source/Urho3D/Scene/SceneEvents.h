@@ -23,17 +23,35 @@
 #pragma once
 
 #include "../Core/Object.h"
+#include "../Core/TypedEvent.h"
 
 namespace Urho3D
 {
 
+class Scene;
+
 /// Variable timestep scene update.
+/// Sent via Scene::OnSceneUpdate: typed receivers, including LogicComponent updates, are invoked before handlers of this event.
 URHO3D_EVENT(E_SCENEUPDATE, SceneUpdate)
 {
     URHO3D_PARAM(P_SCENE, Scene);                  // Scene pointer
     URHO3D_PARAM(P_TIMESTEP, TimeStep);            // float
 }
 
+/// Typed payload of E_SCENEUPDATE.
+struct URHO3D_API SceneUpdateEvent
+{
+    URHO3D_TYPED_EVENT(E_SCENEUPDATE);
+
+    /// Scene being updated.
+    Scene* scene_{};
+    /// Time step.
+    float timeStep_{};
+
+    /// Convert to VariantMap payload.
+    void ToVariantMap(VariantMap& eventData) const;
+};
+
 /// Network-aware scene update.
 /// In standalone mode, SceneNetworkUpdate is equivalent to SceneUpdate.
 /// In server mode, SceneNetworkUpdate is called once per network frame with fixed timestep.
@@ -82,12 +100,27 @@ URHO3D_EVENT(E_ATTRIBUTEANIMATIONREMOVED, AttributeAnimationRemoved)
 }
 
 /// Variable timestep scene post-update.
+/// Sent via Scene::OnScenePostUpdate: typed receivers, including LogicComponent post-updates, are invoked before handlers of this event.
 URHO3D_EVENT(E_SCENEPOSTUPDATE, ScenePostUpdate)
 {
     URHO3D_PARAM(P_SCENE, Scene);                  // Scene pointer
     URHO3D_PARAM(P_TIMESTEP, TimeStep);            // float
 }
 
+/// Typed payload of E_SCENEPOSTUPDATE.
+struct URHO3D_API ScenePostUpdateEvent
+{
+    URHO3D_TYPED_EVENT(E_SCENEPOSTUPDATE);
+
+    /// Scene being updated.
+    Scene* scene_{};
+    /// Time step.
+    float timeStep_{};
+
+    /// Convert to VariantMap payload.
+    void ToVariantMap(VariantMap& eventData) const;
+};
+
 /// Asynchronous scene loading progress.
 URHO3D_EVENT(E_ASYNCLOADPROGRESS, AsyncLoadProgress)
 {
@@ -28,6 +28,7 @@
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../Engine/Engine.h"
 #include "../Graphics/Graphics.h"
 #include "../Graphics/GraphicsEvents.h"
@@ -182,8 +183,16 @@ void DebugHud::RenderUI(DebugHudModeFlags mode)
         ui::SetCursorPosX(left_offset);
         ui::Text("Occluders %u", renderer->GetNumOccluders(true));
         ui::SetCursorPosX(left_offset);
+        ui::Text("Cached draw queues %u/%u", renderer->GetNumReusedDrawQueues(), renderer->GetNumCacheableDrawQueues());
+        ui::SetCursorPosX(left_offset);
+        ui::Text("Cached shadow splits %u/%u", renderer->GetNumReusedShadowSplits(), renderer->GetNumShadowSplits());
+        ui::SetCursorPosX(left_offset);
         ui::Text("Animations %u(%u)", stats.animations_, numChangedAnimations_[0]);
         ui::SetCursorPosX(left_offset);
+        const LinearAllocatorStats frameMemoryStats = GetSubsystem<WorkQueue>()->GetFrameMemory()->GetStats();
+        ui::Text("Frame memory %llu KB (peak %llu KB)",
+            frameMemoryStats.allocatedBytes_ / 1024, frameMemoryStats.peakAllocatedBytes_ / 1024);
+        ui::SetCursorPosX(left_offset);
 
         for (auto i = appStats_.begin(); i != appStats_.end(); ++i)
         {
@@ -0,0 +1,79 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Graphics/Animation.h"
+#include "../IO/File.h"
+#include "../IO/Log.h"
+#include "../Utility/AnimationCompressor.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+AnimationCompressor::AnimationCompressor(Context* context)
+    : AssetTransformer(context)
+{
+}
+
+void AnimationCompressor::RegisterObject(Context* context)
+{
+    context->AddFactoryReflection<AnimationCompressor>(Category_Transformer);
+
+    URHO3D_ATTRIBUTE("Position Tolerance", float, settings_.positionTolerance_, AnimationCompressionSettings{}.positionTolerance_, AM_DEFAULT);
+    URHO3D_ATTRIBUTE("Rotation Tolerance", float, settings_.rotationTolerance_, AnimationCompressionSettings{}.rotationTolerance_, AM_DEFAULT);
+    URHO3D_ATTRIBUTE("Scale Tolerance", float, settings_.scaleTolerance_, AnimationCompressionSettings{}.scaleTolerance_, AM_DEFAULT);
+}
+
+bool AnimationCompressor::IsApplicable(const AssetTransformerInput& input)
+{
+    return input.resourceName_.ends_with(".ani", false);
+}
+
+bool AnimationCompressor::Execute(
+    const AssetTransformerInput& input, AssetTransformerOutput& output, const AssetTransformerVector& transformers)
+{
+    auto animation = MakeShared<Animation>(context_);
+    {
+        File sourceFile(context_, input.inputFileName_);
+        if (!sourceFile.IsOpen() || !animation->Load(sourceFile))
+        {
+            URHO3D_LOGERROR("Failed to load animation {}", input.resourceName_);
+            return false;
+        }
+    }
+
+    animation->Compress(settings_);
+
+    if (!animation->SaveFile(input.outputFileName_))
+    {
+        URHO3D_LOGERROR("Failed to save compressed animation {}", input.resourceName_);
+        return false;
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,345 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Graphics/Material.h"
+#include "../Graphics/Model.h"
+#include "../Graphics/ModelView.h"
+#include "../Graphics/StaticModel.h"
+#include "../IO/Log.h"
+#include "../Resource/ResourceCache.h"
+#include "../Resource/XMLFile.h"
+#include "../Scene/Scene.h"
+#include "../Utility/HierarchicalLodGenerator.h"
+
+#include <EASTL/sort.h>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+namespace
+{
+
+/// Return whether the node has nothing but enabled static models as geometry drawables.
+bool IsNodeClusterable(Node* node)
+{
+    ea::vector<Drawable*> drawables;
+    node->GetDerivedComponents<Drawable>(drawables);
+
+    bool hasModels = false;
+    for (Drawable* drawable : drawables)
+    {
+        if (!(drawable->GetDrawableFlags() & DRAWABLE_GEOMETRY))
+            continue;
+
+        if (drawable->GetType() != StaticModel::GetTypeStatic() || drawable->GetLodProxy())
+            return false;
+
+        const auto staticModel = static_cast<StaticModel*>(drawable);
+        if (!staticModel->IsEnabledEffective() || !staticModel->GetModel())
+            return false;
+
+        hasModels = true;
+    }
+    return hasModels;
+}
+
+/// Return world bounding box of all static models in the node.
+BoundingBox GetNodeBoundingBox(Node* node)
+{
+    ea::vector<StaticModel*> staticModels;
+    node->GetComponents(staticModels);
+
+    BoundingBox boundingBox;
+    for (StaticModel* staticModel : staticModels)
+        boundingBox.Merge(staticModel->GetWorldBoundingBox());
+    return boundingBox;
+}
+
+/// Return whether the cell is before the other one in Z, Y, X order.
+bool CompareCells(const IntVector3& lhs, const IntVector3& rhs)
+{
+    if (lhs.z_ != rhs.z_)
+        return lhs.z_ < rhs.z_;
+    if (lhs.y_ != rhs.y_)
+        return lhs.y_ < rhs.y_;
+    return lhs.x_ < rhs.x_;
+}
+
+/// Append transformed triangles of the geometry to merged geometry.
+void AppendGeometry(GeometryLODView& dest, GeometryLODView& source, const Matrix3x4& transform)
+{
+    const Matrix3 rotationMatrix = transform.ToMatrix3();
+    const Matrix3 normalMatrix = rotationMatrix.Inverse().Transpose();
+    // Mirroring transform flips both triangle winding and tangent frame handedness
+    const bool isMirrored = rotationMatrix.Determinant() < 0.0f;
+
+    const unsigned startVertex = dest.vertices_.size();
+    for (ModelVertex vertex : source.vertices_)
+    {
+        vertex.SetPosition(transform * vertex.GetPosition());
+        if (vertex.HasNormal())
+            vertex.SetNormal((normalMatrix * static_cast<Vector3>(vertex.normal_)).Normalized());
+        if (vertex.HasTangent())
+        {
+            const float sign = isMirrored ? -vertex.tangent_.w_ : vertex.tangent_.w_;
+            vertex.tangent_ = Vector4((rotationMatrix * static_cast<Vector3>(vertex.tangent_)).Normalized(), sign);
+        }
+        if (vertex.HasBinormal())
+            vertex.binormal_ = Vector4((rotationMatrix * static_cast<Vector3>(vertex.binormal_)).Normalized(), 0.0f);
+        dest.vertices_.push_back(vertex);
+    }
+
+    source.ForEachTriangle([&](unsigned i0, unsigned i1, unsigned i2)
+    {
+        if (isMirrored)
+            ea::swap(i1, i2);
+        dest.indices_.push_back(startVertex + i0);
+        dest.indices_.push_back(startVertex + i1);
+        dest.indices_.push_back(startVertex + i2);
+    });
+}
+
+}
+
+ea::vector<HierarchicalLodCluster> ClusterStaticModels(Scene* scene, const HierarchicalLodParameters& params)
+{
+    ea::vector<Node*> nodes;
+    scene->GetChildrenWithComponent<StaticModel>(nodes, true);
+
+    // Assign nodes to grid cells, sort for deterministic output
+    ea::vector<ea::pair<IntVector3, Node*>> nodesByCell;
+    const float invClusterSize = 1.0f / ea::max(M_EPSILON, params.clusterSize_);
+    for (Node* node : nodes)
+    {
+        if (!IsNodeClusterable(node))
+            continue;
+
+        const BoundingBox boundingBox = GetNodeBoundingBox(node);
+        if (!boundingBox.Defined())
+            continue;
+
+        const Vector3 cellPosition = boundingBox.Center() * invClusterSize;
+        const IntVector3 cell = VectorFloorToInt(cellPosition);
+        nodesByCell.emplace_back(cell, node);
+    }
+
+    ea::stable_sort(nodesByCell.begin(), nodesByCell.end(),
+        [](const auto& lhs, const auto& rhs) { return CompareCells(lhs.first, rhs.first); });
+
+    // Group nodes in the same cell
+    ea::vector<HierarchicalLodCluster> clusters;
+    for (unsigned begin = 0; begin < nodesByCell.size();)
+    {
+        unsigned end = begin + 1;
+        while (end < nodesByCell.size() && nodesByCell[end].first == nodesByCell[begin].first)
+            ++end;
+
+        if (end - begin >= params.minNodesInCluster_)
+        {
+            HierarchicalLodCluster& cluster = clusters.emplace_back();
+            BoundingBox clusterBoundingBox;
+            for (unsigned i = begin; i < end; ++i)
+            {
+                Node* node = nodesByCell[i].second;
+                cluster.nodes_.push_back(node);
+                clusterBoundingBox.Merge(GetNodeBoundingBox(node));
+            }
+            cluster.center_ = clusterBoundingBox.Center();
+        }
+
+        begin = end;
+    }
+
+    return clusters;
+}
+
+HierarchicalLodProxyData MergeStaticModels(Context* context, const HierarchicalLodCluster& cluster)
+{
+    struct MergedGeometry
+    {
+        Material* material_{};
+        GeometryLODView lod_;
+    };
+
+    ea::unordered_map<Model*, SharedPtr<ModelView>> modelViews;
+    ea::vector<MergedGeometry> mergedGeometries;
+    HierarchicalLodProxyData result;
+
+    const Matrix3x4 worldToCluster{-cluster.center_, Quaternion::IDENTITY, Vector3::ONE};
+    ea::vector<StaticModel*> staticModels;
+    for (Node* node : cluster.nodes_)
+    {
+        const Matrix3x4 transform = worldToCluster * node->GetWorldTransform();
+
+        node->GetComponents(staticModels);
+        for (StaticModel* staticModel : staticModels)
+        {
+            Model* model = staticModel->GetModel();
+            SharedPtr<ModelView>& modelView = modelViews[model];
+            if (!modelView)
+            {
+                modelView = MakeShared<ModelView>(context);
+                if (!modelView->ImportModel(model))
+                    URHO3D_LOGWARNING("Cannot import model '{}' for hierarchical LOD", model->GetName());
+            }
+
+            if (staticModel->GetCastShadows())
+                result.castShadows_ = true;
+
+            ea::vector<GeometryView>& geometries = modelView->GetGeometries();
+            for (unsigned i = 0; i < geometries.size(); ++i)
+            {
+                if (geometries[i].lods_.empty())
+                    continue;
+
+                // Proxies are small on the screen by definition, so the coarsest LOD is good enough
+                GeometryLODView& sourceLod = geometries[i].lods_.back();
+                if (!sourceLod.IsTriangleGeometry())
+                    continue;
+
+                Material* material = staticModel->GetMaterial(i);
+                auto iter = ea::find_if(mergedGeometries.begin(), mergedGeometries.end(),
+                    [&](const MergedGeometry& mergedGeometry)
+                {
+                    return mergedGeometry.material_ == material
+                        && mergedGeometry.lod_.vertexFormat_ == sourceLod.vertexFormat_;
+                });
+
+                if (iter == mergedGeometries.end())
+                {
+                    iter = &mergedGeometries.emplace_back();
+                    iter->material_ = material;
+                    iter->lod_.primitiveType_ = TRIANGLE_LIST;
+                    iter->lod_.vertexFormat_ = sourceLod.vertexFormat_;
+                }
+
+                AppendGeometry(iter->lod_, sourceLod, transform);
+            }
+        }
+    }
+
+    ea::vector<GeometryView> geometries;
+    for (MergedGeometry& mergedGeometry : mergedGeometries)
+    {
+        GeometryView& geometry = geometries.emplace_back();
+        geometry.lods_.push_back(ea::move(mergedGeometry.lod_));
+        if (mergedGeometry.material_)
+            geometry.material_ = mergedGeometry.material_->GetName();
+        result.materials_.emplace_back(mergedGeometry.material_);
+    }
+
+    result.model_ = MakeShared<ModelView>(context);
+    result.model_->SetGeometries(ea::move(geometries));
+    return result;
+}
+
+ea::vector<SharedPtr<Model>> GenerateHierarchicalLod(
+    Scene* scene, const HierarchicalLodParameters& params, const ea::string& modelNamePrefix)
+{
+    Context* context = scene->GetContext();
+    const ea::vector<HierarchicalLodCluster> clusters = ClusterStaticModels(scene, params);
+
+    ea::vector<SharedPtr<Model>> models;
+    for (const HierarchicalLodCluster& cluster : clusters)
+    {
+        const HierarchicalLodProxyData proxyData = MergeStaticModels(context, cluster);
+        if (proxyData.model_->GetGeometries().empty())
+            continue;
+
+        const ea::string modelName = Format("{}{}.mdl", modelNamePrefix, models.size());
+        const SharedPtr<Model> model = proxyData.model_->ExportModel(modelName);
+
+        Node* proxyNode = scene->CreateChild("HLOD Proxy");
+        proxyNode->SetWorldPosition(cluster.center_);
+
+        auto proxy = proxyNode->CreateComponent<HierarchicalLodProxy>();
+        proxy->SetModel(model);
+        for (unsigned i = 0; i < proxyData.materials_.size(); ++i)
+            proxy->SetMaterial(i, proxyData.materials_[i]);
+        proxy->SetCastShadows(proxyData.castShadows_);
+        proxy->SetSwitchScreenSize(params.switchScreenSize_);
+
+        for (Node* node : cluster.nodes_)
+            proxy->AddClusterNode(node);
+
+        models.push_back(model);
+    }
+
+    return models;
+}
+
+HierarchicalLodGenerator::HierarchicalLodGenerator(Context* context)
+    : AssetTransformer(context)
+{
+}
+
+void HierarchicalLodGenerator::RegisterObject(Context* context)
+{
+    context->AddFactoryReflection<HierarchicalLodGenerator>(Category_Transformer);
+
+    URHO3D_ATTRIBUTE("Cluster Size", float, params_.clusterSize_, 64.0f, AM_DEFAULT);
+    URHO3D_ATTRIBUTE("Min Nodes In Cluster", unsigned, params_.minNodesInCluster_, 2, AM_DEFAULT);
+    URHO3D_ATTRIBUTE("Switch Screen Size", float, params_.switchScreenSize_,
+        HierarchicalLodProxy::DefaultSwitchScreenSize, AM_DEFAULT);
+}
+
+bool HierarchicalLodGenerator::IsApplicable(const AssetTransformerInput& input)
+{
+    return input.resourceName_.ends_with(".xml", false);
+}
+
+bool HierarchicalLodGenerator::Execute(
+    const AssetTransformerInput& input, AssetTransformerOutput& output, const AssetTransformerVector& transformers)
+{
+    auto cache = GetSubsystem<ResourceCache>();
+    auto sourceFile = cache->GetTempResource<XMLFile>(input.resourceName_);
+    if (!sourceFile || sourceFile->GetRoot().GetName() != "scene")
+        return false;
+
+    auto scene = MakeShared<Scene>(context_);
+    if (!scene->LoadXML(sourceFile->GetRoot()))
+        return false;
+
+    const ea::string modelNamePrefix = input.resourceName_ + "/HLOD/Proxy_";
+    const auto models = GenerateHierarchicalLod(scene, params_, modelNamePrefix);
+    if (models.empty())
+        return false;
+
+    for (Model* model : models)
+        model->SaveFile(input.tempPath_ + model->GetName());
+
+    auto xmlFile = MakeShared<XMLFile>(context_);
+    XMLElement xmlRoot = xmlFile->CreateRoot("scene");
+    if (!scene->SaveXML(xmlRoot))
+        return false;
+
+    xmlFile->SaveFile(input.outputFileName_ + "/HLOD.xml");
+    return true;
+}
+
+}
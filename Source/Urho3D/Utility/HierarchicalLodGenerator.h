@@ -0,0 +1,98 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+/// \file
+
+#pragma once
+
+#include "../Graphics/HierarchicalLodProxy.h"
+#include "../Utility/AssetTransformer.h"
+
+namespace Urho3D
+{
+
+class Material;
+class Model;
+class ModelView;
+class Scene;
+
+/// Parameters of hierarchical LOD generation.
+struct URHO3D_API HierarchicalLodParameters
+{
+    /// Size of uniform grid cell used to cluster static models.
+    float clusterSize_{64.0f};
+    /// Minimum number of nodes in cluster. Smaller clusters are left as is.
+    unsigned minNodesInCluster_{2};
+    /// Relative screen size of the cluster below which the proxy is used.
+    float switchScreenSize_{HierarchicalLodProxy::DefaultSwitchScreenSize};
+};
+
+/// Cluster of nodes with static models that is replaced with single proxy.
+struct URHO3D_API HierarchicalLodCluster
+{
+    /// Origin of the proxy in world space.
+    Vector3 center_;
+    /// Nodes in the cluster.
+    ea::vector<Node*> nodes_;
+};
+
+/// Merged geometry of the cluster.
+struct URHO3D_API HierarchicalLodProxyData
+{
+    /// Model in the space of cluster center.
+    SharedPtr<ModelView> model_;
+    /// Material for each geometry of the model.
+    ea::vector<SharedPtr<Material>> materials_;
+    /// Whether any of merged models casts shadows.
+    bool castShadows_{};
+};
+
+/// Group nodes with static models into clusters using uniform grid.
+/// Only nodes that have nothing but enabled StaticModel-s as geometry drawables are clustered.
+URHO3D_API ea::vector<HierarchicalLodCluster> ClusterStaticModels(Scene* scene, const HierarchicalLodParameters& params);
+/// Merge static models of the cluster into single model. The lowest LOD of each geometry is used.
+/// Geometries with the same material and vertex format are merged together.
+URHO3D_API HierarchicalLodProxyData MergeStaticModels(Context* context, const HierarchicalLodCluster& cluster);
+/// Create proxies for all clusters in the scene. Return generated models, named with given prefix and index.
+URHO3D_API ea::vector<SharedPtr<Model>> GenerateHierarchicalLod(
+    Scene* scene, const HierarchicalLodParameters& params, const ea::string& modelNamePrefix);
+
+/// Asset transformer that generates hierarchical LOD proxies for scene files.
+/// Proxy models are stored next to the scene copy with generated proxies.
+class URHO3D_API HierarchicalLodGenerator : public AssetTransformer
+{
+    URHO3D_OBJECT(HierarchicalLodGenerator, AssetTransformer);
+
+public:
+    explicit HierarchicalLodGenerator(Context* context);
+
+    static void RegisterObject(Context* context);
+
+    bool IsApplicable(const AssetTransformerInput& input) override;
+    bool Execute(const AssetTransformerInput& input, AssetTransformerOutput& output, const AssetTransformerVector& transformers) override;
+
+private:
+    HierarchicalLodParameters params_;
+};
+
+}
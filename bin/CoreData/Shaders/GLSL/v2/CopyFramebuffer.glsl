@@ -22,7 +22,9 @@ void main()
 void main()
 {
     vec4 color = texture2D(sDiffMap, vScreenPos);
-    #if defined(URHO3D_GAMMA_TO_LINEAR)
+    #if defined(URHO3D_COPY_DEPTH)
+        gl_FragDepth = color.r;
+    #elif defined(URHO3D_GAMMA_TO_LINEAR)
         gl_FragColor = GammaToLinearSpaceAlpha(color);
     #elif defined(URHO3D_LINEAR_TO_GAMMA)
         gl_FragColor = LinearToGammaSpaceAlpha(color);